@@ -21,6 +21,14 @@ struct StepHook {
     StepHookFn fn = nullptr;
 };
 
+// Blocks until the task has input (true) or a timeout passes (false).
+using WaitHookFn = bool (*)(void *) noexcept;
+
+struct WaitHook {
+    void *ctx = nullptr;
+    WaitHookFn fn = nullptr;
+};
+
 void run_task_fixed_steps(exec::tasks::TaskWrapperRef w, uint32_t steps, std::chrono::milliseconds period,
                           StepHook hook = {})
 {
@@ -33,17 +41,20 @@ void run_task_fixed_steps(exec::tasks::TaskWrapperRef w, uint32_t steps, std::ch
     }
 }
 
-uint32_t run_task_until_stop(exec::tasks::TaskWrapperRef w, const std::atomic<bool> &stop,
-                             std::chrono::milliseconds period, StepHook hook = {})
+// Steps once per input instead of once per period: the wait hook parks the
+// thread between inputs and returns false on timeout, so stop is still seen.
+uint32_t run_task_until_stop(exec::tasks::TaskWrapperRef w, const std::atomic<bool> &stop, WaitHook wait,
+                             StepHook hook = {})
 {
     uint32_t i = 0;
     while (!stop.load(std::memory_order_acquire))
     {
+        if (!wait.fn(wait.ctx))
+            continue;
         w.step_fn(w.obj, i);
         if (hook.fn != nullptr)
             hook.fn(hook.ctx, i);
         ++i;
-        std::this_thread::sleep_for(period);
     }
 
     w.step_fn(w.obj, i);
@@ -81,6 +92,17 @@ struct PrintCtx {
     modules::demo::trivial_nonrt_task *nrt = nullptr;
 };
 
+struct FrameWaitCtx {
+    modules::demo::trivial_nonrt_task *nrt = nullptr;
+    primitives::DoorbellPolicy policy{};
+};
+
+bool frame_wait_hook(void *ctx) noexcept
+{
+    auto *p = static_cast<FrameWaitCtx *>(ctx);
+    return p->nrt->wait_frame(p->policy);
+}
+
 void print_hook(void *ctx, uint32_t tick) noexcept
 {
     const auto *p = static_cast<const PrintCtx *>(ctx);
@@ -95,10 +117,12 @@ void run_rt(exec::tasks::TaskWrapperRef w_rt, std::atomic<bool> &stop, uint32_t
 }
 
 void run_nonrt(exec::tasks::TaskWrapperRef w_nrt, modules::demo::trivial_nonrt_task &nrt,
-               const std::atomic<bool> &stop, std::chrono::milliseconds period)
+               const std::atomic<bool> &stop, std::chrono::milliseconds stop_check)
 {
     PrintCtx ctx{&nrt};
-    (void)run_task_until_stop(w_nrt, stop, period, StepHook{&ctx, &print_hook});
+    FrameWaitCtx wait_ctx{&nrt, {}};
+    wait_ctx.policy.park_timeout_us = static_cast<uint32_t>(stop_check.count() * 1000);
+    (void)run_task_until_stop(w_nrt, stop, WaitHook{&wait_ctx, &frame_wait_hook}, StepHook{&ctx, &print_hook});
 
     std::printf("nrt_final chan={now=%u counter=%u} rx=%u\n", nrt.last_rt_now(),
                 nrt.last_rt_counter(), nrt.rx_frames());
@@ -129,12 +153,12 @@ int main()
 
     constexpr uint32_t rt_steps = 10;
     const auto rt_period = 100ms;
-    const auto nrt_period = 50ms;
+    const auto nrt_stop_check = 50ms;
 
     std::atomic<bool> stop{false};
 
     std::thread rt_thread{run_rt, rt_ref, std::ref(stop), rt_steps, rt_period};
-    std::thread nrt_thread{run_nonrt, nrt_ref, std::ref(nrt), std::cref(stop), nrt_period};
+    std::thread nrt_thread{run_nonrt, nrt_ref, std::ref(nrt), std::cref(stop), nrt_stop_check};
 
     rt_thread.join();
     nrt_thread.join();
@@ -5,6 +5,7 @@
 #include "model/channel_wrapper.hpp"
 #include "model/channel_wrapper_ref.hpp"
 #include "model/port.hpp"
+#include "stam/primitives/doorbell.hpp"
 #include "stam/primitives/mailbox2slot_smp.hpp"
 
 namespace stam::modules::demo {
@@ -17,7 +18,8 @@ struct demo_frame final
 
 static_assert(std::is_trivially_copyable_v<demo_frame>);
 
-using demo_primitive_t = stam::primitives::Mailbox2SlotSmp<demo_frame>;
+// Doorbelled: the non-RT side parks between frames instead of polling.
+using demo_primitive_t = stam::primitives::Doorbelled<stam::primitives::Mailbox2SlotSmp<demo_frame>>;
 using demo_channel_t = stam::model::ChannelWrapper<demo_primitive_t>;
 using demo_writer_t = typename demo_channel_t::writer_t;
 using demo_reader_t = typename demo_channel_t::reader_t;
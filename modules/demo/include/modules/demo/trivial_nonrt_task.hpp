@@ -15,6 +15,11 @@ public:
     [[nodiscard]] stam::model::BindResult bind_port(stam::model::PortName name, demo_reader_t &&reader) noexcept;
     [[nodiscard]] bool is_fully_bound() const noexcept { return sub_.has_value(); }
 
+    // Non-RT: block until the RT side publishes a frame (true) or the park
+    // ends without one (false). Unbound, it sleeps the park timeout and
+    // returns false.
+    [[nodiscard]] bool wait_frame(const stam::primitives::DoorbellPolicy &policy) noexcept;
+
     [[nodiscard]] uint32_t rx_frames() const noexcept { return rx_frames_; }
     [[nodiscard]] uint32_t last_rt_now() const noexcept { return last_rt_now_; }
     [[nodiscard]] uint32_t last_rt_counter() const noexcept { return last_rt_counter_; }
@@ -1,3 +1,5 @@
+#include <chrono>
+#include <thread>
 #include <utility>
 #include "stam/stam.hpp"
 #include "modules/demo/trivial_nonrt_task.hpp"
@@ -18,6 +20,20 @@ stam::model::BindResult trivial_nonrt_task::bind_port(stam::model::PortName name
     return stam::model::BindResult::ok;
 }
 
+bool trivial_nonrt_task::wait_frame(const stam::primitives::DoorbellPolicy &policy) noexcept
+{
+    if (sub_.has_value())
+    {
+        return sub_->wait(policy);
+    }
+    // Unbound: nothing can ring, so still spend the park instead of returning
+    // at once and letting the caller's wait loop spin.
+    const uint32_t us = policy.park_timeout_us != 0u ? policy.park_timeout_us
+                                                     : stam::primitives::Doorbell::kFallbackParkUs;
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+    return false;
+}
+
 void trivial_nonrt_task::step(uint32_t) noexcept
 {
     ++dummy_; // simulate work
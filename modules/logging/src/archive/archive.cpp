@@ -0,0 +1,548 @@
+#include "archive.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "codec/record_codec.hpp"
+#include "recovery/recovery.hpp"
+
+namespace wal::internal {
+
+namespace {
+
+enum ByteColumnMode : uint8_t {
+    kColumnConst = 0,
+    kColumnRle = 1,
+    kColumnRaw = 2,
+};
+
+// Byte columns in record order: version, flags, reserved[10], payload[14].
+constexpr size_t kByteColumns[] = {
+    4, 6,
+    40, 41, 42, 43, 44, 45, 46, 47, 48, 49,
+    50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63,
+};
+
+// --- primitive codecs ---------------------------------------------------------
+
+void put_varint(std::vector<uint8_t>& o, uint64_t v)
+{
+    while (v >= 0x80u) {
+        o.push_back(static_cast<uint8_t>(v | 0x80u));
+        v >>= 7;
+    }
+    o.push_back(static_cast<uint8_t>(v));
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) noexcept
+{
+    v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (p == end)
+            return false;
+        const uint8_t b = *p++;
+        v |= uint64_t{b & 0x7Fu} << shift;
+        if ((b & 0x80u) == 0)
+            return true;
+    }
+    return false;
+}
+
+uint64_t zigzag(uint64_t delta) noexcept
+{
+    const auto d = static_cast<int64_t>(delta);
+    return (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63);
+}
+
+uint64_t unzigzag(uint64_t z) noexcept
+{
+    return (z >> 1) ^ (~(z & 1u) + 1u);
+}
+
+uint8_t byte_at(const LogRecordV2& r, size_t off) noexcept
+{
+    return reinterpret_cast<const uint8_t*>(&r)[off];
+}
+
+uint8_t& byte_at(LogRecordV2& r, size_t off) noexcept
+{
+    return reinterpret_cast<uint8_t*>(&r)[off];
+}
+
+// --- columns ------------------------------------------------------------------
+
+// v[0] raw, then the first delta, then deltas of deltas (all wrapping u64).
+template <typename Get>
+void encode_dod(size_t n, Get get, std::vector<uint8_t>& o)
+{
+    uint64_t prev = 0;
+    uint64_t prev_delta = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t v = get(i);
+        if (i == 0) {
+            put_varint(o, v);
+        } else {
+            const uint64_t delta = v - prev;
+            put_varint(o, zigzag(i == 1 ? delta : delta - prev_delta));
+            prev_delta = delta;
+        }
+        prev = v;
+    }
+}
+
+template <typename Set>
+bool decode_dod(const uint8_t*& p, const uint8_t* end, size_t n, Set set)
+{
+    uint64_t prev = 0;
+    uint64_t prev_delta = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t x = 0;
+        if (!get_varint(p, end, x))
+            return false;
+        uint64_t v = x;
+        if (i == 1) {
+            prev_delta = unzigzag(x);
+            v = prev + prev_delta;
+        } else if (i > 1) {
+            prev_delta += unzigzag(x);
+            v = prev + prev_delta;
+        }
+        set(i, v);
+        prev = v;
+    }
+    return true;
+}
+
+void encode_byte_column(const LogRecordV2* r, size_t n, size_t off, std::vector<uint8_t>& o)
+{
+    size_t runs = 1;
+    for (size_t i = 1; i < n; ++i)
+        runs += byte_at(r[i], off) != byte_at(r[i - 1], off) ? 1u : 0u;
+
+    if (runs == 1) {
+        o.push_back(kColumnConst);
+        o.push_back(byte_at(r[0], off));
+        return;
+    }
+    // A run costs its length varint + 1 byte; compare with n raw bytes.
+    if (runs * 3 < n) {
+        o.push_back(kColumnRle);
+        size_t i = 0;
+        while (i < n) {
+            size_t j = i + 1;
+            while (j < n && byte_at(r[j], off) == byte_at(r[i], off))
+                ++j;
+            put_varint(o, j - i);
+            o.push_back(byte_at(r[i], off));
+            i = j;
+        }
+        return;
+    }
+    o.push_back(kColumnRaw);
+    for (size_t i = 0; i < n; ++i)
+        o.push_back(byte_at(r[i], off));
+}
+
+bool decode_byte_column(const uint8_t*& p, const uint8_t* end, LogRecordV2* r, size_t n, size_t off)
+{
+    if (p == end)
+        return false;
+    const uint8_t mode = *p++;
+    if (mode == kColumnConst) {
+        if (p == end)
+            return false;
+        const uint8_t b = *p++;
+        for (size_t i = 0; i < n; ++i)
+            byte_at(r[i], off) = b;
+        return true;
+    }
+    if (mode == kColumnRle) {
+        size_t i = 0;
+        while (i < n) {
+            uint64_t run = 0;
+            if (!get_varint(p, end, run) || run == 0 || run > n - i || p == end)
+                return false;
+            const uint8_t b = *p++;
+            for (uint64_t k = 0; k < run; ++k)
+                byte_at(r[i++], off) = b;
+        }
+        return true;
+    }
+    if (mode == kColumnRaw) {
+        if (static_cast<size_t>(end - p) < n)
+            return false;
+        for (size_t i = 0; i < n; ++i)
+            byte_at(r[i], off) = *p++;
+        return true;
+    }
+    return false;
+}
+
+unsigned bit_width(unsigned v) noexcept
+{
+    unsigned w = 0;
+    while (v != 0) {
+        ++w;
+        v >>= 1;
+    }
+    return w;
+}
+
+// Dictionary (size - 1, values) then bit-packed indexes, LSB first.
+void encode_dict_column(const LogRecordV2* r, size_t n, size_t off, std::vector<uint8_t>& o)
+{
+    int16_t slot[256];
+    std::memset(slot, -1, sizeof(slot));
+    uint8_t dict[256];
+    unsigned size = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t v = byte_at(r[i], off);
+        if (slot[v] < 0) {
+            slot[v] = static_cast<int16_t>(size);
+            dict[size++] = v;
+        }
+    }
+    o.push_back(static_cast<uint8_t>(size - 1));
+    o.insert(o.end(), dict, dict + size);
+
+    const unsigned w = bit_width(size - 1);
+    uint32_t acc = 0;
+    unsigned bits = 0;
+    for (size_t i = 0; i < n && w != 0; ++i) {
+        acc |= static_cast<uint32_t>(slot[byte_at(r[i], off)]) << bits;
+        bits += w;
+        while (bits >= 8) {
+            o.push_back(static_cast<uint8_t>(acc));
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits != 0)
+        o.push_back(static_cast<uint8_t>(acc));
+}
+
+bool decode_dict_column(const uint8_t*& p, const uint8_t* end, LogRecordV2* r, size_t n, size_t off)
+{
+    if (p == end)
+        return false;
+    const unsigned size = unsigned{*p++} + 1u;
+    if (static_cast<size_t>(end - p) < size)
+        return false;
+    const uint8_t* dict = p;
+    p += size;
+
+    const unsigned w = bit_width(size - 1);
+    if (w == 0) {
+        for (size_t i = 0; i < n; ++i)
+            byte_at(r[i], off) = dict[0];
+        return true;
+    }
+    const size_t bytes = (n * w + 7) / 8;
+    if (static_cast<size_t>(end - p) < bytes)
+        return false;
+    uint32_t acc = 0;
+    unsigned bits = 0;
+    const uint32_t mask = (1u << w) - 1u;
+    for (size_t i = 0; i < n; ++i) {
+        while (bits < w) {
+            acc |= uint32_t{*p++} << bits;
+            bits += 8;
+        }
+        const uint32_t idx = acc & mask;
+        if (idx >= size)
+            return false;
+        byte_at(r[i], off) = dict[idx];
+        acc >>= w;
+        bits -= w;
+    }
+    return true;
+}
+
+// --- file helpers -------------------------------------------------------------
+
+bool write_all(int fd, const void* data, size_t bytes, uint64_t offset) noexcept
+{
+    const auto* p = static_cast<const uint8_t*>(data);
+    while (bytes > 0) {
+        const ssize_t n = ::pwrite(fd, p, bytes, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t bytes, uint64_t offset) noexcept
+{
+    auto* p = static_cast<uint8_t*>(data);
+    while (bytes > 0) {
+        const ssize_t n = ::pread(fd, p, bytes, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+constexpr size_t kBlockCrcFrom = offsetof(ArchiveBlockHeader, records);
+
+uint32_t block_crc(const ArchiveBlockHeader& h, const uint8_t* body, size_t bytes) noexcept
+{
+    uint32_t s = ~0u;
+    s = stam::primitives::crc32c_update(s, reinterpret_cast<const uint8_t*>(&h) + kBlockCrcFrom,
+                                        sizeof(h) - kBlockCrcFrom);
+    s = stam::primitives::crc32c_update(s, body, bytes);
+    return ~s;
+}
+
+} // namespace
+
+std::string archive_path(const std::string& segment_path)
+{
+    constexpr const char kSeg[] = ".seg";
+    constexpr size_t kExt = sizeof(kSeg) - 1;
+    if (segment_path.size() >= kExt && segment_path.compare(segment_path.size() - kExt, kExt, kSeg) == 0)
+        return segment_path.substr(0, segment_path.size() - kExt) + ".arc";
+    return segment_path + ".arc";
+}
+
+void encode_archive_block(const LogRecordV2* r, size_t n, std::vector<uint8_t>& o)
+{
+    if (n == 0)
+        return;
+    encode_dod(n, [r](size_t i) { return r[i].global_seq; }, o);
+    encode_dod(n, [r](size_t i) { return r[i].commit_ts; }, o);
+    for (size_t i = 0; i < n; ++i)
+        put_varint(o, zigzag(r[i].event_ts - r[i].commit_ts));
+
+    uint64_t last[256] = {};
+    for (size_t i = 0; i < n; ++i) {
+        put_varint(o, zigzag(r[i].producer_seq - last[r[i].producer_id]));
+        last[r[i].producer_id] = r[i].producer_seq;
+    }
+
+    encode_dict_column(r, n, offsetof(LogRecordV2, event_type), o);
+    encode_dict_column(r, n, offsetof(LogRecordV2, producer_id), o);
+    for (size_t off : kByteColumns)
+        encode_byte_column(r, n, off, o);
+}
+
+bool decode_archive_block(const uint8_t* body, size_t bytes, size_t n, std::vector<LogRecordV2>& out)
+{
+    out.assign(n, LogRecordV2{});
+    if (n == 0)
+        return bytes == 0;
+    LogRecordV2* r = out.data();
+    const uint8_t* p = body;
+    const uint8_t* end = body + bytes;
+
+    if (!decode_dod(p, end, n, [r](size_t i, uint64_t v) { r[i].global_seq = v; }))
+        return false;
+    if (!decode_dod(p, end, n, [r](size_t i, uint64_t v) { r[i].commit_ts = v; }))
+        return false;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t z = 0;
+        if (!get_varint(p, end, z))
+            return false;
+        r[i].event_ts = r[i].commit_ts + unzigzag(z);
+    }
+    // producer_seq deltas need producer_id: decode the dictionaries first.
+    const uint8_t* seq_col = p;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t z = 0;
+        if (!get_varint(p, end, z))
+            return false;
+    }
+    if (!decode_dict_column(p, end, r, n, offsetof(LogRecordV2, event_type)))
+        return false;
+    if (!decode_dict_column(p, end, r, n, offsetof(LogRecordV2, producer_id)))
+        return false;
+    for (size_t off : kByteColumns) {
+        if (!decode_byte_column(p, end, r, n, off))
+            return false;
+    }
+    if (p != end)
+        return false;
+
+    uint64_t last[256] = {};
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t z = 0;
+        (void)get_varint(seq_col, end, z);
+        r[i].producer_seq = last[r[i].producer_id] + unzigzag(z);
+        last[r[i].producer_id] = r[i].producer_seq;
+    }
+    seal_records(r, n);
+    return true;
+}
+
+bool archive_segment(const char* segment_path, const char* out_path, uint32_t block_records, ArchiveStats* stats)
+{
+    if (block_records == 0)
+        return false;
+    SegmentScan scan{};
+    if (!scan_segment(segment_path, scan))
+        return false;
+
+    const int in = ::open(segment_path, O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+        return false;
+    const std::string tmp = std::string{out_path} + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        ::close(in);
+        return false;
+    }
+
+    ArchiveHeader fh{};
+    std::memcpy(fh.magic, kArchiveMagic, sizeof(fh.magic));
+    fh.version = kArchiveVersion;
+    fh.block_records = block_records;
+    fh.records = scan.records;
+
+    std::vector<LogRecordV2> recs(block_records);
+    std::vector<uint8_t> body;
+    uint64_t at = sizeof(fh);
+    bool ok = true;
+    for (uint64_t done = 0; ok && done < scan.records;) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(block_records, scan.records - done));
+        if (!read_all(in, recs.data(), n * sizeof(LogRecordV2), done * sizeof(LogRecordV2))) {
+            ok = false;
+            break;
+        }
+        body.clear();
+        encode_archive_block(recs.data(), n, body);
+
+        ArchiveBlockHeader bh{};
+        bh.magic = kArchiveBlockMagic;
+        bh.records = static_cast<uint32_t>(n);
+        bh.body_bytes = static_cast<uint32_t>(body.size());
+        bh.first_seq = recs[0].global_seq;
+        bh.last_seq = recs[n - 1].global_seq;
+        bh.min_ts = bh.max_ts = recs[0].commit_ts;
+        for (size_t i = 1; i < n; ++i) {
+            if (ts_before(recs[i].commit_ts, bh.min_ts))
+                bh.min_ts = recs[i].commit_ts;
+            if (ts_before(bh.max_ts, recs[i].commit_ts))
+                bh.max_ts = recs[i].commit_ts;
+        }
+        bh.crc32c = block_crc(bh, body.data(), body.size());
+
+        ok = write_all(fd, &bh, sizeof(bh), at) && write_all(fd, body.data(), body.size(), at + sizeof(bh));
+        at += sizeof(bh) + body.size();
+        done += n;
+        ++fh.blocks;
+    }
+    ::close(in);
+
+    ok = ok && write_all(fd, &fh, sizeof(fh), 0) && ::fdatasync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), out_path) != 0) {
+        (void)::unlink(tmp.c_str());
+        return false;
+    }
+
+    if (stats != nullptr) {
+        stats->records = scan.records;
+        stats->blocks = fh.blocks;
+        stats->segment_bytes = scan.records * sizeof(LogRecordV2);
+        stats->archive_bytes = at;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// ArchiveReader
+// ---------------------------------------------------------------------------
+
+ArchiveReader::~ArchiveReader()
+{
+    close();
+}
+
+ArchiveStatus ArchiveReader::open(const char* path) noexcept
+{
+    close();
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return ArchiveStatus::IoError;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return ArchiveStatus::IoError;
+    }
+    if (!read_all(fd, &header_, sizeof(header_), 0)
+        || std::memcmp(header_.magic, kArchiveMagic, sizeof(header_.magic)) != 0
+        || header_.version != kArchiveVersion) {
+        ::close(fd);
+        return ArchiveStatus::BadHeader;
+    }
+    fd_ = fd;
+    size_ = static_cast<uint64_t>(st.st_size);
+    offset_ = sizeof(header_);
+    return ArchiveStatus::Ok;
+}
+
+void ArchiveReader::close() noexcept
+{
+    if (fd_ >= 0)
+        ::close(fd_);
+    fd_ = -1;
+    offset_ = 0;
+    size_ = 0;
+    header_ = ArchiveHeader{};
+}
+
+ArchiveStatus ArchiveReader::peek(ArchiveBlockHeader& out) noexcept
+{
+    if (fd_ < 0)
+        return ArchiveStatus::IoError;
+    if (offset_ == size_)
+        return ArchiveStatus::End;
+    if (size_ - offset_ < sizeof(out) || !read_all(fd_, &out, sizeof(out), offset_))
+        return ArchiveStatus::BadBlock;
+    if (out.magic != kArchiveBlockMagic || out.records == 0 || out.records > header_.block_records
+        || size_ - offset_ - sizeof(out) < out.body_bytes)
+        return ArchiveStatus::BadBlock;
+    return ArchiveStatus::Ok;
+}
+
+ArchiveStatus ArchiveReader::skip() noexcept
+{
+    ArchiveBlockHeader h{};
+    const ArchiveStatus s = peek(h);
+    if (s == ArchiveStatus::Ok)
+        offset_ += sizeof(h) + h.body_bytes;
+    return s;
+}
+
+ArchiveStatus ArchiveReader::next(std::vector<LogRecordV2>& out)
+{
+    ArchiveBlockHeader h{};
+    const ArchiveStatus s = peek(h);
+    if (s != ArchiveStatus::Ok)
+        return s;
+    body_.resize(h.body_bytes);
+    if (!read_all(fd_, body_.data(), body_.size(), offset_ + sizeof(h)))
+        return ArchiveStatus::IoError;
+    if (block_crc(h, body_.data(), body_.size()) != h.crc32c
+        || !decode_archive_block(body_.data(), body_.size(), h.records, out))
+        return ArchiveStatus::BadBlock;
+    offset_ += sizeof(h) + h.body_bytes;
+    return ArchiveStatus::Ok;
+}
+
+} // namespace wal::internal
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "log_record.hpp"
+
+namespace wal::internal {
+
+// Columnar archive of sealed segments (`<boot_id>_<part_id>.arc`, non-RT).
+//
+// The valid prefix of a segment (§11) is cut into blocks of up to
+// `block_records` records; each block stores its records column by column:
+//
+//   global_seq, commit_ts   delta-of-delta, zigzag LEB128 (a +1 sequence → 1 byte)
+//   event_ts                zigzag LEB128 of (event_ts - commit_ts)
+//   producer_seq            zigzag LEB128 delta to the same producer's previous value
+//   event_type, producer_id dictionary + bit-packed indexes
+//   version, flags,
+//   reserved[10], payload[14]  one byte column each: const, run-length or raw,
+//                              whichever is smallest
+//
+// The record CRC is not stored: the reader recomputes it, so decoded records
+// are byte-identical to the originals. Each block carries its record count,
+// seq range and commit_ts range (scans can skip whole blocks without decoding)
+// and a CRC32C over header and body.
+//
+// File layout: ArchiveHeader, then blocks back to back (ArchiveBlockHeader +
+// body). See wal_format.md §14.
+
+inline constexpr char     kArchiveMagic[8]      = {'W', 'A', 'L', 'A', 'R', 'C', '0', '1'};
+inline constexpr uint32_t kArchiveVersion       = 1;
+inline constexpr uint32_t kArchiveBlockMagic    = 0x314B4C42u; // "BLK1"
+inline constexpr uint32_t kDefaultArchiveBlock  = 4096;        // records per block
+
+struct ArchiveHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t block_records;
+    uint64_t records;
+    uint64_t blocks;
+};
+
+struct ArchiveBlockHeader {
+    uint32_t magic;
+    uint32_t crc32c;       // over the header from `records` on, then the body
+    uint32_t records;
+    uint32_t body_bytes;
+    uint64_t first_seq;
+    uint64_t last_seq;
+    uint64_t min_ts;       // commit_ts range, §6.3 order
+    uint64_t max_ts;
+};
+
+static_assert(sizeof(ArchiveHeader) == 32);
+static_assert(sizeof(ArchiveBlockHeader) == 48);
+
+// "<dir>/00000042_00000001.seg" → "<dir>/00000042_00000001.arc".
+std::string archive_path(const std::string& segment_path);
+
+// Encode `count` records as one block body (appended to `out`).
+void encode_archive_block(const LogRecordV2* records, size_t count, std::vector<uint8_t>& out);
+
+// Decode a block body of `count` records; false → malformed.
+bool decode_archive_block(const uint8_t* body, size_t bytes, size_t count, std::vector<LogRecordV2>& out);
+
+struct ArchiveStats {
+    uint64_t records = 0;
+    uint64_t blocks = 0;
+    uint64_t segment_bytes = 0;   // valid prefix of the source
+    uint64_t archive_bytes = 0;
+};
+
+// Archive the valid prefix of a sealed segment to `out_path` (temporary file,
+// fsync, rename). The segment itself is left in place.
+bool archive_segment(const char* segment_path, const char* out_path,
+                     uint32_t block_records = kDefaultArchiveBlock, ArchiveStats* stats = nullptr);
+
+enum class ArchiveStatus : uint8_t {
+    Ok,
+    End,          // no more blocks
+    IoError,
+    BadHeader,
+    BadBlock,     // CRC mismatch or malformed body
+};
+
+// Sequential reader: block by block, back to LogRecordV2.
+class ArchiveReader {
+public:
+    ArchiveReader() noexcept = default;
+    ~ArchiveReader();
+
+    ArchiveReader(const ArchiveReader&) = delete;
+    ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+    ArchiveStatus open(const char* path) noexcept;
+    void close() noexcept;
+
+    [[nodiscard]] const ArchiveHeader& header() const noexcept { return header_; }
+
+    // Header of the next block, without reading its body.
+    ArchiveStatus peek(ArchiveBlockHeader& out) noexcept;
+
+    // Skip the next block (after peek(), e.g. out of the wanted range).
+    ArchiveStatus skip() noexcept;
+
+    // Read, verify and decode the next block into `out` (replaced).
+    ArchiveStatus next(std::vector<LogRecordV2>& out);
+
+private:
+    int fd_ = -1;
+    uint64_t offset_ = 0;
+    uint64_t size_ = 0;
+    ArchiveHeader header_{};
+    std::vector<uint8_t> body_;
+};
+
+} // namespace wal::internal
@@ -1,10 +1,46 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
+#include "log_record.hpp"
+
 namespace wal::internal {
 
+// Durable sink for 64-byte WAL records (non-RT domain).
+//
+// Records are appended to the open segment strictly in submission order.
+// submit() hands over one batch: the backend copies the records into its own
+// buffers (the caller may reuse its array on return) and starts making them
+// durable (data written + fdatasync). Completion is observed through poll():
+// durable() counts records, since construction, whose batch and every earlier
+// batch are on stable storage — a contiguous watermark, never a hole.
+//
+// Errors are sticky: after the first failed I/O, failed() stays true and
+// submit() returns false. The caller stops, reopens or fails over.
 class Backend {
 public:
     virtual ~Backend() = default;
+
+    // Close the current segment (after drain) and open `path` for appending.
+    // Existing content is kept; new records go after it.
+    virtual bool open_segment(const char* path) noexcept = 0;
+
+    // Queue `count` records for write + fdatasync. May block while all
+    // in-flight buffers are busy (backpressure). false → failed() or no segment.
+    virtual bool submit(const LogRecordV2* records, size_t count) noexcept = 0;
+
+    // Reap completions without blocking; returns durable().
+    virtual uint64_t poll() noexcept = 0;
+
+    // Block until everything submitted is durable (or failed); returns durable().
+    virtual uint64_t drain() noexcept = 0;
+
+    // drain() and close the segment.
+    virtual void close_segment() noexcept = 0;
+
+    [[nodiscard]] virtual uint64_t durable() const noexcept = 0;
+    [[nodiscard]] virtual bool failed() const noexcept = 0;
 };
 
 } // namespace wal::internal
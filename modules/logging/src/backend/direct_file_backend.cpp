@@ -0,0 +1,293 @@
+#include "direct_file_backend.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wal::internal {
+
+namespace {
+
+constexpr unsigned kSlotBits = 8;
+
+bool valid_at(const uint8_t* p) noexcept
+{
+    LogRecordV2 r;
+    std::memcpy(&r, p, sizeof(r));
+    return record_valid(r);
+}
+
+} // namespace
+
+DirectFileBackend::DirectFileBackend(const DirectFileBackendConfig& cfg) noexcept
+    : cfg_(cfg)
+{
+    if (cfg_.pages < 2)
+        cfg_.pages = 2;
+    if (cfg_.pages > DirectFileBackendConfig::kMaxPages)
+        cfg_.pages = DirectFileBackendConfig::kMaxPages;
+    if (cfg_.page_bytes < 512 || cfg_.page_bytes % 512 != 0)
+        cfg_.page_bytes = 4096;
+
+#if WAL_HAVE_IO_URING
+    if (!ring_.init(cfg_.pages))
+        return;
+
+    buffers_ = stam::sys::sys_mem_map(size_t{cfg_.page_bytes} * cfg_.pages, stam::sys::sys_mem_policy{});
+    if (buffers_.addr == nullptr) {
+        ring_.shutdown();
+        return;
+    }
+
+    iovec iov[DirectFileBackendConfig::kMaxPages];
+    for (uint32_t i = 0; i < cfg_.pages; ++i) {
+        iov[i].iov_base = page(i);
+        iov[i].iov_len = cfg_.page_bytes;
+    }
+    fixed_bufs_ = ring_.register_buffers(iov, cfg_.pages) >= 0;
+#endif
+}
+
+DirectFileBackend::~DirectFileBackend()
+{
+    close_segment();
+#if WAL_HAVE_IO_URING
+    ring_.shutdown();
+#endif
+    stam::sys::sys_mem_unmap(buffers_);
+}
+
+bool DirectFileBackend::available() const noexcept
+{
+#if WAL_HAVE_IO_URING
+    return ring_.ready() && buffers_.addr != nullptr;
+#else
+    return false;
+#endif
+}
+
+uint8_t* DirectFileBackend::page(uint32_t slot) noexcept
+{
+    return static_cast<uint8_t*>(buffers_.addr) + size_t{slot} * cfg_.page_bytes;
+}
+
+bool DirectFileBackend::open_segment(const char* path) noexcept
+{
+    if (!available())
+        return false;
+    close_segment();
+
+    const int fd = ::open(path, O_RDWR | O_CREAT | O_DIRECT | O_DSYNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Resume inside the tail page: reload it and keep its valid prefix. Zero
+    // padding and a torn record both end it (§11 stops there too); everything
+    // after is zeroed in the buffer and overwritten by the next tail write. A
+    // page-aligned end may still be a padded tail, so look at the page holding
+    // the last byte.
+    const uint64_t end = static_cast<uint64_t>(st.st_size) / sizeof(LogRecordV2) * sizeof(LogRecordV2);
+    page_no_ = end == 0 ? 0 : (end - 1) / cfg_.page_bytes;
+    cur_ = 0;
+    fill_ = 0;
+    uint8_t* buf = page(cur_);
+    std::memset(buf, 0, cfg_.page_bytes);
+
+    const uint64_t in_page = end - page_no_ * cfg_.page_bytes;
+    if (in_page != 0) {
+        const ssize_t n = ::pread(fd, buf, cfg_.page_bytes, static_cast<off_t>(page_no_ * cfg_.page_bytes));
+        if (n < static_cast<ssize_t>(in_page)) {
+            ::close(fd);
+            return false;
+        }
+        const uint32_t max_fill = static_cast<uint32_t>(in_page / sizeof(LogRecordV2));
+        while (fill_ < max_fill && valid_at(buf + size_t{fill_} * sizeof(LogRecordV2)))
+            ++fill_;
+        if (fill_ == records_per_page()) {
+            // Tail page is full: continue on a fresh page.
+            ++page_no_;
+            fill_ = 0;
+        }
+        std::memset(buf + size_t{fill_} * sizeof(LogRecordV2), 0,
+                    cfg_.page_bytes - size_t{fill_} * sizeof(LogRecordV2));
+    }
+
+    fd_ = fd;
+    return true;
+}
+
+bool DirectFileBackend::submit(const LogRecordV2* records, size_t count) noexcept
+{
+    if (failed_ || fd_ < 0)
+        return false;
+
+    const uint32_t per_page = records_per_page();
+    while (count > 0) {
+        // The current buffer may still be in flight from a previous tail write.
+        if (!wait_slot(cur_))
+            return false;
+
+        const uint32_t room = per_page - fill_;
+        const uint32_t n = count < room ? static_cast<uint32_t>(count) : room;
+        std::memcpy(page(cur_) + size_t{fill_} * sizeof(LogRecordV2), records, size_t{n} * sizeof(LogRecordV2));
+        fill_ += n;
+        submitted_ += n;
+        records += n;
+        count -= n;
+
+        if (fill_ == per_page) {
+            if (!write_page(cur_))
+                return false;
+            cur_ = (cur_ + 1) % cfg_.pages;
+            ++page_no_;
+            fill_ = 0;
+            if (!wait_slot(cur_))
+                return false;
+            std::memset(page(cur_), 0, cfg_.page_bytes);
+        }
+    }
+
+    // Partially filled tail page: write it zero-padded; rewritten by later submits.
+    if (fill_ != 0 && !write_page(cur_))
+        return false;
+
+#if WAL_HAVE_IO_URING
+    if (ring_.submit(0) < 0)
+        failed_ = true;
+#endif
+    return !failed_;
+}
+
+bool DirectFileBackend::write_page(uint32_t slot) noexcept
+{
+#if WAL_HAVE_IO_URING
+    // Op ring holds cfg_.pages entries in submission order.
+    while (ops_submitted_ - ops_retired_ >= cfg_.pages) {
+        if (!wait_one())
+            return false;
+    }
+
+    io_uring_sqe* sqe = ring_.get_sqe();
+    if (sqe == nullptr) {
+        if (ring_.submit(0) < 0 || (sqe = ring_.get_sqe()) == nullptr) {
+            failed_ = true;
+            return false;
+        }
+    }
+
+    uint8_t* buf = page(slot);
+    sqe->opcode = fixed_bufs_ ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(buf);
+    sqe->len = cfg_.page_bytes;
+    sqe->off = page_no_ * cfg_.page_bytes;
+    sqe->buf_index = static_cast<uint16_t>(fixed_bufs_ ? slot : 0);
+    sqe->user_data = (ops_submitted_ << kSlotBits) | slot;
+
+    ops_[ops_submitted_ % cfg_.pages] = Op{submitted_, false};
+    ++ops_submitted_;
+    ++cqes_pending_;
+    slot_busy_[slot] = true;
+    return true;
+#else
+    (void)slot;
+    return false;
+#endif
+}
+
+bool DirectFileBackend::wait_slot(uint32_t slot) noexcept
+{
+    while (slot_busy_[slot]) {
+        if (!wait_one())
+            return false;
+    }
+    return true;
+}
+
+bool DirectFileBackend::wait_one() noexcept
+{
+    if (failed_)
+        return false;
+#if WAL_HAVE_IO_URING
+    if (ring_.submit(1) < 0) {
+        failed_ = true;
+        return false;
+    }
+#endif
+    reap();
+    return !failed_;
+}
+
+void DirectFileBackend::reap() noexcept
+{
+#if WAL_HAVE_IO_URING
+    while (io_uring_cqe* cqe = ring_.peek_cqe()) {
+        const uint64_t ud = cqe->user_data;
+        const int res = cqe->res;
+        ring_.cqe_seen();
+        --cqes_pending_;
+
+        slot_busy_[ud & ((1u << kSlotBits) - 1u)] = false;
+        if (res != static_cast<int>(cfg_.page_bytes))
+            failed_ = true;
+        else
+            ops_[(ud >> kSlotBits) % cfg_.pages].done = true;
+    }
+
+    // Ops retire in submission order; each covers every record submitted before it.
+    while (ops_retired_ < ops_submitted_) {
+        Op& op = ops_[ops_retired_ % cfg_.pages];
+        if (!op.done)
+            break;
+        if (op.end > durable_)
+            durable_ = op.end;
+        op = Op{};
+        ++ops_retired_;
+    }
+#endif
+}
+
+uint64_t DirectFileBackend::poll() noexcept
+{
+    reap();
+    return durable_;
+}
+
+uint64_t DirectFileBackend::drain() noexcept
+{
+#if WAL_HAVE_IO_URING
+    while (cqes_pending_ > 0) {
+        if (ring_.submit(1) < 0) {
+            failed_ = true;
+            break;
+        }
+        reap();
+    }
+#endif
+    return durable_;
+}
+
+void DirectFileBackend::close_segment() noexcept
+{
+    if (fd_ < 0)
+        return;
+    drain();
+    // Drop the zero padding of the tail page.
+    if (!failed_) {
+        const uint64_t end = page_no_ * cfg_.page_bytes + uint64_t{fill_} * sizeof(LogRecordV2);
+        (void)::ftruncate(fd_, static_cast<off_t>(end));
+    }
+    ::close(fd_);
+    fd_ = -1;
+    fill_ = 0;
+    page_no_ = 0;
+}
+
+} // namespace wal::internal
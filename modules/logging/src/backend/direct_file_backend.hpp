@@ -0,0 +1,97 @@
+#pragma once
+
+#include "backend.hpp"
+#include "uring.hpp"
+
+#include "stam/sys/sys_mem.hpp"
+
+namespace wal::internal {
+
+struct DirectFileBackendConfig {
+    static constexpr uint32_t kMaxPages = 64;
+
+    uint32_t page_bytes = 4096; // commit page; multiple of the device logical block and of 64
+    uint32_t pages = 8;         // page buffers, 2..kMaxPages (double buffering and deeper)
+};
+
+// O_DIRECT | O_DSYNC page-writer backend (Linux, io_uring).
+//
+// 64-byte records divide evenly into commit pages (64 per 4 KiB page). Records
+// are copied in place into page-aligned, registered page buffers; the writer
+// flips to the next buffer when a page fills and the full page is written
+// while the next one is being filled. At the end of each submit() the partially
+// filled tail page (zero-padded) is written too; later submits append to the
+// same buffer and rewrite only that tail page. Bypassing the page cache removes
+// double buffering and writeback bursts; O_DSYNC makes each completed page
+// write durable (FUA on capable devices), so no separate fdatasync is queued.
+//
+// Writes to one page are serialized: a buffer is not modified or resubmitted
+// while its previous write is in flight (two writes of one offset could
+// otherwise complete out of order).
+//
+// On disk the segment is a sequence of valid records followed by zero padding
+// up to the page boundary; an all-zero record is never valid (§3, version 0),
+// so recovery stops there. close_segment() truncates the padding away;
+// open_segment() on an existing file resumes at the first invalid record of
+// the tail page (padding or a torn write), so appends stay reachable.
+class DirectFileBackend final : public Backend {
+public:
+    explicit DirectFileBackend(const DirectFileBackendConfig& cfg = {}) noexcept;
+    ~DirectFileBackend() override;
+
+    DirectFileBackend(const DirectFileBackend&) = delete;
+    DirectFileBackend& operator=(const DirectFileBackend&) = delete;
+
+    [[nodiscard]] bool available() const noexcept;
+
+    // Fails if the filesystem does not support O_DIRECT (e.g. tmpfs).
+    bool open_segment(const char* path) noexcept override;
+    bool submit(const LogRecordV2* records, size_t count) noexcept override;
+    uint64_t poll() noexcept override;
+    uint64_t drain() noexcept override;
+    void close_segment() noexcept override;
+
+    [[nodiscard]] uint64_t durable() const noexcept override { return durable_; }
+    [[nodiscard]] bool failed() const noexcept override { return failed_; }
+
+    // Page writes issued so far (full pages + tail rewrites).
+    [[nodiscard]] uint64_t page_writes() const noexcept { return ops_submitted_; }
+
+private:
+    struct Op {
+        uint64_t end = 0;  // records submitted (since construction) covered once this op is durable
+        bool done = false;
+    };
+
+    uint8_t* page(uint32_t slot) noexcept;
+    uint32_t records_per_page() const noexcept { return cfg_.page_bytes / sizeof(LogRecordV2); }
+    bool wait_slot(uint32_t slot) noexcept;
+    bool write_page(uint32_t slot) noexcept;
+    bool wait_one() noexcept;
+    void reap() noexcept;
+
+    DirectFileBackendConfig cfg_;
+
+#if WAL_HAVE_IO_URING
+    Uring ring_;
+#endif
+    stam::sys::sys_mem_region buffers_{};
+    bool fixed_bufs_ = false;
+
+    int fd_ = -1;
+    uint32_t cur_ = 0;          // slot being filled
+    uint32_t fill_ = 0;         // records in the current page
+    uint64_t page_no_ = 0;      // file page index of the current page
+    bool slot_busy_[DirectFileBackendConfig::kMaxPages]{};
+
+    Op ops_[DirectFileBackendConfig::kMaxPages]{};
+    uint64_t ops_submitted_ = 0;
+    uint64_t ops_retired_ = 0;
+    uint32_t cqes_pending_ = 0;
+
+    uint64_t submitted_ = 0;    // records accepted since construction
+    uint64_t durable_ = 0;
+    bool failed_ = false;
+};
+
+} // namespace wal::internal
@@ -1 +1,70 @@
 #include "file_backend.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wal::internal {
+
+FileBackend::~FileBackend()
+{
+    close_segment();
+}
+
+bool FileBackend::open_segment(const char* path) noexcept
+{
+    close_segment();
+
+    const int fd = ::open(path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    offset_ = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+bool FileBackend::submit(const LogRecordV2* records, size_t count) noexcept
+{
+    if (failed_ || fd_ < 0)
+        return false;
+
+    const auto* p = reinterpret_cast<const uint8_t*>(records);
+    size_t left = count * sizeof(LogRecordV2);
+    while (left > 0) {
+        const ssize_t n = ::pwrite(fd_, p, left, static_cast<off_t>(offset_));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            failed_ = true;
+            return false;
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+        offset_ += static_cast<uint64_t>(n);
+    }
+
+    if (::fdatasync(fd_) != 0) {
+        failed_ = true;
+        return false;
+    }
+    durable_ += count;
+    return true;
+}
+
+void FileBackend::close_segment() noexcept
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    offset_ = 0;
+}
+
+} // namespace wal::internal
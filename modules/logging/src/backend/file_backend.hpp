@@ -1,3 +1,33 @@
 #pragma once
 
 #include "backend.hpp"
+
+namespace wal::internal {
+
+// Portable synchronous backend: pwrite + fdatasync inside submit().
+// Reference implementation and fallback where io_uring is unavailable.
+class FileBackend final : public Backend {
+public:
+    FileBackend() noexcept = default;
+    ~FileBackend() override;
+
+    FileBackend(const FileBackend&) = delete;
+    FileBackend& operator=(const FileBackend&) = delete;
+
+    bool open_segment(const char* path) noexcept override;
+    bool submit(const LogRecordV2* records, size_t count) noexcept override;
+    uint64_t poll() noexcept override { return durable_; }
+    uint64_t drain() noexcept override { return durable_; }
+    void close_segment() noexcept override;
+
+    [[nodiscard]] uint64_t durable() const noexcept override { return durable_; }
+    [[nodiscard]] bool failed() const noexcept override { return failed_; }
+
+private:
+    int fd_ = -1;
+    uint64_t offset_ = 0;
+    uint64_t durable_ = 0;
+    bool failed_ = false;
+};
+
+} // namespace wal::internal
@@ -0,0 +1,260 @@
+#include "io_uring_backend.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wal::internal {
+
+namespace {
+
+constexpr uint64_t kFsyncTag = 1u;
+
+size_t round_up(size_t v, size_t a) noexcept
+{
+    return (v + a - 1u) / a * a;
+}
+
+} // namespace
+
+IoUringBackend::IoUringBackend(const IoUringBackendConfig& cfg) noexcept
+    : cfg_(cfg)
+{
+    if (cfg_.batch_records == 0)
+        cfg_.batch_records = 1;
+    if (cfg_.batches_in_flight == 0)
+        cfg_.batches_in_flight = 1;
+    if (cfg_.batches_in_flight > IoUringBackendConfig::kMaxBatchesInFlight)
+        cfg_.batches_in_flight = IoUringBackendConfig::kMaxBatchesInFlight;
+
+#if WAL_HAVE_IO_URING
+    if (!ring_.init(2u * cfg_.batches_in_flight))
+        return;
+
+    // Buffers live in one prefaulted, locked mapping: no first-touch faults and
+    // no reclaim while the kernel DMAs out of them.
+    const size_t page = stam::sys::detail::base_page_size();
+    const size_t batch_bytes = round_up(size_t{cfg_.batch_records} * sizeof(LogRecordV2), page);
+    buffers_ = stam::sys::sys_mem_map(batch_bytes * cfg_.batches_in_flight, stam::sys::sys_mem_policy{});
+    if (buffers_.addr == nullptr) {
+        ring_.shutdown();
+        return;
+    }
+
+    iovec iov[IoUringBackendConfig::kMaxBatchesInFlight];
+    for (uint32_t i = 0; i < cfg_.batches_in_flight; ++i) {
+        iov[i].iov_base = buffer(i);
+        iov[i].iov_len = batch_bytes;
+    }
+    fixed_bufs_ = ring_.register_buffers(iov, cfg_.batches_in_flight) >= 0;
+#endif
+}
+
+IoUringBackend::~IoUringBackend()
+{
+    close_segment();
+#if WAL_HAVE_IO_URING
+    ring_.shutdown();
+#endif
+    stam::sys::sys_mem_unmap(buffers_);
+}
+
+bool IoUringBackend::available() const noexcept
+{
+#if WAL_HAVE_IO_URING
+    return ring_.ready() && buffers_.addr != nullptr;
+#else
+    return false;
+#endif
+}
+
+uint8_t* IoUringBackend::buffer(uint32_t slot) noexcept
+{
+    const size_t batch_bytes = buffers_.bytes / cfg_.batches_in_flight;
+    return static_cast<uint8_t*>(buffers_.addr) + size_t{slot} * batch_bytes;
+}
+
+bool IoUringBackend::open_segment(const char* path) noexcept
+{
+    if (!available())
+        return false;
+    close_segment();
+
+    const int fd = ::open(path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    offset_ = static_cast<uint64_t>(st.st_size);
+
+#if WAL_HAVE_IO_URING
+    // Registered file slot 0 follows the open segment.
+    if (!files_registered_) {
+        files_registered_ = ring_.register_files(&fd_, 1) >= 0;
+        fixed_files_ = files_registered_;
+    } else {
+        fixed_files_ = ring_.update_file(0, fd_) >= 0;
+    }
+#endif
+    return true;
+}
+
+bool IoUringBackend::submit(const LogRecordV2* records, size_t count) noexcept
+{
+    if (failed_ || fd_ < 0)
+        return false;
+
+    while (count > 0) {
+        const uint32_t n = count > cfg_.batch_records ? cfg_.batch_records : static_cast<uint32_t>(count);
+        if (!submit_one(records, n))
+            return false;
+        records += n;
+        count -= n;
+    }
+
+#if WAL_HAVE_IO_URING
+    if (ring_.submit(0) < 0) {
+        failed_ = true;
+        return false;
+    }
+#endif
+    return !failed_;
+}
+
+bool IoUringBackend::submit_one(const LogRecordV2* records, uint32_t count) noexcept
+{
+#if WAL_HAVE_IO_URING
+    // Backpressure: wait until the oldest in-flight batch retires.
+    while (submitted_ - retired_ >= cfg_.batches_in_flight) {
+        if (failed_)
+            return false;
+        if (ring_.submit(1) < 0) {
+            failed_ = true;
+            return false;
+        }
+        reap();
+    }
+
+    const uint32_t slot = static_cast<uint32_t>(submitted_ % cfg_.batches_in_flight);
+    const uint32_t bytes = count * static_cast<uint32_t>(sizeof(LogRecordV2));
+    uint8_t* buf = buffer(slot);
+    std::memcpy(buf, records, bytes);
+    batches_[slot] = Batch{count, false, false};
+
+    io_uring_sqe* w = ring_.get_sqe();
+    io_uring_sqe* f = ring_.get_sqe();
+    if (w == nullptr || f == nullptr) {
+        // SQ is sized for 2 SQEs per in-flight batch; cannot happen.
+        failed_ = true;
+        return false;
+    }
+
+    const uint8_t file_flag = fixed_files_ ? IOSQE_FIXED_FILE : 0;
+    const int fd = fixed_files_ ? 0 : fd_;
+
+    w->opcode = fixed_bufs_ ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    w->flags = static_cast<uint8_t>(IOSQE_IO_LINK | file_flag);
+    w->fd = fd;
+    w->addr = reinterpret_cast<uint64_t>(buf);
+    w->len = bytes;
+    w->off = offset_;
+    w->buf_index = static_cast<uint16_t>(fixed_bufs_ ? slot : 0);
+    w->user_data = submitted_ << 1;
+
+    f->opcode = IORING_OP_FSYNC;
+    f->flags = file_flag;
+    f->fd = fd;
+    f->fsync_flags = IORING_FSYNC_DATASYNC;
+    f->user_data = (submitted_ << 1) | kFsyncTag;
+
+    offset_ += bytes;
+    ++submitted_;
+    cqes_pending_ += 2;
+    return true;
+#else
+    (void)records;
+    (void)count;
+    return false;
+#endif
+}
+
+void IoUringBackend::reap() noexcept
+{
+#if WAL_HAVE_IO_URING
+    while (io_uring_cqe* cqe = ring_.peek_cqe()) {
+        const uint64_t ud = cqe->user_data;
+        const int res = cqe->res;
+        ring_.cqe_seen();
+        --cqes_pending_;
+
+        Batch& b = batches_[(ud >> 1) % cfg_.batches_in_flight];
+        if ((ud & kFsyncTag) == 0) {
+            // Short write breaks the link as well; the fsync completes with -ECANCELED.
+            if (res != static_cast<int>(b.records * sizeof(LogRecordV2)))
+                failed_ = true;
+            else
+                b.write_done = true;
+        } else {
+            if (res < 0)
+                failed_ = true;
+            else
+                b.sync_done = true;
+        }
+    }
+    retire();
+#endif
+}
+
+void IoUringBackend::retire() noexcept
+{
+    while (retired_ < submitted_) {
+        Batch& b = batches_[retired_ % cfg_.batches_in_flight];
+        if (!b.write_done || !b.sync_done)
+            break;
+        durable_ += b.records;
+        b = Batch{};
+        ++retired_;
+    }
+}
+
+uint64_t IoUringBackend::poll() noexcept
+{
+    reap();
+    return durable_;
+}
+
+uint64_t IoUringBackend::drain() noexcept
+{
+#if WAL_HAVE_IO_URING
+    while (cqes_pending_ > 0) {
+        if (ring_.submit(1) < 0) {
+            failed_ = true;
+            break;
+        }
+        reap();
+    }
+#endif
+    return durable_;
+}
+
+void IoUringBackend::close_segment() noexcept
+{
+    if (fd_ < 0)
+        return;
+    drain();
+#if WAL_HAVE_IO_URING
+    if (fixed_files_)
+        (void)ring_.update_file(0, -1);
+#endif
+    ::close(fd_);
+    fd_ = -1;
+    offset_ = 0;
+    fixed_files_ = false;
+}
+
+} // namespace wal::internal
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "backend.hpp"
+#include "uring.hpp"
+
+#include "stam/sys/sys_mem.hpp"
+
+namespace wal::internal {
+
+struct IoUringBackendConfig {
+    static constexpr uint32_t kMaxBatchesInFlight = 64;
+
+    uint32_t batch_records = 1024;   // records per fixed buffer (1024 * 64 B = 64 KiB)
+    uint32_t batches_in_flight = 8;  // fixed buffers, 1..kMaxBatchesInFlight; SQ depth = 2x
+};
+
+// Linux io_uring backend.
+//
+// Each submitted batch is copied into one of `batches_in_flight` pre-registered
+// (IORING_REGISTER_BUFFERS) page-aligned buffers and queued as
+//
+//     WRITE_FIXED(buf, offset) --IOSQE_IO_LINK--> FSYNC(IORING_FSYNC_DATASYNC)
+//
+// against the registered segment fd (IOSQE_FIXED_FILE). The fsync only starts
+// after its own write completed; a failed write cancels it. Up to
+// `batches_in_flight` batches are outstanding, so the device queue stays
+// several batches deep while the caller prepares the next one.
+//
+// Batches may complete out of order; durable() advances only over the
+// contiguous prefix of batches whose fsync has completed.
+//
+// If registration is refused (old kernel, RLIMIT_MEMLOCK), plain WRITE with
+// unregistered buffers / fds is used instead. If io_uring itself is unavailable
+// open_segment() fails: use FileBackend.
+class IoUringBackend final : public Backend {
+public:
+    explicit IoUringBackend(const IoUringBackendConfig& cfg = {}) noexcept;
+    ~IoUringBackend() override;
+
+    IoUringBackend(const IoUringBackend&) = delete;
+    IoUringBackend& operator=(const IoUringBackend&) = delete;
+
+    // true if io_uring could be set up in this process.
+    [[nodiscard]] bool available() const noexcept;
+
+    bool open_segment(const char* path) noexcept override;
+    bool submit(const LogRecordV2* records, size_t count) noexcept override;
+    uint64_t poll() noexcept override;
+    uint64_t drain() noexcept override;
+    void close_segment() noexcept override;
+
+    [[nodiscard]] uint64_t durable() const noexcept override { return durable_; }
+    [[nodiscard]] bool failed() const noexcept override { return failed_; }
+
+    [[nodiscard]] bool fixed_buffers() const noexcept { return fixed_bufs_; }
+    [[nodiscard]] bool fixed_files() const noexcept { return fixed_files_; }
+
+private:
+    struct Batch {
+        uint32_t records = 0;
+        bool write_done = false;
+        bool sync_done = false;
+    };
+
+    bool submit_one(const LogRecordV2* records, uint32_t count) noexcept;
+    void reap() noexcept;
+    void retire() noexcept;
+    uint8_t* buffer(uint32_t slot) noexcept;
+
+    IoUringBackendConfig cfg_;
+
+#if WAL_HAVE_IO_URING
+    Uring ring_;
+#endif
+    stam::sys::sys_mem_region buffers_{};
+    Batch batches_[IoUringBackendConfig::kMaxBatchesInFlight]{};
+
+    int fd_ = -1;
+    uint64_t offset_ = 0;
+
+    uint64_t submitted_ = 0;     // batches submitted
+    uint64_t retired_ = 0;       // batches durable (contiguous prefix)
+    uint32_t cqes_pending_ = 0;  // CQEs still owed by the kernel
+
+    uint64_t durable_ = 0;
+    bool failed_ = false;
+    bool fixed_bufs_ = false;
+    bool fixed_files_ = false;
+    bool files_registered_ = false;
+};
+
+} // namespace wal::internal
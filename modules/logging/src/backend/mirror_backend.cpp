@@ -0,0 +1,119 @@
+#include "mirror_backend.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace wal::internal {
+
+MirrorBackend::MirrorBackend(Backend& a, const char* dir_a, Backend& b, const char* dir_b) noexcept
+    : legs_{&a, &b}, dirs_{dir_a, dir_b}, base_{a.durable(), b.durable()}
+{
+    for (int i = 0; i < kLegs; ++i) {
+        if (legs_[i]->failed())
+            live_[i] = false;
+    }
+}
+
+MirrorBackend::~MirrorBackend()
+{
+    close_segment();
+}
+
+uint64_t MirrorBackend::leg_durable(int leg) const noexcept
+{
+    return legs_[leg]->durable() - base_[leg];
+}
+
+void MirrorBackend::drop(int leg) noexcept
+{
+    live_[leg] = false;
+    if (open_)
+        legs_[leg]->close_segment();
+}
+
+uint64_t MirrorBackend::update() noexcept
+{
+    uint64_t d = UINT64_MAX;
+    for (int i = 0; i < kLegs; ++i) {
+        if (live_[i] && legs_[i]->failed())
+            drop(i);
+        if (live_[i] && leg_durable(i) < d)
+            d = leg_durable(i);
+    }
+    // Dropping the slower leg can only move the watermark forward.
+    if (d != UINT64_MAX && d > durable_)
+        durable_ = d;
+    return durable_;
+}
+
+bool MirrorBackend::open_segment(const char* path) noexcept
+{
+    close_segment();
+
+    const char* slash = std::strrchr(path, '/');
+    const char* name = slash != nullptr ? slash + 1 : path;
+
+    bool opened[kLegs] = {false, false};
+    for (int i = 0; i < kLegs; ++i) {
+        if (live_[i])
+            opened[i] = legs_[i]->open_segment((dirs_[i] + "/" + name).c_str());
+    }
+    if (!opened[0] && !opened[1])
+        return false;
+
+    // Only the leg that could not follow is dropped: a path that opens
+    // nowhere is the caller's error, not a device failure.
+    for (int i = 0; i < kLegs; ++i) {
+        if (live_[i] && !opened[i])
+            drop(i);
+    }
+    open_ = true;
+    return true;
+}
+
+bool MirrorBackend::submit(const LogRecordV2* records, size_t count) noexcept
+{
+    if (!open_ || failed())
+        return false;
+
+    // Both legs queue before either is waited on; an asynchronous leg
+    // returns as soon as its writes are in flight.
+    for (int i = 0; i < kLegs; ++i) {
+        if (live_[i] && !legs_[i]->submit(records, count))
+            drop(i);
+    }
+    update();
+    return !failed();
+}
+
+uint64_t MirrorBackend::poll() noexcept
+{
+    for (int i = 0; i < kLegs; ++i) {
+        if (live_[i])
+            (void)legs_[i]->poll();
+    }
+    return update();
+}
+
+uint64_t MirrorBackend::drain() noexcept
+{
+    for (int i = 0; i < kLegs; ++i) {
+        if (live_[i])
+            (void)legs_[i]->drain();
+    }
+    return update();
+}
+
+void MirrorBackend::close_segment() noexcept
+{
+    if (!open_)
+        return;
+    for (int i = 0; i < kLegs; ++i) {
+        if (live_[i])
+            legs_[i]->close_segment();
+    }
+    update();
+    open_ = false;
+}
+
+} // namespace wal::internal
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+
+#include "backend.hpp"
+
+namespace wal::internal {
+
+// Two-device mirror: every batch goes to two segment directories.
+//
+// The legs are ordinary backends, one per device (not owned). open_segment()
+// opens the file name of `path` in each leg's directory, submit() hands the
+// batch to both, and durable() is the minimum of the two legs' watermarks: a
+// record counts as durable once it is on stable storage on both devices.
+// With asynchronous legs (IoUringBackend, DirectFileBackend: one ring each)
+// submit() only queues, so both devices work on the batch at the same time
+// and a commit costs the slower device's latency, not the sum.
+//
+// A failed leg is dropped and the mirror continues on the other one
+// (degraded(); durable() is then the survivor's). failed() only when both
+// legs have failed. Errors of a leg are sticky, like the leg's own.
+//
+// After a crash the two copies may end at different records: reconcile them
+// with recover_mirror() (recovery.hpp) before opening segments again.
+class MirrorBackend final : public Backend {
+public:
+    static constexpr int kLegs = 2;
+
+    MirrorBackend(Backend& a, const char* dir_a, Backend& b, const char* dir_b) noexcept;
+    ~MirrorBackend() override;
+
+    MirrorBackend(const MirrorBackend&) = delete;
+    MirrorBackend& operator=(const MirrorBackend&) = delete;
+
+    // Opens `<dir_a>/<name>` and `<dir_b>/<name>`, name = file name of `path`.
+    // A leg that cannot open is dropped; false only if neither opens.
+    bool open_segment(const char* path) noexcept override;
+    bool submit(const LogRecordV2* records, size_t count) noexcept override;
+    uint64_t poll() noexcept override;
+    uint64_t drain() noexcept override;
+    void close_segment() noexcept override;
+
+    [[nodiscard]] uint64_t durable() const noexcept override { return durable_; }
+    [[nodiscard]] bool failed() const noexcept override { return !live_[0] && !live_[1]; }
+
+    // One leg dropped, running on the other.
+    [[nodiscard]] bool degraded() const noexcept { return live_[0] != live_[1]; }
+    [[nodiscard]] bool leg_live(int leg) const noexcept { return live_[leg]; }
+
+    // Records durable on `leg` (since this mirror was constructed).
+    [[nodiscard]] uint64_t leg_durable(int leg) const noexcept;
+
+private:
+    void drop(int leg) noexcept;
+    uint64_t update() noexcept;
+
+    Backend* legs_[kLegs];
+    std::string dirs_[kLegs];
+    uint64_t base_[kLegs];      // leg's durable() at construction
+    bool live_[kLegs] = {true, true};
+    bool open_ = false;
+    uint64_t durable_ = 0;
+};
+
+} // namespace wal::internal
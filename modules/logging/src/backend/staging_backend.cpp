@@ -0,0 +1,232 @@
+#include "staging_backend.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace wal::internal {
+
+namespace {
+
+uint32_t header_crc(const StagingHeader& h) noexcept
+{
+    return stam::primitives::crc32c(reinterpret_cast<const uint8_t*>(&h) + 4, sizeof(StagingHeader) - 4);
+}
+
+} // namespace
+
+bool staging_header_valid(const StagingHeader& h) noexcept
+{
+    return std::memcmp(h.magic, kStagingMagic, sizeof(h.magic)) == 0
+        && h.version == kStagingVersion
+        && h.capacity != 0
+        && h.path_len < sizeof(h.path)
+        && h.crc32 == header_crc(h);
+}
+
+StagingBackend::StagingBackend(Backend& persistent, const char* staging_path,
+                               const StagingBackendConfig& cfg) noexcept
+    : persistent_(persistent), cfg_(cfg), base_(persistent.durable())
+{
+    if (cfg_.ring_pages < 2)
+        cfg_.ring_pages = 2;
+    failed_ = persistent_.failed();
+    last_step_ = std::chrono::steady_clock::now();
+
+    const int fd = ::open(staging_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return;
+    // Truncating to zero first discards a previous ring: recover_staging()
+    // must have run before.
+    const size_t bytes = kStagingHeaderBytes + capacity() * sizeof(LogRecordV2);
+    if (::ftruncate(fd, 0) == 0 && ::ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+        stam::sys::sys_mem_policy policy{};
+        policy.lock = cfg_.lock;
+        region_ = stam::sys::sys_mem_map_shared(fd, bytes, policy);
+    }
+    ::close(fd);
+    if (region_.addr == nullptr)
+        return;
+
+    header_ = static_cast<StagingHeader*>(region_.addr);
+    std::memcpy(header_->magic, kStagingMagic, sizeof(header_->magic));
+    header_->version = kStagingVersion;
+    header_->capacity = capacity();
+    set_segment("");
+}
+
+StagingBackend::~StagingBackend()
+{
+    close_segment();
+    stam::sys::sys_mem_unmap(region_);
+}
+
+LogRecordV2* StagingBackend::ring() const noexcept
+{
+    return reinterpret_cast<LogRecordV2*>(static_cast<uint8_t*>(region_.addr) + kStagingHeaderBytes);
+}
+
+void StagingBackend::set_segment(const char* path) noexcept
+{
+    // Only called with nothing unpromoted: the previous segment's records
+    // are cleared so recovery never appends them to the new one.
+    std::memset(ring(), 0, capacity() * sizeof(LogRecordV2));
+    const size_t len = std::strlen(path);
+    std::memset(header_->path, 0, sizeof(header_->path));
+    std::memcpy(header_->path, path, len);
+    header_->path_len = len;
+    header_->crc32 = header_crc(*header_);
+    if (cfg_.sync)
+        (void)::msync(region_.addr, region_.bytes, MS_SYNC);
+}
+
+void StagingBackend::sync_range(uint64_t first, uint64_t count) noexcept
+{
+    if (!cfg_.sync || count == 0)
+        return;
+    static const uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    const uint64_t cap = capacity();
+    const uint64_t slot = first % cap;
+    const uint64_t head = count < cap - slot ? count : cap - slot;
+    const auto msync_slots = [&](uint64_t s, uint64_t n) {
+        const uint64_t from = kStagingHeaderBytes + s * sizeof(LogRecordV2);
+        const uint64_t to = from + n * sizeof(LogRecordV2);
+        const uint64_t aligned = from / page * page;
+        (void)::msync(static_cast<uint8_t*>(region_.addr) + aligned, to - aligned, MS_SYNC);
+    };
+    msync_slots(slot, head);
+    if (head < count)
+        msync_slots(0, count - head);
+}
+
+uint64_t StagingBackend::update() noexcept
+{
+    if (persistent_.failed())
+        failed_ = true;
+    persisted_ = persistent_.durable() - base_;
+    return persisted_;
+}
+
+bool StagingBackend::hand_over(uint64_t count) noexcept
+{
+    if (count == 0)
+        return true;
+    const uint64_t cap = capacity();
+    const uint64_t slot = promoted_ % cap;
+    const uint64_t head = count < cap - slot ? count : cap - slot;
+    // The persistent leg copies the records before submit() returns, so the
+    // ring slots stay reusable once they are durable there.
+    if (!persistent_.submit(ring() + slot, head)
+        || (head < count && !persistent_.submit(ring(), count - head))) {
+        failed_ = true;
+        return false;
+    }
+    promoted_ += count;
+    return true;
+}
+
+uint64_t StagingBackend::promote(uint64_t pages) noexcept
+{
+    if (!open_ || failed_)
+        return 0;
+    const uint64_t full = (staged_ - promoted_) / StagingBackendConfig::kPageRecords;
+    const uint64_t n = pages < full ? pages : full;
+    if (!hand_over(n * StagingBackendConfig::kPageRecords))
+        return 0;
+    promoted_pages_ += n;
+    update();
+    return n;
+}
+
+bool StagingBackend::make_room(uint64_t count) noexcept
+{
+    const uint64_t cap = capacity();
+    if (staged_ - update() + count <= cap)
+        return true;
+
+    // Backpressure: the mover fell behind. Whole pages first; the chunking in
+    // submit() leaves room for the partial page.
+    (void)promote(UINT64_MAX);
+    (void)persistent_.drain();
+    return staged_ - update() + count <= cap && !failed_;
+}
+
+bool StagingBackend::submit(const LogRecordV2* records, size_t count) noexcept
+{
+    if (!open_ || failed_)
+        return false;
+
+    const uint64_t cap = capacity();
+    const uint64_t chunk = cap - StagingBackendConfig::kPageRecords;
+    while (count > 0) {
+        const uint64_t n = count < chunk ? count : chunk;
+        if (!make_room(n))
+            return false;
+        const uint64_t slot = staged_ % cap;
+        const uint64_t head = n < cap - slot ? n : cap - slot;
+        std::memcpy(ring() + slot, records, head * sizeof(LogRecordV2));
+        std::memcpy(ring(), records + head, (n - head) * sizeof(LogRecordV2));
+        sync_range(staged_, n);
+        staged_ += n;
+        records += n;
+        count -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+uint64_t StagingBackend::poll() noexcept
+{
+    if (!open_ || failed_)
+        return staged_;
+
+    if (cfg_.promote_pages_per_sec == 0) {
+        (void)promote(UINT64_MAX);
+    } else {
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - last_step_).count();
+        last_step_ = now;
+        budget_pages_ += elapsed * cfg_.promote_pages_per_sec;
+        if (budget_pages_ > cfg_.promote_burst_pages)
+            budget_pages_ = cfg_.promote_burst_pages;
+        budget_pages_ -= static_cast<double>(promote(static_cast<uint64_t>(budget_pages_)));
+    }
+    (void)persistent_.poll();
+    update();
+    return staged_;
+}
+
+uint64_t StagingBackend::drain() noexcept
+{
+    if (open_ && !failed_)
+        (void)hand_over(staged_ - promoted_);
+    (void)persistent_.drain();
+    update();
+    return staged_;
+}
+
+bool StagingBackend::open_segment(const char* path) noexcept
+{
+    close_segment();
+    if (!available() || failed_ || promoted_ != staged_ || persisted_ != staged_)
+        return false;
+    if (std::strlen(path) >= sizeof(header_->path))
+        return false;
+    if (!persistent_.open_segment(path))
+        return false;
+    set_segment(path);
+    open_ = true;
+    return true;
+}
+
+void StagingBackend::close_segment() noexcept
+{
+    if (!open_)
+        return;
+    drain();
+    persistent_.close_segment();
+    open_ = false;
+}
+
+} // namespace wal::internal
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+
+#include "backend.hpp"
+
+#include "stam/sys/sys_mem.hpp"
+
+namespace wal::internal {
+
+// On-media layout of a staging file: one header page, then a ring of
+// `capacity` 64-byte records (wal_format.md §18).
+inline constexpr char     kStagingMagic[8]    = {'W', 'A', 'L', 'S', 'T', 'G', '0', '1'};
+inline constexpr uint32_t kStagingVersion     = 1;
+inline constexpr size_t   kStagingHeaderBytes = 4096;
+
+struct StagingHeader {
+    uint32_t crc32;      // CRC32C over bytes [4 .. kStagingHeaderBytes)
+    uint32_t version;
+    char     magic[8];
+    uint64_t capacity;   // ring slots, in records
+    uint64_t path_len;   // segment the staged records belong to (0 = none)
+    char     path[kStagingHeaderBytes - 32];
+};
+
+static_assert(sizeof(StagingHeader) == kStagingHeaderBytes);
+
+// Header checks: magic, version, CRC, path length.
+bool staging_header_valid(const StagingHeader& h) noexcept;
+
+struct StagingBackendConfig {
+    static constexpr uint32_t kPageRecords = 64; // promotion unit: one 4 KiB page
+
+    uint32_t ring_pages = 64;            // staging capacity, in pages (>= 2)
+    uint32_t promote_pages_per_sec = 0;  // mover rate; 0 = every full page at once
+    uint32_t promote_burst_pages = 8;    // pages the mover may catch up in one poll()
+    bool     sync = false;               // msync staged records (DAX / pmem file; tmpfs needs none)
+    bool     lock = true;                // mlock the staging ring
+};
+
+// Two-tier backend: records are committed to a RAM staging ring, whole pages
+// are promoted to a persistent backend in the background.
+//
+// The staging file is mmap'd (MAP_SHARED) from tmpfs or a pmem-like region;
+// submit() copies the records (CRC already applied by the writer) into the
+// ring and returns. durable() counts records in the staging tier: they
+// survive a crash of the process, not of the machine (unless the region is
+// persistent memory and `sync` is set). persisted() counts records on the
+// persistent leg.
+//
+// The mover runs inside poll(): it hands whole pages of staged records to
+// the persistent backend, at most `promote_pages_per_sec` on average, so a
+// flash device sees a bounded stream of full-page appends instead of an
+// fsync per batch. drain() and close_segment() promote everything, the
+// partial page included. A ring that fills up promotes synchronously in
+// submit() (backpressure), never overwriting an unpersisted record.
+//
+// The staging header names the segment being appended to. After a crash,
+// recover_staging() (recovery.hpp) appends the staged records the segment
+// is missing; run it before constructing a StagingBackend on the same file,
+// which discards the ring's content.
+//
+// Errors are sticky: a failed persistent leg fails the backend.
+class StagingBackend final : public Backend {
+public:
+    StagingBackend(Backend& persistent, const char* staging_path, const StagingBackendConfig& cfg = {}) noexcept;
+    ~StagingBackend() override;
+
+    StagingBackend(const StagingBackend&) = delete;
+    StagingBackend& operator=(const StagingBackend&) = delete;
+
+    // The staging file was created and mapped.
+    [[nodiscard]] bool available() const noexcept { return header_ != nullptr; }
+
+    // Promotes what is staged, then opens `path` on the persistent leg.
+    bool open_segment(const char* path) noexcept override;
+    bool submit(const LogRecordV2* records, size_t count) noexcept override;
+    uint64_t poll() noexcept override;
+    uint64_t drain() noexcept override;
+    void close_segment() noexcept override;
+
+    [[nodiscard]] uint64_t durable() const noexcept override { return staged_; }
+    [[nodiscard]] bool failed() const noexcept override { return failed_; }
+
+    // Records durable on the persistent leg (since construction).
+    [[nodiscard]] uint64_t persisted() const noexcept { return persisted_; }
+
+    // Records handed to the persistent leg; pages it was handed by the mover.
+    [[nodiscard]] uint64_t promoted() const noexcept { return promoted_; }
+    [[nodiscard]] uint64_t promoted_pages() const noexcept { return promoted_pages_; }
+
+    // Mover step without the rate limit: promote up to `pages` full pages.
+    uint64_t promote(uint64_t pages) noexcept;
+
+private:
+    LogRecordV2* ring() const noexcept;
+    uint64_t capacity() const noexcept { return uint64_t{cfg_.ring_pages} * StagingBackendConfig::kPageRecords; }
+    bool hand_over(uint64_t count) noexcept;
+    bool make_room(uint64_t count) noexcept;
+    void sync_range(uint64_t first, uint64_t count) noexcept;
+    void set_segment(const char* path) noexcept;
+    uint64_t update() noexcept;
+
+    Backend& persistent_;
+    StagingBackendConfig cfg_;
+    stam::sys::sys_mem_region region_{};
+    StagingHeader* header_ = nullptr;
+    bool open_ = false;
+
+    uint64_t base_;                 // persistent leg's durable() at construction
+    uint64_t staged_ = 0;           // records copied into the ring
+    uint64_t promoted_ = 0;         // records handed to the persistent leg
+    uint64_t persisted_ = 0;        // records durable on the persistent leg
+    uint64_t promoted_pages_ = 0;
+    bool failed_ = false;
+
+    std::chrono::steady_clock::time_point last_step_{};
+    double budget_pages_ = 0.0;     // mover token bucket
+};
+
+} // namespace wal::internal
@@ -0,0 +1,190 @@
+#include "uring.hpp"
+
+#if WAL_HAVE_IO_URING
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace wal::internal {
+
+namespace {
+
+int sys_setup(unsigned entries, io_uring_params* p) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+template <class T>
+T* at(void* base, unsigned off) noexcept
+{
+    return reinterpret_cast<T*>(static_cast<uint8_t*>(base) + off);
+}
+
+} // namespace
+
+Uring::~Uring()
+{
+    shutdown();
+}
+
+bool Uring::init(unsigned entries) noexcept
+{
+    shutdown();
+
+    io_uring_params p{};
+    const int fd = sys_setup(entries, &p);
+    if (fd < 0)
+        return false;
+    ring_fd_ = fd;
+
+    sq_ring_bytes_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && cq_ring_bytes_ > sq_ring_bytes_)
+        sq_ring_bytes_ = cq_ring_bytes_;
+
+    sq_ring_ = ::mmap(nullptr, sq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        shutdown();
+        return false;
+    }
+    if (single) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = ::mmap(nullptr, cq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            shutdown();
+            return false;
+        }
+    }
+
+    sqes_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        shutdown();
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    sq_head_ = at<unsigned>(sq_ring_, p.sq_off.head);
+    sq_tail_ = at<unsigned>(sq_ring_, p.sq_off.tail);
+    sq_array_ = at<unsigned>(sq_ring_, p.sq_off.array);
+    sq_mask_ = *at<unsigned>(sq_ring_, p.sq_off.ring_mask);
+    sq_entries_ = p.sq_entries;
+    sqe_tail_ = *sq_tail_;
+    sqe_flushed_ = sqe_tail_;
+
+    cq_head_ = at<unsigned>(cq_ring_, p.cq_off.head);
+    cq_tail_ = at<unsigned>(cq_ring_, p.cq_off.tail);
+    cqes_ = at<io_uring_cqe>(cq_ring_, p.cq_off.cqes);
+    cq_mask_ = *at<unsigned>(cq_ring_, p.cq_off.ring_mask);
+    return true;
+}
+
+void Uring::shutdown() noexcept
+{
+    if (sqes_ != nullptr)
+        ::munmap(sqes_, sqes_bytes_);
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+        ::munmap(cq_ring_, cq_ring_bytes_);
+    if (sq_ring_ != nullptr)
+        ::munmap(sq_ring_, sq_ring_bytes_);
+    if (ring_fd_ >= 0)
+        ::close(ring_fd_);
+    ring_fd_ = -1;
+    sq_ring_ = cq_ring_ = nullptr;
+    sqes_ = nullptr;
+    sq_head_ = sq_tail_ = sq_array_ = nullptr;
+    cq_head_ = cq_tail_ = nullptr;
+    cqes_ = nullptr;
+    sq_entries_ = 0;
+}
+
+io_uring_sqe* Uring::get_sqe() noexcept
+{
+    const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= sq_entries_)
+        return nullptr;
+    const unsigned idx = sqe_tail_ & sq_mask_;
+    sq_array_[idx] = idx;
+    ++sqe_tail_;
+    io_uring_sqe* sqe = &sqes_[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int Uring::submit(unsigned wait_nr) noexcept
+{
+    const unsigned to_submit = sqe_tail_ - sqe_flushed_;
+    if (to_submit != 0) {
+        __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+        sqe_flushed_ = sqe_tail_;
+    }
+    if (to_submit == 0 && wait_nr == 0)
+        return 0;
+
+    const unsigned flags = wait_nr != 0 ? IORING_ENTER_GETEVENTS : 0u;
+    for (;;) {
+        const int rc = sys_enter(ring_fd_, to_submit, wait_nr, flags);
+        if (rc < 0 && errno == EINTR)
+            continue;
+        return rc < 0 ? -errno : rc;
+    }
+}
+
+io_uring_cqe* Uring::peek_cqe() noexcept
+{
+    const unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail)
+        return nullptr;
+    return &cqes_[head & cq_mask_];
+}
+
+void Uring::cqe_seen() noexcept
+{
+    __atomic_store_n(cq_head_, *cq_head_ + 1u, __ATOMIC_RELEASE);
+}
+
+int Uring::register_buffers(const iovec* iov, unsigned count) noexcept
+{
+    const int rc = sys_register(ring_fd_, IORING_REGISTER_BUFFERS, iov, count);
+    return rc < 0 ? -errno : rc;
+}
+
+int Uring::register_files(const int* fds, unsigned count) noexcept
+{
+    const int rc = sys_register(ring_fd_, IORING_REGISTER_FILES, fds, count);
+    return rc < 0 ? -errno : rc;
+}
+
+int Uring::update_file(unsigned index, int fd) noexcept
+{
+    io_uring_files_update up{};
+    up.offset = index;
+    up.fds = reinterpret_cast<uint64_t>(&fd);
+    const int rc = sys_register(ring_fd_, IORING_REGISTER_FILES_UPDATE, &up, 1);
+    return rc < 0 ? -errno : rc;
+}
+
+} // namespace wal::internal
+
+#endif // WAL_HAVE_IO_URING
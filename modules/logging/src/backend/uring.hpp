@@ -0,0 +1,77 @@
+#pragma once
+
+// Minimal io_uring binding over raw syscalls (no liburing dependency).
+// Covers what the WAL backends need: one SQ/CQ pair, fixed buffers, fixed files.
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+  #define WAL_HAVE_IO_URING 1
+  #include <linux/io_uring.h>
+  #include <sys/uio.h>
+#else
+  #define WAL_HAVE_IO_URING 0
+#endif
+
+namespace wal::internal {
+
+#if WAL_HAVE_IO_URING
+
+class Uring final {
+public:
+    Uring() noexcept = default;
+    ~Uring();
+
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    // io_uring_setup + ring mmaps. false if io_uring is unavailable (ENOSYS, EPERM, ...).
+    bool init(unsigned entries) noexcept;
+    void shutdown() noexcept;
+
+    [[nodiscard]] bool ready() const noexcept { return ring_fd_ >= 0; }
+    [[nodiscard]] unsigned sq_entries() const noexcept { return sq_entries_; }
+
+    // Next free SQE (zeroed), or nullptr if the SQ is full. Visible to the kernel on submit().
+    io_uring_sqe* get_sqe() noexcept;
+
+    // Submit pending SQEs and wait for at least `wait_nr` completions.
+    // Returns the number of SQEs consumed, or -errno.
+    int submit(unsigned wait_nr) noexcept;
+
+    // Oldest unseen completion, or nullptr.
+    io_uring_cqe* peek_cqe() noexcept;
+    void cqe_seen() noexcept;
+
+    int register_buffers(const iovec* iov, unsigned count) noexcept;
+    int register_files(const int* fds, unsigned count) noexcept;
+    int update_file(unsigned index, int fd) noexcept;
+
+private:
+    int ring_fd_ = -1;
+
+    void* sq_ring_ = nullptr;
+    size_t sq_ring_bytes_ = 0;
+    void* cq_ring_ = nullptr; // == sq_ring_ with IORING_FEAT_SINGLE_MMAP
+    size_t cq_ring_bytes_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_bytes_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sqe_tail_ = 0;   // local tail (SQEs handed out)
+    unsigned sqe_flushed_ = 0; // local tail last published to the kernel
+
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned cq_mask_ = 0;
+};
+
+#endif // WAL_HAVE_IO_URING
+
+} // namespace wal::internal
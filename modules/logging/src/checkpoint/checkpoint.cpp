@@ -0,0 +1,240 @@
+#include "checkpoint.hpp"
+
+#include "recovery/recovery.hpp"
+
+namespace wal::internal {
+
+namespace {
+
+constexpr size_t kExtIdOffset = 2;
+constexpr size_t kExtIndexOffset = 6;
+constexpr size_t kExtCountOffset = 8;
+
+constexpr size_t kChunkOffset = 0;
+constexpr size_t kChunkLength = 2;
+constexpr size_t kChunkData = 3;
+
+static_assert(kChunkData + kCheckpointChunkBytes == sizeof(LogRecordV2::payload));
+
+// Walk state for recover_checkpoint().
+struct Scan {
+    CheckpointAssembler* assembler = nullptr;
+    uint64_t records = 0;
+    bool have = false;
+    uint64_t first_seq = 0;
+    uint64_t last_seq = 0;
+};
+
+bool visit_all(void* ctx, const LogRecordV2& rec) noexcept
+{
+    auto& s = *static_cast<Scan*>(ctx);
+    if (!s.have)
+        s.first_seq = rec.global_seq;
+    s.have = true;
+    s.last_seq = rec.global_seq;
+    ++s.records;
+    (void)s.assembler->feed(rec);
+    return true;
+}
+
+// Only the checkpoint carried over from the previous segment.
+bool visit_fragment(void* ctx, const LogRecordV2& rec) noexcept
+{
+    auto& s = *static_cast<Scan*>(ctx);
+    ++s.records;
+    (void)s.assembler->feed(rec);
+    return s.assembler->pending();
+}
+
+} // namespace
+
+bool checkpoint_ext(const LogRecordV2& rec, CheckpointExt& out) noexcept
+{
+    if (rec.reserved[0] != kExtCheckpoint || rec.reserved[1] != kCheckpointExtLen)
+        return false;
+    std::memcpy(&out.id, rec.reserved + kExtIdOffset, sizeof(out.id));
+    std::memcpy(&out.index, rec.reserved + kExtIndexOffset, sizeof(out.index));
+    std::memcpy(&out.count, rec.reserved + kExtCountOffset, sizeof(out.count));
+    return out.count != 0 && out.index < out.count;
+}
+
+bool CheckpointBuilder::add(uint8_t channel, CheckpointSource source)
+{
+    if (source.snapshot_fn == nullptr || source.bytes == 0 || source.bytes > kCheckpointMaxState)
+        return false;
+    for (const Channel& c : channels_) {
+        if (c.id == channel)
+            return false;
+    }
+    channels_.push_back({channel, source});
+    return true;
+}
+
+size_t CheckpointBuilder::build(const CheckpointStamp& stamp, std::vector<LogRecordV2>& out)
+{
+    // Snapshot everything first, back to back, so the states are as close
+    // in time as the readers allow; encode afterwards.
+    struct Taken {
+        uint8_t id;
+        size_t at;
+        size_t bytes;
+    };
+    std::vector<Taken> taken;
+    size_t total_bytes = 0;
+    for (const Channel& c : channels_)
+        total_bytes += c.source.bytes;
+    scratch_.resize(total_bytes);
+
+    size_t at = 0;
+    size_t records = 0;
+    for (const Channel& c : channels_) {
+        const SnapshotResult r = c.source.snapshot_fn(c.source.obj, scratch_.data() + at);
+        if (r == SnapshotResult::Failed)
+            return 0;
+        if (r == SnapshotResult::Empty)
+            continue;
+        taken.push_back({c.id, at, c.source.bytes});
+        records += (c.source.bytes + kCheckpointChunkBytes - 1) / kCheckpointChunkBytes;
+        at += c.source.bytes;
+    }
+    if (records == 0 || records > 0xFFFF)
+        return 0;
+
+    const auto count = static_cast<uint16_t>(records);
+    uint16_t index = 0;
+    out.reserve(out.size() + records);
+    for (const Taken& t : taken) {
+        for (size_t off = 0; off < t.bytes; off += kCheckpointChunkBytes) {
+            const size_t len = t.bytes - off < kCheckpointChunkBytes ? t.bytes - off : kCheckpointChunkBytes;
+            LogRecordV2 r{};
+            r.version = kLogRecordVersion;
+            r.event_type = t.id;
+            r.producer_id = stamp.producer_id;
+            r.global_seq = stamp.first_seq + index;
+            r.commit_ts = stamp.ts;
+            r.event_ts = stamp.ts;
+            r.producer_seq = stamp.producer_seq + index;
+            r.reserved[0] = kExtCheckpoint;
+            r.reserved[1] = kCheckpointExtLen;
+            std::memcpy(r.reserved + kExtIdOffset, &stamp.id, sizeof(stamp.id));
+            std::memcpy(r.reserved + kExtIndexOffset, &index, sizeof(index));
+            std::memcpy(r.reserved + kExtCountOffset, &count, sizeof(count));
+            const auto off16 = static_cast<uint16_t>(off);
+            std::memcpy(r.payload + kChunkOffset, &off16, sizeof(off16));
+            r.payload[kChunkLength] = static_cast<uint8_t>(len);
+            std::memcpy(r.payload + kChunkData, scratch_.data() + t.at + off, len);
+            r.crc32 = record_crc(r);
+            out.push_back(r);
+            ++index;
+        }
+    }
+    return records;
+}
+
+const std::vector<uint8_t>* Checkpoint::state(uint8_t channel) const noexcept
+{
+    for (const CheckpointChannelState& c : channels) {
+        if (c.channel == channel)
+            return &c.bytes;
+    }
+    return nullptr;
+}
+
+void CheckpointAssembler::drop() noexcept
+{
+    pending_ = false;
+    current_.channels.clear();
+}
+
+bool CheckpointAssembler::feed(const LogRecordV2& rec)
+{
+    CheckpointExt e{};
+    if (!checkpoint_ext(rec, e)) {
+        drop();
+        return false;
+    }
+
+    if (e.index == 0) {
+        drop();
+        current_.id = e.id;
+        current_.first_seq = rec.global_seq;
+        current_.ts = rec.commit_ts;
+        pending_ = true;
+    } else if (!pending_ || e.id != ext_.id || e.count != ext_.count || e.index != ext_.index + 1
+               || rec.global_seq != current_.last_seq + 1) {
+        drop();
+        return false;
+    }
+
+    // Chunks of a channel are contiguous and in offset order.
+    uint16_t off = 0;
+    std::memcpy(&off, rec.payload + kChunkOffset, sizeof(off));
+    const size_t len = rec.payload[kChunkLength];
+    if (current_.channels.empty() || current_.channels.back().channel != rec.event_type) {
+        if (current_.state(rec.event_type) != nullptr) {
+            drop();
+            return false;
+        }
+        current_.channels.push_back({rec.event_type, {}});
+    }
+    std::vector<uint8_t>& bytes = current_.channels.back().bytes;
+    if (len == 0 || len > kCheckpointChunkBytes || off != bytes.size()) {
+        drop();
+        return false;
+    }
+    bytes.insert(bytes.end(), rec.payload + kChunkData, rec.payload + kChunkData + len);
+    current_.last_seq = rec.global_seq;
+    ext_ = e;
+
+    if (e.index + 1 != e.count)
+        return false;
+    last_ = std::move(current_);
+    current_ = Checkpoint{};
+    pending_ = false;
+    found_ = true;
+    return true;
+}
+
+bool recover_checkpoint(const char* dir, CheckpointRecovery& out)
+{
+    out = CheckpointRecovery{};
+
+    std::vector<std::string> paths;
+    if (!list_segments(dir, paths))
+        return false;
+
+    bool ok = true;
+    for (size_t i = paths.size(); i-- > 0;) {
+        CheckpointAssembler assembler;
+        Scan scan{&assembler};
+        if (!visit_segment(paths[i].c_str(), &visit_all, &scan)) {
+            ok = false;
+            continue;
+        }
+        // A checkpoint cut by a segment roll continues in the next segment.
+        if (assembler.pending() && i + 1 < paths.size()) {
+            Scan tail{&assembler};
+            if (!visit_segment(paths[i + 1].c_str(), &visit_fragment, &tail))
+                ok = false;
+            out.records_scanned += tail.records;
+        }
+        ++out.segments_scanned;
+        out.records_scanned += scan.records;
+
+        if (scan.have && !out.wal_found) {
+            out.wal_found = true;
+            out.next_global_seq = scan.last_seq + 1;
+        }
+        if (scan.have)
+            out.resume_seq = scan.first_seq;
+        if (assembler.found()) {
+            out.found = true;
+            out.checkpoint = assembler.last();
+            out.resume_seq = out.checkpoint.last_seq + 1;
+            break;
+        }
+    }
+    return ok;
+}
+
+} // namespace wal::internal
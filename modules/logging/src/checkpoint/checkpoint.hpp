@@ -0,0 +1,227 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "log_record.hpp"
+#include "model/port.hpp"
+#include "model/tags.hpp"
+
+namespace wal::internal {
+
+// State checkpoints (wal_format.md §15, non-RT).
+//
+// A checkpoint is a run of consecutive records (global_seq n, n + 1, ...)
+// carrying a snapshot of every registered state channel, taken at one point
+// in time. Each record uses the §8 extension convention:
+//
+//   reserved[0]     ext_tag = kExtCheckpoint
+//   reserved[1]     ext_len = 8
+//   reserved[2..5]  checkpoint id (u32)
+//   reserved[6..7]  record index within the checkpoint (u16)
+//   reserved[8..9]  record count of the checkpoint (u16)
+//
+//   event_type      state channel id
+//   payload[0..1]   byte offset of the chunk within the channel state (u16)
+//   payload[2]      chunk length (1..11)
+//   payload[3..13]  chunk bytes
+//
+// A checkpoint is complete when all `count` records are present in order
+// with consecutive global_seq; anything else (torn tail, interleaved record)
+// discards it. The coordinator writes it with
+// WritersDispatcher::append_block(), which assigns that global_seq run. Recovery loads the newest complete checkpoint and replays only
+// the records after it.
+
+inline constexpr uint8_t  kExtCheckpoint        = 0x01;
+inline constexpr uint8_t  kCheckpointExtLen     = 8;
+inline constexpr size_t   kCheckpointChunkBytes = 11;
+inline constexpr size_t   kCheckpointMaxState   = 0x10000; // per channel (u16 offsets)
+
+struct CheckpointExt {
+    uint32_t id = 0;
+    uint16_t index = 0;
+    uint16_t count = 0;
+};
+
+// false → not a checkpoint record.
+bool checkpoint_ext(const LogRecordV2& rec, CheckpointExt& out) noexcept;
+
+enum class SnapshotResult : uint8_t {
+    Taken,      // `out` holds the current state
+    Empty,      // nothing published yet: the channel is left out
+    Failed,     // not read: lost every retry, or unknown whether anything was published
+};
+
+// Type-erased state snapshot: copies `bytes` bytes of current state into
+// `out`.
+struct CheckpointSource {
+    void* obj = nullptr;
+    size_t bytes = 0;
+    SnapshotResult (*snapshot_fn)(void*, uint8_t* out) noexcept = nullptr;
+};
+
+// Checkpoint-side payload owning one reader port of a state channel
+// (SPMCSnapshotSmp, DoubleBufferSeqLock, ...). Bind it with
+// ChannelWrapper::bind_reader(port, name) next to the channel's consumers.
+template <class Reader, class T>
+class CheckpointPort final {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "checkpointed state must be trivially copyable");
+    static_assert(sizeof(T) <= kCheckpointMaxState, "checkpointed state is limited to 64 KiB");
+
+    // A snapshot read may lose a race with the writer; retry a bounded number
+    // of times before reporting the read as failed.
+    static constexpr int kSnapshotAttempts = 16;
+
+    using rt_class = stam::model::rt_unsafe_tag;
+
+    explicit CheckpointPort(stam::model::PortName name) noexcept : name_(name) {}
+
+    CheckpointPort(const CheckpointPort&) = delete;
+    CheckpointPort& operator=(const CheckpointPort&) = delete;
+
+    [[nodiscard]] stam::model::BindResult bind_port(stam::model::PortName name, Reader&& reader) noexcept
+    {
+        if (!(name == name_))
+            return stam::model::BindResult::unknown_port;
+        if (reader_.has_value())
+            return stam::model::BindResult::already_bound;
+        reader_.emplace(std::move(reader));
+        return stam::model::BindResult::ok;
+    }
+
+    [[nodiscard]] bool is_fully_bound() const noexcept { return reader_.has_value(); }
+
+    // "Nothing published" comes from the primitive (Reader::has_value(),
+    // e.g. SPMCSnapshotSmp, DoubleBufferSeqLock): only then is the channel
+    // Empty. Lost reads are Failed, and so is a reader that cannot tell —
+    // a channel is never left out of a checkpoint on a guess.
+    SnapshotResult snapshot(T& out) noexcept
+    {
+        if (!reader_.has_value())
+            return SnapshotResult::Failed;
+        if constexpr (requires(const Reader& r) { { r.has_value() } -> std::same_as<bool>; }) {
+            if (!std::as_const(*reader_).has_value())
+                return SnapshotResult::Empty;
+        }
+        for (int i = 0; i < kSnapshotAttempts; ++i) {
+            if (reader_->try_read(out))
+                return SnapshotResult::Taken;
+        }
+        return SnapshotResult::Failed;
+    }
+
+    [[nodiscard]] CheckpointSource source() noexcept
+    {
+        return {
+            this,
+            sizeof(T),
+            [](void* p, uint8_t* out) noexcept -> SnapshotResult {
+                T value;
+                const SnapshotResult r = static_cast<CheckpointPort*>(p)->snapshot(value);
+                if (r == SnapshotResult::Taken)
+                    std::memcpy(out, &value, sizeof(T));
+                return r;
+            }
+        };
+    }
+
+private:
+    stam::model::PortName name_;
+    std::optional<Reader> reader_{};
+};
+
+// Header fields of the first checkpoint record; later ones count up.
+struct CheckpointStamp {
+    uint32_t id = 0;
+    uint64_t first_seq = 0;
+    uint64_t producer_seq = 0;
+    uint64_t ts = 0;             // commit_ts and event_ts of every record
+    uint8_t  producer_id = 0;
+};
+
+// Snapshots the registered channels and encodes them as one checkpoint.
+class CheckpointBuilder {
+public:
+    // false → channel id already registered or invalid source.
+    bool add(uint8_t channel, CheckpointSource source);
+
+    // Snapshot every channel and append the checkpoint records to `out`.
+    // Channels with nothing published are left out. Returns the record
+    // count; 0 → nothing to checkpoint, a channel read failed (the
+    // checkpoint would not be complete) or more than 65535 records.
+    size_t build(const CheckpointStamp& stamp, std::vector<LogRecordV2>& out);
+
+private:
+    struct Channel {
+        uint8_t id;
+        CheckpointSource source;
+    };
+
+    std::vector<Channel> channels_;
+    std::vector<uint8_t> scratch_;
+};
+
+struct CheckpointChannelState {
+    uint8_t channel = 0;
+    std::vector<uint8_t> bytes;
+};
+
+struct Checkpoint {
+    uint32_t id = 0;
+    uint64_t first_seq = 0;
+    uint64_t last_seq = 0;
+    uint64_t ts = 0;
+    std::vector<CheckpointChannelState> channels;
+
+    // State of `channel`, or nullptr if it is not in the checkpoint.
+    [[nodiscard]] const std::vector<uint8_t>* state(uint8_t channel) const noexcept;
+};
+
+// Reassembles checkpoints from records in global_seq order.
+class CheckpointAssembler {
+public:
+    // Feed the next record; true → it completed a checkpoint (see last()).
+    bool feed(const LogRecordV2& rec);
+
+    // A checkpoint has started but is not complete yet.
+    [[nodiscard]] bool pending() const noexcept { return pending_; }
+
+    [[nodiscard]] bool found() const noexcept { return found_; }
+    [[nodiscard]] const Checkpoint& last() const noexcept { return last_; }
+
+private:
+    void drop() noexcept;
+
+    Checkpoint current_;
+    Checkpoint last_;
+    CheckpointExt ext_{};
+    bool pending_ = false;
+    bool found_ = false;
+};
+
+struct CheckpointRecovery {
+    bool found = false;             // a complete checkpoint exists
+    Checkpoint checkpoint;
+    uint64_t resume_seq = 0;        // first record to replay on top of it
+    bool wal_found = false;         // at least one valid record
+    uint64_t next_global_seq = 0;   // as in RecoveryResult
+    uint64_t segments_scanned = 0;
+    uint64_t records_scanned = 0;
+};
+
+// Load the newest complete checkpoint of a WAL directory. Segments are
+// scanned newest first and the search stops at the first one holding a
+// complete checkpoint, so the cost is bounded by the checkpoint interval,
+// not the WAL length. Without a checkpoint every segment is scanned and
+// resume_seq is the first record of the WAL.
+bool recover_checkpoint(const char* dir, CheckpointRecovery& out);
+
+} // namespace wal::internal
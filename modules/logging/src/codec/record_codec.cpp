@@ -0,0 +1,336 @@
+#include "record_codec.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+#include "stam/sys/sys_arch.hpp"
+
+#if SYS_ARCH_X86 && defined(__GNUC__)
+#include <immintrin.h>
+#define WAL_CODEC_HAVE_SSE42 1
+#else
+#define WAL_CODEC_HAVE_SSE42 0
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define WAL_CODEC_HAVE_ARM_CRC 1
+#else
+#define WAL_CODEC_HAVE_ARM_CRC 0
+#endif
+
+namespace wal::internal {
+
+namespace {
+
+// The struct is the canonical image: encode/decode are copies and the CRC
+// kernels can run over LogRecordV2 arrays directly.
+constexpr bool kNativeLayout = std::endian::native == std::endian::little
+    && offsetof(LogRecordV2, crc32) == kFieldCrc32.offset
+    && offsetof(LogRecordV2, version) == kFieldVersion.offset
+    && offsetof(LogRecordV2, event_type) == kFieldEventType.offset
+    && offsetof(LogRecordV2, flags) == kFieldFlags.offset
+    && offsetof(LogRecordV2, producer_id) == kFieldProducerId.offset
+    && offsetof(LogRecordV2, global_seq) == kFieldGlobalSeq.offset
+    && offsetof(LogRecordV2, commit_ts) == kFieldCommitTs.offset
+    && offsetof(LogRecordV2, event_ts) == kFieldEventTs.offset
+    && offsetof(LogRecordV2, producer_seq) == kFieldProducerSeq.offset
+    && offsetof(LogRecordV2, reserved) == kFieldReserved.offset
+    && offsetof(LogRecordV2, payload) == kFieldPayload.offset
+    && sizeof(LogRecordV2) == kRecordBytes;
+
+constexpr size_t kBatch = 192; // CRCs per kernel call (multiple of 3)
+
+template <class T>
+void put_le(uint8_t* p, T v) noexcept
+{
+    for (size_t i = 0; i < sizeof(T); ++i)
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+template <class T>
+T get_le(const uint8_t* p) noexcept
+{
+    T v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+        v |= static_cast<T>(static_cast<T>(p[i]) << (8 * i));
+    return v;
+}
+
+void encode_fields(const LogRecordV2& r, uint8_t* b) noexcept
+{
+    if constexpr (kNativeLayout) {
+        std::memcpy(b, &r, kRecordBytes);
+    } else {
+        put_le(b + kFieldCrc32.offset, r.crc32);
+        b[kFieldVersion.offset] = r.version;
+        b[kFieldEventType.offset] = r.event_type;
+        b[kFieldFlags.offset] = r.flags;
+        b[kFieldProducerId.offset] = r.producer_id;
+        put_le(b + kFieldGlobalSeq.offset, r.global_seq);
+        put_le(b + kFieldCommitTs.offset, r.commit_ts);
+        put_le(b + kFieldEventTs.offset, r.event_ts);
+        put_le(b + kFieldProducerSeq.offset, r.producer_seq);
+        std::memcpy(b + kFieldReserved.offset, r.reserved, kFieldReserved.size);
+        std::memcpy(b + kFieldPayload.offset, r.payload, kFieldPayload.size);
+    }
+}
+
+void decode_fields(const uint8_t* b, LogRecordV2& r) noexcept
+{
+    if constexpr (kNativeLayout) {
+        std::memcpy(&r, b, kRecordBytes);
+    } else {
+        r.crc32 = get_le<uint32_t>(b + kFieldCrc32.offset);
+        r.version = b[kFieldVersion.offset];
+        r.event_type = b[kFieldEventType.offset];
+        r.flags = b[kFieldFlags.offset];
+        r.producer_id = b[kFieldProducerId.offset];
+        r.global_seq = get_le<uint64_t>(b + kFieldGlobalSeq.offset);
+        r.commit_ts = get_le<uint64_t>(b + kFieldCommitTs.offset);
+        r.event_ts = get_le<uint64_t>(b + kFieldEventTs.offset);
+        r.producer_seq = get_le<uint64_t>(b + kFieldProducerSeq.offset);
+        std::memcpy(r.reserved, b + kFieldReserved.offset, kFieldReserved.size);
+        std::memcpy(r.payload, b + kFieldPayload.offset, kFieldPayload.size);
+    }
+}
+
+// CRC of bytes [4..63] of each of the n 64-byte images at `base`.
+using CrcBatchFn = void (*)(const uint8_t* base, size_t n, uint32_t* out);
+
+uint32_t crc_image(const uint8_t* rec) noexcept
+{
+    return stam::primitives::crc32c(rec + kCrcFrom, kRecordBytes - kCrcFrom);
+}
+
+void crc_table(const uint8_t* base, size_t n, uint32_t* out)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = crc_image(base + i * kRecordBytes);
+}
+
+#if WAL_CODEC_HAVE_SSE42
+
+// The crc32 instruction has 3-cycle latency and 1-cycle throughput: one
+// record is a dependent chain of 8 steps, three records keep the unit busy.
+__attribute__((target("sse4.2")))
+inline uint32_t crc_one_sse42(const uint8_t* r)
+{
+    uint32_t h;
+    std::memcpy(&h, r + kCrcFrom, sizeof(h));
+    uint64_t c = _mm_crc32_u32(~0u, h);
+    for (size_t off = 8; off < kRecordBytes; off += 8) {
+        uint64_t x;
+        std::memcpy(&x, r + off, sizeof(x));
+        c = _mm_crc32_u64(c, x);
+    }
+    return ~static_cast<uint32_t>(c);
+}
+
+__attribute__((target("sse4.2")))
+void crc_sse42(const uint8_t* base, size_t n, uint32_t* out)
+{
+    size_t i = 0;
+    for (; i + 3 <= n; i += 3) {
+        const uint8_t* a = base + i * kRecordBytes;
+        const uint8_t* b = a + kRecordBytes;
+        const uint8_t* c = b + kRecordBytes;
+        uint32_t ha, hb, hc;
+        std::memcpy(&ha, a + kCrcFrom, sizeof(ha));
+        std::memcpy(&hb, b + kCrcFrom, sizeof(hb));
+        std::memcpy(&hc, c + kCrcFrom, sizeof(hc));
+        uint64_t ca = _mm_crc32_u32(~0u, ha);
+        uint64_t cb = _mm_crc32_u32(~0u, hb);
+        uint64_t cc = _mm_crc32_u32(~0u, hc);
+        for (size_t off = 8; off < kRecordBytes; off += 8) {
+            uint64_t xa, xb, xc;
+            std::memcpy(&xa, a + off, sizeof(xa));
+            std::memcpy(&xb, b + off, sizeof(xb));
+            std::memcpy(&xc, c + off, sizeof(xc));
+            ca = _mm_crc32_u64(ca, xa);
+            cb = _mm_crc32_u64(cb, xb);
+            cc = _mm_crc32_u64(cc, xc);
+        }
+        out[i] = ~static_cast<uint32_t>(ca);
+        out[i + 1] = ~static_cast<uint32_t>(cb);
+        out[i + 2] = ~static_cast<uint32_t>(cc);
+    }
+    for (; i < n; ++i)
+        out[i] = crc_one_sse42(base + i * kRecordBytes);
+}
+
+#endif
+
+#if WAL_CODEC_HAVE_ARM_CRC
+
+inline uint32_t crc_one_arm(const uint8_t* r)
+{
+    uint32_t h;
+    std::memcpy(&h, r + kCrcFrom, sizeof(h));
+    uint32_t c = __crc32cw(~0u, h);
+    for (size_t off = 8; off < kRecordBytes; off += 8) {
+        uint64_t x;
+        std::memcpy(&x, r + off, sizeof(x));
+        c = __crc32cd(c, x);
+    }
+    return ~c;
+}
+
+void crc_arm(const uint8_t* base, size_t n, uint32_t* out)
+{
+    size_t i = 0;
+    for (; i + 3 <= n; i += 3) {
+        const uint8_t* a = base + i * kRecordBytes;
+        const uint8_t* b = a + kRecordBytes;
+        const uint8_t* c = b + kRecordBytes;
+        uint32_t ha, hb, hc;
+        std::memcpy(&ha, a + kCrcFrom, sizeof(ha));
+        std::memcpy(&hb, b + kCrcFrom, sizeof(hb));
+        std::memcpy(&hc, c + kCrcFrom, sizeof(hc));
+        uint32_t ca = __crc32cw(~0u, ha);
+        uint32_t cb = __crc32cw(~0u, hb);
+        uint32_t cc = __crc32cw(~0u, hc);
+        for (size_t off = 8; off < kRecordBytes; off += 8) {
+            uint64_t xa, xb, xc;
+            std::memcpy(&xa, a + off, sizeof(xa));
+            std::memcpy(&xb, b + off, sizeof(xb));
+            std::memcpy(&xc, c + off, sizeof(xc));
+            ca = __crc32cd(ca, xa);
+            cb = __crc32cd(cb, xb);
+            cc = __crc32cd(cc, xc);
+        }
+        out[i] = ~ca;
+        out[i + 1] = ~cb;
+        out[i + 2] = ~cc;
+    }
+    for (; i < n; ++i)
+        out[i] = crc_one_arm(base + i * kRecordBytes);
+}
+
+#endif
+
+CrcBatchFn crc_batch(CrcKernel k) noexcept
+{
+    if (k == CrcKernel::Auto)
+        k = best_crc_kernel();
+    switch (k) {
+    case CrcKernel::Sse42:
+#if WAL_CODEC_HAVE_SSE42
+        if (__builtin_cpu_supports("sse4.2"))
+            return &crc_sse42;
+#endif
+        break;
+    case CrcKernel::ArmCrc:
+#if WAL_CODEC_HAVE_ARM_CRC
+        return &crc_arm;
+#endif
+        break;
+    case CrcKernel::Auto:
+    case CrcKernel::Table:
+        break;
+    }
+    return &crc_table;
+}
+
+} // namespace
+
+uint32_t encode_record(const LogRecordV2& rec, uint8_t* bytes) noexcept
+{
+    encode_fields(rec, bytes);
+    const uint32_t crc = crc_image(bytes);
+    put_le(bytes + kFieldCrc32.offset, crc);
+    return crc;
+}
+
+bool decode_record(const uint8_t* bytes, LogRecordV2& rec) noexcept
+{
+    decode_fields(bytes, rec);
+    return bytes[kFieldVersion.offset] == kLogRecordVersion
+        && get_le<uint32_t>(bytes + kFieldCrc32.offset) == crc_image(bytes);
+}
+
+CrcKernel best_crc_kernel() noexcept
+{
+#if WAL_CODEC_HAVE_SSE42
+    if (__builtin_cpu_supports("sse4.2"))
+        return CrcKernel::Sse42;
+#endif
+#if WAL_CODEC_HAVE_ARM_CRC
+    return CrcKernel::ArmCrc;
+#endif
+    return CrcKernel::Table;
+}
+
+const char* crc_kernel_name(CrcKernel k) noexcept
+{
+    switch (k) {
+    case CrcKernel::Auto:   return "auto";
+    case CrcKernel::Table:  return "table";
+    case CrcKernel::Sse42:  return "sse4.2";
+    case CrcKernel::ArmCrc: return "armv8-crc";
+    }
+    return "?";
+}
+
+bool crc_kernel_available(CrcKernel k) noexcept
+{
+    return k == CrcKernel::Auto || k == CrcKernel::Table || crc_batch(k) != &crc_table;
+}
+
+void seal_records(LogRecordV2* recs, size_t n, CrcKernel k) noexcept
+{
+    if constexpr (!kNativeLayout) {
+        uint8_t img[kRecordBytes];
+        for (size_t i = 0; i < n; ++i)
+            recs[i].crc32 = encode_record(recs[i], img);
+        return;
+    }
+    const CrcBatchFn fn = crc_batch(k);
+    uint32_t crc[kBatch];
+    for (size_t b = 0; b < n; b += kBatch) {
+        const size_t m = n - b < kBatch ? n - b : kBatch;
+        fn(reinterpret_cast<const uint8_t*>(recs + b), m, crc);
+        for (size_t i = 0; i < m; ++i)
+            recs[b + i].crc32 = crc[i];
+    }
+}
+
+void encode_records(const LogRecordV2* recs, size_t n, uint8_t* bytes, CrcKernel k) noexcept
+{
+    const CrcBatchFn fn = crc_batch(k);
+    uint32_t crc[kBatch];
+    for (size_t b = 0; b < n; b += kBatch) {
+        const size_t m = n - b < kBatch ? n - b : kBatch;
+        uint8_t* out = bytes + b * kRecordBytes;
+        for (size_t i = 0; i < m; ++i)
+            encode_fields(recs[b + i], out + i * kRecordBytes);
+        fn(out, m, crc);
+        for (size_t i = 0; i < m; ++i)
+            put_le(out + i * kRecordBytes + kFieldCrc32.offset, crc[i]);
+    }
+}
+
+size_t valid_prefix(const LogRecordV2* recs, size_t n, CrcKernel k) noexcept
+{
+    if constexpr (!kNativeLayout) {
+        for (size_t i = 0; i < n; ++i) {
+            if (!record_valid(recs[i]))
+                return i;
+        }
+        return n;
+    }
+    const CrcBatchFn fn = crc_batch(k);
+    uint32_t crc[kBatch];
+    for (size_t b = 0; b < n; b += kBatch) {
+        const size_t m = n - b < kBatch ? n - b : kBatch;
+        fn(reinterpret_cast<const uint8_t*>(recs + b), m, crc);
+        for (size_t i = 0; i < m; ++i) {
+            if (recs[b + i].version != kLogRecordVersion || recs[b + i].crc32 != crc[i])
+                return b + i;
+        }
+    }
+    return n;
+}
+
+} // namespace wal::internal
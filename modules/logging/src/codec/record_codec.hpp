@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "log_record.hpp"
+
+namespace wal::internal {
+
+// Canonical on-media byte layout of a record (wal_format.md §1, §2).
+//
+// LogRecordV2 happens to match it on little-endian hosts with the usual ABI,
+// but the struct is not the spec (§2.2). The codec writes and reads the exact
+// 64-byte layout field by field; on little-endian hosts where the layout
+// checks below hold it is a plain copy.
+
+struct RecordField {
+    size_t offset;
+    size_t size;
+};
+
+inline constexpr size_t kRecordBytes = 64;
+
+inline constexpr RecordField kFieldCrc32       {0, 4};
+inline constexpr RecordField kFieldVersion     {4, 1};
+inline constexpr RecordField kFieldEventType   {5, 1};
+inline constexpr RecordField kFieldFlags       {6, 1};
+inline constexpr RecordField kFieldProducerId  {7, 1};
+inline constexpr RecordField kFieldGlobalSeq   {8, 8};
+inline constexpr RecordField kFieldCommitTs    {16, 8};
+inline constexpr RecordField kFieldEventTs     {24, 8};
+inline constexpr RecordField kFieldProducerSeq {32, 8};
+inline constexpr RecordField kFieldReserved    {40, 10};
+inline constexpr RecordField kFieldPayload     {50, 14};
+
+// CRC coverage (§3.1).
+inline constexpr size_t kCrcFrom = kFieldVersion.offset;
+
+static_assert(kFieldPayload.offset + kFieldPayload.size == kRecordBytes);
+
+// bytes[0 .. 64) ← rec, crc32 recomputed over [4..63]. Returns the CRC.
+uint32_t encode_record(const LogRecordV2& rec, uint8_t* bytes) noexcept;
+
+// rec ← bytes[0 .. 64). false → unsupported version or CRC mismatch (§3.3);
+// `rec` is filled in either case.
+bool decode_record(const uint8_t* bytes, LogRecordV2& rec) noexcept;
+
+// CRC32C implementation for the batch paths.
+enum class CrcKernel : uint8_t {
+    Auto,    // best available on this CPU
+    Table,   // portable, byte at a time
+    Sse42,   // x86 crc32 instruction, three records in flight
+    ArmCrc,  // ARMv8 CRC32 extension, three records in flight
+};
+
+// Kernel Auto resolves to on this CPU.
+CrcKernel best_crc_kernel() noexcept;
+const char* crc_kernel_name(CrcKernel k) noexcept;
+
+// false if `k` is not available on this CPU / build.
+bool crc_kernel_available(CrcKernel k) noexcept;
+
+// Set crc32 of recs[0 .. n) in place (commit side). An unavailable kernel
+// falls back to Table.
+void seal_records(LogRecordV2* recs, size_t n, CrcKernel k = CrcKernel::Auto) noexcept;
+
+// Encode and seal recs[0 .. n) into bytes[0 .. 64 * n).
+void encode_records(const LogRecordV2* recs, size_t n, uint8_t* bytes, CrcKernel k = CrcKernel::Auto) noexcept;
+
+// Length of the valid prefix of recs[0 .. n) (§11): the index of the first
+// record with an unsupported version or a bad CRC, or n.
+size_t valid_prefix(const LogRecordV2* recs, size_t n, CrcKernel k = CrcKernel::Auto) noexcept;
+
+} // namespace wal::internal
@@ -0,0 +1,154 @@
+#include "fragment.hpp"
+
+#include "recovery/recovery.hpp"
+
+namespace wal::internal {
+
+namespace {
+
+struct FragmentExt {
+    uint8_t  index;
+    uint8_t  count;
+    uint16_t length;
+    uint32_t crc;
+};
+
+bool fragment_ext(const LogRecordV2& rec, FragmentExt& out) noexcept
+{
+    if (rec.reserved[0] != kExtFragment || rec.reserved[1] != kFragmentExtLen)
+        return false;
+    out.index = rec.reserved[2];
+    out.count = rec.reserved[3];
+    std::memcpy(&out.length, rec.reserved + 4, sizeof(out.length));
+    std::memcpy(&out.crc, rec.reserved + 6, sizeof(out.crc));
+    return true;
+}
+
+void view_record(const LogRecordV2& rec, AssembledEvent& out) noexcept
+{
+    out.event_type = rec.event_type;
+    out.producer_id = rec.producer_id;
+    out.flags = rec.flags;
+    out.length = static_cast<uint16_t>(kFragmentBytes);
+    out.first_seq = rec.global_seq;
+    out.last_seq = rec.global_seq;
+    out.commit_ts = rec.commit_ts;
+    out.event_ts = rec.event_ts;
+    out.producer_seq = rec.producer_seq;
+    out.data = rec.payload;
+}
+
+struct EventWalk {
+    FragmentAssembler* assembler;
+    bool (*visit)(void*, const AssembledEvent&) noexcept;
+    void* ctx;
+};
+
+bool walk_record(void* ctx, const LogRecordV2& rec) noexcept
+{
+    auto& w = *static_cast<EventWalk*>(ctx);
+    AssembledEvent ev;
+    const FragmentResult r = w.assembler->feed(rec, ev);
+    if (r == FragmentResult::Record || r == FragmentResult::Complete)
+        return w.visit(w.ctx, ev);
+    return true;
+}
+
+} // namespace
+
+FragmentAssembler::Slot* FragmentAssembler::find(uint8_t producer_id) noexcept
+{
+    for (Slot& s : slots_) {
+        if (s.open && s.producer_id == producer_id)
+            return &s;
+    }
+    return nullptr;
+}
+
+FragmentAssembler::Slot* FragmentAssembler::claim() noexcept
+{
+    for (Slot& s : slots_) {
+        if (!s.open)
+            return &s;
+    }
+    return nullptr;
+}
+
+void FragmentAssembler::reset() noexcept
+{
+    for (Slot& s : slots_)
+        s.open = false;
+}
+
+FragmentResult FragmentAssembler::feed(const LogRecordV2& rec, AssembledEvent& out) noexcept
+{
+    FragmentExt e{};
+    if (!fragment_ext(rec, e)) {
+        view_record(rec, out);
+        return FragmentResult::Record;
+    }
+
+    const bool sane = e.count != 0 && e.count <= kMaxFragments && e.index < e.count
+        && e.length != 0 && e.length <= kMaxFragmentedEvent && fragment_count(e.length) == e.count;
+    Slot* s = find(rec.producer_id);
+
+    if (sane && e.index == 0) {
+        if (s != nullptr) {
+            ++dropped_; // the producer started over: its previous event is lost
+        } else if ((s = claim()) == nullptr) {
+            ++dropped_;
+            return FragmentResult::Dropped;
+        }
+        s->open = true;
+        s->producer_id = rec.producer_id;
+        s->event_type = rec.event_type;
+        s->flags = rec.flags;
+        s->next_index = 0;
+        s->count = e.count;
+        s->length = e.length;
+        s->crc = e.crc;
+        s->next_producer_seq = rec.producer_seq;
+        s->first_seq = rec.global_seq;
+        s->event_ts = rec.event_ts;
+        s->head_producer_seq = rec.producer_seq;
+    } else if (!sane || s == nullptr || e.index != s->next_index || e.count != s->count
+               || e.length != s->length || e.crc != s->crc || rec.producer_seq != s->next_producer_seq
+               || rec.event_type != s->event_type) {
+        if (s != nullptr)
+            s->open = false;
+        ++dropped_;
+        return FragmentResult::Dropped;
+    }
+
+    std::memcpy(s->data + static_cast<size_t>(e.index) * kFragmentBytes, rec.payload, kFragmentBytes);
+    ++s->next_index;
+    ++s->next_producer_seq;
+    if (s->next_index != s->count)
+        return FragmentResult::Pending;
+
+    s->open = false;
+    if (stam::primitives::crc32c(s->data, s->length) != s->crc) {
+        ++dropped_;
+        return FragmentResult::Dropped;
+    }
+    out.event_type = s->event_type;
+    out.producer_id = s->producer_id;
+    out.flags = s->flags;
+    out.length = s->length;
+    out.first_seq = s->first_seq;
+    out.last_seq = rec.global_seq;
+    out.commit_ts = rec.commit_ts;
+    out.event_ts = s->event_ts;
+    out.producer_seq = s->head_producer_seq;
+    out.data = s->data;
+    return FragmentResult::Complete;
+}
+
+bool visit_segment_events(const char* segment_path, FragmentAssembler& assembler,
+                          bool (*visit)(void* ctx, const AssembledEvent& ev) noexcept, void* ctx) noexcept
+{
+    EventWalk w{&assembler, visit, ctx};
+    return visit_segment(segment_path, &walk_record, &w);
+}
+
+} // namespace wal::internal
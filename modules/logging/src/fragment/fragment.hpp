@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "log_record.hpp"
+
+namespace wal::internal {
+
+// Events larger than one payload (wal_format.md §16).
+//
+// An event of up to kMaxFragmentedEvent bytes is split into `count` records
+// of one producer with consecutive producer_seq; every record uses the §8
+// extension convention:
+//
+//   reserved[0]     ext_tag = kExtFragment
+//   reserved[1]     ext_len = 8
+//   reserved[2]     fragment index (0 = head)
+//   reserved[3]     fragment count
+//   reserved[4..5]  event length in bytes (u16)
+//   reserved[6..9]  CRC32C of the whole event
+//   payload[0..13]  event bytes [14 * index, 14 * index + 14)
+//
+// Other producers' records may fall between the fragments in global_seq
+// order; the (producer_id, producer_seq) chain links them.
+//
+// Splitting is RT-safe: no allocation, fixed upper bound on work. Records
+// come out unsealed — global_seq, commit_ts and crc32 are set at commit like
+// for any other record.
+
+inline constexpr uint8_t kExtFragment        = 0x02;
+inline constexpr uint8_t kFragmentExtLen     = 8;
+inline constexpr size_t  kFragmentBytes      = sizeof(LogRecordV2::payload);
+inline constexpr size_t  kMaxFragmentedEvent = 512;
+inline constexpr size_t  kMaxFragments       = (kMaxFragmentedEvent + kFragmentBytes - 1) / kFragmentBytes;
+
+inline constexpr size_t fragment_count(size_t bytes) noexcept
+{
+    return (bytes + kFragmentBytes - 1) / kFragmentBytes;
+}
+
+// Split `bytes` of `data` into out[0 .. fragment_count(bytes)). Header fields
+// come from `proto` (version, event_type, flags, producer_id, event_ts,
+// producer_seq of the head; fragment i gets producer_seq + i). Returns the
+// record count; 0 → empty, larger than kMaxFragmentedEvent, or `capacity`
+// too small.
+inline size_t encode_fragments(const LogRecordV2& proto, const void* data, size_t bytes,
+                               LogRecordV2* out, size_t capacity) noexcept
+{
+    const size_t count = fragment_count(bytes);
+    if (bytes == 0 || bytes > kMaxFragmentedEvent || capacity < count)
+        return 0;
+
+    const auto* src = static_cast<const uint8_t*>(data);
+    const uint32_t crc = stam::primitives::crc32c(src, bytes);
+    const auto length = static_cast<uint16_t>(bytes);
+    for (size_t i = 0; i < count; ++i) {
+        LogRecordV2& r = out[i];
+        r = proto;
+        r.crc32 = 0;
+        r.producer_seq = proto.producer_seq + i;
+        std::memset(r.reserved, 0, sizeof(r.reserved));
+        r.reserved[0] = kExtFragment;
+        r.reserved[1] = kFragmentExtLen;
+        r.reserved[2] = static_cast<uint8_t>(i);
+        r.reserved[3] = static_cast<uint8_t>(count);
+        std::memcpy(r.reserved + 4, &length, sizeof(length));
+        std::memcpy(r.reserved + 6, &crc, sizeof(crc));
+        const size_t off = i * kFragmentBytes;
+        const size_t n = bytes - off < kFragmentBytes ? bytes - off : kFragmentBytes;
+        std::memset(r.payload, 0, sizeof(r.payload));
+        std::memcpy(r.payload, src + off, n);
+    }
+    return count;
+}
+
+// One logical event: a plain record (its 14 payload bytes) or a reassembled
+// fragmented one. `data` stays valid until the next FragmentAssembler::feed().
+struct AssembledEvent {
+    uint8_t  event_type = 0;
+    uint8_t  producer_id = 0;
+    uint8_t  flags = 0;
+    uint16_t length = 0;
+    uint64_t first_seq = 0;     // global_seq of the head (or the record)
+    uint64_t last_seq = 0;      // global_seq of the last fragment
+    uint64_t commit_ts = 0;     // of the last fragment: when the event was whole
+    uint64_t event_ts = 0;
+    uint64_t producer_seq = 0;  // of the head
+    const uint8_t* data = nullptr;
+};
+
+enum class FragmentResult : uint8_t {
+    Record,     // not a fragment: `out` views the record itself
+    Pending,    // fragment stored, event not complete yet
+    Complete,   // last fragment: `out` is the reassembled event
+    Dropped,    // fragment without a matching head, out of order, or bad CRC
+};
+
+// Reassembles fragmented events from records in global_seq order (recovery,
+// tailer). Fixed storage: up to kOpenEvents events in flight at once, one
+// per producer; no allocation.
+class FragmentAssembler {
+public:
+    static constexpr size_t kOpenEvents = 16;
+
+    FragmentResult feed(const LogRecordV2& rec, AssembledEvent& out) noexcept;
+
+    // Forget events in flight (e.g. at a segment the writer did not finish).
+    void reset() noexcept;
+
+    [[nodiscard]] uint64_t dropped() const noexcept { return dropped_; }
+
+private:
+    struct Slot {
+        bool     open = false;
+        uint8_t  producer_id = 0;
+        uint8_t  event_type = 0;
+        uint8_t  flags = 0;
+        uint8_t  next_index = 0;
+        uint8_t  count = 0;
+        uint16_t length = 0;
+        uint32_t crc = 0;
+        uint64_t next_producer_seq = 0;
+        uint64_t first_seq = 0;
+        uint64_t event_ts = 0;
+        uint64_t head_producer_seq = 0;
+        uint8_t  data[kMaxFragments * kFragmentBytes];
+    };
+
+    Slot* find(uint8_t producer_id) noexcept;
+    Slot* claim() noexcept;
+
+    Slot slots_[kOpenEvents];
+    uint64_t dropped_ = 0;
+};
+
+// Run `records` through `assembler`, calling fn(const AssembledEvent&) for
+// every plain record and every completed event, in order.
+template <class Fn>
+void assemble_events(std::span<const LogRecordV2> records, FragmentAssembler& assembler, Fn&& fn)
+{
+    AssembledEvent ev;
+    for (const LogRecordV2& rec : records) {
+        const FragmentResult r = assembler.feed(rec, ev);
+        if (r == FragmentResult::Record || r == FragmentResult::Complete)
+            fn(static_cast<const AssembledEvent&>(ev));
+    }
+}
+
+// Recovery path: the valid prefix of a segment (§11) as events. false →
+// segment unreadable.
+bool visit_segment_events(const char* segment_path, FragmentAssembler& assembler,
+                          bool (*visit)(void* ctx, const AssembledEvent& ev) noexcept, void* ctx) noexcept;
+
+} // namespace wal::internal
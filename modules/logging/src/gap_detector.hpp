@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+#include "log_record.hpp"
+#include "model/port.hpp"
+#include "model/tags.hpp"
+
+namespace wal {
+
+// Loss records (wal_format.md §17).
+//
+// The coordinator emits one when producer_seq of a producer skips values:
+//
+//   producer_id     the producer that lost records
+//   producer_seq    first missing producer_seq
+//   reserved[0]     ext_tag = kExtLoss
+//   reserved[1]     ext_len = 8
+//   reserved[2..9]  number of missing producer_seq values (u64)
+//
+// global_seq / commit_ts / crc32 are assigned like for any drained record.
+
+inline constexpr uint8_t kExtLoss = 0x03;
+inline constexpr uint8_t kLossExtLen = 8;
+
+inline LogRecordV2 make_loss_record(uint8_t producer_id, uint64_t first_missing, uint64_t count, uint64_t now) noexcept
+{
+    LogRecordV2 r{};
+    r.version = kLogRecordVersion;
+    r.producer_id = producer_id;
+    r.producer_seq = first_missing;
+    r.event_ts = now;
+    r.reserved[0] = kExtLoss;
+    r.reserved[1] = kLossExtLen;
+    std::memcpy(r.reserved + 2, &count, sizeof(count));
+    return r;
+}
+
+// false → not a loss record.
+inline bool loss_ext(const LogRecordV2& r, uint64_t& first_missing, uint64_t& count) noexcept
+{
+    if (r.reserved[0] != kExtLoss || r.reserved[1] != kLossExtLen)
+        return false;
+    first_missing = r.producer_seq;
+    std::memcpy(&count, r.reserved + 2, sizeof(count));
+    return true;
+}
+
+// Running loss counters, published by the coordinator after every drain pass
+// that changed them.
+struct LossSnapshot {
+    uint64_t lost_total = 0;        // missing producer_seq values, all producers
+    uint64_t gaps = 0;              // loss records emitted
+    uint64_t late = 0;              // records behind the window (already counted lost, or duplicate)
+    uint64_t lost[256] = {};        // per producer_id
+};
+
+// Type-erased snapshot channel writer, cf. ReplaySink.
+struct LossPublisher {
+    void* obj = nullptr;
+    void (*publish_fn)(void*, const LossSnapshot&) noexcept = nullptr;
+};
+
+// Coordinator-side payload owning the writer port of the loss channel
+// (SPMCSnapshotSmp, DoubleBufferSeqLock, ... of LossSnapshot). Bind it with
+// ChannelWrapper::bind_writer(port, name); supervisors bind readers as usual.
+template <class Writer>
+class LossPort final {
+public:
+    using rt_class = stam::model::rt_unsafe_tag;
+
+    explicit LossPort(stam::model::PortName name) noexcept : name_(name) {}
+
+    LossPort(const LossPort&) = delete;
+    LossPort& operator=(const LossPort&) = delete;
+
+    [[nodiscard]] stam::model::BindResult bind_port(stam::model::PortName name, Writer&& writer) noexcept
+    {
+        if (!(name == name_))
+            return stam::model::BindResult::unknown_port;
+        if (writer_.has_value())
+            return stam::model::BindResult::already_bound;
+        writer_.emplace(std::move(writer));
+        return stam::model::BindResult::ok;
+    }
+
+    [[nodiscard]] bool is_fully_bound() const noexcept { return writer_.has_value(); }
+
+    [[nodiscard]] LossPublisher publisher() noexcept
+    {
+        return {
+            this,
+            [](void* p, const LossSnapshot& s) noexcept {
+                auto& self = *static_cast<LossPort*>(p);
+                if (self.writer_.has_value())
+                    self.writer_->write(s);
+            }
+        };
+    }
+
+private:
+    stam::model::PortName name_;
+    std::optional<Writer> writer_{};
+};
+
+// Online producer_seq gap detection (coordinator, non-RT).
+//
+// The dispatcher delivers one producer's records through two FIFO lanes, so
+// producer_seq arrives as two increasing sequences merged in no fixed order:
+// a trip overtakes queued telemetry, and a trip submitted during a pass can
+// land behind that pass's telemetry. A value is therefore declared lost only
+// at the end of a pass, below a frontier neither lane can still deliver
+// under:
+//   - bulk: one past the last bulk value, or, if the bulk lane was seen empty,
+//     one past everything popped before that (pushes of lower values happen
+//     before pushes of higher ones, so they would have been visible);
+//   - critical: the dispatcher sweeps the critical lanes at the end of the
+//     pass, so anything left there is above every value popped.
+//
+// Flat per-producer state: the frontier `next`, this pass's bulk values as
+// runs, and the critical values above the frontier. A producer session
+// starts at producer_seq 0 with the detector; reset() re-bases one that starts
+// anew. on_gap(producer_id, first_missing, count) runs once per missing run.
+template <size_t Producers>
+class GapDetector final {
+public:
+    static constexpr size_t kRuns = 32;     // bulk runs per producer per pass
+    static constexpr size_t kAhead = 256;   // critical values above the frontier
+
+    // Room for one more bulk value this pass (else leave the lane for the next).
+    [[nodiscard]] bool bulk_room(uint8_t producer_id) const noexcept
+    {
+        return state_[producer_id].runs < kRuns;
+    }
+
+    // Bulk lane value (increasing within the lane).
+    void bulk(uint8_t producer_id, uint64_t seq) noexcept
+    {
+        State& s = state_[producer_id];
+        if (seq < s.next) {
+            ++late_;
+            return;
+        }
+        if (s.runs != 0 && s.run[s.runs - 1].end == seq)
+            s.run[s.runs - 1].end = seq + 1;
+        else
+            s.run[s.runs++] = {seq, seq + 1};
+        s.bulk_end = seq + 1;
+        if (seq >= s.seen_end)
+            s.seen_end = seq + 1;
+    }
+
+    // Failed bulk pop: nothing below what was popped so far is still queued.
+    void bulk_empty(uint8_t producer_id) noexcept
+    {
+        State& s = state_[producer_id];
+        s.empty_mark = s.seen_end;
+    }
+
+    // Critical lane value (increasing within the lane).
+    template <class OnGap>
+    void critical(uint8_t producer_id, uint64_t seq, OnGap&& on_gap) noexcept
+    {
+        State& s = state_[producer_id];
+        if (seq < s.next) {
+            ++late_;
+            return;
+        }
+        // Bounded memory: when too many trips run ahead of the telemetry,
+        // account up to the oldest one now; a telemetry value below it that
+        // still arrives is counted late.
+        if (s.ahead_count == kAhead)
+            merge(producer_id, s.ahead[s.ahead_head] + 1, on_gap);
+        s.ahead[(s.ahead_head + s.ahead_count++) % kAhead] = seq;
+        if (seq >= s.seen_end)
+            s.seen_end = seq + 1;
+    }
+
+    // After the pass (and the critical sweep): account below the frontier.
+    template <class OnGap>
+    void end_pass(uint8_t producer_id, OnGap&& on_gap) noexcept
+    {
+        State& s = state_[producer_id];
+        const uint64_t frontier = s.empty_mark > s.bulk_end ? s.empty_mark : s.bulk_end;
+        if (frontier > s.next)
+            merge(producer_id, frontier, on_gap);
+        s.empty_mark = 0;
+    }
+
+    // New producer session: the next value expected is `next_seq`; open gaps
+    // are dropped without being reported.
+    void reset(uint8_t producer_id, uint64_t next_seq) noexcept
+    {
+        State& s = state_[producer_id];
+        const uint64_t lost = s.lost;
+        s = State{};
+        s.next = next_seq;
+        s.bulk_end = next_seq;
+        s.seen_end = next_seq;
+        s.lost = lost;
+    }
+
+    [[nodiscard]] uint64_t lost(uint8_t producer_id) const noexcept { return state_[producer_id].lost; }
+    [[nodiscard]] uint64_t late() const noexcept { return late_; }
+
+private:
+    struct Run {
+        uint64_t first;
+        uint64_t end;
+    };
+
+    struct State {
+        uint64_t next = 0;          // every value below is accounted for
+        uint64_t bulk_end = 0;      // one past the last bulk value
+        uint64_t seen_end = 0;      // one past the highest value seen
+        uint64_t empty_mark = 0;    // seen_end when the bulk lane was seen empty
+        uint64_t lost = 0;
+        Run run[kRuns];
+        size_t runs = 0;
+        uint64_t ahead[kAhead];
+        size_t ahead_head = 0;
+        size_t ahead_count = 0;
+    };
+
+    // Walk the seen values below `to` in order; report the holes; next = to.
+    template <class OnGap>
+    void merge(uint8_t producer_id, uint64_t to, OnGap& on_gap) noexcept
+    {
+        State& s = state_[producer_id];
+        uint64_t cursor = s.next;
+        size_t r = 0;
+        for (;;) {
+            const bool have_run = r < s.runs && s.run[r].first < to;
+            const bool have_ahead = s.ahead_count != 0 && s.ahead[s.ahead_head] < to;
+            if (!have_run && !have_ahead)
+                break;
+            uint64_t first;
+            uint64_t end;
+            if (have_run && (!have_ahead || s.run[r].first <= s.ahead[s.ahead_head])) {
+                first = s.run[r].first;
+                if (s.run[r].end <= to) {
+                    end = s.run[r].end;
+                    ++r;
+                } else {
+                    end = to;
+                    s.run[r].first = to;
+                }
+            } else {
+                first = s.ahead[s.ahead_head];
+                end = first + 1;
+                s.ahead_head = (s.ahead_head + 1) % kAhead;
+                --s.ahead_count;
+            }
+            if (first > cursor)
+                report(s, producer_id, cursor, first - cursor, on_gap);
+            if (end > cursor)
+                cursor = end;
+        }
+        if (cursor < to)
+            report(s, producer_id, cursor, to - cursor, on_gap);
+        for (size_t i = r; i < s.runs; ++i)
+            s.run[i - r] = s.run[i];
+        s.runs -= r;
+        s.next = to;
+        if (s.bulk_end < to)
+            s.bulk_end = to;
+    }
+
+    template <class OnGap>
+    static void report(State& s, uint8_t producer_id, uint64_t first, uint64_t count, OnGap& on_gap) noexcept
+    {
+        s.lost += count;
+        on_gap(producer_id, first, count);
+    }
+
+    State state_[Producers];
+    uint64_t late_ = 0;
+};
+
+} // namespace wal
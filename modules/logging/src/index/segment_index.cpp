@@ -0,0 +1,219 @@
+#include "segment_index.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wal::internal {
+
+namespace {
+
+bool write_all(int fd, const void* data, size_t bytes, uint64_t offset) noexcept
+{
+    const auto* p = static_cast<const uint8_t*>(data);
+    while (bytes > 0) {
+        const ssize_t n = ::pwrite(fd, p, bytes, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool read_header(int fd, SegmentIndexHeader& h) noexcept
+{
+    return ::pread(fd, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h))
+        && std::memcmp(h.magic, kSegmentIndexMagic, sizeof(h.magic)) == 0
+        && h.version == kSegmentIndexVersion
+        && h.stride != 0;
+}
+
+uint64_t entry_offset(uint64_t k) noexcept
+{
+    return sizeof(SegmentIndexHeader) + k * sizeof(SegmentIndexEntry);
+}
+
+} // namespace
+
+std::string segment_index_path(const std::string& segment_path)
+{
+    constexpr const char kSeg[] = ".seg";
+    constexpr size_t kExt = sizeof(kSeg) - 1;
+    if (segment_path.size() >= kExt && segment_path.compare(segment_path.size() - kExt, kExt, kSeg) == 0)
+        return segment_path.substr(0, segment_path.size() - kExt) + ".idx";
+    return segment_path + ".idx";
+}
+
+// ---------------------------------------------------------------------------
+// SegmentIndexWriter
+// ---------------------------------------------------------------------------
+
+SegmentIndexWriter::~SegmentIndexWriter()
+{
+    close();
+}
+
+bool SegmentIndexWriter::open(const char* path, uint32_t stride, uint64_t segment_records) noexcept
+{
+    close();
+    if (stride == 0)
+        return false;
+
+    const int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+
+    const uint64_t needed = (segment_records + stride - 1) / stride;
+    uint64_t kept = 0;
+    SegmentIndexHeader h{};
+    if (segment_records != 0) {
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || !read_header(fd, h) || h.stride != stride
+            || static_cast<uint64_t>(st.st_size) < entry_offset(needed)) {
+            ::close(fd);
+            return false;
+        }
+        kept = needed;
+    } else {
+        std::memcpy(h.magic, kSegmentIndexMagic, sizeof(h.magic));
+        h.version = kSegmentIndexVersion;
+        h.stride = stride;
+        if (!write_all(fd, &h, sizeof(h), 0)) {
+            ::close(fd);
+            return false;
+        }
+    }
+
+    if (::ftruncate(fd, static_cast<off_t>(entry_offset(kept))) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    stride_ = stride;
+    records_ = segment_records;
+    entries_ = kept;
+    pending_ = 0;
+    return true;
+}
+
+bool SegmentIndexWriter::add(const LogRecordV2& rec) noexcept
+{
+    if (fd_ < 0)
+        return false;
+    if (records_ % stride_ == 0) {
+        if (pending_ == kPendingEntries && !flush())
+            return false;
+        pending_entries_[pending_++] =
+            SegmentIndexEntry{rec.global_seq, rec.commit_ts, records_ * sizeof(LogRecordV2)};
+    }
+    ++records_;
+    return true;
+}
+
+bool SegmentIndexWriter::flush() noexcept
+{
+    if (fd_ < 0)
+        return false;
+    if (pending_ == 0)
+        return true;
+    if (!write_all(fd_, pending_entries_, pending_ * sizeof(SegmentIndexEntry), entry_offset(entries_)))
+        return false;
+    entries_ += pending_;
+    pending_ = 0;
+    return true;
+}
+
+void SegmentIndexWriter::close() noexcept
+{
+    if (fd_ < 0)
+        return;
+    (void)flush();
+    ::close(fd_);
+    fd_ = -1;
+    records_ = 0;
+    entries_ = 0;
+    pending_ = 0;
+}
+
+// ---------------------------------------------------------------------------
+// SegmentIndex
+// ---------------------------------------------------------------------------
+
+bool SegmentIndex::load(const char* path)
+{
+    stride_ = 0;
+    entries_.clear();
+
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    SegmentIndexHeader h{};
+    struct stat st{};
+    if (!read_header(fd, h) || ::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    const uint64_t count = (static_cast<uint64_t>(st.st_size) - sizeof(h)) / sizeof(SegmentIndexEntry);
+    entries_.resize(count);
+    const ssize_t want = static_cast<ssize_t>(count * sizeof(SegmentIndexEntry));
+    const ssize_t got = count == 0 ? 0 : ::pread(fd, entries_.data(), static_cast<size_t>(want), sizeof(h));
+    ::close(fd);
+    if (got != want) {
+        entries_.clear();
+        return false;
+    }
+
+    // Keep the prefix that matches the layout: entry k is record k * stride,
+    // global_seq strictly increasing.
+    size_t valid = 0;
+    for (; valid < entries_.size(); ++valid) {
+        const SegmentIndexEntry& e = entries_[valid];
+        if (e.offset != valid * uint64_t{h.stride} * sizeof(LogRecordV2))
+            break;
+        if (valid != 0 && e.global_seq <= entries_[valid - 1].global_seq)
+            break;
+    }
+    entries_.resize(valid);
+    stride_ = h.stride;
+    return true;
+}
+
+uint64_t SegmentIndex::seek_seq(uint64_t seq) const noexcept
+{
+    // Last entry with global_seq <= seq.
+    size_t lo = 0;
+    size_t hi = entries_.size();
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (entries_[mid].global_seq <= seq)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo == 0 ? 0 : entries_[lo - 1].offset;
+}
+
+uint64_t SegmentIndex::seek_ts(uint64_t ts) const noexcept
+{
+    // Last entry strictly before ts: equal timestamps may start earlier.
+    size_t lo = 0;
+    size_t hi = entries_.size();
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (ts_before(entries_[mid].commit_ts, ts))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo == 0 ? 0 : entries_[lo - 1].offset;
+}
+
+} // namespace wal::internal
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "log_record.hpp"
+
+namespace wal::internal {
+
+// Sparse per-segment index (sidecar `<boot_id>_<part_id>.idx`, wal_format.md §13).
+//
+// One entry per `stride` records: entry k describes record k * stride of the
+// segment. Lookups binary-search the entries and scan at most `stride`
+// records forward, instead of reading the segment from its start.
+//
+// The index is advisory: it is never fsync'ed and may lag or be torn after a
+// crash. Readers trust only entries that pass validation on load, and
+// recovery rebuilds a missing or unreadable index from the segment itself.
+
+inline constexpr char     kSegmentIndexMagic[8] = {'W', 'A', 'L', 'I', 'D', 'X', '0', '1'};
+inline constexpr uint32_t kSegmentIndexVersion  = 1;
+inline constexpr uint32_t kDefaultIndexStride   = 1024; // one entry per 64 KiB of records
+
+struct SegmentIndexHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t stride;   // records per entry
+};
+
+struct SegmentIndexEntry {
+    uint64_t global_seq;
+    uint64_t commit_ts;
+    uint64_t offset;   // byte offset of the record in the segment
+};
+
+static_assert(sizeof(SegmentIndexHeader) == 16);
+static_assert(sizeof(SegmentIndexEntry) == 24);
+
+// "<dir>/00000042_00000001.seg" → "<dir>/00000042_00000001.idx".
+std::string segment_index_path(const std::string& segment_path);
+
+// Incremental index builder, fed by the Writer in record order (non-RT).
+//
+// Entries are staged in a fixed array and appended to the file when it fills
+// or on flush(); no allocation after open().
+class SegmentIndexWriter {
+public:
+    static constexpr size_t kPendingEntries = 64;
+
+    SegmentIndexWriter() noexcept = default;
+    ~SegmentIndexWriter();
+
+    SegmentIndexWriter(const SegmentIndexWriter&) = delete;
+    SegmentIndexWriter& operator=(const SegmentIndexWriter&) = delete;
+
+    // Open the index of a segment that already holds `segment_records` valid
+    // records. An empty segment (re)creates the index. Otherwise an existing
+    // index with the same stride covering those records is kept and trimmed
+    // beyond them; if there is none, open() fails — rebuild it first
+    // (rebuild_segment_index(), recovery.hpp).
+    bool open(const char* path, uint32_t stride, uint64_t segment_records) noexcept;
+
+    // Account for the next record of the segment (in order).
+    bool add(const LogRecordV2& rec) noexcept;
+
+    // Append staged entries to the file (no fsync).
+    bool flush() noexcept;
+
+    // flush() and close.
+    void close() noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept { return fd_ >= 0; }
+    [[nodiscard]] uint64_t records() const noexcept { return records_; }
+    [[nodiscard]] uint64_t entries() const noexcept { return entries_ + pending_; }
+
+private:
+    int fd_ = -1;
+    uint32_t stride_ = kDefaultIndexStride;
+    uint64_t records_ = 0;    // records of the segment seen so far
+    uint64_t entries_ = 0;    // entries on file
+    size_t pending_ = 0;
+    SegmentIndexEntry pending_entries_[kPendingEntries]{};
+};
+
+// Loaded index of one segment (offline readers, recovery).
+class SegmentIndex {
+public:
+    // Reads and validates the sidecar; entries are kept up to the first one
+    // that breaks the layout (torn tail, stale content). false → unusable.
+    bool load(const char* path);
+
+    [[nodiscard]] uint32_t stride() const noexcept { return stride_; }
+    [[nodiscard]] const std::vector<SegmentIndexEntry>& entries() const noexcept { return entries_; }
+
+    // Byte offset at which a forward scan for the first record with
+    // global_seq >= seq (resp. commit_ts >= ts) must start. Within a segment
+    // both are non-decreasing; commit_ts is compared with the §6.3 rule.
+    [[nodiscard]] uint64_t seek_seq(uint64_t seq) const noexcept;
+    [[nodiscard]] uint64_t seek_ts(uint64_t ts) const noexcept;
+
+private:
+    uint32_t stride_ = 0;
+    std::vector<SegmentIndexEntry> entries_;
+};
+
+} // namespace wal::internal
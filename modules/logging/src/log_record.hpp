@@ -2,6 +2,8 @@
 #include <cstdint>
 #include <type_traits>
 
+#include "stam/primitives/crc32_rt.hpp"
+
 namespace wal {
 
 struct LogRecordV2 final {
@@ -26,4 +28,21 @@ static_assert(sizeof(LogRecordV2) == 64);
 static_assert(std::is_trivially_copyable_v<LogRecordV2>);
 static_assert(alignof(LogRecordV2) >= 8);
 
+inline constexpr uint8_t kLogRecordVersion = 2;
+
+// CRC32C over bytes [4..63] (wal_format.md §3).
+inline uint32_t record_crc(const LogRecordV2& r) noexcept {
+  return stam::primitives::crc32c(reinterpret_cast<const uint8_t*>(&r) + 4, sizeof(LogRecordV2) - 4);
+}
+
+// Valid iff the version is supported and the CRC matches (§3.3).
+inline bool record_valid(const LogRecordV2& r) noexcept {
+  return r.version == kLogRecordVersion && r.crc32 == record_crc(r);
+}
+
+// Timestamp order with wrap-around (§6.3): a is before b iff the signed delta is negative.
+inline constexpr bool ts_before(uint64_t a, uint64_t b) noexcept {
+  return static_cast<int64_t>(a - b) < 0;
+}
+
 } // namespace wal
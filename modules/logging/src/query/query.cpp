@@ -0,0 +1,148 @@
+#include "query.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "codec/record_codec.hpp"
+#include "query_kernels.hpp"
+
+namespace wal::internal {
+
+namespace {
+
+constexpr size_t kBlockRecords = 1024; // 64 KiB per kernel call
+
+struct SegmentResult {
+    std::vector<QueryMatch> matches;
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    bool invalid = false;
+    bool ok = true;
+};
+
+void scan_segment_mapped(const std::string& path, uint32_t seg, const CompiledFilter& f, FilterKernelFn kernel,
+                         const QueryOptions& opt, SegmentResult& res)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        res.ok = false;
+        return;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        res.ok = false;
+        return;
+    }
+    const size_t n = static_cast<size_t>(st.st_size) / sizeof(LogRecordV2);
+    res.bytes = static_cast<uint64_t>(st.st_size);
+    if (n == 0) {
+        ::close(fd);
+        return;
+    }
+
+    const size_t bytes = n * sizeof(LogRecordV2);
+    void* map = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        res.ok = false;
+        return;
+    }
+    (void)::madvise(map, bytes, MADV_SEQUENTIAL);
+    const auto* recs = static_cast<const LogRecordV2*>(map);
+
+    uint32_t hits[kBlockRecords];
+    bool stop = false;
+    for (size_t b = 0; b < n && !stop; b += kBlockRecords) {
+        size_t count = std::min(kBlockRecords, n - b);
+        if (opt.verify_all) {
+            const size_t valid = valid_prefix(recs + b, count);
+            if (valid < count) {
+                res.invalid = true;
+                stop = true;
+            }
+            count = valid;
+        }
+        res.records += count;
+
+        const size_t m = kernel(recs + b, count, f, hits);
+        for (size_t j = 0; j < m; ++j) {
+            const LogRecordV2& r = recs[b + hits[j]];
+            if (!opt.verify_all && !record_valid(r)) {
+                // Everything from here on is past the valid prefix (§11).
+                res.records -= count - hits[j];
+                res.invalid = true;
+                stop = true;
+                break;
+            }
+            res.matches.push_back(QueryMatch{seg, (b + hits[j]) * sizeof(LogRecordV2), r});
+            if (opt.limit != 0 && res.matches.size() == opt.limit) {
+                stop = true;
+                break;
+            }
+        }
+    }
+    ::munmap(map, bytes);
+}
+
+} // namespace
+
+bool run_query(const std::vector<std::string>& segments, const QueryFilter& filter,
+               const QueryOptions& options, std::vector<QueryMatch>& out, QueryStats* stats)
+{
+    out.clear();
+    QueryStats st{};
+    st.kernel = options.kernel == QueryKernel::Auto ? best_query_kernel() : options.kernel;
+    FilterKernelFn kernel = filter_kernel(st.kernel);
+    if (kernel == nullptr) {
+        st.kernel = QueryKernel::Scalar;
+        kernel = filter_kernel(QueryKernel::Scalar);
+    }
+
+    CompiledFilter f{};
+    compile_filter(filter, f);
+
+    std::vector<SegmentResult> results(segments.size());
+    std::atomic<size_t> next{0};
+    const auto worker = [&] {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < segments.size();
+             i = next.fetch_add(1, std::memory_order_relaxed))
+            scan_segment_mapped(segments[i], static_cast<uint32_t>(i), f, kernel, options, results[i]);
+    };
+
+    unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, segments.size()));
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool)
+        t.join();
+
+    bool ok = true;
+    for (SegmentResult& r : results) {
+        ok = ok && r.ok;
+        if (!r.ok)
+            continue;
+        ++st.segments;
+        st.records += r.records;
+        st.bytes += r.bytes;
+        st.matches += r.matches.size();
+        st.invalid += r.invalid ? 1u : 0u;
+        for (const QueryMatch& m : r.matches) {
+            if (options.limit != 0 && out.size() == options.limit)
+                break;
+            out.push_back(m);
+        }
+    }
+    if (stats != nullptr)
+        *stats = st;
+    return ok;
+}
+
+} // namespace wal::internal
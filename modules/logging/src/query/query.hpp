@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "log_record.hpp"
+
+namespace wal::internal {
+
+// Offline WAL query engine (non-RT).
+//
+// Segments are mmap'ed read-only and filtered in place over the fixed 64-byte
+// record stride: the header dword [4..7] (version, event_type, flags,
+// producer_id) and commit_ts / global_seq are pulled out of 8 records at a
+// time with AVX2 gathers (x86-64, selected at runtime) or lane loads plus
+// masked compares (NEON), with a scalar fallback. Segments are spread over
+// worker threads; results come back in segment order.
+
+// 256-bit set of byte values (event types, producer ids).
+struct ByteSet {
+    uint64_t bits[4] = {~uint64_t{0}, ~uint64_t{0}, ~uint64_t{0}, ~uint64_t{0}};
+
+    static ByteSet none() noexcept { return ByteSet{{0, 0, 0, 0}}; }
+    void add(uint8_t v) noexcept { bits[v >> 6] |= uint64_t{1} << (v & 63u); }
+    [[nodiscard]] bool contains(uint8_t v) const noexcept { return (bits[v >> 6] >> (v & 63u)) & 1u; }
+};
+
+struct QueryFilter {
+    ByteSet event_types;            // default: any
+    ByteSet producers;              // default: any
+
+    // (flags & flags_mask) == flags_value
+    uint8_t flags_mask = 0;
+    uint8_t flags_value = 0;
+
+    // Severity = flags & severity_mask; records below min_severity are dropped.
+    uint8_t severity_mask = 0;
+    uint8_t min_severity = 0;
+
+    // commit_ts in [ts_from, ts_to), compared per §6.3.
+    bool by_ts = false;
+    uint64_t ts_from = 0;
+    uint64_t ts_to = 0;
+
+    // global_seq in [seq_from, seq_to).
+    bool by_seq = false;
+    uint64_t seq_from = 0;
+    uint64_t seq_to = 0;
+};
+
+enum class QueryKernel : uint8_t {
+    Auto,    // best available on this CPU
+    Scalar,
+    Avx2,
+    Neon,
+};
+
+// Kernel Auto resolves to on this CPU.
+QueryKernel best_query_kernel() noexcept;
+const char* query_kernel_name(QueryKernel k) noexcept;
+
+struct QueryOptions {
+    unsigned threads = 0;           // 0 → hardware concurrency
+    bool verify_all = false;        // CRC every record, not only matches
+    uint64_t limit = 0;             // max matches returned, 0 → unlimited
+    QueryKernel kernel = QueryKernel::Auto;
+};
+
+struct QueryMatch {
+    uint32_t segment;               // index into the segment list
+    uint64_t offset;                // byte offset in the segment
+    LogRecordV2 record;
+};
+
+struct QueryStats {
+    uint64_t segments = 0;
+    uint64_t records = 0;           // records scanned
+    uint64_t bytes = 0;
+    uint64_t matches = 0;           // found (each segment stops at `limit`)
+    uint64_t invalid = 0;           // segments cut short by an invalid record (§11)
+    QueryKernel kernel = QueryKernel::Scalar;
+};
+
+// Scan `segments` (paths, in order) for records matching `filter`.
+//
+// A segment is read up to its first invalid record. With verify_all that is
+// exact (§11); otherwise only matching records are CRC-checked and the scan
+// stops at the first match that fails — a corrupt record that does not match
+// the filter goes unnoticed. The version check is part of every filter, so
+// zero padding never matches.
+//
+// false → some segment could not be opened or mapped (the others are still
+// scanned).
+bool run_query(const std::vector<std::string>& segments, const QueryFilter& filter,
+               const QueryOptions& options, std::vector<QueryMatch>& out, QueryStats* stats = nullptr);
+
+} // namespace wal::internal
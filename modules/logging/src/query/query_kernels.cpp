@@ -0,0 +1,248 @@
+#include "query_kernels.hpp"
+
+#include <cstring>
+
+#include "stam/sys/sys_arch.hpp"
+
+#if SYS_ARCH_X86 && defined(__GNUC__)
+#include <immintrin.h>
+#define WAL_QUERY_HAVE_AVX2 1
+#else
+#define WAL_QUERY_HAVE_AVX2 0
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define WAL_QUERY_HAVE_NEON 1
+#else
+#define WAL_QUERY_HAVE_NEON 0
+#endif
+
+namespace wal::internal {
+
+namespace {
+
+constexpr size_t kHeaderOffset = 4;   // version, event_type, flags, producer_id
+constexpr size_t kSeqOffset = 8;
+constexpr size_t kCommitTsOffset = 16;
+
+uint32_t header_of(const LogRecordV2& r) noexcept
+{
+    uint32_t h;
+    std::memcpy(&h, reinterpret_cast<const uint8_t*>(&r) + kHeaderOffset, sizeof(h));
+    return h;
+}
+
+// Everything but the header dword compare.
+bool tail_matches(const LogRecordV2& r, const CompiledFilter& f) noexcept
+{
+    if (f.type_ok[r.event_type] == 0 || f.producer_ok[r.producer_id] == 0)
+        return false;
+    if ((r.flags & f.severity_mask) < f.min_severity)
+        return false;
+    if (f.by_ts && (ts_before(r.commit_ts, f.ts_from) || !ts_before(r.commit_ts, f.ts_to)))
+        return false;
+    if (f.by_seq && (r.global_seq < f.seq_from || r.global_seq >= f.seq_to))
+        return false;
+    return true;
+}
+
+size_t filter_scalar(const LogRecordV2* recs, size_t n, const CompiledFilter& f, uint32_t* out)
+{
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (record_matches(recs[i], f))
+            out[k++] = static_cast<uint32_t>(i);
+    }
+    return k;
+}
+
+#if WAL_QUERY_HAVE_AVX2
+
+// 4 records from `base`: per-lane mask of lo <= x < hi, signed (§6.3) or unsigned.
+__attribute__((target("avx2")))
+inline int range_mask4(const uint8_t* base, bool wrap, uint64_t lo, uint64_t hi)
+{
+    const __m128i idx = _mm_setr_epi32(0, 8, 16, 24); // x8 bytes → record stride
+    const __m256i x = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(base), idx, 8);
+    __m256i ok;
+    if (wrap) {
+        const __m256i d_lo = _mm256_sub_epi64(x, _mm256_set1_epi64x(static_cast<long long>(lo)));
+        const __m256i d_hi = _mm256_sub_epi64(x, _mm256_set1_epi64x(static_cast<long long>(hi)));
+        ok = _mm256_and_si256(_mm256_cmpgt_epi64(d_lo, _mm256_set1_epi64x(-1)),
+                              _mm256_cmpgt_epi64(_mm256_setzero_si256(), d_hi));
+    } else {
+        const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(uint64_t{1} << 63));
+        const __m256i xs = _mm256_xor_si256(x, sign);
+        const __m256i lo_gt = _mm256_cmpgt_epi64(_mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(lo)), sign), xs);
+        const __m256i hi_gt = _mm256_cmpgt_epi64(_mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(hi)), sign), xs);
+        ok = _mm256_andnot_si256(lo_gt, hi_gt);
+    }
+    return _mm256_movemask_pd(_mm256_castsi256_pd(ok));
+}
+
+__attribute__((target("avx2")))
+int range_mask8(const LogRecordV2* recs, size_t field, bool wrap, uint64_t lo, uint64_t hi)
+{
+    const auto* base = reinterpret_cast<const uint8_t*>(recs) + field;
+    return range_mask4(base, wrap, lo, hi) | (range_mask4(base + 4 * sizeof(LogRecordV2), wrap, lo, hi) << 4);
+}
+
+__attribute__((target("avx2")))
+size_t filter_avx2(const LogRecordV2* recs, size_t n, const CompiledFilter& f, uint32_t* out)
+{
+    // Header dword of record i sits at dword 16 * i from the first one.
+    const __m256i idx = _mm256_setr_epi32(0, 16, 32, 48, 64, 80, 96, 112);
+    const __m256i hdr_mask = _mm256_set1_epi32(static_cast<int>(f.hdr_mask));
+    const __m256i hdr_value = _mm256_set1_epi32(static_cast<int>(f.hdr_value));
+    const __m256i sev_mask = _mm256_set1_epi32(static_cast<int>(f.severity_mask));
+    const __m256i min_sev = _mm256_set1_epi32(static_cast<int>(f.min_severity));
+    const __m256i byte = _mm256_set1_epi32(0xFF);
+
+    size_t k = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const auto* base = reinterpret_cast<const int*>(reinterpret_cast<const uint8_t*>(recs + i) + kHeaderOffset);
+        const __m256i h = _mm256_i32gather_epi32(base, idx, 4);
+
+        __m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(h, hdr_mask), hdr_value);
+        const __m256i type = _mm256_and_si256(_mm256_srli_epi32(h, 8), byte);
+        m = _mm256_and_si256(m, _mm256_i32gather_epi32(f.type_ok, type, 4));
+        const __m256i producer = _mm256_srli_epi32(h, 24);
+        m = _mm256_and_si256(m, _mm256_i32gather_epi32(f.producer_ok, producer, 4));
+        const __m256i sev = _mm256_and_si256(_mm256_srli_epi32(h, 16), sev_mask);
+        m = _mm256_andnot_si256(_mm256_cmpgt_epi32(min_sev, sev), m);
+
+        int bits = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+        if (bits != 0 && f.by_ts)
+            bits &= range_mask8(recs + i, kCommitTsOffset, true, f.ts_from, f.ts_to);
+        if (bits != 0 && f.by_seq)
+            bits &= range_mask8(recs + i, kSeqOffset, false, f.seq_from, f.seq_to);
+
+        while (bits != 0) {
+            out[k++] = static_cast<uint32_t>(i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(bits))));
+            bits &= bits - 1;
+        }
+    }
+    for (; i < n; ++i) {
+        if (record_matches(recs[i], f))
+            out[k++] = static_cast<uint32_t>(i);
+    }
+    return k;
+}
+
+#endif // WAL_QUERY_HAVE_AVX2
+
+#if WAL_QUERY_HAVE_NEON
+
+// No gathers on NEON: header dwords are lane-loaded, compared four at a time,
+// and only surviving lanes go through the table / range checks.
+size_t filter_neon(const LogRecordV2* recs, size_t n, const CompiledFilter& f, uint32_t* out)
+{
+    const uint32x4_t hdr_mask = vdupq_n_u32(f.hdr_mask);
+    const uint32x4_t hdr_value = vdupq_n_u32(f.hdr_value);
+    const uint32x4_t sev_mask = vdupq_n_u32(f.severity_mask);
+    const uint32x4_t min_sev = vdupq_n_u32(f.min_severity);
+
+    size_t k = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t h = vdupq_n_u32(0);
+        h = vsetq_lane_u32(header_of(recs[i + 0]), h, 0);
+        h = vsetq_lane_u32(header_of(recs[i + 1]), h, 1);
+        h = vsetq_lane_u32(header_of(recs[i + 2]), h, 2);
+        h = vsetq_lane_u32(header_of(recs[i + 3]), h, 3);
+
+        uint32x4_t m = vceqq_u32(vandq_u32(h, hdr_mask), hdr_value);
+        m = vandq_u32(m, vcgeq_u32(vandq_u32(vshrq_n_u32(h, 16), sev_mask), min_sev));
+        if (vmaxvq_u32(m) == 0)
+            continue;
+
+        uint32_t lanes[4];
+        vst1q_u32(lanes, m);
+        for (size_t j = 0; j < 4; ++j) {
+            if (lanes[j] != 0 && tail_matches(recs[i + j], f))
+                out[k++] = static_cast<uint32_t>(i + j);
+        }
+    }
+    for (; i < n; ++i) {
+        if (record_matches(recs[i], f))
+            out[k++] = static_cast<uint32_t>(i);
+    }
+    return k;
+}
+
+#endif // WAL_QUERY_HAVE_NEON
+
+} // namespace
+
+void compile_filter(const QueryFilter& in, CompiledFilter& out) noexcept
+{
+    for (unsigned v = 0; v < 256; ++v) {
+        out.type_ok[v] = in.event_types.contains(static_cast<uint8_t>(v)) ? -1 : 0;
+        out.producer_ok[v] = in.producers.contains(static_cast<uint8_t>(v)) ? -1 : 0;
+    }
+    out.hdr_mask = 0xFFu | (uint32_t{in.flags_mask} << 16);
+    out.hdr_value = kLogRecordVersion | (static_cast<uint32_t>(in.flags_value & in.flags_mask) << 16);
+    out.severity_mask = in.severity_mask;
+    out.min_severity = in.min_severity;
+    out.by_ts = in.by_ts;
+    out.ts_from = in.ts_from;
+    out.ts_to = in.ts_to;
+    out.by_seq = in.by_seq;
+    out.seq_from = in.seq_from;
+    out.seq_to = in.seq_to;
+}
+
+bool record_matches(const LogRecordV2& r, const CompiledFilter& f) noexcept
+{
+    return (header_of(r) & f.hdr_mask) == f.hdr_value && tail_matches(r, f);
+}
+
+FilterKernelFn filter_kernel(QueryKernel k) noexcept
+{
+    switch (k) {
+    case QueryKernel::Auto:
+        return filter_kernel(best_query_kernel());
+    case QueryKernel::Scalar:
+        return &filter_scalar;
+    case QueryKernel::Avx2:
+#if WAL_QUERY_HAVE_AVX2
+        if (__builtin_cpu_supports("avx2"))
+            return &filter_avx2;
+#endif
+        return nullptr;
+    case QueryKernel::Neon:
+#if WAL_QUERY_HAVE_NEON
+        return &filter_neon;
+#else
+        return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+QueryKernel best_query_kernel() noexcept
+{
+#if WAL_QUERY_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return QueryKernel::Avx2;
+#endif
+#if WAL_QUERY_HAVE_NEON
+    return QueryKernel::Neon;
+#endif
+    return QueryKernel::Scalar;
+}
+
+const char* query_kernel_name(QueryKernel k) noexcept
+{
+    switch (k) {
+    case QueryKernel::Auto:   return "auto";
+    case QueryKernel::Scalar: return "scalar";
+    case QueryKernel::Avx2:   return "avx2";
+    case QueryKernel::Neon:   return "neon";
+    }
+    return "?";
+}
+
+} // namespace wal::internal
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "query.hpp"
+
+namespace wal::internal {
+
+// QueryFilter lowered for the scan kernels.
+struct CompiledFilter {
+    alignas(32) int32_t type_ok[256];      // 0 or -1 per event_type
+    alignas(32) int32_t producer_ok[256];  // 0 or -1 per producer_id
+
+    // Header dword [4..7] = version | event_type << 8 | flags << 16 | producer_id << 24.
+    uint32_t hdr_mask;
+    uint32_t hdr_value;
+    uint32_t severity_mask;
+    uint32_t min_severity;
+
+    bool by_ts;
+    uint64_t ts_from;
+    uint64_t ts_to;
+    bool by_seq;
+    uint64_t seq_from;
+    uint64_t seq_to;
+};
+
+void compile_filter(const QueryFilter& in, CompiledFilter& out) noexcept;
+
+bool record_matches(const LogRecordV2& r, const CompiledFilter& f) noexcept;
+
+// Writes the indexes of the matching records among recs[0, n) to `out`
+// (capacity n), in increasing order; returns their count.
+using FilterKernelFn = size_t (*)(const LogRecordV2* recs, size_t n, const CompiledFilter& f, uint32_t* out);
+
+// nullptr if `k` is not available on this CPU / build.
+FilterKernelFn filter_kernel(QueryKernel k) noexcept;
+
+} // namespace wal::internal
@@ -0,0 +1,531 @@
+#include "recovery.hpp"
+
+#include "backend/staging_backend.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <dirent.h>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace wal::internal {
+
+namespace {
+
+constexpr size_t kChunkRecords = 256; // 16 KiB read granularity
+
+// Forward reader over the valid prefix of a segment, starting at `offset`.
+class RecordScanner {
+public:
+    RecordScanner(int fd, uint64_t offset) noexcept
+        : fd_(fd), offset_(offset / sizeof(LogRecordV2) * sizeof(LogRecordV2))
+    {
+    }
+
+    // Next valid record; false at EOF or at the first invalid / partial record.
+    bool next(const LogRecordV2*& rec, uint64_t& offset) noexcept
+    {
+        if (pos_ == count_ && !refill())
+            return false;
+        rec = &buf_[pos_];
+        if (!record_valid(*rec)) {
+            invalid_ = true;
+            return false;
+        }
+        offset = offset_ + pos_ * sizeof(LogRecordV2);
+        ++pos_;
+        return true;
+    }
+
+    // Stopped on an invalid record or a torn tail rather than a clean EOF.
+    [[nodiscard]] bool invalid() const noexcept { return invalid_; }
+
+private:
+    bool refill() noexcept
+    {
+        offset_ += count_ * sizeof(LogRecordV2);
+        pos_ = 0;
+        count_ = 0;
+        ssize_t n;
+        do {
+            n = ::pread(fd_, buf_, sizeof(buf_), static_cast<off_t>(offset_));
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0)
+            return false;
+        count_ = static_cast<size_t>(n) / sizeof(LogRecordV2);
+        if (count_ == 0) {
+            invalid_ = true; // partial record at the tail
+            return false;
+        }
+        return true;
+    }
+
+    int fd_;
+    uint64_t offset_;
+    size_t pos_ = 0;
+    size_t count_ = 0;
+    bool invalid_ = false;
+    LogRecordV2 buf_[kChunkRecords];
+};
+
+// Forward search from the index hint for the first record that is not
+// `before` the target. If the record at the hint does not match what the
+// index promised (`stale`), or there is no valid record at a non-zero hint
+// (the segment is shorter than when it was indexed), the index is out of
+// date: restart at offset 0.
+template <typename Before, typename Stale>
+bool find_from(const char* segment_path, uint64_t hint, Before before, Stale stale,
+               LogRecordV2& out, uint64_t* offset) noexcept
+{
+    const int fd = ::open(segment_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    bool found = false;
+    bool restart = false;
+    for (uint64_t start : {hint, uint64_t{0}}) {
+        RecordScanner scan{fd, start};
+        const LogRecordV2* rec = nullptr;
+        uint64_t at = 0;
+        bool first = true;
+        while (scan.next(rec, at)) {
+            if (first && start != 0 && stale(*rec)) {
+                restart = true;
+                break;
+            }
+            first = false;
+            if (!before(*rec)) {
+                out = *rec;
+                if (offset != nullptr)
+                    *offset = at;
+                found = true;
+                break;
+            }
+        }
+        if (first && start != 0)
+            restart = true;
+        if (!restart || start == 0)
+            break;
+    }
+    ::close(fd);
+    return found;
+}
+
+// Index present, with `stride`, covering every valid record of `scan`.
+bool index_covers(const char* segment_path, const SegmentScan& scan, uint32_t stride)
+{
+    SegmentIndex index;
+    const uint64_t needed = (scan.records + stride - 1) / stride;
+    return index.load(segment_index_path(segment_path).c_str()) && index.stride() == stride
+        && index.entries().size() >= needed
+        && (needed == 0 || index.entries()[0].global_seq == scan.first_seq);
+}
+
+const char* file_name(const std::string& path) noexcept
+{
+    const size_t slash = path.rfind('/');
+    return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+bool fsync_dir(const char* dir) noexcept
+{
+    const int fd = ::open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+// Replace `dst` with the first `bytes` of `src`: temporary file, fdatasync,
+// rename, directory fsync. A crash leaves either copy whole.
+bool copy_prefix(const std::string& src, const std::string& dst, const char* dst_dir, uint64_t bytes) noexcept
+{
+    const std::string tmp = dst + ".tmp";
+    const int in = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+        return false;
+    const int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+
+    static constexpr size_t kCopyBytes = kChunkRecords * sizeof(LogRecordV2);
+    uint8_t buf[kCopyBytes];
+    bool ok = true;
+    for (uint64_t off = 0; ok && off < bytes;) {
+        const size_t want = bytes - off < kCopyBytes ? static_cast<size_t>(bytes - off) : kCopyBytes;
+        const ssize_t n = ::pread(in, buf, want, static_cast<off_t>(off));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        for (ssize_t done = 0; ok && done < n;) {
+            const ssize_t w = ::write(out, buf + done, static_cast<size_t>(n - done));
+            if (w < 0 && errno == EINTR)
+                continue;
+            ok = w > 0;
+            done += w > 0 ? w : 0;
+        }
+        off += static_cast<uint64_t>(n);
+    }
+    ok = ok && ::fdatasync(out) == 0;
+    ::close(out);
+    ::close(in);
+    if (!ok || std::rename(tmp.c_str(), dst.c_str()) != 0) {
+        (void)::unlink(tmp.c_str());
+        return false;
+    }
+    return fsync_dir(dst_dir);
+}
+
+uint64_t file_bytes(const std::string& path) noexcept
+{
+    struct stat st{};
+    return ::stat(path.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+}
+
+} // namespace
+
+bool scan_segment(const char* segment_path, SegmentScan& out, SegmentIndexWriter* index) noexcept
+{
+    out = SegmentScan{};
+    const int fd = ::open(segment_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    RecordScanner scan{fd, 0};
+    const LogRecordV2* rec = nullptr;
+    uint64_t at = 0;
+    bool ok = true;
+    while (scan.next(rec, at)) {
+        if (out.records == 0) {
+            out.first_seq = rec->global_seq;
+            out.first_ts = rec->commit_ts;
+        }
+        out.last_seq = rec->global_seq;
+        out.last_ts = rec->commit_ts;
+        ++out.records;
+        if (index != nullptr && !index->add(*rec))
+            ok = false;
+    }
+    out.truncated = scan.invalid();
+    ::close(fd);
+    return ok;
+}
+
+bool visit_segment(const char* segment_path, RecordVisitor visit, void* ctx) noexcept
+{
+    const int fd = ::open(segment_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    RecordScanner scan{fd, 0};
+    const LogRecordV2* rec = nullptr;
+    uint64_t at = 0;
+    while (scan.next(rec, at) && visit(ctx, *rec)) {
+    }
+    ::close(fd);
+    return true;
+}
+
+bool rebuild_segment_index(const char* segment_path, uint32_t stride) noexcept
+{
+    const std::string idx = segment_index_path(segment_path);
+    const std::string tmp = idx + ".tmp";
+
+    SegmentIndexWriter w;
+    if (!w.open(tmp.c_str(), stride, 0))
+        return false;
+    SegmentScan scan{};
+    const bool ok = scan_segment(segment_path, scan, &w) && w.flush();
+    w.close();
+    if (!ok || std::rename(tmp.c_str(), idx.c_str()) != 0) {
+        (void)::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ensure_segment_index(const char* segment_path, uint32_t stride, bool* rebuilt) noexcept
+{
+    if (rebuilt != nullptr)
+        *rebuilt = false;
+
+    SegmentScan scan{};
+    if (!scan_segment(segment_path, scan))
+        return false;
+
+    if (index_covers(segment_path, scan, stride))
+        return true;
+
+    if (rebuilt != nullptr)
+        *rebuilt = true;
+    return rebuild_segment_index(segment_path, stride);
+}
+
+bool list_segments(const char* dir, std::vector<std::string>& out)
+{
+    out.clear();
+    DIR* d = ::opendir(dir);
+    if (d == nullptr)
+        return false;
+    while (const dirent* e = ::readdir(d)) {
+        const std::string name = e->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".seg") == 0)
+            out.push_back(std::string{dir} + "/" + name);
+    }
+    ::closedir(d);
+
+    // Fixed-width <boot_id>_<part_id> names sort lexicographically.
+    std::sort(out.begin(), out.end());
+    return true;
+}
+
+bool recover_directory(const char* dir, RecoveryResult& out, uint32_t stride)
+{
+    out = RecoveryResult{};
+
+    std::vector<std::string> paths;
+    if (!list_segments(dir, paths))
+        return false;
+
+    bool ok = true;
+    for (const std::string& path : paths) {
+        SegmentScan scan{};
+        if (!scan_segment(path.c_str(), scan)) {
+            ok = false;
+            continue;
+        }
+        ++out.segments;
+        out.records += scan.records;
+        if (scan.records != 0) {
+            out.found = true;
+            out.last_seq = scan.last_seq;
+        }
+
+        // The last segment is the one appends resume on: cut its torn tail,
+        // or §11 readers would never reach them.
+        const uint64_t valid = scan.records * sizeof(LogRecordV2);
+        if (&path == &paths.back() && file_bytes(path) != valid) {
+            const int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+            const bool cut = fd >= 0 && ::ftruncate(fd, static_cast<off_t>(valid)) == 0 && ::fdatasync(fd) == 0;
+            if (fd >= 0)
+                ::close(fd);
+            if (!cut) {
+                ok = false;
+                continue;
+            }
+            (void)::unlink(segment_index_path(path).c_str());
+            out.tail_truncated = true;
+        }
+
+        if (!index_covers(path.c_str(), scan, stride)) {
+            ++out.indexes_rebuilt;
+            if (!rebuild_segment_index(path.c_str(), stride))
+                ok = false;
+        }
+    }
+    out.next_global_seq = out.found ? out.last_seq + 1 : 0;
+    return ok;
+}
+
+bool recover_mirror(const char* dir_a, const char* dir_b, MirrorRecoveryResult& out, uint32_t stride)
+{
+    out = MirrorRecoveryResult{};
+    const char* dirs[2] = {dir_a, dir_b};
+
+    std::vector<std::string> names;
+    for (const char* dir : dirs) {
+        std::vector<std::string> paths;
+        if (!list_segments(dir, paths))
+            return false;
+        for (const std::string& p : paths)
+            names.emplace_back(file_name(p));
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    bool ok = true;
+    for (const std::string& name : names) {
+        std::string path[2];
+        SegmentScan scan[2];
+        bool exists[2];
+        for (int i = 0; i < 2; ++i) {
+            path[i] = std::string{dirs[i]} + "/" + name;
+            exists[i] = ::access(path[i].c_str(), F_OK) == 0;
+            if (exists[i] && !scan_segment(path[i].c_str(), scan[i]))
+                ok = false;
+        }
+
+        int win = scan[1].records > scan[0].records ? 1 : 0;
+        if (scan[1].records == scan[0].records && !exists[0])
+            win = 1;
+        const int lose = 1 - win;
+        const uint64_t valid = scan[win].records * sizeof(LogRecordV2);
+
+        // Torn tail (or padding) on the winner: appends must follow the
+        // valid prefix, or §11 readers would never reach them.
+        if (file_bytes(path[win]) != valid) {
+            if (::truncate(path[win].c_str(), static_cast<off_t>(valid)) != 0) {
+                ok = false;
+                continue;
+            }
+            (void)::unlink(segment_index_path(path[win]).c_str());
+            ++out.repaired[win];
+        }
+        if (!exists[lose] || scan[lose].records != scan[win].records || file_bytes(path[lose]) != valid) {
+            if (!copy_prefix(path[win], path[lose], dirs[lose], valid)) {
+                ok = false;
+                continue;
+            }
+            (void)::unlink(segment_index_path(path[lose]).c_str());
+            ++out.repaired[lose];
+        }
+    }
+
+    RecoveryResult other{};
+    ok = recover_directory(dir_a, out.wal, stride) && ok;
+    ok = recover_directory(dir_b, other, stride) && ok;
+    return ok;
+}
+
+bool recover_staging(const char* staging_path, StagingRecoveryResult& out, uint32_t stride)
+{
+    out = StagingRecoveryResult{};
+
+    const int sfd = ::open(staging_path, O_RDONLY | O_CLOEXEC);
+    if (sfd < 0)
+        return errno == ENOENT;
+
+    StagingHeader header{};
+    std::vector<LogRecordV2> staged;
+    bool ok = ::pread(sfd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+        && staging_header_valid(header);
+    if (ok && header.path_len != 0) {
+        out.segment.assign(header.path, header.path_len);
+        SegmentScan scan{};
+        if (::access(out.segment.c_str(), F_OK) == 0 && !scan_segment(out.segment.c_str(), scan))
+            ok = false;
+        out.segment_records = scan.records;
+        out.found = scan.records != 0;
+        out.last_seq = scan.last_seq;
+        out.next_global_seq = out.found ? out.last_seq + 1 : 0;
+
+        // Slots hold the unpromoted records and older ones already in the
+        // segment (or zeroes): keep what lies past the segment's last record.
+        LogRecordV2 buf[kChunkRecords];
+        for (uint64_t slot = 0; ok && slot < header.capacity;) {
+            const uint64_t want = header.capacity - slot < kChunkRecords ? header.capacity - slot : kChunkRecords;
+            const ssize_t n = ::pread(sfd, buf, want * sizeof(LogRecordV2),
+                                      static_cast<off_t>(kStagingHeaderBytes + slot * sizeof(LogRecordV2)));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n != static_cast<ssize_t>(want * sizeof(LogRecordV2))) {
+                ok = false;
+                break;
+            }
+            for (uint64_t i = 0; i < want; ++i) {
+                if (record_valid(buf[i]) && (!out.found || buf[i].global_seq > out.last_seq))
+                    staged.push_back(buf[i]);
+            }
+            slot += want;
+        }
+    }
+    ::close(sfd);
+    if (!ok || out.segment.empty())
+        return ok;
+
+    std::sort(staged.begin(), staged.end(),
+              [](const LogRecordV2& a, const LogRecordV2& b) { return a.global_seq < b.global_seq; });
+    staged.erase(std::unique(staged.begin(), staged.end(),
+                             [](const LogRecordV2& a, const LogRecordV2& b) { return a.global_seq == b.global_seq; }),
+                 staged.end());
+    // Only a gapless run continues the segment: a lost or corrupt slot ends
+    // it, and nothing past the hole is stitched (§11 valid prefix).
+    if (!staged.empty()) {
+        uint64_t expect = out.found ? out.last_seq + 1 : staged.front().global_seq;
+        size_t run = 0;
+        while (run < staged.size() && staged[run].global_seq == expect) {
+            ++run;
+            ++expect;
+        }
+        staged.resize(run);
+    }
+
+    const uint64_t valid = out.segment_records * sizeof(LogRecordV2);
+    const bool exists = ::access(out.segment.c_str(), F_OK) == 0;
+    if (staged.empty() && (!exists || file_bytes(out.segment) == valid))
+        return !exists || ensure_segment_index(out.segment.c_str(), stride);
+
+    // Appends must follow the valid prefix, or §11 readers never reach them.
+    const int fd = ::open(out.segment.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+    ok = ::ftruncate(fd, static_cast<off_t>(valid)) == 0;
+    const auto* p = reinterpret_cast<const uint8_t*>(staged.data());
+    uint64_t off = valid;
+    for (size_t left = staged.size() * sizeof(LogRecordV2); ok && left > 0;) {
+        const ssize_t n = ::pwrite(fd, p, left, static_cast<off_t>(off));
+        if (n < 0 && errno == EINTR)
+            continue;
+        ok = n > 0;
+        if (ok) {
+            p += n;
+            off += static_cast<uint64_t>(n);
+            left -= static_cast<size_t>(n);
+        }
+    }
+    ok = ok && ::fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok)
+        return false;
+    if (!exists) {
+        const size_t slash = out.segment.rfind('/');
+        const std::string dir = slash == std::string::npos ? "." : out.segment.substr(0, slash);
+        if (!fsync_dir(dir.c_str()))
+            return false;
+    }
+
+    out.stitched = staged.size();
+    if (!staged.empty()) {
+        out.found = true;
+        out.last_seq = staged.back().global_seq;
+        out.next_global_seq = out.last_seq + 1;
+    }
+    return rebuild_segment_index(out.segment.c_str(), stride);
+}
+
+bool find_by_seq(const char* segment_path, const SegmentIndex* index, uint64_t seq,
+                 LogRecordV2& out, uint64_t* offset) noexcept
+{
+    const uint64_t hint = index != nullptr ? index->seek_seq(seq) : 0;
+    LogRecordV2 rec{};
+    const auto before = [seq](const LogRecordV2& r) { return r.global_seq < seq; };
+    const auto stale = [seq](const LogRecordV2& r) { return r.global_seq > seq; };
+    if (!find_from(segment_path, hint, before, stale, rec, offset))
+        return false;
+    if (rec.global_seq != seq)
+        return false;
+    out = rec;
+    return true;
+}
+
+bool find_by_ts(const char* segment_path, const SegmentIndex* index, uint64_t ts,
+                LogRecordV2& out, uint64_t* offset) noexcept
+{
+    const uint64_t hint = index != nullptr ? index->seek_ts(ts) : 0;
+    // The hint entry is strictly before ts; a record at or after ts there means stale.
+    const auto before = [ts](const LogRecordV2& r) { return ts_before(r.commit_ts, ts); };
+    return find_from(segment_path, hint, before, [&before](const LogRecordV2& r) { return !before(r); },
+                     out, offset);
+}
+
+} // namespace wal::internal
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "index/segment_index.hpp"
+#include "log_record.hpp"
+
+namespace wal::internal {
+
+// Recovery and lookup over segment files (non-RT, offline or at startup).
+// Implements the decoder rules of wal_format.md §11.
+
+struct SegmentScan {
+    uint64_t records = 0;     // valid records (prefix of the segment)
+    uint64_t first_seq = 0;
+    uint64_t last_seq = 0;
+    uint64_t first_ts = 0;
+    uint64_t last_ts = 0;
+    bool truncated = false;   // stopped at an invalid record or partial tail
+};
+
+// Scan a segment forward up to its first invalid record. If `index` is given,
+// every valid record is fed to it (rebuild).
+bool scan_segment(const char* segment_path, SegmentScan& out, SegmentIndexWriter* index = nullptr) noexcept;
+
+// Called for each valid record in order; false stops the walk.
+using RecordVisitor = bool (*)(void* ctx, const LogRecordV2& rec) noexcept;
+
+// Walk the valid prefix of a segment (§11). false → segment unreadable.
+bool visit_segment(const char* segment_path, RecordVisitor visit, void* ctx) noexcept;
+
+// Rebuild the sidecar of `segment_path` from scratch (temporary file + rename).
+bool rebuild_segment_index(const char* segment_path, uint32_t stride = kDefaultIndexStride) noexcept;
+
+// Keep the sidecar if it has `stride` and covers every valid record,
+// otherwise rebuild it. `rebuilt` (optional) reports which happened.
+bool ensure_segment_index(const char* segment_path, uint32_t stride = kDefaultIndexStride,
+                          bool* rebuilt = nullptr) noexcept;
+
+// `<dir>/<name>.seg` paths of a WAL directory in (boot_id, part_id) order (§10).
+bool list_segments(const char* dir, std::vector<std::string>& out);
+
+struct RecoveryResult {
+    uint64_t segments = 0;
+    uint64_t records = 0;          // valid records over all segments
+    uint64_t indexes_rebuilt = 0;
+    bool     found = false;        // at least one valid record
+    uint64_t last_seq = 0;
+    uint64_t next_global_seq = 0;  // last_seq + 1, or 0 on an empty WAL
+    bool     tail_truncated = false; // last segment cut back to its valid prefix
+};
+
+// §11 over a WAL directory: segments in (boot_id, part_id) order, each
+// scanned to its first invalid record, missing indexes rebuilt. A torn tail
+// (or padding) on the last segment is truncated (fdatasync, sidecar rebuilt)
+// so that a backend reopening it appends right after the valid prefix.
+bool recover_directory(const char* dir, RecoveryResult& out, uint32_t stride = kDefaultIndexStride);
+
+struct MirrorRecoveryResult {
+    RecoveryResult wal;            // of the reconciled WAL (both directories)
+    uint64_t repaired[2] = {};     // segment copies rewritten in dir_a / dir_b
+};
+
+// Reconcile the two directories of a MirrorBackend, then recover_directory()
+// both. Per segment name the copy with the longer valid prefix wins: its
+// torn tail (if any) is truncated and the other copy is replaced by it
+// (temporary file + rename), a missing copy included. Stale sidecars of
+// rewritten copies are dropped and rebuilt. Appending may resume on both
+// legs afterwards.
+bool recover_mirror(const char* dir_a, const char* dir_b, MirrorRecoveryResult& out,
+                    uint32_t stride = kDefaultIndexStride);
+
+struct StagingRecoveryResult {
+    std::string segment;           // segment named by the staging header ("" = none)
+    uint64_t segment_records = 0;  // valid records in it before stitching
+    uint64_t stitched = 0;         // staged records appended to it
+    bool     found = false;        // the segment holds at least one valid record
+    uint64_t last_seq = 0;
+    uint64_t next_global_seq = 0;  // last_seq + 1, or 0 on an empty segment
+};
+
+// Stitch the two tiers of a StagingBackend after a crash: the staged records
+// continuing the segment's valid prefix (last_seq + 1, + 2, ... up to the
+// first missing one) are appended to it in global_seq order (torn tail
+// truncated first, fdatasync, sidecar rebuilt).
+// A missing staging file (tmpfs after a power loss) stitches nothing.
+// Idempotent; false → the staging file or the segment is unreadable, or the
+// staging header is corrupt.
+bool recover_staging(const char* staging_path, StagingRecoveryResult& out,
+                     uint32_t stride = kDefaultIndexStride);
+
+// Record with global_seq == seq. With an index the scan starts at the nearest
+// entry and reads at most one stride of records; without one (or if the index
+// turns out stale) it starts at the beginning of the segment.
+bool find_by_seq(const char* segment_path, const SegmentIndex* index, uint64_t seq,
+                 LogRecordV2& out, uint64_t* offset = nullptr) noexcept;
+
+// First record with commit_ts >= ts (§6.3 comparison); same strategy.
+bool find_by_ts(const char* segment_path, const SegmentIndex* index, uint64_t ts,
+                LogRecordV2& out, uint64_t* offset = nullptr) noexcept;
+
+} // namespace wal::internal
@@ -0,0 +1,327 @@
+#include "replay.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+
+#include "archive/archive.hpp"
+#include "index/segment_index.hpp"
+
+namespace wal::internal {
+
+namespace {
+
+bool ends_with(const std::string& s, const char* suffix)
+{
+    const size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Valid records of one segment (§11 prefix) from the first one with
+// global_seq >= seq_from.
+class SegmentSource {
+public:
+    ~SegmentSource()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    bool open(const std::string& path, uint64_t seq_from) noexcept
+    {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0)
+            return false;
+        if (seq_from == 0)
+            return true;
+
+        // Start one stride before seq_from; a stale index (first record past
+        // seq_from) falls back to the beginning of the segment.
+        SegmentIndex index;
+        if (!index.load(segment_index_path(path).c_str()))
+            return true;
+        offset_ = index.seek_seq(seq_from);
+        const LogRecordV2* rec = nullptr;
+        if (offset_ != 0 && (!next(rec) || rec->global_seq > seq_from)) {
+            offset_ = 0;
+            pos_ = count_ = 0;
+            done_ = false;
+            return true;
+        }
+        pos_ = 0; // hand the probed record out again
+        return true;
+    }
+
+    bool next(const LogRecordV2*& rec) noexcept
+    {
+        if (pos_ == count_ && !refill())
+            return false;
+        rec = &buf_[pos_];
+        if (!record_valid(*rec)) {
+            done_ = true;
+            return false;
+        }
+        ++pos_;
+        return true;
+    }
+
+    [[nodiscard]] bool failed() const noexcept { return failed_; }
+
+private:
+    bool refill() noexcept
+    {
+        if (done_)
+            return false;
+        offset_ += count_ * sizeof(LogRecordV2);
+        pos_ = 0;
+        count_ = 0;
+        ssize_t n;
+        do {
+            n = ::pread(fd_, buf_, sizeof(buf_), static_cast<off_t>(offset_));
+        } while (n < 0 && errno == EINTR);
+        if (n < 0)
+            failed_ = true;
+        if (n <= 0) {
+            done_ = true;
+            return false;
+        }
+        count_ = static_cast<size_t>(n) / sizeof(LogRecordV2);
+        done_ = count_ == 0; // partial record at the tail
+        return count_ != 0;
+    }
+
+    int fd_ = -1;
+    uint64_t offset_ = 0;
+    size_t pos_ = 0;
+    size_t count_ = 0;
+    bool done_ = false;
+    bool failed_ = false;
+    LogRecordV2 buf_[256];
+};
+
+// Records of an archive, blocks before seq_from skipped by header.
+class ArchiveSource {
+public:
+    bool open(const std::string& path, uint64_t seq_from) noexcept
+    {
+        if (reader_.open(path.c_str()) != ArchiveStatus::Ok)
+            return false;
+        ArchiveBlockHeader h{};
+        ArchiveStatus s;
+        while ((s = reader_.peek(h)) == ArchiveStatus::Ok && h.last_seq < seq_from) {
+            if ((s = reader_.skip()) != ArchiveStatus::Ok)
+                break;
+        }
+        status_ = s;
+        return status_ != ArchiveStatus::IoError && status_ != ArchiveStatus::BadHeader;
+    }
+
+    bool next(const LogRecordV2*& rec)
+    {
+        while (pos_ == block_.size()) {
+            if (status_ != ArchiveStatus::Ok || (status_ = reader_.next(block_)) != ArchiveStatus::Ok)
+                return false;
+            pos_ = 0;
+        }
+        rec = &block_[pos_++];
+        return true;
+    }
+
+    // A damaged block ends the archive like an invalid record ends a segment.
+    [[nodiscard]] bool failed() const noexcept { return status_ == ArchiveStatus::IoError; }
+
+private:
+    ArchiveReader reader_;
+    ArchiveStatus status_ = ArchiveStatus::Ok;
+    std::vector<LogRecordV2> block_;
+    size_t pos_ = 0;
+};
+
+// Virtual clock and pacing.
+class Driver {
+public:
+    Driver(ReplayTick tick, const ReplayOptions& options, ReplayStats& stats) noexcept
+        : tick_(tick), options_(options), stats_(stats),
+          units_(options.tick_units == 0 ? 1 : options.tick_units)
+    {
+    }
+
+    // Steps every tick that ends at or before `ts`; the caller then injects
+    // the record into the (still open) tick containing it.
+    void advance(const LogRecordV2& rec) noexcept
+    {
+        uint64_t ts = options_.clock == ReplayClock::Commit ? rec.commit_ts : rec.event_ts;
+        if (!started_) {
+            started_ = true;
+            ts0_ = ts;
+            last_ts_ = ts;
+            wall0_ = std::chrono::steady_clock::now();
+        }
+        if (ts_before(ts, last_ts_))
+            ts = last_ts_;
+        last_ts_ = ts;
+
+        const uint64_t target = (ts - ts0_) / units_;
+        while (next_tick_ < target)
+            step();
+    }
+
+    // Step the tick holding the last record.
+    void finish() noexcept
+    {
+        if (started_)
+            step();
+    }
+
+private:
+    void step() noexcept
+    {
+        if (options_.speed > 0.0) {
+            // Tick n runs when virtual time reaches the end of its interval.
+            const double seconds = static_cast<double>((next_tick_ + 1) * units_) * 100e-6 / options_.speed;
+            std::this_thread::sleep_until(
+                wall0_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double>(seconds)));
+        }
+        tick_.step_fn(tick_.obj, static_cast<stam::model::tick_t>(next_tick_));
+        ++next_tick_;
+        ++stats_.ticks;
+    }
+
+    ReplayTick tick_;
+    const ReplayOptions& options_;
+    ReplayStats& stats_;
+    uint64_t units_;
+    bool started_ = false;
+    uint64_t ts0_ = 0;
+    uint64_t last_ts_ = 0;
+    uint64_t next_tick_ = 0;
+    std::chrono::steady_clock::time_point wall0_{};
+};
+
+} // namespace
+
+Replayer::Replayer()
+    : exact_(256 * 256, kNoRoute)
+{
+    for (uint16_t& r : any_)
+        r = kNoRoute;
+}
+
+bool Replayer::route(uint8_t event_type, uint8_t producer_id, ReplaySink sink)
+{
+    if (sink.inject_fn == nullptr || sinks_.size() >= kNoRoute)
+        return false;
+    exact_[static_cast<size_t>(event_type) << 8 | producer_id] = static_cast<uint16_t>(sinks_.size());
+    sinks_.push_back(sink);
+    return true;
+}
+
+bool Replayer::route(uint8_t event_type, ReplaySink sink)
+{
+    if (sink.inject_fn == nullptr || sinks_.size() >= kNoRoute)
+        return false;
+    any_[event_type] = static_cast<uint16_t>(sinks_.size());
+    sinks_.push_back(sink);
+    return true;
+}
+
+bool Replayer::run(const std::vector<std::string>& sources, ReplayTick tick,
+                   const ReplayOptions& options, ReplayStats* stats)
+{
+    ReplayStats st;
+    if (tick.step_fn == nullptr) {
+        if (stats != nullptr)
+            *stats = st;
+        return false;
+    }
+
+    Driver driver{tick, options, st};
+    assembler_.reset();
+    bool ok = true;
+    bool have_seq = false;
+    uint64_t prev_seq = 0;
+
+    // true → keep going with the next record.
+    auto feed = [&](const LogRecordV2& rec) noexcept {
+        if (rec.global_seq < options.seq_from)
+            return true;
+        if (rec.global_seq >= options.seq_to)
+            return false;
+        if (have_seq && rec.global_seq <= prev_seq) {
+            st.out_of_order = true;
+            ok = false;
+            return false;
+        }
+        if (!have_seq)
+            st.first_seq = rec.global_seq;
+        have_seq = true;
+        prev_seq = rec.global_seq;
+        st.last_seq = rec.global_seq;
+        ++st.records;
+
+        driver.advance(rec);
+        if (rec.reserved[0] != 0 && rec.reserved[0] != kExtFragment) {
+            ++st.skipped;
+            return true;
+        }
+        // A fragmented event goes out once, in the tick of its last fragment.
+        AssembledEvent ev;
+        switch (assembler_.feed(rec, ev)) {
+        case FragmentResult::Pending:
+            return true;
+        case FragmentResult::Dropped:
+            ++st.dropped;
+            return true;
+        case FragmentResult::Record:
+        case FragmentResult::Complete:
+            break;
+        }
+        uint16_t r = exact_[static_cast<size_t>(ev.event_type) << 8 | ev.producer_id];
+        if (r == kNoRoute)
+            r = any_[ev.event_type];
+        if (r == kNoRoute)
+            ++st.unrouted;
+        else if (sinks_[r].inject_fn(sinks_[r].obj, ev))
+            ++st.injected;
+        else
+            ++st.rejected;
+        return true;
+    };
+
+    bool more = true;
+    for (size_t i = 0; i < sources.size() && more && ok; ++i) {
+        const std::string& path = sources[i];
+        const LogRecordV2* rec = nullptr;
+        if (ends_with(path, ".arc")) {
+            ArchiveSource src;
+            if (!src.open(path, options.seq_from)) {
+                ok = false;
+                break;
+            }
+            ++st.sources;
+            while (more && src.next(rec))
+                more = feed(*rec);
+            ok = ok && !src.failed();
+        } else {
+            SegmentSource src;
+            if (!src.open(path, options.seq_from)) {
+                ok = false;
+                break;
+            }
+            ++st.sources;
+            while (more && src.next(rec))
+                more = feed(*rec);
+            ok = ok && !src.failed();
+        }
+    }
+
+    driver.finish();
+    if (stats != nullptr)
+        *stats = st;
+    return ok;
+}
+
+} // namespace wal::internal
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fragment/fragment.hpp"
+#include "log_record.hpp"
+#include "model/port.hpp"
+#include "model/tags.hpp"
+
+namespace wal::internal {
+
+// Deterministic replay of a recorded WAL into a bootstrapped task set (non-RT,
+// offline).
+//
+// Records are read in global_seq order from segments (§11 valid prefix) or
+// archives (§14), fragmented events (§16) are reassembled, and every event is
+// routed by (event_type, producer_id) to a channel writer. Extension records
+// that carry no event (checkpoints §15, loss records §17, unknown tags) are
+// skipped: their event_type is not an event type.
+// The replay driver stands in for the recorded producers: their ChannelWrapper
+// writers are bound into ReplayPort payloads at bootstrap instead of into the
+// live tasks, the consumers are bound as usual.
+//
+// Time is virtual. Tick n of the replay covers timestamps
+// [ts0 + n * tick_units, ts0 + (n + 1) * tick_units); all records of tick n
+// are injected, then the step target runs with now = n. Every tick is
+// stepped, idle ones included, so a run depends only on the recorded data:
+// the speed setting changes wall-clock pacing, never what the tasks see.
+
+// Type-erased channel writer (one per route), cf. ChannelRef.
+struct ReplaySink {
+    void* obj = nullptr;
+    bool (*inject_fn)(void*, const AssembledEvent&) noexcept = nullptr;
+};
+
+// Type-erased step target: a Scheduler, TaskWrapper, or a test driver.
+struct ReplayTick {
+    void* obj = nullptr;
+    void (*step_fn)(void*, stam::model::tick_t) noexcept = nullptr;
+};
+
+template <class T>
+concept TickSteppable =
+    requires(T& t, stam::model::tick_t now) { { t.step(now) } noexcept; } ||
+    requires(T& t) { { t.step() } noexcept; };
+
+template <TickSteppable T>
+ReplayTick make_replay_tick(T& target) noexcept
+{
+    return {
+        &target,
+        [](void* p, stam::model::tick_t now) noexcept {
+            if constexpr (requires(T& t) { t.step(now); })
+                static_cast<T*>(p)->step(now);
+            else
+                static_cast<T*>(p)->step();
+        }
+    };
+}
+
+// Replay-side payload owning one channel writer port.
+//
+// Bind it with ChannelWrapper::bind_writer(port, name) in place of the
+// recorded producer; each routed event is decoded as `T` (the first sizeof(T)
+// bytes of a record's payload or of a reassembled event) and written; a
+// shorter event is rejected. SPSC-style writers report a full channel as a
+// rejected event; mailbox / snapshot writers always accept.
+template <class Writer, class T>
+class ReplayPort final {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "replayed value must be trivially copyable");
+    static_assert(sizeof(T) <= kMaxFragmentedEvent, "replayed value must fit one event");
+
+    using rt_class = stam::model::rt_unsafe_tag;
+
+    explicit ReplayPort(stam::model::PortName name) noexcept : name_(name) {}
+
+    ReplayPort(const ReplayPort&) = delete;
+    ReplayPort& operator=(const ReplayPort&) = delete;
+
+    [[nodiscard]] stam::model::BindResult bind_port(stam::model::PortName name, Writer&& writer) noexcept
+    {
+        if (!(name == name_))
+            return stam::model::BindResult::unknown_port;
+        if (writer_.has_value())
+            return stam::model::BindResult::already_bound;
+        writer_.emplace(std::move(writer));
+        return stam::model::BindResult::ok;
+    }
+
+    [[nodiscard]] bool is_fully_bound() const noexcept { return writer_.has_value(); }
+
+    bool inject(const AssembledEvent& ev) noexcept
+    {
+        if (!writer_.has_value() || ev.length < sizeof(T))
+            return false;
+        T value;
+        std::memcpy(&value, ev.data, sizeof(T));
+        if constexpr (requires(Writer& w) { { w.push(value) } -> std::same_as<bool>; })
+            return writer_->push(value);
+        else if constexpr (requires(Writer& w) { w.write(value); })
+            writer_->write(value);
+        else
+            writer_->publish(value);
+        return true;
+    }
+
+    [[nodiscard]] ReplaySink sink() noexcept
+    {
+        return {
+            this,
+            [](void* p, const AssembledEvent& ev) noexcept -> bool {
+                return static_cast<ReplayPort*>(p)->inject(ev);
+            }
+        };
+    }
+
+private:
+    stam::model::PortName name_;
+    std::optional<Writer> writer_{};
+};
+
+enum class ReplayClock : uint8_t {
+    Commit,   // commit_ts: coordinator order, monotonic by construction (§6.3)
+    Event,    // event_ts: producer time, clamped so the clock never runs back
+};
+
+struct ReplayOptions {
+    ReplayClock clock = ReplayClock::Commit;
+    uint64_t tick_units = 10;   // timestamp units (100 µs) per scheduler tick
+    double speed = 0.0;         // 1 = real time, N = N times faster, 0 = max (no pacing)
+    uint64_t seq_from = 0;      // replay global_seq in [seq_from, seq_to)
+    uint64_t seq_to = ~uint64_t{0};
+};
+
+struct ReplayStats {
+    uint64_t records = 0;       // valid records in the window, in order
+    uint64_t injected = 0;      // events accepted by a sink
+    uint64_t unrouted = 0;      // no route for (event_type, producer_id)
+    uint64_t rejected = 0;      // sink refused (channel full, event too short)
+    uint64_t skipped = 0;       // extension records that are no event (checkpoint, loss, unknown tag)
+    uint64_t dropped = 0;       // fragment records the assembler discarded (§16)
+    uint64_t ticks = 0;         // scheduler steps
+    uint64_t first_seq = 0;
+    uint64_t last_seq = 0;
+    uint64_t sources = 0;       // segments / archives opened
+    bool     out_of_order = false; // global_seq did not increase; replay stopped
+};
+
+class Replayer {
+public:
+    Replayer();
+
+    Replayer(const Replayer&) = delete;
+    Replayer& operator=(const Replayer&) = delete;
+
+    // Route records of `event_type` to `sink`: from `producer_id` only, or
+    // from every producer without a more specific route. false → sink invalid.
+    bool route(uint8_t event_type, uint8_t producer_id, ReplaySink sink);
+    bool route(uint8_t event_type, ReplaySink sink);
+
+    // Replay `sources` (`.seg` or `.arc` paths, in (boot_id, part_id) order)
+    // stepping `tick` on the virtual clock. false → unreadable source or a
+    // global_seq that does not increase (stats tell which); everything before
+    // that point has been replayed.
+    bool run(const std::vector<std::string>& sources, ReplayTick tick,
+             const ReplayOptions& options, ReplayStats* stats = nullptr);
+
+private:
+    static constexpr uint16_t kNoRoute = 0xFFFF;
+
+    std::vector<ReplaySink> sinks_;
+    std::vector<uint16_t> exact_;      // [event_type << 8 | producer_id]
+    uint16_t any_[256];                // [event_type]
+    FragmentAssembler assembler_;
+};
+
+} // namespace wal::internal
@@ -0,0 +1,265 @@
+#include "retention.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "archive/archive.hpp"
+#include "index/segment_index.hpp"
+#include "log_record.hpp"
+#include "recovery/recovery.hpp"
+
+namespace wal::internal {
+
+namespace {
+
+constexpr char kFreeSuffix[] = ".free";
+constexpr size_t kFreeSuffixLen = sizeof(kFreeSuffix) - 1;
+
+bool fsync_dir(const char* dir) noexcept
+{
+    const int fd = ::open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+bool has_suffix(const char* name, const char* suffix, size_t len) noexcept
+{
+    const size_t n = std::strlen(name);
+    return n > len && std::memcmp(name + n - len, suffix, len) == 0;
+}
+
+// Names of the pooled files of `dir`.
+std::vector<std::string> list_free(const char* dir)
+{
+    std::vector<std::string> out;
+    DIR* d = ::opendir(dir);
+    if (d == nullptr)
+        return out;
+    while (const dirent* e = ::readdir(d)) {
+        if (has_suffix(e->d_name, kFreeSuffix, kFreeSuffixLen))
+            out.emplace_back(e->d_name);
+    }
+    ::closedir(d);
+    return out;
+}
+
+bool read_record(int fd, uint64_t index, LogRecordV2& out) noexcept
+{
+    ssize_t n;
+    do {
+        n = ::pread(fd, &out, sizeof(out), static_cast<off_t>(index * sizeof(LogRecordV2)));
+    } while (n < 0 && errno == EINTR);
+    return n == static_cast<ssize_t>(sizeof(out)) && record_valid(out);
+}
+
+const char* file_name(const std::string& path) noexcept
+{
+    const size_t slash = path.rfind('/');
+    return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+} // namespace
+
+RetentionManager::RetentionManager(const char* dir, const RetentionPolicy& policy, const RetentionBudget& budget)
+    : dir_(dir), policy_(policy), budget_(budget)
+{
+    // Continue the pool numbering after a restart; a file caught between
+    // retirement and the pool is dropped.
+    for (const std::string& name : list_free(dir)) {
+        unsigned n = 0;
+        if (std::sscanf(name.c_str(), "recycle_%u", &n) == 1 && n >= next_free_)
+            next_free_ = n + 1;
+    }
+    if (DIR* d = ::opendir(dir)) {
+        while (const dirent* e = ::readdir(d)) {
+            if (std::strncmp(e->d_name, "recycle_", 8) == 0 && has_suffix(e->d_name, ".tmp", 4))
+                (void)::unlinkat(::dirfd(d), e->d_name, 0);
+        }
+        ::closedir(d);
+    }
+}
+
+void RetentionManager::note_checkpoint(uint64_t first_seq) noexcept
+{
+    checkpoint_seq_.store(first_seq, std::memory_order_relaxed);
+    have_checkpoint_.store(true, std::memory_order_release);
+}
+
+uint32_t RetentionManager::pool_size() const
+{
+    return static_cast<uint32_t>(list_free(dir_.c_str()).size());
+}
+
+bool RetentionManager::probe(const std::string& path, SegmentInfo& out)
+{
+    out = SegmentInfo{};
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st{};
+    bool ok = ::fstat(fd, &st) == 0;
+    out.bytes = static_cast<uint64_t>(st.st_size);
+
+    // A sealed segment normally ends on a valid record: the last record is
+    // enough. A torn or padded tail needs the §11 scan.
+    const uint64_t n = out.bytes / sizeof(LogRecordV2);
+    LogRecordV2 last{};
+    if (ok && n != 0 && out.bytes % sizeof(LogRecordV2) == 0 && read_record(fd, n - 1, last)) {
+        out.found = true;
+        out.last_seq = last.global_seq;
+        out.last_ts = last.commit_ts;
+    } else if (ok && n != 0) {
+        SegmentScan scan{};
+        ok = scan_segment(path.c_str(), scan);
+        out.found = scan.records != 0;
+        out.last_seq = scan.last_seq;
+        out.last_ts = scan.last_ts;
+    }
+    ::close(fd);
+    return ok;
+}
+
+bool RetentionManager::retire(const std::string& path, const SegmentInfo& info)
+{
+    if (!policy_.archive_dir.empty() && info.found) {
+        const std::string arc = policy_.archive_dir + "/" + file_name(archive_path(path));
+        if (!archive_segment(path.c_str(), arc.c_str()))
+            return false;
+        ++stats_.archived;
+    }
+
+    // Out of the WAL in one step. The inode is never reused: a Tailer or a
+    // query scan may still map it, and truncating it would fault them.
+    if (::unlink(path.c_str()) != 0)
+        return false;
+    (void)::unlink(segment_index_path(path).c_str());
+
+    // The pool gets a fresh file with the retired segment's blocks reserved
+    // (fallocate, best effort), published by rename; a crash before it
+    // leaves at most a stray recycle_<n>.tmp (dropped at the next start).
+    bool recycled = false;
+    if (policy_.recycle_max != 0 && pool_size() < policy_.recycle_max) {
+        const std::string base = dir_ + "/recycle_" + std::to_string(next_free_);
+        const std::string tmp = base + ".tmp";
+        const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd >= 0) {
+#if defined(__linux__)
+            if (info.bytes != 0)
+                (void)::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(info.bytes));
+#endif
+            ::close(fd);
+            recycled = std::rename(tmp.c_str(), (base + kFreeSuffix).c_str()) == 0;
+            if (!recycled)
+                (void)::unlink(tmp.c_str());
+        }
+    }
+    if (recycled) {
+        ++next_free_;
+        ++stats_.recycled;
+    } else {
+        ++stats_.deleted;
+    }
+    (void)fsync_dir(dir_.c_str());
+
+    ++stats_.retired;
+    stats_.bytes_freed += info.bytes;
+    return true;
+}
+
+RetentionTick RetentionManager::tick(uint64_t now)
+{
+    RetentionTick res;
+    std::vector<std::string> paths;
+    if (!list_segments(dir_.c_str(), paths)) {
+        res.ok = false;
+        ++stats_.errors;
+        return res;
+    }
+
+    // Forget segments that are gone; account the rest.
+    std::map<std::string, SegmentInfo> probed;
+    wal_bytes_ = 0;
+    for (const std::string& p : paths) {
+        const auto it = probed_.find(p);
+        struct stat st{};
+        if (it != probed_.end()) {
+            wal_bytes_ += it->second.bytes;
+            probed.emplace(p, it->second);
+        } else if (::stat(p.c_str(), &st) == 0) {
+            wal_bytes_ += static_cast<uint64_t>(st.st_size);
+        }
+    }
+    probed_.swap(probed);
+
+    const bool have_cp = have_checkpoint_.load(std::memory_order_acquire);
+    const uint64_t cp_seq = checkpoint_seq_.load(std::memory_order_relaxed);
+    uint32_t probes = 0;
+    for (size_t i = 0; i + 1 < paths.size(); ++i) {   // never the newest
+        const std::string& path = paths[i];
+        auto it = probed_.find(path);
+        if (it == probed_.end()) {
+            if (probes == budget_.probes) {
+                res.deferred = true;
+                break;
+            }
+            ++probes;
+            SegmentInfo info;
+            if (!probe(path, info)) {
+                res.ok = false;
+                ++stats_.errors;
+                break;
+            }
+            it = probed_.emplace(path, info).first;
+        }
+        const SegmentInfo& info = it->second;
+
+        const bool over = policy_.max_bytes != 0 && wal_bytes_ > policy_.max_bytes;
+        const bool expired = policy_.max_age_ticks != 0
+            && (!info.found || ts_before(info.last_ts, now - policy_.max_age_ticks));
+        if (!over && !expired)
+            break;
+        if (policy_.keep_since_checkpoint && info.found && (!have_cp || info.last_seq >= cp_seq)) {
+            res.pinned = true;
+            break;
+        }
+        if (res.retired == budget_.segments
+            || (res.retired != 0 && budget_.bytes != 0 && res.bytes_freed + info.bytes > budget_.bytes)) {
+            res.deferred = true;
+            break;
+        }
+
+        const uint64_t bytes = info.bytes;
+        if (!retire(path, info)) {
+            res.ok = false;
+            ++stats_.errors;
+            break;
+        }
+        probed_.erase(it);
+        ++res.retired;
+        res.bytes_freed += bytes;
+        wal_bytes_ -= bytes;
+    }
+    return res;
+}
+
+bool take_recycled_segment(const char* dir, const char* segment_path)
+{
+    for (const std::string& name : list_free(dir)) {
+        const std::string from = std::string{dir} + "/" + name;
+        // Racing takers: rename is atomic, the loser moves on to the next.
+        if (std::rename(from.c_str(), segment_path) == 0)
+            return fsync_dir(dir);
+    }
+    return false;
+}
+
+} // namespace wal::internal
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "model/tags.hpp"
+
+namespace wal::internal {
+
+// Retention of a WAL directory (non-RT).
+//
+// Segments are retired oldest first, whole, and only as a prefix of the WAL:
+// a segment goes once a rule asks for it and nothing protects it.
+//
+//   max_bytes              total segment bytes above the limit: retire the oldest
+//   max_age_ticks          last commit_ts older than now - max_age (§6.3): retire
+//   keep_since_checkpoint  never retire the segment holding the newest complete
+//                          checkpoint (note_checkpoint()) or anything after it;
+//                          with no checkpoint noted, nothing is retired
+//
+// The newest segment is the one being appended to and is never touched.
+//
+// Retiring: optionally archive_segment() into `archive_dir`, then unlink the
+// segment, drop its sidecar index and fsync the directory. The retired inode
+// is never truncated or reused in place: readers that still map it (Tailer,
+// query scans) keep a valid mapping until they let go. Instead, while fewer
+// than `recycle_max` files are pooled, a fresh `<dir>/recycle_<n>.free` is
+// created with the retired segment's size preallocated (fallocate, best
+// effort) for the logger's next segment (take_recycled_segment()).
+//
+// tick() does a bounded amount of work: one directory listing, at most
+// `probes` segment probes (one record read each, a full scan only for a
+// torn tail) and at most `segments` retirements / `bytes` retired bytes, so
+// deletion I/O is spread over ticks instead of bursting. The first
+// retirement of a tick is always allowed, whatever its size.
+struct RetentionPolicy {
+    uint64_t max_bytes = 0;             // 0 = no size limit
+    uint64_t max_age_ticks = 0;         // 0 = no age limit
+    bool     keep_since_checkpoint = false;
+    std::string archive_dir;            // "" = delete without archiving
+    uint32_t recycle_max = 4;           // retired files kept for reuse
+};
+
+struct RetentionBudget {
+    uint32_t segments = 1;              // retirements per tick
+    uint64_t bytes = 0;                 // retired bytes per tick; 0 = unlimited
+    uint32_t probes = 16;               // new segments probed per tick
+};
+
+struct RetentionTick {
+    uint32_t retired = 0;
+    uint64_t bytes_freed = 0;
+    bool     pinned = false;            // a rule wanted more, the checkpoint rule refused
+    bool     deferred = false;          // more is due, the budget ran out
+    bool     ok = true;                 // false → an I/O step failed (segment kept)
+};
+
+struct RetentionStats {
+    uint64_t retired = 0;
+    uint64_t archived = 0;
+    uint64_t recycled = 0;
+    uint64_t deleted = 0;
+    uint64_t bytes_freed = 0;
+    uint64_t errors = 0;
+};
+
+class RetentionManager {
+public:
+    RetentionManager(const char* dir, const RetentionPolicy& policy, const RetentionBudget& budget = {});
+
+    RetentionManager(const RetentionManager&) = delete;
+    RetentionManager& operator=(const RetentionManager&) = delete;
+
+    // The newest complete checkpoint starts at global_seq `first_seq`
+    // (from the logger, any thread; or recover_checkpoint() at startup).
+    void note_checkpoint(uint64_t first_seq) noexcept;
+
+    // One bounded pass; `now` on the commit_ts clock.
+    RetentionTick tick(uint64_t now);
+
+    [[nodiscard]] const RetentionStats& stats() const noexcept { return stats_; }
+
+    // Total bytes of the segments seen by the last tick.
+    [[nodiscard]] uint64_t wal_bytes() const noexcept { return wal_bytes_; }
+
+private:
+    struct SegmentInfo {
+        uint64_t bytes = 0;
+        bool     found = false;         // holds a valid record
+        uint64_t last_seq = 0;
+        uint64_t last_ts = 0;
+    };
+
+    bool probe(const std::string& path, SegmentInfo& out);
+    bool retire(const std::string& path, const SegmentInfo& info);
+    uint32_t pool_size() const;
+
+    std::string dir_;
+    RetentionPolicy policy_;
+    RetentionBudget budget_;
+    std::atomic<uint64_t> checkpoint_seq_{0};
+    std::atomic<bool> have_checkpoint_{false};
+    std::map<std::string, SegmentInfo> probed_;   // by path; sealed segments do not change
+    uint64_t wal_bytes_ = 0;
+    uint32_t next_free_ = 0;
+    RetentionStats stats_{};
+};
+
+// Rename one recycled file of `dir` to `segment_path` (same filesystem) and
+// fsync the directory; the caller then open_segment()s it. false → pool
+// empty (create the segment as usual).
+bool take_recycled_segment(const char* dir, const char* segment_path);
+
+// Commit clock of the retention task (type-erased, like CheckpointSource).
+struct RetentionClock {
+    void* obj = nullptr;
+    uint64_t (*now_fn)(void*) noexcept = nullptr;
+};
+
+// Non-RT task payload: one RetentionManager::tick() per step.
+class RetentionTask final {
+public:
+    using rt_class = stam::model::rt_unsafe_tag;
+
+    RetentionTask(RetentionManager& manager, RetentionClock clock) noexcept
+        : manager_(manager), clock_(clock)
+    {
+    }
+
+    void step(stam::model::tick_t) noexcept { last_ = manager_.tick(clock_.now_fn(clock_.obj)); }
+
+    [[nodiscard]] const RetentionTick& last() const noexcept { return last_; }
+
+private:
+    RetentionManager& manager_;
+    RetentionClock clock_;
+    RetentionTick last_{};
+};
+
+} // namespace wal::internal
@@ -0,0 +1,301 @@
+#include "event_schema.hpp"
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace wal::internal {
+
+namespace {
+
+constexpr const char* kKindNames[] = {
+    "u8", "u16", "u32", "u64",
+    "i8", "i16", "i32", "i64",
+    "f32", "f64",
+    "bool",
+    "bytes",
+    "char",
+};
+
+constexpr char kSchemaHeader[] = "# wal event schema v1";
+
+// Little-endian element at `p` (§2).
+uint64_t load_le(const uint8_t* p, size_t n) noexcept
+{
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; ++i)
+        v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+void append_element(std::string& out, FieldKind k, const uint8_t* p)
+{
+    char buf[40];
+    const uint64_t u = load_le(p, field_kind_size(k));
+    switch (k) {
+    case FieldKind::U8: case FieldKind::U16: case FieldKind::U32: case FieldKind::U64:
+        std::snprintf(buf, sizeof(buf), "%" PRIu64, u);
+        break;
+    case FieldKind::I8:
+        std::snprintf(buf, sizeof(buf), "%d", static_cast<int>(static_cast<int8_t>(u)));
+        break;
+    case FieldKind::I16:
+        std::snprintf(buf, sizeof(buf), "%d", static_cast<int>(static_cast<int16_t>(u)));
+        break;
+    case FieldKind::I32:
+        std::snprintf(buf, sizeof(buf), "%" PRId32, static_cast<int32_t>(u));
+        break;
+    case FieldKind::I64:
+        std::snprintf(buf, sizeof(buf), "%" PRId64, static_cast<int64_t>(u));
+        break;
+    case FieldKind::F32: {
+        float f;
+        const auto bits = static_cast<uint32_t>(u);
+        std::memcpy(&f, &bits, sizeof(f));
+        std::snprintf(buf, sizeof(buf), "%g", static_cast<double>(f));
+        break;
+    }
+    case FieldKind::F64: {
+        double d;
+        std::memcpy(&d, &u, sizeof(d));
+        std::snprintf(buf, sizeof(buf), "%g", d);
+        break;
+    }
+    case FieldKind::Bool:
+        std::snprintf(buf, sizeof(buf), "%s", u != 0 ? "true" : "false");
+        break;
+    default:
+        std::snprintf(buf, sizeof(buf), "%02x", static_cast<unsigned>(u));
+        break;
+    }
+    out += buf;
+}
+
+void append_field(std::string& out, const FieldDesc& f, const uint8_t* p)
+{
+    if (f.kind == FieldKind::Char) {
+        out += '"';
+        for (size_t i = 0; i < f.size && p[i] != 0; ++i) {
+            const auto c = static_cast<char>(p[i]);
+            if (p[i] >= 0x20 && p[i] < 0x7f && c != '"' && c != '\\') {
+                out += c;
+            } else {
+                char esc[8];
+                std::snprintf(esc, sizeof(esc), "\\x%02x", p[i]);
+                out += esc;
+            }
+        }
+        out += '"';
+        return;
+    }
+    if (f.kind == FieldKind::Bytes) {
+        for (size_t i = 0; i < f.size; ++i)
+            append_element(out, f.kind, p + i);
+        return;
+    }
+    const size_t elem = field_kind_size(f.kind);
+    if (f.size == elem) {
+        append_element(out, f.kind, p);
+        return;
+    }
+    out += '[';
+    for (size_t at = 0; at < f.size; at += elem) {
+        if (at != 0)
+            out += ',';
+        append_element(out, f.kind, p + at);
+    }
+    out += ']';
+}
+
+void split_words(const std::string& line, std::vector<std::string>& out)
+{
+    out.clear();
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r'))
+            ++i;
+        const size_t from = i;
+        while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+            ++i;
+        if (i > from)
+            out.push_back(line.substr(from, i - from));
+    }
+}
+
+bool parse_uint(const std::string& s, uint64_t max, uint64_t& out) noexcept
+{
+    if (s.empty())
+        return false;
+    char* end = nullptr;
+    errno = 0;
+    out = std::strtoull(s.c_str(), &end, 0);
+    return errno == 0 && *end == '\0' && s[0] != '-' && out <= max;
+}
+
+} // namespace
+
+const char* field_kind_name(FieldKind k) noexcept
+{
+    const auto i = static_cast<size_t>(k);
+    return i < std::size(kKindNames) ? kKindNames[i] : "?";
+}
+
+bool parse_field_kind(const char* name, FieldKind& out) noexcept
+{
+    for (size_t i = 0; i < std::size(kKindNames); ++i) {
+        if (std::strcmp(name, kKindNames[i]) == 0) {
+            out = static_cast<FieldKind>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string format_event(const EventDesc& desc, const uint8_t* data, size_t bytes)
+{
+    std::string out = desc.name;
+    out += '{';
+    for (size_t i = 0; i < desc.field_count; ++i) {
+        const FieldDesc& f = desc.fields[i];
+        if (i != 0)
+            out += ' ';
+        if (static_cast<size_t>(f.offset) + f.size > bytes) {
+            out += "...";
+            break;
+        }
+        out += f.name;
+        out += '=';
+        append_field(out, f, data + f.offset);
+    }
+    out += '}';
+    return out;
+}
+
+std::string schema_text(std::span<const EventDesc> table)
+{
+    std::string out = kSchemaHeader;
+    out += '\n';
+    char line[160];
+    for (const EventDesc& d : table) {
+        std::snprintf(line, sizeof(line), "event %u %s %u %u\n", static_cast<unsigned>(d.type), d.name,
+                      static_cast<unsigned>(d.wire_bytes), static_cast<unsigned>(d.records));
+        out += line;
+        for (size_t i = 0; i < d.field_count; ++i) {
+            const FieldDesc& f = d.fields[i];
+            std::snprintf(line, sizeof(line), "field %s %s %u %u\n", f.name, field_kind_name(f.kind),
+                          static_cast<unsigned>(f.offset), static_cast<unsigned>(f.size));
+            out += line;
+        }
+    }
+    return out;
+}
+
+void SchemaSet::relink() noexcept
+{
+    for (size_t i = 0; i < events_.size(); ++i)
+        events_[i].fields = fields_.data() + first_field_[i];
+}
+
+bool SchemaSet::parse(const std::string& text)
+{
+    names_.clear();
+    fields_.clear();
+    first_field_.clear();
+    events_.clear();
+
+    // Close the current event: fields contiguous from 0, sizes consistent.
+    const auto finish = [&]() -> bool {
+        if (events_.empty())
+            return true;
+        const EventDesc& d = events_.back();
+        const size_t first = first_field_.back();
+        size_t at = 0;
+        for (size_t i = first; i < fields_.size(); ++i) {
+            if (fields_[i].offset != at)
+                return false;
+            at += fields_[i].size;
+        }
+        const size_t count = fields_.size() - first;
+        const size_t records = at <= kFragmentBytes ? 1 : fragment_count(at);
+        return count != 0 && count <= 255 && at == d.wire_bytes && d.records == records;
+    };
+
+    std::vector<std::string> w;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos)
+            eol = text.size();
+        split_words(text.substr(pos, eol - pos), w);
+        pos = eol + 1;
+        if (w.empty() || w[0][0] == '#')
+            continue;
+
+        uint64_t a = 0, b = 0, c = 0;
+        if (w[0] == "event" && w.size() == 5) {
+            if (!finish() || !parse_uint(w[1], 255, a) || !parse_uint(w[3], kMaxFragmentedEvent, b)
+                || !parse_uint(w[4], kMaxFragments, c) || find(static_cast<uint8_t>(a)) != nullptr)
+                return false;
+            names_.push_back(w[2]);
+            EventDesc d;
+            d.type = static_cast<uint8_t>(a);
+            d.name = names_.back().c_str();
+            d.wire_bytes = static_cast<uint16_t>(b);
+            d.records = static_cast<uint8_t>(c);
+            events_.push_back(d);
+            first_field_.push_back(fields_.size());
+        } else if (w[0] == "field" && w.size() == 5 && !events_.empty() && events_.back().field_count != 255) {
+            FieldDesc f;
+            if (!parse_field_kind(w[2].c_str(), f.kind) || !parse_uint(w[3], kMaxFragmentedEvent, a)
+                || !parse_uint(w[4], kMaxFragmentedEvent, b) || b == 0 || b % field_kind_size(f.kind) != 0)
+                return false;
+            names_.push_back(w[1]);
+            f.name = names_.back().c_str();
+            f.offset = static_cast<uint16_t>(a);
+            f.size = static_cast<uint16_t>(b);
+            fields_.push_back(f);
+            ++events_.back().field_count;
+        } else {
+            return false;
+        }
+    }
+    if (!finish())
+        return false;
+    relink();
+    return true;
+}
+
+bool SchemaSet::load(const char* path)
+{
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    std::string text;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) != 0) {
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            ::close(fd);
+            return false;
+        }
+        text.append(buf, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return parse(text);
+}
+
+const EventDesc* SchemaSet::find(uint8_t type) const noexcept
+{
+    for (const EventDesc& d : events_) {
+        if (d.type == type)
+            return &d;
+    }
+    return nullptr;
+}
+
+} // namespace wal::internal
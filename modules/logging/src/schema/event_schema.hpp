@@ -0,0 +1,397 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fragment/fragment.hpp"
+#include "log_record.hpp"
+
+namespace wal::internal {
+
+// Typed event payloads (wal_format.md §9, §19).
+//
+// Each event type is a trivially copyable struct with a schema declared next
+// to it:
+//
+//   struct MotorCurrent { uint16_t axis; int32_t milliamps; float temp_c; };
+//
+//   template <>
+//   struct wal::internal::EventSchema<MotorCurrent> {
+//       static constexpr uint8_t type = 0x10;
+//       static constexpr const char* name = "motor_current";
+//       static constexpr FieldDesc fields[] = {
+//           WAL_EVENT_FIELD(MotorCurrent, axis),
+//           WAL_EVENT_FIELD(MotorCurrent, milliamps),
+//           WAL_EVENT_FIELD(MotorCurrent, temp_c),
+//       };
+//   };
+//
+// On the wire the fields are packed in declaration order, little-endian,
+// without the struct's padding (10 bytes above). Up to 14 bytes an event is
+// one record; up to kMaxFragmentedEvent it is split into §16 fragments. The
+// fit is checked at compile time, so is the field list (scalar, enum or
+// array of them; inside the struct; no overlap).
+//
+// encode_event() / decode_event() are generated per type from the constexpr
+// field list: a fixed sequence of copies, no lookup and no allocation
+// (RT-safe). EventRegistry<Events...> collects the schemas of a program into
+// a reflection table (EventDesc) for readers and tools; schema_text() writes
+// it as a schema file for the offline query tool.
+
+enum class FieldKind : uint8_t {
+    U8, U16, U32, U64,
+    I8, I16, I32, I64,
+    F32, F64,
+    Bool,
+    Bytes,      // uint8_t / std::byte array, shown as hex
+    Char,       // char array, shown as a NUL-padded string
+};
+
+// Bytes of one element of `k`.
+inline constexpr size_t field_kind_size(FieldKind k) noexcept
+{
+    switch (k) {
+    case FieldKind::U16: case FieldKind::I16: return 2;
+    case FieldKind::U32: case FieldKind::I32: case FieldKind::F32: return 4;
+    case FieldKind::U64: case FieldKind::I64: case FieldKind::F64: return 8;
+    default: return 1;
+    }
+}
+
+const char* field_kind_name(FieldKind k) noexcept;
+
+// false → unknown name.
+bool parse_field_kind(const char* name, FieldKind& out) noexcept;
+
+template <class>
+inline constexpr bool kUnsupportedField = false;
+
+template <class T>
+consteval FieldKind field_kind() noexcept
+{
+    if constexpr (std::is_array_v<T>) {
+        using E = std::remove_cv_t<std::remove_all_extents_t<T>>;
+        if constexpr (std::is_same_v<E, char>)
+            return FieldKind::Char;
+        else if constexpr (std::is_same_v<E, uint8_t> || std::is_same_v<E, std::byte>)
+            return FieldKind::Bytes;
+        else
+            return field_kind<E>();
+    } else if constexpr (std::is_enum_v<T>) {
+        return field_kind<std::underlying_type_t<T>>();
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return FieldKind::Bool;
+    } else if constexpr (std::is_floating_point_v<T> && sizeof(T) == 4) {
+        return FieldKind::F32;
+    } else if constexpr (std::is_floating_point_v<T> && sizeof(T) == 8) {
+        return FieldKind::F64;
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        return sizeof(T) == 1 ? FieldKind::I8 : sizeof(T) == 2 ? FieldKind::I16
+             : sizeof(T) == 4 ? FieldKind::I32 : FieldKind::I64;
+    } else if constexpr (std::is_integral_v<T>) {
+        return sizeof(T) == 1 ? FieldKind::U8 : sizeof(T) == 2 ? FieldKind::U16
+             : sizeof(T) == 4 ? FieldKind::U32 : FieldKind::U64;
+    } else {
+        static_assert(kUnsupportedField<T>, "event fields are integers, enums, floats, bool or arrays of them");
+        return FieldKind::U8;
+    }
+}
+
+// One field: `offset` is in the struct for a schema declaration and on the
+// wire in a reflection table (EventDesc::fields).
+struct FieldDesc {
+    const char* name = nullptr;
+    FieldKind   kind = FieldKind::U8;
+    uint16_t    offset = 0;
+    uint16_t    size = 0;         // total bytes (element size × count)
+};
+
+#define WAL_EVENT_FIELD(Struct, member)                                                         \
+    ::wal::internal::FieldDesc{#member,                                                         \
+                               ::wal::internal::field_kind<decltype(Struct::member)>(),         \
+                               static_cast<uint16_t>(offsetof(Struct, member)),                 \
+                               static_cast<uint16_t>(sizeof(Struct::member))}
+
+// Specialized per event struct (see above).
+template <class T>
+struct EventSchema;
+
+// Reflection entry of one event type.
+struct EventDesc {
+    uint8_t          type = 0;
+    const char*      name = nullptr;
+    uint16_t         wire_bytes = 0;
+    uint8_t          records = 0;           // 1, or the §16 fragment count
+    const FieldDesc* fields = nullptr;      // wire offsets
+    uint8_t          field_count = 0;
+};
+
+namespace schema_detail {
+
+template <class T>
+consteval size_t wire_bytes() noexcept
+{
+    size_t n = 0;
+    for (const FieldDesc& f : EventSchema<T>::fields)
+        n += f.size;
+    return n;
+}
+
+template <class T>
+consteval bool fields_valid() noexcept
+{
+    constexpr auto& fs = EventSchema<T>::fields;
+    for (size_t i = 0; i < std::size(fs); ++i) {
+        const FieldDesc& f = fs[i];
+        if (f.name == nullptr || f.size == 0 || f.offset + f.size > sizeof(T))
+            return false;
+        if (f.size % field_kind_size(f.kind) != 0)
+            return false;
+        for (size_t j = 0; j < i; ++j) {
+            if (f.offset < fs[j].offset + fs[j].size && fs[j].offset < f.offset + f.size)
+                return false;
+        }
+    }
+    return true;
+}
+
+template <class T>
+consteval auto wire_fields() noexcept
+{
+    constexpr auto& fs = EventSchema<T>::fields;
+    std::array<FieldDesc, std::size(fs)> out{};
+    uint16_t at = 0;
+    for (size_t i = 0; i < std::size(fs); ++i) {
+        out[i] = fs[i];
+        out[i].offset = at;
+        at = static_cast<uint16_t>(at + fs[i].size);
+    }
+    return out;
+}
+
+// Field bytes to little-endian wire order (and back: the same swap).
+template <FieldKind K, size_t Size>
+inline void copy_field(uint8_t* dst, const uint8_t* src) noexcept
+{
+    constexpr size_t elem = field_kind_size(K);
+    if constexpr (elem == 1 || std::endian::native == std::endian::little) {
+        std::memcpy(dst, src, Size);
+    } else {
+        for (size_t e = 0; e < Size; e += elem) {
+            for (size_t b = 0; b < elem; ++b)
+                dst[e + b] = src[e + elem - 1 - b];
+        }
+    }
+}
+
+} // namespace schema_detail
+
+template <class T>
+concept TypedEvent = requires {
+    { EventSchema<T>::type } -> std::convertible_to<uint8_t>;
+    { EventSchema<T>::name } -> std::convertible_to<const char*>;
+    std::size(EventSchema<T>::fields);
+};
+
+// Compile-time facts of one event type; instantiating it runs the checks.
+template <TypedEvent T>
+struct EventTraits {
+    static_assert(std::is_trivially_copyable_v<T>, "event payloads must be trivially copyable");
+    static_assert(std::size(EventSchema<T>::fields) != 0 && std::size(EventSchema<T>::fields) <= 255,
+                  "an event has 1..255 fields");
+    static_assert(schema_detail::fields_valid<T>(),
+                  "event fields must lie inside the struct, be whole elements and not overlap");
+
+    static constexpr uint8_t type = EventSchema<T>::type;
+    static constexpr size_t  wire_bytes = schema_detail::wire_bytes<T>();
+    static_assert(wire_bytes <= kMaxFragmentedEvent,
+                  "event does not fit one payload nor the fragment scheme (wal_format.md §16)");
+    static constexpr size_t  records = wire_bytes <= kFragmentBytes ? 1 : fragment_count(wire_bytes);
+
+    static constexpr auto wire_fields = schema_detail::wire_fields<T>();
+
+    static constexpr EventDesc desc{
+        type, EventSchema<T>::name, static_cast<uint16_t>(wire_bytes), static_cast<uint8_t>(records),
+        wire_fields.data(), static_cast<uint8_t>(wire_fields.size())};
+};
+
+// Records one encode_event<T>() produces.
+template <TypedEvent T>
+inline constexpr size_t kEventRecords = EventTraits<T>::records;
+
+// value → wire[0 .. wire_bytes).
+template <TypedEvent T>
+inline void pack_event(const T& value, uint8_t* wire) noexcept
+{
+    using Tr = EventTraits<T>;
+    const auto* src = reinterpret_cast<const uint8_t*>(&value);
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (schema_detail::copy_field<EventSchema<T>::fields[I].kind, EventSchema<T>::fields[I].size>(
+             wire + Tr::wire_fields[I].offset, src + EventSchema<T>::fields[I].offset), ...);
+    }(std::make_index_sequence<Tr::wire_fields.size()>{});
+}
+
+// wire[0 .. wire_bytes) → value. Bytes outside the declared fields keep
+// their value-initialized state.
+template <TypedEvent T>
+inline void unpack_event(const uint8_t* wire, T& value) noexcept
+{
+    using Tr = EventTraits<T>;
+    value = T{};
+    auto* dst = reinterpret_cast<uint8_t*>(&value);
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (schema_detail::copy_field<EventSchema<T>::fields[I].kind, EventSchema<T>::fields[I].size>(
+             dst + EventSchema<T>::fields[I].offset, wire + Tr::wire_fields[I].offset), ...);
+    }(std::make_index_sequence<Tr::wire_fields.size()>{});
+}
+
+// Fill out[0 .. kEventRecords<T>) with `value`. Header fields come from
+// `proto` as for encode_fragments(); event_type is set from the schema.
+// Records come out unsealed. Returns kEventRecords<T>.
+template <TypedEvent T>
+inline size_t encode_event(const LogRecordV2& proto, const T& value, LogRecordV2* out) noexcept
+{
+    using Tr = EventTraits<T>;
+    if constexpr (Tr::records == 1) {
+        LogRecordV2& r = out[0];
+        r = proto;
+        r.crc32 = 0;
+        r.event_type = Tr::type;
+        std::memset(r.payload, 0, sizeof(r.payload));
+        pack_event(value, r.payload);
+        return 1;
+    } else {
+        uint8_t wire[Tr::wire_bytes];
+        pack_event(value, wire);
+        LogRecordV2 head = proto;
+        head.event_type = Tr::type;
+        return encode_fragments(head, wire, Tr::wire_bytes, out, Tr::records);
+    }
+}
+
+// A plain record of a one-record type. false → other event_type, or a
+// fragment.
+template <TypedEvent T>
+inline bool decode_event(const LogRecordV2& rec, T& out) noexcept
+{
+    static_assert(EventTraits<T>::records == 1, "fragmented events decode from an AssembledEvent");
+    if (rec.event_type != EventTraits<T>::type || rec.reserved[0] == kExtFragment)
+        return false;
+    unpack_event(rec.payload, out);
+    return true;
+}
+
+// An event from a FragmentAssembler (plain record or reassembled). false →
+// other event_type or length.
+template <TypedEvent T>
+inline bool decode_event(const AssembledEvent& ev, T& out) noexcept
+{
+    using Tr = EventTraits<T>;
+    if (ev.event_type != Tr::type)
+        return false;
+    if (ev.length != Tr::wire_bytes && !(Tr::records == 1 && ev.length == kFragmentBytes))
+        return false;
+    unpack_event(ev.data, out);
+    return true;
+}
+
+// The event types of one program. Types must be unique.
+template <TypedEvent... Events>
+class EventRegistry {
+    static consteval bool unique_types() noexcept
+    {
+        constexpr uint8_t types[] = {EventTraits<Events>::type...};
+        for (size_t i = 0; i < sizeof...(Events); ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                if (types[i] == types[j])
+                    return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    static_assert(sizeof...(Events) != 0, "an event registry needs at least one event");
+    static_assert(unique_types(), "event_type values in a registry must be unique");
+
+    static constexpr std::array<EventDesc, sizeof...(Events)> table{EventTraits<Events>::desc...};
+
+    static constexpr const EventDesc* find(uint8_t type) noexcept
+    {
+        for (const EventDesc& d : table) {
+            if (d.type == type)
+                return &d;
+        }
+        return nullptr;
+    }
+
+    // Decode `ev` as its registered type and call fn(const T&). false →
+    // unregistered type or wrong length.
+    template <class Fn>
+    static bool dispatch(const AssembledEvent& ev, Fn&& fn)
+    {
+        return (dispatch_one<Events>(ev, fn) || ...);
+    }
+
+private:
+    template <class T, class Fn>
+    static bool dispatch_one(const AssembledEvent& ev, Fn& fn)
+    {
+        T value;
+        if (!decode_event(ev, value))
+            return false;
+        fn(static_cast<const T&>(value));
+        return true;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Reflection (non-RT): formatting and schema files
+// ---------------------------------------------------------------------------
+
+// "name{field=value ...}" for `bytes` of wire data. Missing trailing bytes
+// end the list with "...".
+std::string format_event(const EventDesc& desc, const uint8_t* data, size_t bytes);
+
+// Schema file text of `table`:
+//
+//   # wal event schema v1
+//   event <type> <name> <wire_bytes> <records>
+//   field <name> <kind> <wire_offset> <size>
+//   ...
+std::string schema_text(std::span<const EventDesc> table);
+
+// Reflection table read back from a schema file; owns its strings.
+class SchemaSet {
+public:
+    SchemaSet() = default;
+    SchemaSet(const SchemaSet&) = delete;
+    SchemaSet& operator=(const SchemaSet&) = delete;
+
+    // false → syntax error, inconsistent sizes or a duplicate type.
+    bool parse(const std::string& text);
+    bool load(const char* path);
+
+    [[nodiscard]] const EventDesc* find(uint8_t type) const noexcept;
+    [[nodiscard]] std::span<const EventDesc> table() const noexcept { return events_; }
+
+private:
+    void relink() noexcept;
+
+    std::deque<std::string> names_;
+    std::vector<FieldDesc> fields_;
+    std::vector<size_t> first_field_;
+    std::vector<EventDesc> events_;
+};
+
+} // namespace wal::internal
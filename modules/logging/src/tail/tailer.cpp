@@ -0,0 +1,276 @@
+#include "tailer.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "codec/record_codec.hpp"
+#include "recovery/recovery.hpp"
+
+namespace wal::internal {
+
+namespace {
+
+// Mappings grow in steps: a growing segment is remapped once per step, not
+// per batch. Pages past EOF are never touched (size_records_ bounds reads).
+constexpr size_t kMapStep = size_t{16} << 20;
+
+// Next segment after `current` in (boot_id, part_id) order, or "".
+std::string next_segment(const std::string& dir, const std::string& current)
+{
+    std::vector<std::string> paths;
+    if (!list_segments(dir.c_str(), paths))
+        return {};
+    for (const std::string& p : paths) {
+        if (current.empty() || p > current)
+            return p;
+    }
+    return {};
+}
+
+// global_seq of the first record, if it is valid.
+bool first_seq_of(const std::string& path, uint64_t& seq) noexcept
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    LogRecordV2 rec{};
+    const bool ok = ::pread(fd, &rec, sizeof(rec), 0) == static_cast<ssize_t>(sizeof(rec)) && record_valid(rec);
+    ::close(fd);
+    seq = rec.global_seq;
+    return ok;
+}
+
+} // namespace
+
+Tailer::~Tailer()
+{
+    close();
+}
+
+bool Tailer::open(const char* dir, const TailerOptions& options) noexcept
+{
+    close();
+    dir_ = dir;
+    options_ = options;
+    if (options_.max_batch == 0)
+        options_.max_batch = 1;
+
+    stop_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (stop_fd_ < 0 || inotify_fd_ < 0
+        || ::inotify_add_watch(inotify_fd_, dir, IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE) < 0) {
+        close();
+        return false;
+    }
+
+    std::vector<std::string> paths;
+    if (!list_segments(dir, paths)) {
+        close();
+        return false;
+    }
+    dir_changed_ = false;
+    if (paths.empty())
+        return true;
+
+    if (options_.from_end) {
+        if (!open_segment(paths.back())) {
+            close();
+            return false;
+        }
+        cursor_ = valid_run(size_records_);
+        return true;
+    }
+
+    // Start in the last segment beginning at or before from_seq.
+    size_t first = 0;
+    if (options_.from_seq != 0) {
+        for (size_t i = paths.size(); i-- > 0;) {
+            uint64_t seq = 0;
+            if (first_seq_of(paths[i], seq) && seq <= options_.from_seq) {
+                first = i;
+                break;
+            }
+        }
+    }
+    if (!open_segment(paths[first])) {
+        close();
+        return false;
+    }
+    dir_changed_ = first + 1 < paths.size(); // later segments to roll into
+    return true;
+}
+
+void Tailer::close() noexcept
+{
+    close_segment();
+    if (inotify_fd_ >= 0)
+        ::close(inotify_fd_);
+    if (stop_fd_ >= 0)
+        ::close(stop_fd_);
+    inotify_fd_ = -1;
+    stop_fd_ = -1;
+    dir_changed_ = true;
+    delivered_ = 0;
+    last_seq_ = 0;
+}
+
+bool Tailer::open_segment(const std::string& path) noexcept
+{
+    close_segment();
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0)
+        return false;
+    path_ = path;
+    return map_to_size();
+}
+
+void Tailer::close_segment() noexcept
+{
+    if (map_ != nullptr)
+        ::munmap(const_cast<LogRecordV2*>(map_), map_bytes_);
+    if (fd_ >= 0)
+        ::close(fd_);
+    map_ = nullptr;
+    map_bytes_ = 0;
+    fd_ = -1;
+    size_records_ = 0;
+    cursor_ = 0;
+    path_.clear();
+}
+
+bool Tailer::map_to_size() noexcept
+{
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0)
+        return false;
+    const size_t records = static_cast<size_t>(st.st_size) / sizeof(LogRecordV2);
+    const size_t bytes = records * sizeof(LogRecordV2);
+    if (bytes > map_bytes_) {
+        const size_t want = (bytes + kMapStep - 1) / kMapStep * kMapStep;
+        if (map_ != nullptr)
+            ::munmap(const_cast<LogRecordV2*>(map_), map_bytes_);
+        map_ = nullptr;
+        map_bytes_ = 0;
+        void* p = ::mmap(nullptr, want, PROT_READ, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED)
+            return false;
+        map_ = static_cast<const LogRecordV2*>(p);
+        map_bytes_ = want;
+    }
+    size_records_ = records;
+    return true;
+}
+
+size_t Tailer::valid_run(size_t max) const noexcept
+{
+    const size_t n = size_records_ - cursor_ < max ? size_records_ - cursor_ : max;
+    return cursor_ + valid_prefix(map_ + cursor_, n);
+}
+
+bool Tailer::next(std::span<const LogRecordV2>& out) noexcept
+{
+    out = {};
+    if (inotify_fd_ < 0)
+        return false;
+
+    for (;;) {
+        if (fd_ >= 0) {
+            if (!map_to_size())
+                return false;
+            // Records before from_seq are validated and passed over.
+            size_t end = valid_run(options_.max_batch);
+            while (end > cursor_ && map_[end - 1].global_seq < options_.from_seq) {
+                cursor_ = end;
+                end = valid_run(options_.max_batch);
+            }
+            size_t begin = cursor_;
+            while (begin < end && map_[begin].global_seq < options_.from_seq)
+                ++begin;
+            cursor_ = end;
+            if (end > begin) {
+                out = {map_ + begin, end - begin};
+                delivered_ += out.size();
+                last_seq_ = out.back().global_seq;
+                return true;
+            }
+        }
+
+        // Nothing new here: a later segment means this one is final. Look once
+        // more (records may have landed before the roll) and move on.
+        const std::string current = path_;
+        if (!dir_changed_)
+            return true;
+        dir_changed_ = false;
+        const std::string next = next_segment(dir_, current);
+        if (next.empty())
+            return true;
+        if (fd_ >= 0) {
+            if (!map_to_size())
+                return false;
+            if (valid_run(1) > cursor_) {
+                dir_changed_ = true; // roll after these
+                continue;
+            }
+        }
+        if (!open_segment(next))
+            return false;
+        dir_changed_ = true; // there may be more than one new segment
+    }
+}
+
+bool Tailer::wait(int timeout_ms) noexcept
+{
+    if (inotify_fd_ < 0)
+        return false;
+
+    pollfd fds[3] = {
+        {stop_fd_, POLLIN, 0},
+        {inotify_fd_, POLLIN, 0},
+        {options_.doorbell_fd, POLLIN, 0},
+    };
+    const nfds_t n = options_.doorbell_fd >= 0 ? 3 : 2;
+    int r;
+    do {
+        r = ::poll(fds, n, timeout_ms);
+    } while (r < 0 && errno == EINTR);
+    if (r <= 0 || (fds[0].revents & POLLIN) != 0)
+        return false;
+
+    if ((fds[1].revents & POLLIN) != 0) {
+        // Only creations and renames can add a segment; plain writes just wake.
+        alignas(inotify_event) char buf[4096];
+        ssize_t len;
+        while ((len = ::read(inotify_fd_, buf, sizeof(buf))) > 0) {
+            for (ssize_t off = 0; off < len;) {
+                const auto* ev = reinterpret_cast<const inotify_event*>(buf + off);
+                if ((ev->mask & (IN_CREATE | IN_MOVED_TO | IN_Q_OVERFLOW)) != 0)
+                    dir_changed_ = true;
+                off += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+            }
+        }
+    }
+    // The doorbell is shared with nobody else: consume its count. A writer
+    // rolling segments also creates a file, which inotify reports.
+    if (n == 3 && (fds[2].revents & POLLIN) != 0) {
+        uint64_t count;
+        (void)::read(options_.doorbell_fd, &count, sizeof(count));
+    }
+    return true;
+}
+
+void Tailer::stop() noexcept
+{
+    if (stop_fd_ >= 0) {
+        const uint64_t one = 1;
+        (void)::write(stop_fd_, &one, sizeof(one));
+    }
+}
+
+} // namespace wal::internal
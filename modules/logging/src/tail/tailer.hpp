@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "log_record.hpp"
+
+namespace wal::internal {
+
+// Live follower of a WAL directory (non-RT, consumer process or thread).
+//
+// The active segment is mapped read-only and records are handed out in place
+// as spans over the page cache — no copy beyond the kernel's. Each record is
+// CRC-checked once, when the cursor first reaches it; the cursor stops at the
+// first record that is not valid yet (unwritten, torn or zero padding of a
+// direct-I/O tail page) and rereads it on the next call. Records are handed
+// out once written, which may be before their fdatasync completes.
+//
+// A segment is finished once a later one exists: the writer drains and closes
+// a segment before opening the next (§10), so the tailer rereads the old one
+// a last time and rolls on, as recovery does at its first invalid record
+// (§11).
+//
+// wait() blocks on inotify (writes and new segments in the directory) and,
+// optionally, an eventfd doorbell rung by the writer when its durable
+// watermark moves (Writer::attach_doorbell). Nothing is polled on a timer.
+
+struct TailerOptions {
+    uint64_t from_seq = 0;      // first global_seq to deliver
+    bool from_end = false;      // start after the last valid record instead
+    size_t max_batch = 4096;    // records per span
+    int doorbell_fd = -1;       // eventfd from the writer (optional, not owned)
+};
+
+class Tailer {
+public:
+    Tailer() noexcept = default;
+    ~Tailer();
+
+    Tailer(const Tailer&) = delete;
+    Tailer& operator=(const Tailer&) = delete;
+
+    // Watch `dir` and position on the first segment (or per options). An empty
+    // directory is fine: the first segment is picked up when it appears.
+    bool open(const char* dir, const TailerOptions& options = {}) noexcept;
+    void close() noexcept;
+
+    // Next batch of valid records, non-blocking. `out` views the mapped
+    // segment and stays valid until the next call; empty → nothing new.
+    // false → I/O error.
+    bool next(std::span<const LogRecordV2>& out) noexcept;
+
+    // Block until the WAL may have grown, stop() was called, or `timeout_ms`
+    // passed (-1 = forever). false → timeout or stopped.
+    bool wait(int timeout_ms) noexcept;
+
+    // Deliver batches to `fn(std::span<const LogRecordV2>)` as they are
+    // committed until `fn` returns false, stop() is called, an I/O error, or
+    // `idle_timeout_ms` passes without new records. false → I/O error.
+    template <class Fn>
+    bool follow(Fn&& fn, int idle_timeout_ms = -1)
+    {
+        std::span<const LogRecordV2> batch;
+        for (;;) {
+            if (!next(batch))
+                return false;
+            if (!batch.empty()) {
+                if (!fn(batch))
+                    return true;
+                continue;
+            }
+            if (!wait(idle_timeout_ms))
+                return true;
+        }
+    }
+
+    // Wake a wait() / follow() from another thread; sticky until open().
+    void stop() noexcept;
+
+    [[nodiscard]] const std::string& segment() const noexcept { return path_; }
+    [[nodiscard]] uint64_t delivered() const noexcept { return delivered_; }
+    [[nodiscard]] uint64_t last_seq() const noexcept { return last_seq_; }
+
+private:
+    bool open_segment(const std::string& path) noexcept;
+    void close_segment() noexcept;
+    bool map_to_size() noexcept;
+    size_t valid_run(size_t max) const noexcept;
+
+    std::string dir_;
+    TailerOptions options_{};
+    int inotify_fd_ = -1;
+    int stop_fd_ = -1;
+    bool dir_changed_ = true;   // a .seg may have appeared since the last listing
+
+    std::string path_;
+    int fd_ = -1;
+    const LogRecordV2* map_ = nullptr;
+    size_t map_bytes_ = 0;
+    size_t size_records_ = 0;   // whole records in the file at the last fstat
+    size_t cursor_ = 0;         // next record to validate
+
+    uint64_t delivered_ = 0;
+    uint64_t last_seq_ = 0;
+};
+
+} // namespace wal::internal
@@ -1 +1,68 @@
-// TODO: implement writer
+#include "writer.hpp"
+
+#include <unistd.h>
+
+#include "backend/backend.hpp"
+#include "index/segment_index.hpp"
+
+namespace wal::internal {
+
+Writer::Writer(Backend& backend) noexcept
+    : backend_(backend)
+{
+}
+
+bool Writer::push(const LogRecordV2& rec) noexcept
+{
+    if (backend_.failed())
+        return false;
+    // A full batch the backend refused (e.g. no segment open after a failed
+    // roll) is retried before anything else is staged.
+    if (fill_ == kBatchRecords && !flush())
+        return false;
+    batch_[fill_++] = rec;
+    ++pushed_;
+    // The index is advisory (rebuilt by recovery): its errors do not fail the WAL.
+    if (index_ != nullptr)
+        (void)index_->add(rec);
+    // A refused hand-over keeps the batch staged; the next push() or
+    // flush() retries it, so the record is still taken.
+    if (fill_ == kBatchRecords)
+        (void)flush();
+    return true;
+}
+
+bool Writer::flush() noexcept
+{
+    if (fill_ == 0)
+        return !backend_.failed();
+    if (!backend_.submit(batch_, fill_))
+        return false;
+    fill_ = 0;
+    if (index_ != nullptr)
+        (void)index_->flush();
+    (void)ring(backend_.durable());
+    return true;
+}
+
+bool Writer::failed() const noexcept
+{
+    return backend_.failed();
+}
+
+uint64_t Writer::durable() noexcept
+{
+    return ring(backend_.poll());
+}
+
+uint64_t Writer::ring(uint64_t durable) noexcept
+{
+    if (doorbell_ >= 0 && durable != rung_) {
+        rung_ = durable;
+        const uint64_t one = 1;
+        (void)::write(doorbell_, &one, sizeof(one));
+    }
+    return durable;
+}
+
+} // namespace wal::internal
@@ -1,13 +1,72 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
+#include "log_record.hpp"
+
 namespace wal::internal {
 
 class Backend;
+class SegmentIndexWriter;
 
+// Batching front of a Backend (non-RT, logger thread).
+//
+// push() stages encoded records (CRC already applied) and hands a full batch
+// to the backend; flush() hands over a partial one. While the backend commits
+// batch k, the caller fills batch k + 1.
+//
+// With an index attached, every pushed record is also accounted in the
+// segment's sparse index; staged index entries are appended on flush().
+//
+// With a doorbell attached (an eventfd), the writer adds 1 to it whenever it
+// observes the durable watermark move, so tailers wake without polling.
 class Writer {
 public:
+    static constexpr size_t kBatchRecords = 1024; // 64 KiB per batch
+
     explicit Writer(Backend&) noexcept;
-    bool push(/* raw record */) noexcept;
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // true → `rec` is staged: it reaches the backend with its batch, even
+    // if handing that batch over fails now (the batch stays staged and is
+    // retried by the next push() / flush(); failed() tells a sticky backend
+    // failure apart). false → `rec` was refused and nothing was staged: the
+    // backend failed, or it still refuses a full batch.
+    bool push(const LogRecordV2& rec) noexcept;
+
+    // Submit the staged partial batch (no-op if empty). false → the batch is
+    // still staged, or the backend failed.
+    bool flush() noexcept;
+
+    // Backend failed (sticky): staged records no longer reach storage.
+    [[nodiscard]] bool failed() const noexcept;
+
+    // Records accepted by push() so far.
+    [[nodiscard]] uint64_t pushed() const noexcept { return pushed_; }
+
+    // Records on stable storage (non-blocking).
+    uint64_t durable() noexcept;
+
+    // Index of the open segment (nullptr detaches). The owner opens it with
+    // the segment's current record count and switches it with the segment.
+    void attach_index(SegmentIndexWriter* index) noexcept { index_ = index; }
+
+    // eventfd rung on durable progress (-1 detaches; not owned).
+    void attach_doorbell(int eventfd) noexcept { doorbell_ = eventfd; }
+
+private:
+    uint64_t ring(uint64_t durable) noexcept;
+
+    Backend& backend_;
+    SegmentIndexWriter* index_ = nullptr;
+    LogRecordV2 batch_[kBatchRecords];
+    size_t fill_ = 0;
+    uint64_t pushed_ = 0;
+    int doorbell_ = -1;
+    uint64_t rung_ = 0;
 };
 
 } // namespace wal::internal
@@ -1,22 +1,393 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
+#include "codec/record_codec.hpp"
+#include "gap_detector.hpp"
+#include "log_record.hpp"
+#include "stam/primitives/doorbell.hpp"
+#include "stam/primitives/spsc_ring.hpp"
+
 namespace wal {
 
-struct RecordView;   // forward-only, POD-like
-struct SubmitResult; // enum / status, no exceptions
+// Dispatcher lanes (design.md: critical / normal stream).
+enum class Lane : uint8_t {
+    Critical,   // alarms, trips: drained first and completely on every pass
+    Bulk,       // telemetry, diagnostics: drained with the remaining budget
+};
+
+inline constexpr size_t kLaneCount = 2;
+
+struct DispatcherConfig {
+    // Severity = flags & severity_mask (the QueryFilter convention); records
+    // with severity >= critical_severity take the critical lane.
+    uint8_t severity_mask = 0x07;
+    uint8_t critical_severity = 0x06;
+    // Bulk records moved per drain() (design.md: dispatcher budget).
+    uint32_t bulk_budget = 64;
+};
+
+enum class SubmitResult : uint8_t {
+    Ok,
+    Overflow,       // lane full: not queued, counted against the lane
+    BadProducer,    // producer_id out of range
+};
 
+struct LaneStats {
+    uint64_t submitted = 0;     // accepted by submit()
+    uint64_t overflow = 0;      // refused by submit(): lane full
+    uint64_t drained = 0;       // popped from the lane, not yet necessarily taken by the sink (see held())
+};
+
+struct DrainResult {
+    uint32_t critical = 0;
+    uint32_t bulk = 0;
+    uint32_t losses = 0;        // loss records emitted (§17)
+    bool ok = true;             // false → the sink refused a record (kept for the next drain()) or a flush failed
+};
+
+// Per-producer record lanes between RT producers and the coordinator.
+//
+// Every producer_id owns one SPSC ring per lane, so submit() is wait-free and
+// never contends with another producer. The coordinator (non-RT, logger
+// thread) calls drain() once per tick: all critical lanes are emptied first,
+// then bulk lanes are served round-robin up to bulk_budget, then the critical
+// lanes are swept once more. Drained records get global_seq and commit_ts,
+// are sealed in batches and pushed to the sink in that order; the sink is
+// flushed whenever critical records went out, so an alarm is with the
+// backend one tick after submit() at most, whatever the bulk backlog.
+//
+// The critical lanes are never starved by telemetry: a bulk burst fills
+// only the bulk lanes. Size CriticalDepth for the worst-case alarms per
+// producer per tick; a critical overflow is a sizing fault for the
+// supervisor (design.md: critical stream overflow), reported per lane.
+//
+// The coordinator also watches producer_seq per producer (GapDetector) and
+// appends a loss record at the end of the pass for every run of missing
+// values, so the WAL itself shows where a producer outran the logger; the
+// running counters go to an optional LossSnapshot channel.
+//
+// Nothing drained is dropped when the sink refuses a record: the pass stops
+// popping lanes, and the refused record and everything behind it stay in the
+// batch, global_seq already assigned, to be pushed first by the next drain().
+// Until then the lanes (and an overflowing critical lane) absorb the
+// backlog.
+//
+// Runs that must be contiguous in global_seq (checkpoints, §15) go through
+// append_block() between drains instead of a lane.
+//
+// Between ticks the coordinator may park in wait() instead of sleeping a
+// fixed period: submit() rings a Doorbell, which costs the producer a fence
+// and a relaxed load unless the coordinator is actually parked.
+//
+// Sink: bool push(const LogRecordV2&) noexcept (true → taken, false →
+// refused, nothing taken); bool flush() noexcept (Writer).
+template <size_t Producers, size_t CriticalDepth = 64, size_t BulkDepth = 1024>
 class WritersDispatcher final {
 public:
-    explicit WritersDispatcher(/* config */) noexcept;
+    static_assert(Producers >= 1 && Producers <= 256, "producer_id is 8 bits");
+
+    explicit WritersDispatcher(const DispatcherConfig& cfg = {}, uint64_t next_global_seq = 0) noexcept
+        : cfg_(cfg), next_seq_(next_global_seq)
+    {
+    }
+
+    WritersDispatcher(const WritersDispatcher&) = delete;
+    WritersDispatcher& operator=(const WritersDispatcher&) = delete;
+
+    [[nodiscard]] Lane lane_of(const LogRecordV2& rec) const noexcept
+    {
+        return (rec.flags & cfg_.severity_mask) >= cfg_.critical_severity ? Lane::Critical : Lane::Bulk;
+    }
+
+    // RT-safe: wait-free, no allocation, no IO. One caller per producer_id.
+    // global_seq, commit_ts and crc32 are assigned at drain.
+    SubmitResult submit(const LogRecordV2& rec) noexcept
+    {
+        if (rec.producer_id >= Producers)
+            return SubmitResult::BadProducer;
+        Producer& p = producers_[rec.producer_id];
+        const Lane lane = lane_of(rec);
+        const bool queued = lane == Lane::Critical ? p.critical.in.push(rec) : p.bulk.in.push(rec);
+        Counters& c = p.counters[static_cast<size_t>(lane)];
+        // Single writer per counter: load + store, no RMW on the RT path.
+        std::atomic<uint64_t>& n = queued ? c.submitted : c.overflow;
+        n.store(n.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (!queued)
+            return SubmitResult::Overflow;
+        bell_.ring();
+        return SubmitResult::Ok;
+    }
+
+    // Coordinator: spin, then park until some lane holds a record (true) or
+    // the park ends without one (false: check for shutdown, wait again).
+    [[nodiscard]] bool wait(const stam::primitives::DoorbellPolicy& policy = {}) noexcept
+    {
+        return bell_.wait([this]() noexcept { return pending(); }, policy);
+    }
+
+    // Loss counters channel (publisher.obj == nullptr detaches).
+    void attach_loss_publisher(LossPublisher publisher) noexcept { loss_pub_ = publisher; }
+
+    // Coordinator: move queued records to `sink` (see class comment).
+    template <class Sink>
+    DrainResult drain(Sink& sink, uint64_t now) noexcept
+    {
+        DrainResult res;
+        stalled_ = false;
+
+        // What the sink refused last time goes first, in global_seq order.
+        if (fill_ != 0 && !commit(sink, now))
+            res.ok = false;
+
+        if (drain_critical(sink, now, res) != 0 && !stalled_) {
+            if (!commit(sink, now) || !sink.flush())
+                res.ok = false;
+        }
+
+        // Bulk: one record per producer per turn, from a rotating start.
+        while (res.bulk < cfg_.bulk_budget && !stalled_) {
+            bool any = false;
+            for (size_t k = 0; k < Producers && res.bulk < cfg_.bulk_budget; ++k) {
+                const size_t i = (rr_ + k) % Producers;
+                const auto id = static_cast<uint8_t>(i);
+                if (!gaps_.bulk_room(id))
+                    continue;
+                if (!room(sink, now, res))
+                    break;
+                if (!producers_[i].bulk.out.pop(batch_[fill_])) {
+                    gaps_.bulk_empty(id);
+                    continue;
+                }
+                any = true;
+                ++producers_[i].drained[static_cast<size_t>(Lane::Bulk)];
+                ++res.bulk;
+                gaps_.bulk(id, batch_[fill_++].producer_seq);
+            }
+            if (!any)
+                break;
+        }
+        rr_ = (rr_ + 1) % Producers;
+
+        // Sweep: trips submitted during this pass go out now, and whatever
+        // is left in a critical lane is newer than everything popped, which
+        // lets the gap detector close this pass. A stalled pass may have
+        // left older trips queued, so it closes nothing.
+        const uint32_t swept = drain_critical(sink, now, res);
+        for (size_t i = 0; i < Producers && room(sink, now, res); ++i) {
+            gaps_.end_pass(static_cast<uint8_t>(i), [&](uint8_t p, uint64_t first, uint64_t count) noexcept {
+                emit_loss(p, first, count, now, res);
+            });
+        }
+        if (!stalled_ && (!commit(sink, now) || (swept != 0 && !sink.flush())))
+            res.ok = false;
+
+        if (loss_dirty_ || gaps_.late() != loss_.late) {
+            loss_.late = gaps_.late();
+            loss_dirty_ = false;
+            if (loss_pub_.publish_fn != nullptr)
+                loss_pub_.publish_fn(loss_pub_.obj, loss_);
+        }
+        return res;
+    }
+
+    // Coordinator, between drains: push recs[0 .. n) with consecutive
+    // global_seq and nothing interleaved (a checkpoint, §15); global_seq,
+    // commit_ts and crc32 are assigned here. A tail refused by the last
+    // drain() goes out first. false → the sink refused a record: the block
+    // is abandoned there, its accepted prefix is an incomplete run that
+    // readers discard, and no global_seq is skipped.
+    template <class Sink>
+    bool append_block(Sink& sink, const LogRecordV2* recs, size_t n, uint64_t now) noexcept
+    {
+        if (fill_ != 0 && !commit(sink, now))
+            return false;
+        for (size_t at = 0; at < n;) {
+            const size_t k = n - at < kBatch ? n - at : kBatch;
+            for (size_t i = 0; i < k; ++i) {
+                batch_[i] = recs[at + i];
+                batch_[i].global_seq = next_seq_ + i;
+                batch_[i].commit_ts = now;
+            }
+            internal::seal_records(batch_, k);
+            for (size_t i = 0; i < k; ++i) {
+                if (!sink.push(batch_[i])) {
+                    next_seq_ += i;
+                    return false;
+                }
+            }
+            next_seq_ += k;
+            at += k;
+        }
+        return true;
+    }
+
+    // Counters of one producer's lane. submitted / overflow are read relaxed
+    // (telemetry); drained is the coordinator's own.
+    [[nodiscard]] LaneStats lane_stats(uint8_t producer_id, Lane lane) const noexcept
+    {
+        LaneStats s;
+        if (producer_id >= Producers)
+            return s;
+        const Producer& p = producers_[producer_id];
+        const Counters& c = p.counters[static_cast<size_t>(lane)];
+        s.submitted = c.submitted.load(std::memory_order_relaxed);
+        s.overflow = c.overflow.load(std::memory_order_relaxed);
+        s.drained = p.drained[static_cast<size_t>(lane)];
+        return s;
+    }
+
+    // Sum over producers.
+    [[nodiscard]] LaneStats lane_stats(Lane lane) const noexcept
+    {
+        LaneStats s;
+        for (size_t i = 0; i < Producers; ++i) {
+            const LaneStats p = lane_stats(static_cast<uint8_t>(i), lane);
+            s.submitted += p.submitted;
+            s.overflow += p.overflow;
+            s.drained += p.drained;
+        }
+        return s;
+    }
+
+    // Running loss counters (coordinator thread).
+    [[nodiscard]] const LossSnapshot& loss() const noexcept { return loss_; }
+
+    // Times wait() parked in the kernel (telemetry).
+    [[nodiscard]] uint64_t parks() const noexcept { return bell_.parks(); }
+
+    // global_seq the next drained record gets.
+    [[nodiscard]] uint64_t next_global_seq() const noexcept { return next_seq_; }
+
+    // Drained records the sink has not taken yet (retried by the next drain()).
+    [[nodiscard]] size_t held() const noexcept { return fill_ - head_; }
+
+private:
+    static constexpr size_t kBatch = 64;    // records sealed per CRC batch
+    // Loss records one gap detector call can emit: a hole around every bulk
+    // run and every critical value ahead of the frontier.
+    static constexpr size_t kLossBurst = GapDetector<Producers>::kRuns + GapDetector<Producers>::kAhead + 1;
+
+    struct Counters {
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> overflow{0};
+    };
+
+    // Both ends stay here: the producer thread pushes, the coordinator pops.
+    template <size_t Depth>
+    struct LaneRing {
+        stam::primitives::SPSCRing<LogRecordV2, Depth> ring;
+        stam::primitives::SPSCRingWriter<LogRecordV2, Depth> in = ring.writer();
+        stam::primitives::SPSCRingReader<LogRecordV2, Depth> out = ring.reader();
+    };
+
+    struct Producer {
+        LaneRing<CriticalDepth> critical;
+        LaneRing<BulkDepth> bulk;
+        Counters counters[kLaneCount];
+        uint64_t drained[kLaneCount] = {};
+    };
+
+    [[nodiscard]] bool pending() const noexcept
+    {
+        for (const Producer& p : producers_) {
+            if (!p.critical.out.empty() || !p.bulk.out.empty())
+                return true;
+        }
+        return false;
+    }
+
+    // Empty every critical lane, round-robin. Each holds fewer than
+    // CriticalDepth records at entry; the turn limit bounds a producer that
+    // keeps pushing.
+    template <class Sink>
+    uint32_t drain_critical(Sink& sink, uint64_t now, DrainResult& res) noexcept
+    {
+        uint32_t n = 0;
+        for (size_t turn = 0; turn < CriticalDepth; ++turn) {
+            bool any = false;
+            for (size_t i = 0; i < Producers && room(sink, now, res); ++i) {
+                if (!producers_[i].critical.out.pop(batch_[fill_]))
+                    continue;
+                any = true;
+                ++n;
+                ++producers_[i].drained[static_cast<size_t>(Lane::Critical)];
+                const uint64_t seq = batch_[fill_++].producer_seq;
+                gaps_.critical(static_cast<uint8_t>(i), seq, [&](uint8_t p, uint64_t first, uint64_t count) noexcept {
+                    emit_loss(p, first, count, now, res);
+                });
+            }
+            if (!any || stalled_)
+                break;
+        }
+        res.critical += n;
+        return n;
+    }
+
+    // Room for one more pop and the loss records it may cause: commits a
+    // full batch first. false → the sink refused it (stop popping).
+    template <class Sink>
+    bool room(Sink& sink, uint64_t now, DrainResult& res) noexcept
+    {
+        if (stalled_)
+            return false;
+        if (fill_ < kBatch)
+            return true;
+        if (commit(sink, now))
+            return true;
+        res.ok = false;
+        return false;
+    }
+
+    void emit_loss(uint8_t producer, uint64_t first, uint64_t count, uint64_t now, DrainResult& res) noexcept
+    {
+        batch_[fill_++] = make_loss_record(producer, first, count, now);
+        ++res.losses;
+        ++loss_.gaps;
+        loss_.lost_total += count;
+        loss_.lost[producer] += count;
+        loss_dirty_ = true;
+    }
 
-    // RT-safe: non-blocking, no allocation, no IO
-    bool submit(const RecordView& rec) noexcept;
+    // Number and seal what is new in the batch, then push from the first
+    // record the sink has not taken. false → refused: the rest stays.
+    template <class Sink>
+    bool commit(Sink& sink, uint64_t now) noexcept
+    {
+        for (size_t i = sealed_; i < fill_; ++i) {
+            batch_[i].global_seq = next_seq_++;
+            batch_[i].commit_ts = now;
+        }
+        internal::seal_records(batch_ + sealed_, fill_ - sealed_);
+        sealed_ = fill_;
+        for (; head_ < fill_; ++head_) {
+            if (!sink.push(batch_[head_])) {
+                stalled_ = true;
+                return false;
+            }
+        }
+        fill_ = sealed_ = head_ = 0;
+        return true;
+    }
 
-    // lifecycle
-    void flush() noexcept;   // non-RT domain
+    DispatcherConfig cfg_;
+    Producer producers_[Producers];
+    // [0, head_) taken by the sink, [head_, sealed_) numbered and sealed,
+    // [sealed_, fill_) popped this pass.
+    LogRecordV2 batch_[kBatch + kLossBurst];
+    size_t fill_ = 0;
+    size_t sealed_ = 0;
+    size_t head_ = 0;
+    bool stalled_ = false;
+    uint64_t next_seq_;
+    size_t rr_ = 0;
+    GapDetector<Producers> gaps_;
+    LossSnapshot loss_;
+    LossPublisher loss_pub_;
+    bool loss_dirty_ = false;
+    stam::primitives::Doorbell bell_;
 };
 
 } // namespace wal
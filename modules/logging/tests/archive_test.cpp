@@ -0,0 +1,235 @@
+#include "archive/archive.hpp"
+#include "test_harness.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using wal::LogRecordV2;
+using wal::internal::ArchiveBlockHeader;
+using wal::internal::ArchiveReader;
+using wal::internal::ArchiveStats;
+using wal::internal::ArchiveStatus;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static uint64_t g_rng = 0x2545F4914F6CDD1Dull;
+
+static uint64_t next_rand()
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return g_rng;
+}
+
+static void seal(LogRecordV2& r)
+{
+    r.crc32 = wal::record_crc(r);
+}
+
+// Plant-like stream: 4 producers, 6 event types, jittery clock, small
+// counters in the payload.
+static std::vector<LogRecordV2> plant_records(uint64_t first_seq, size_t n)
+{
+    std::vector<LogRecordV2> v(n);
+    uint64_t ts = 1'000'000;
+    uint64_t pseq[4] = {10, 20, 30, 40};
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t x = next_rand();
+        LogRecordV2& r = v[i];
+        r = LogRecordV2{};
+        r.version = wal::kLogRecordVersion;
+        r.producer_id = static_cast<uint8_t>(x % 4);
+        r.event_type = static_cast<uint8_t>(1 + (x >> 8) % 6);
+        r.flags = (x >> 16) % 64 == 0 ? 0x03 : 0x01;
+        ts += (x >> 24) % 4;
+        r.global_seq = first_seq + i;
+        r.commit_ts = ts;
+        r.event_ts = ts - (x >> 28) % 3;
+        r.producer_seq = ++pseq[r.producer_id];
+        const uint16_t value = static_cast<uint16_t>(i / 64);
+        std::memcpy(r.payload, &value, sizeof(value));
+        r.payload[2] = r.event_type;
+        seal(r);
+    }
+    return v;
+}
+
+static std::vector<LogRecordV2> read_archive(const std::string& path)
+{
+    ArchiveReader rd;
+    EXPECT(rd.open(path.c_str()) == ArchiveStatus::Ok);
+    std::vector<LogRecordV2> all;
+    std::vector<LogRecordV2> block;
+    ArchiveStatus s;
+    while ((s = rd.next(block)) == ArchiveStatus::Ok)
+        all.insert(all.end(), block.begin(), block.end());
+    EXPECT(s == ArchiveStatus::End);
+    EXPECT(all.size() == rd.header().records);
+    return all;
+}
+
+static bool same(const std::vector<LogRecordV2>& a, const std::vector<LogRecordV2>& b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(LogRecordV2)) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_block_codec_roundtrip_edge_values)
+{
+    // Wrapping seq / timestamps, every byte value in payload, one-record block.
+    std::vector<LogRecordV2> recs(300);
+    for (size_t i = 0; i < recs.size(); ++i) {
+        const uint64_t x = next_rand();
+        LogRecordV2& r = recs[i];
+        r = LogRecordV2{};
+        r.version = wal::kLogRecordVersion;
+        r.event_type = static_cast<uint8_t>(x);
+        r.producer_id = static_cast<uint8_t>(x >> 8);
+        r.flags = static_cast<uint8_t>(x >> 16);
+        r.global_seq = ~uint64_t{0} - 150 + i;
+        r.commit_ts = x;
+        r.event_ts = ~x;
+        r.producer_seq = next_rand();
+        for (size_t k = 0; k < sizeof(r.reserved); ++k)
+            r.reserved[k] = static_cast<uint8_t>(next_rand());
+        for (size_t k = 0; k < sizeof(r.payload); ++k)
+            r.payload[k] = static_cast<uint8_t>(next_rand());
+        seal(r);
+    }
+
+    for (size_t n : {size_t{1}, size_t{2}, size_t{3}, recs.size()}) {
+        std::vector<uint8_t> body;
+        wal::internal::encode_archive_block(recs.data(), n, body);
+        std::vector<LogRecordV2> out;
+        EXPECT(wal::internal::decode_archive_block(body.data(), body.size(), n, out));
+        EXPECT(out.size() == n);
+        EXPECT(std::memcmp(out.data(), recs.data(), n * sizeof(LogRecordV2)) == 0);
+
+        // Truncated body is rejected, never read past.
+        if (body.size() > 1) {
+            std::vector<LogRecordV2> bad;
+            EXPECT(!wal::internal::decode_archive_block(body.data(), body.size() - 1, n, bad));
+        }
+    }
+}
+
+TEST(test_archive_roundtrip_and_ratio)
+{
+    const std::string dir = make_tmp_dir("wal_archive");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string arc = wal::internal::archive_path(seg);
+    EXPECT(arc == dir + "/00000001_00000001.arc");
+
+    const std::vector<LogRecordV2> recs = plant_records(5000, 50'000);
+    write_records(seg, recs);
+
+    ArchiveStats st;
+    EXPECT(wal::internal::archive_segment(seg.c_str(), arc.c_str(), 4096, &st));
+    EXPECT(st.records == 50'000u && st.blocks == 13u);
+    const double ratio = static_cast<double>(st.segment_bytes) / static_cast<double>(st.archive_bytes);
+    std::printf("(%.1fx) ", ratio);
+    EXPECT(ratio >= 5.0);
+
+    EXPECT(same(read_archive(arc), recs));
+    remove_tree(dir);
+}
+
+TEST(test_archive_keeps_only_valid_prefix)
+{
+    const std::string dir = make_tmp_dir("wal_archive");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string arc = dir + "/00000001_00000001.arc";
+
+    std::vector<LogRecordV2> recs = plant_records(1, 1000);
+    recs[700].payload[5] ^= 0x10; // corrupt: §11 stops here
+    write_records(seg, recs);
+
+    EXPECT(wal::internal::archive_segment(seg.c_str(), arc.c_str(), 256));
+    const std::vector<LogRecordV2> back = read_archive(arc);
+    recs.resize(700);
+    EXPECT(same(back, recs));
+
+    remove_tree(dir);
+}
+
+TEST(test_archive_block_skip_and_corruption)
+{
+    const std::string dir = make_tmp_dir("wal_archive");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string arc = dir + "/00000001_00000001.arc";
+    const std::vector<LogRecordV2> recs = plant_records(1, 1000);
+    write_records(seg, recs);
+    EXPECT(wal::internal::archive_segment(seg.c_str(), arc.c_str(), 256));
+
+    // Seek to seq 600 by block headers alone.
+    {
+        ArchiveReader rd;
+        EXPECT(rd.open(arc.c_str()) == ArchiveStatus::Ok);
+        EXPECT(rd.header().blocks == 4u);
+        ArchiveBlockHeader h{};
+        while (rd.peek(h) == ArchiveStatus::Ok && h.last_seq < 600)
+            EXPECT(rd.skip() == ArchiveStatus::Ok);
+        EXPECT(h.first_seq == 513u && h.last_seq == 768u);
+        EXPECT(h.min_ts == recs[512].commit_ts && h.max_ts == recs[767].commit_ts);
+        std::vector<LogRecordV2> block;
+        EXPECT(rd.next(block) == ArchiveStatus::Ok);
+        EXPECT(block.size() == 256u && block[87].global_seq == 600u);
+    }
+
+    // Flip one body byte of the second block: CRC catches it.
+    {
+        ArchiveReader rd;
+        EXPECT(rd.open(arc.c_str()) == ArchiveStatus::Ok);
+        ArchiveBlockHeader h{};
+        EXPECT(rd.peek(h) == ArchiveStatus::Ok);
+        const long second = static_cast<long>(sizeof(wal::internal::ArchiveHeader) + sizeof(h) + h.body_bytes);
+        FILE* f = std::fopen(arc.c_str(), "r+b");
+        EXPECT(f != nullptr);
+        EXPECT(std::fseek(f, second + static_cast<long>(sizeof(h)) + 3, SEEK_SET) == 0);
+        const int c = std::fgetc(f);
+        EXPECT(std::fseek(f, second + static_cast<long>(sizeof(h)) + 3, SEEK_SET) == 0);
+        EXPECT(std::fputc(c ^ 0x40, f) != EOF);
+        std::fclose(f);
+    }
+    {
+        ArchiveReader rd;
+        EXPECT(rd.open(arc.c_str()) == ArchiveStatus::Ok);
+        std::vector<LogRecordV2> block;
+        EXPECT(rd.next(block) == ArchiveStatus::Ok);
+        EXPECT(rd.next(block) == ArchiveStatus::BadBlock);
+    }
+
+    ArchiveReader rd;
+    EXPECT(rd.open(seg.c_str()) == ArchiveStatus::BadHeader);
+    EXPECT(rd.open((dir + "/missing.arc").c_str()) == ArchiveStatus::IoError);
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void archive_tests()
+{
+    std::printf("\n--- archive ---\n");
+
+    RUN(test_block_codec_roundtrip_edge_values);
+    RUN(test_archive_roundtrip_and_ratio);
+    RUN(test_archive_keeps_only_valid_prefix);
+    RUN(test_archive_block_skip_and_corruption);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
@@ -0,0 +1,766 @@
+#include "backend/direct_file_backend.hpp"
+#include "backend/file_backend.hpp"
+#include "backend/io_uring_backend.hpp"
+#include "backend/mirror_backend.hpp"
+#include "backend/staging_backend.hpp"
+#include "recovery/recovery.hpp"
+#include "writer/writer.hpp"
+#include "test_harness.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using wal::LogRecordV2;
+using wal::internal::Backend;
+using wal::internal::DirectFileBackend;
+using wal::internal::DirectFileBackendConfig;
+using wal::internal::FileBackend;
+using wal::internal::IoUringBackend;
+using wal::internal::IoUringBackendConfig;
+using wal::internal::MirrorBackend;
+using wal::internal::StagingBackend;
+using wal::internal::StagingBackendConfig;
+using wal::internal::Writer;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static LogRecordV2 make_record(uint64_t seq)
+{
+    LogRecordV2 r{};
+    r.version = 2;
+    r.global_seq = seq;
+    r.producer_seq = ~seq;
+    std::memcpy(r.payload, &seq, sizeof(seq));
+    r.crc32 = wal::record_crc(r);
+    return r;
+}
+
+// Reads back a segment and checks records [first, first + count) in order.
+static bool verify_segment(const std::string& path, uint64_t first, uint64_t count)
+{
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (f == nullptr)
+        return false;
+    bool ok = true;
+    LogRecordV2 r{};
+    uint64_t n = 0;
+    while (std::fread(&r, sizeof(r), 1, f) == 1) {
+        if (r.global_seq != first + n || r.producer_seq != ~(first + n))
+            ok = false;
+        ++n;
+    }
+    std::fclose(f);
+    return ok && n == count;
+}
+
+static bool submit_range(Backend& b, uint64_t first, uint64_t count)
+{
+    constexpr uint64_t kChunk = 300;
+    LogRecordV2 buf[kChunk];
+    for (uint64_t done = 0; done < count;) {
+        const uint64_t n = count - done < kChunk ? count - done : kChunk;
+        for (uint64_t i = 0; i < n; ++i)
+            buf[i] = make_record(first + done + i);
+        if (!b.submit(buf, n))
+            return false;
+        done += n;
+    }
+    return true;
+}
+
+// Segment of `count` valid records (CRC set) starting at global_seq `first`.
+static bool write_valid_segment(const std::string& path, uint64_t first, uint64_t count)
+{
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (f == nullptr)
+        return false;
+    bool ok = true;
+    for (uint64_t i = 0; i < count; ++i) {
+        const LogRecordV2 r = make_record(first + i);
+        ok = std::fwrite(&r, sizeof(r), 1, f) == 1 && ok;
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+namespace {
+
+// Leg with scripted completions.
+struct ManualBackend final : Backend {
+    bool open_segment(const char*) noexcept override { return open_ok; }
+    bool submit(const LogRecordV2*, size_t count) noexcept override
+    {
+        submitted += count;
+        return !fail;
+    }
+    uint64_t poll() noexcept override { return done; }
+    uint64_t drain() noexcept override { return done; }
+    void close_segment() noexcept override {}
+    [[nodiscard]] uint64_t durable() const noexcept override { return done; }
+    [[nodiscard]] bool failed() const noexcept override { return fail; }
+
+    bool open_ok = true;
+    bool fail = false;
+    uint64_t submitted = 0;
+    uint64_t done = 0;
+};
+
+} // namespace
+
+static bool uring_available()
+{
+    IoUringBackend probe;
+    if (!probe.available()) {
+        std::printf("(io_uring unavailable, skipped) ");
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// FileBackend
+// ---------------------------------------------------------------------------
+
+TEST(test_file_backend_roundtrip)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+
+    FileBackend b;
+    EXPECT(!b.submit(nullptr, 0)); // no segment yet
+    EXPECT(b.open_segment(seg.c_str()));
+    EXPECT(submit_range(b, 1, 1000));
+    EXPECT(b.durable() == 1000u);
+    b.close_segment();
+    EXPECT(verify_segment(seg, 1, 1000));
+
+    // Reopen appends after existing content.
+    EXPECT(b.open_segment(seg.c_str()));
+    EXPECT(submit_range(b, 1001, 24));
+    b.close_segment();
+    EXPECT(verify_segment(seg, 1, 1024));
+    EXPECT(!b.failed());
+
+    remove_tree(dir);
+}
+
+TEST(test_file_backend_open_failure)
+{
+    FileBackend b;
+    EXPECT(!b.open_segment("/nonexistent_dir_for_wal_test/x.seg"));
+    EXPECT(!b.submit(nullptr, 0));
+}
+
+// ---------------------------------------------------------------------------
+// IoUringBackend
+// ---------------------------------------------------------------------------
+
+TEST(test_uring_backend_roundtrip)
+{
+    if (!uring_available())
+        return;
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+
+    IoUringBackendConfig cfg{};
+    cfg.batch_records = 64;
+    cfg.batches_in_flight = 4;
+    IoUringBackend b{cfg};
+    EXPECT(b.available());
+    std::printf("(fixed_bufs=%d) ", b.fixed_buffers() ? 1 : 0);
+
+    EXPECT(b.open_segment(seg.c_str()));
+    std::printf("(fixed_files=%d) ", b.fixed_files() ? 1 : 0);
+
+    // 10'000 records → 157 batches through 4 slots: exercises backpressure and slot reuse.
+    EXPECT(submit_range(b, 1, 10'000));
+    EXPECT(b.poll() <= 10'000u);
+    EXPECT(b.drain() == 10'000u);
+    EXPECT(!b.failed());
+    b.close_segment();
+    EXPECT(verify_segment(seg, 1, 10'000));
+
+    remove_tree(dir);
+}
+
+TEST(test_uring_backend_segment_switch)
+{
+    if (!uring_available())
+        return;
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg1 = dir + "/00000001_00000001.seg";
+    const std::string seg2 = dir + "/00000001_00000002.seg";
+
+    IoUringBackend b;
+    EXPECT(b.open_segment(seg1.c_str()));
+    EXPECT(submit_range(b, 1, 500));
+    // Switching drains the old segment first.
+    EXPECT(b.open_segment(seg2.c_str()));
+    EXPECT(b.durable() == 500u);
+    EXPECT(submit_range(b, 501, 700));
+    EXPECT(b.drain() == 1200u);
+    b.close_segment();
+
+    EXPECT(verify_segment(seg1, 1, 500));
+    EXPECT(verify_segment(seg2, 501, 700));
+    remove_tree(dir);
+}
+
+TEST(test_uring_backend_durable_is_contiguous)
+{
+    if (!uring_available())
+        return;
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+
+    IoUringBackendConfig cfg{};
+    cfg.batch_records = 16;
+    cfg.batches_in_flight = 8;
+    IoUringBackend b{cfg};
+    EXPECT(b.open_segment(seg.c_str()));
+
+    uint64_t last = 0;
+    for (uint64_t i = 0; i < 200; ++i) {
+        EXPECT(submit_range(b, 1 + i * 10, 10));
+        const uint64_t d = b.poll();
+        EXPECT(d >= last);          // monotonic
+        EXPECT(d <= (i + 1) * 10);  // never ahead of submitted
+        last = d;
+    }
+    EXPECT(b.drain() == 2000u);
+    b.close_segment();
+    EXPECT(verify_segment(seg, 1, 2000));
+    remove_tree(dir);
+}
+
+TEST(test_uring_backend_open_failure)
+{
+    if (!uring_available())
+        return;
+    IoUringBackend b;
+    EXPECT(!b.open_segment("/nonexistent_dir_for_wal_test/x.seg"));
+    EXPECT(!b.submit(nullptr, 0));
+}
+
+// ---------------------------------------------------------------------------
+// DirectFileBackend
+// ---------------------------------------------------------------------------
+
+static uint64_t file_size(const std::string& path)
+{
+    struct stat st{};
+    return ::stat(path.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : ~uint64_t{0};
+}
+
+// O_DIRECT needs io_uring here and a filesystem that supports it (not tmpfs).
+static bool direct_open(DirectFileBackend& b, const std::string& path)
+{
+    if (!b.available() || !b.open_segment(path.c_str())) {
+        std::printf("(O_DIRECT unavailable, skipped) ");
+        return false;
+    }
+    return true;
+}
+
+TEST(test_direct_backend_roundtrip)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+
+    DirectFileBackendConfig cfg{};
+    cfg.pages = 4;
+    DirectFileBackend b{cfg};
+    if (!direct_open(b, seg)) {
+        remove_tree(dir);
+        return;
+    }
+
+    // Odd-sized submits: pages fill across calls, tail page rewritten each time.
+    for (uint64_t first = 1; first <= 1000; first += 37) {
+        const uint64_t n = first + 37 > 1001 ? 1001 - first : 37;
+        EXPECT(submit_range(b, first, n));
+    }
+    EXPECT(b.drain() == 1000u);
+    EXPECT(!b.failed());
+    EXPECT(file_size(seg) % 4096u == 0u); // zero-padded tail page
+    b.close_segment();
+    EXPECT(file_size(seg) == 1000u * sizeof(LogRecordV2));
+    EXPECT(verify_segment(seg, 1, 1000));
+
+    remove_tree(dir);
+}
+
+TEST(test_direct_backend_rewrites_only_tail_page)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+
+    DirectFileBackend b;
+    if (!direct_open(b, seg)) {
+        remove_tree(dir);
+        return;
+    }
+
+    EXPECT(submit_range(b, 1, 10));
+    EXPECT(b.page_writes() == 1u);
+    EXPECT(submit_range(b, 11, 10));
+    EXPECT(b.page_writes() == 2u); // same tail page again
+    EXPECT(submit_range(b, 21, 64)); // completes page 0, tail in page 1
+    EXPECT(b.page_writes() == 4u);
+    EXPECT(b.drain() == 84u);
+    EXPECT(file_size(seg) == 2u * 4096u);
+    b.close_segment();
+    EXPECT(verify_segment(seg, 1, 84));
+
+    remove_tree(dir);
+}
+
+TEST(test_direct_backend_resumes_after_padding)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string crashed = dir + "/00000001_00000002.seg";
+
+    {
+        DirectFileBackend b;
+        if (!direct_open(b, seg)) {
+            remove_tree(dir);
+            return;
+        }
+        EXPECT(submit_range(b, 1, 70));
+        EXPECT(b.drain() == 70u);
+        // Snapshot the on-disk state before close() trims the padding (= crash image).
+        const std::string cmd = "cp '" + seg + "' '" + crashed + "'";
+        EXPECT(std::system(cmd.c_str()) == 0);
+    }
+    EXPECT(file_size(crashed) == 2u * 4096u);
+
+    DirectFileBackend b;
+    EXPECT(b.open_segment(crashed.c_str()));
+    EXPECT(submit_range(b, 71, 30));
+    EXPECT(b.drain() == 30u);
+    b.close_segment();
+    EXPECT(verify_segment(crashed, 1, 100));
+
+    remove_tree(dir);
+}
+
+TEST(test_direct_backend_resumes_at_torn_record)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string crashed = dir + "/00000001_00000002.seg";
+
+    {
+        DirectFileBackend b;
+        if (!direct_open(b, seg)) {
+            remove_tree(dir);
+            return;
+        }
+        EXPECT(submit_range(b, 1, 70));
+        EXPECT(b.drain() == 70u);
+        const std::string cmd = "cp '" + seg + "' '" + crashed + "'";
+        EXPECT(std::system(cmd.c_str()) == 0);
+    }
+
+    // Tear record 70: non-zero, but its CRC no longer matches.
+    {
+        FILE* f = std::fopen(crashed.c_str(), "r+b");
+        EXPECT(f != nullptr);
+        EXPECT(std::fseek(f, 69 * static_cast<long>(sizeof(LogRecordV2)) + 60, SEEK_SET) == 0);
+        EXPECT(std::fputc(0x5A, f) != EOF);
+        EXPECT(std::fclose(f) == 0);
+    }
+
+    DirectFileBackend b;
+    EXPECT(b.open_segment(crashed.c_str()));
+    EXPECT(submit_range(b, 70, 31));
+    EXPECT(b.drain() == 31u);
+    b.close_segment();
+    EXPECT(verify_segment(crashed, 1, 100));
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// MirrorBackend
+// ---------------------------------------------------------------------------
+
+TEST(test_mirror_backend_writes_both_legs)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string a = dir + "/ssd";
+    const std::string b = dir + "/sd";
+    EXPECT(::mkdir(a.c_str(), 0755) == 0 && ::mkdir(b.c_str(), 0755) == 0);
+
+    // Two rings when io_uring is there: both devices commit concurrently.
+    std::unique_ptr<Backend> legs[2];
+    for (auto& leg : legs) {
+        auto u = std::make_unique<IoUringBackend>();
+        if (u->available())
+            leg = std::move(u);
+        else
+            leg = std::make_unique<FileBackend>();
+    }
+    auto m = std::make_unique<MirrorBackend>(*legs[0], a.c_str(), *legs[1], b.c_str());
+    EXPECT(m->open_segment("/anywhere/00000001_00000001.seg"));
+    EXPECT(submit_range(*m, 1, 5000));
+    EXPECT(m->drain() == 5000u);
+    EXPECT(m->leg_durable(0) == 5000u && m->leg_durable(1) == 5000u);
+    EXPECT(!m->degraded() && !m->failed());
+    m->close_segment();
+    EXPECT(verify_segment(a + "/00000001_00000001.seg", 1, 5000));
+    EXPECT(verify_segment(b + "/00000001_00000001.seg", 1, 5000));
+
+    remove_tree(dir);
+}
+
+TEST(test_mirror_backend_durable_is_minimum)
+{
+    ManualBackend a;
+    ManualBackend b;
+    b.done = 7; // history before the mirror: not counted
+    MirrorBackend m{a, "/a", b, "/b"};
+    EXPECT(!m.submit(nullptr, 1)); // no segment yet
+    EXPECT(m.open_segment("00000001_00000001.seg"));
+
+    LogRecordV2 recs[10]{};
+    EXPECT(m.submit(recs, 10));
+    EXPECT(a.submitted == 10u && b.submitted == 10u);
+    a.done = 10;
+    b.done = 7 + 4;
+    EXPECT(m.poll() == 4u);
+    b.done = 7 + 10;
+    EXPECT(m.poll() == 10u);
+
+    // The SD card dies: the mirror carries on with the SSD alone.
+    EXPECT(m.submit(recs, 10));
+    b.fail = true;
+    EXPECT(m.submit(recs, 5));
+    EXPECT(m.degraded() && !m.leg_live(1) && !m.failed());
+    EXPECT(m.submit(recs, 5));
+    EXPECT(b.submitted == 25u && a.submitted == 30u);
+    a.done = 30;
+    EXPECT(m.poll() == 30u);
+
+    a.fail = true;
+    EXPECT(!m.submit(recs, 1));
+    EXPECT(m.failed() && m.durable() == 30u);
+
+    // A leg that cannot open its directory is dropped at open_segment().
+    ManualBackend c;
+    ManualBackend d;
+    d.open_ok = false;
+    MirrorBackend m2{c, "/c", d, "/d"};
+    EXPECT(m2.open_segment("x.seg") && m2.degraded() && m2.leg_live(0));
+    c.open_ok = false;
+    MirrorBackend m3{c, "/c", d, "/d"};
+    EXPECT(!m3.open_segment("x.seg") && !m3.degraded() && !m3.failed());
+}
+
+TEST(test_recover_mirror_keeps_longer_tail)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string a = dir + "/ssd";
+    const std::string b = dir + "/sd";
+    EXPECT(::mkdir(a.c_str(), 0755) == 0 && ::mkdir(b.c_str(), 0755) == 0);
+    const std::string s1 = "/00000001_00000001.seg";
+    const std::string s2 = "/00000001_00000002.seg";
+
+    // Crash: the SSD got further in segment 1 but tore its last write; the
+    // SD card lags there and alone holds the start of segment 2.
+    EXPECT(write_valid_segment(a + s1, 1, 100));
+    {
+        FILE* f = std::fopen((a + s1).c_str(), "ab");
+        EXPECT(f != nullptr);
+        const char torn[40] = {2, 9, 9};
+        EXPECT(std::fwrite(torn, sizeof(torn), 1, f) == 1);
+        std::fclose(f);
+    }
+    EXPECT(write_valid_segment(b + s1, 1, 60));
+    EXPECT(write_valid_segment(b + s2, 101, 10));
+
+    wal::internal::MirrorRecoveryResult res{};
+    EXPECT(wal::internal::recover_mirror(a.c_str(), b.c_str(), res, 32));
+    EXPECT(res.repaired[0] == 2u && res.repaired[1] == 1u);
+    EXPECT(res.wal.segments == 2u && res.wal.records == 110u && res.wal.next_global_seq == 111u);
+    for (const std::string& d : {a, b}) {
+        EXPECT(file_size(d + s1) == 100u * sizeof(LogRecordV2));
+        EXPECT(verify_segment(d + s1, 1, 100));
+        EXPECT(verify_segment(d + s2, 101, 10));
+    }
+
+    // Reconciled: a second pass has nothing to do.
+    EXPECT(wal::internal::recover_mirror(a.c_str(), b.c_str(), res, 32));
+    EXPECT(res.repaired[0] == 0u && res.repaired[1] == 0u && res.wal.records == 110u);
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// StagingBackend
+// ---------------------------------------------------------------------------
+
+TEST(test_staging_backend_promotes_whole_pages)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string stage = dir + "/staging.ring";
+
+    auto file = std::make_unique<FileBackend>();
+    StagingBackendConfig cfg{};
+    cfg.ring_pages = 4;
+    cfg.lock = false;
+    auto s = std::make_unique<StagingBackend>(*file, stage.c_str(), cfg);
+    EXPECT(s->available());
+    EXPECT(s->open_segment(seg.c_str()));
+
+    // Committed to RAM only; the mover hands over the one full page.
+    EXPECT(submit_range(*s, 1, 100));
+    EXPECT(s->durable() == 100u && s->persisted() == 0u && file_size(seg) == 0u);
+    EXPECT(s->poll() == 100u);
+    EXPECT(s->promoted_pages() == 1u && s->persisted() == 64u);
+    EXPECT(s->drain() == 100u && s->persisted() == 100u);
+
+    // More than the ring holds: submit() promotes synchronously.
+    EXPECT(submit_range(*s, 101, 1000));
+    EXPECT(s->durable() == 1100u && s->persisted() >= 1100u - 4u * 64u);
+    s->close_segment();
+    EXPECT(s->persisted() == 1100u && !s->failed());
+    EXPECT(verify_segment(seg, 1, 1100));
+
+    remove_tree(dir);
+}
+
+TEST(test_staging_mover_rate_limit)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    ManualBackend leg;
+    StagingBackendConfig cfg{};
+    cfg.ring_pages = 16;
+    cfg.promote_pages_per_sec = 10;
+    cfg.promote_burst_pages = 2;
+    cfg.lock = false;
+    StagingBackend s{leg, (dir + "/staging.ring").c_str(), cfg};
+    EXPECT(s.open_segment("00000001_00000001.seg"));
+
+    EXPECT(submit_range(s, 1, 10 * 64));
+    (void)s.poll(); // no time has passed: no budget yet
+    EXPECT(s.promoted_pages() <= 1u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    const uint64_t before = s.promoted_pages();
+    (void)s.poll(); // budget capped at the burst
+    EXPECT(s.promoted_pages() - before == 2u);
+    EXPECT(leg.submitted == s.promoted_pages() * 64u);
+
+    // drain() does not wait for the rate: everything, partial page included.
+    EXPECT(submit_range(s, 10 * 64 + 1, 5));
+    (void)s.drain();
+    EXPECT(leg.submitted == 10u * 64u + 5u);
+
+    remove_tree(dir);
+}
+
+TEST(test_recover_staging_stitches_tiers)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string stage = dir + "/staging.ring";
+
+    {
+        // The persistent leg never completes: the crash leaves the segment
+        // with 150 records (and a torn write), the staging ring with 200.
+        ManualBackend leg;
+        StagingBackendConfig cfg{};
+        cfg.ring_pages = 8;
+        cfg.lock = false;
+        StagingBackend s{leg, stage.c_str(), cfg};
+        EXPECT(s.open_segment(seg.c_str()));
+        LogRecordV2 recs[200];
+        for (uint64_t i = 0; i < 200; ++i) {
+            recs[i] = make_record(1 + i);
+            recs[i].crc32 = wal::record_crc(recs[i]);
+        }
+        EXPECT(s.submit(recs, 200));
+    }
+    EXPECT(write_valid_segment(seg, 1, 150));
+    {
+        FILE* f = std::fopen(seg.c_str(), "ab");
+        EXPECT(f != nullptr);
+        const char torn[24] = {2, 7};
+        EXPECT(std::fwrite(torn, sizeof(torn), 1, f) == 1);
+        std::fclose(f);
+    }
+
+    wal::internal::StagingRecoveryResult res{};
+    EXPECT(wal::internal::recover_staging(stage.c_str(), res, 32));
+    EXPECT(res.segment == seg && res.segment_records == 150u && res.stitched == 50u);
+    EXPECT(res.found && res.last_seq == 200u && res.next_global_seq == 201u);
+    EXPECT(verify_segment(seg, 1, 200));
+
+    // Idempotent; no staging file (tmpfs lost with power) stitches nothing.
+    EXPECT(wal::internal::recover_staging(stage.c_str(), res, 32));
+    EXPECT(res.stitched == 0u && res.segment_records == 200u && res.next_global_seq == 201u);
+    EXPECT(::unlink(stage.c_str()) == 0);
+    EXPECT(wal::internal::recover_staging(stage.c_str(), res, 32));
+    EXPECT(res.segment.empty() && res.stitched == 0u);
+
+    remove_tree(dir);
+}
+
+TEST(test_recover_staging_stops_at_gap)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string stage = dir + "/staging.ring";
+
+    {
+        ManualBackend leg;
+        StagingBackendConfig cfg{};
+        cfg.ring_pages = 8;
+        cfg.lock = false;
+        StagingBackend s{leg, stage.c_str(), cfg};
+        EXPECT(s.open_segment(seg.c_str()));
+        LogRecordV2 recs[200];
+        for (uint64_t i = 0; i < 200; ++i) {
+            recs[i] = make_record(1 + i);
+            recs[i].crc32 = wal::record_crc(recs[i]);
+        }
+        EXPECT(s.submit(recs, 200));
+    }
+    EXPECT(write_valid_segment(seg, 1, 150));
+
+    // Corrupt the slot holding global_seq 170: records 171..200 lie past a
+    // hole and must not be stitched.
+    {
+        FILE* f = std::fopen(stage.c_str(), "r+b");
+        EXPECT(f != nullptr);
+        bool hit = false;
+        LogRecordV2 r{};
+        for (long off = static_cast<long>(wal::internal::kStagingHeaderBytes);
+             !hit && std::fseek(f, off, SEEK_SET) == 0 && std::fread(&r, sizeof(r), 1, f) == 1;
+             off += static_cast<long>(sizeof(r))) {
+            if (wal::record_valid(r) && r.global_seq == 170) {
+                r.payload[0] ^= 0xFF;
+                EXPECT(std::fseek(f, off, SEEK_SET) == 0);
+                EXPECT(std::fwrite(&r, sizeof(r), 1, f) == 1);
+                hit = true;
+            }
+        }
+        std::fclose(f);
+        EXPECT(hit);
+    }
+
+    wal::internal::StagingRecoveryResult res{};
+    EXPECT(wal::internal::recover_staging(stage.c_str(), res, 32));
+    EXPECT(res.segment_records == 150u && res.stitched == 19u);
+    EXPECT(res.last_seq == 169u && res.next_global_seq == 170u);
+    EXPECT(verify_segment(seg, 1, 169));
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+TEST(test_writer_batches_into_backend)
+{
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+
+    std::unique_ptr<Backend> b;
+    {
+        auto u = std::make_unique<IoUringBackend>();
+        if (u->available())
+            b = std::move(u);
+        else
+            b = std::make_unique<FileBackend>();
+    }
+    EXPECT(b->open_segment(seg.c_str()));
+
+    auto w = std::make_unique<Writer>(*b);
+    const uint64_t total = Writer::kBatchRecords * 3 + 17;
+    for (uint64_t i = 1; i <= total; ++i)
+        EXPECT(w->push(make_record(i)));
+    EXPECT(w->pushed() == total);
+    EXPECT(b->drain() == Writer::kBatchRecords * 3); // partial batch still staged
+    EXPECT(w->flush());
+    EXPECT(b->drain() == total);
+    EXPECT(w->durable() == total);
+    b->close_segment();
+    EXPECT(verify_segment(seg, 1, total));
+
+    remove_tree(dir);
+}
+
+TEST(test_writer_full_batch_without_segment)
+{
+    // No segment open: submit() fails without a sticky failure. The record
+    // that fills the batch is still staged; the full batch must stay put and
+    // later pushes must be refused, not overrun it.
+    FileBackend b;
+    auto w = std::make_unique<Writer>(b);
+    for (uint64_t i = 1; i <= Writer::kBatchRecords; ++i)
+        EXPECT(w->push(make_record(i)));
+    EXPECT(!w->failed());
+    EXPECT(!w->flush());
+    for (uint64_t i = 1; i <= 3 * Writer::kBatchRecords; ++i)
+        EXPECT(!w->push(make_record(Writer::kBatchRecords + i)));
+    EXPECT(w->pushed() == Writer::kBatchRecords);
+
+    // Once a segment opens, the staged batch goes out and pushing resumes.
+    const std::string dir = make_tmp_dir("wal_backend");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    EXPECT(b.open_segment(seg.c_str()));
+    EXPECT(w->push(make_record(Writer::kBatchRecords + 1)));
+    EXPECT(w->flush());
+    EXPECT(b.drain() == Writer::kBatchRecords + 1);
+    b.close_segment();
+    EXPECT(verify_segment(seg, 1, Writer::kBatchRecords + 1));
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void backend_tests()
+{
+    std::printf("\n--- backend ---\n");
+
+    RUN(test_file_backend_roundtrip);
+    RUN(test_file_backend_open_failure);
+    RUN(test_uring_backend_roundtrip);
+    RUN(test_uring_backend_segment_switch);
+    RUN(test_uring_backend_durable_is_contiguous);
+    RUN(test_uring_backend_open_failure);
+    RUN(test_direct_backend_roundtrip);
+    RUN(test_direct_backend_rewrites_only_tail_page);
+    RUN(test_direct_backend_resumes_after_padding);
+    RUN(test_direct_backend_resumes_at_torn_record);
+    RUN(test_mirror_backend_writes_both_legs);
+    RUN(test_mirror_backend_durable_is_minimum);
+    RUN(test_recover_mirror_keeps_longer_tail);
+    RUN(test_staging_backend_promotes_whole_pages);
+    RUN(test_staging_mover_rate_limit);
+    RUN(test_recover_staging_stitches_tiers);
+    RUN(test_recover_staging_stops_at_gap);
+    RUN(test_writer_batches_into_backend);
+    RUN(test_writer_full_batch_without_segment);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
@@ -0,0 +1,328 @@
+#include "checkpoint/checkpoint.hpp"
+#include "model/channel_wrapper.hpp"
+#include "stam/primitives/dbl_buffer_seqlock.hpp"
+#include "stam/primitives/spmc_snapshot_smp.hpp"
+#include "test_harness.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+using wal::LogRecordV2;
+using wal::internal::Checkpoint;
+using wal::internal::CheckpointAssembler;
+using wal::internal::CheckpointBuilder;
+using wal::internal::CheckpointExt;
+using wal::internal::CheckpointPort;
+using wal::internal::CheckpointRecovery;
+using wal::internal::CheckpointSource;
+using wal::internal::CheckpointStamp;
+using wal::internal::SnapshotResult;
+using stam::model::BindResult;
+using stam::model::PortName;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static std::string segment_name(const std::string& dir, unsigned part)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "/00000001_%08x.seg", part);
+    return dir + name;
+}
+
+namespace {
+
+struct ControllerState {
+    uint64_t mode;
+    double setpoints[8];
+    uint32_t counters[5];
+};
+
+struct ValveState {
+    uint16_t position;
+    uint8_t open;
+    uint8_t spare;
+};
+
+using controller_channel_t = stam::model::ChannelWrapper<stam::primitives::SPMCSnapshotSmp<ControllerState, 1>>;
+using valve_channel_t = stam::model::ChannelWrapper<stam::primitives::DoubleBufferSeqLock<ValveState>>;
+
+inline constexpr PortName kPortController{"CTL0"};
+inline constexpr PortName kPortValve{"VLV0"};
+constexpr uint8_t kChannelController = 10;
+constexpr uint8_t kChannelValve = 11;
+
+// Producer side of the state channels (stands in for the RT tasks).
+struct Publisher {
+    BindResult bind_port(PortName name, controller_channel_t::writer_t&& w) noexcept
+    {
+        if (!(name == kPortController))
+            return BindResult::unknown_port;
+        controller.emplace(std::move(w));
+        return BindResult::ok;
+    }
+
+    BindResult bind_port(PortName name, valve_channel_t::writer_t&& w) noexcept
+    {
+        if (!(name == kPortValve))
+            return BindResult::unknown_port;
+        valve.emplace(std::move(w));
+        return BindResult::ok;
+    }
+
+    std::optional<controller_channel_t::writer_t> controller;
+    std::optional<valve_channel_t::writer_t> valve;
+};
+
+struct Graph {
+    Graph()
+    {
+        EXPECT(controller.bind_writer(publisher, kPortController) == BindResult::ok);
+        EXPECT(controller.bind_reader(controller_port, kPortController) == BindResult::ok);
+        EXPECT(valve.bind_writer(publisher, kPortValve) == BindResult::ok);
+        EXPECT(valve.bind_reader(valve_port, kPortValve) == BindResult::ok);
+        EXPECT(controller.is_fully_bound() && valve.is_fully_bound());
+        EXPECT(builder.add(kChannelController, controller_port.source()));
+        EXPECT(builder.add(kChannelValve, valve_port.source()));
+        EXPECT(!builder.add(kChannelValve, valve_port.source()));
+    }
+
+    controller_channel_t controller;
+    valve_channel_t valve;
+    Publisher publisher;
+    CheckpointPort<controller_channel_t::reader_t, ControllerState> controller_port{kPortController};
+    CheckpointPort<valve_channel_t::reader_t, ValveState> valve_port{kPortValve};
+    CheckpointBuilder builder;
+};
+
+// Reader whose reads succeed `good` times and then always lose the race.
+struct FlakyReader {
+    int good = 0;
+    int reads = 0;
+
+    bool try_read(ValveState& out) noexcept
+    {
+        ++reads;
+        if (good == 0)
+            return false;
+        --good;
+        out = ValveState{1, 1, 0};
+        return true;
+    }
+};
+
+SnapshotResult always_failed(void*, uint8_t*) noexcept
+{
+    return SnapshotResult::Failed;
+}
+
+} // namespace
+
+static ControllerState controller_at(uint64_t k)
+{
+    ControllerState s{};
+    s.mode = k;
+    for (int i = 0; i < 8; ++i)
+        s.setpoints[i] = static_cast<double>(k) * 0.5 + i;
+    for (int i = 0; i < 5; ++i)
+        s.counters[i] = static_cast<uint32_t>(k * 7 + i);
+    return s;
+}
+
+static LogRecordV2 event_record(uint64_t seq) { return sealed_record(seq, seq, 1); }
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_build_and_reassemble)
+{
+    Graph g;
+    std::vector<LogRecordV2> recs;
+    CheckpointStamp stamp;
+    stamp.id = 7;
+    stamp.first_seq = 500;
+    stamp.ts = 12345;
+
+    // Neither channel has published yet: both are left out, nothing to write.
+    EXPECT(g.builder.build(stamp, recs) == 0u && recs.empty());
+
+    const ControllerState cs = controller_at(3);
+    const ValveState vs{321, 1, 0};
+    g.publisher.controller->write(cs);
+    g.publisher.valve->write(vs);
+    const size_t n = g.builder.build(stamp, recs);
+    const size_t expect = (sizeof(ControllerState) + 10) / 11 + (sizeof(ValveState) + 10) / 11;
+    EXPECT(n == expect && recs.size() == n);
+
+    for (size_t i = 0; i < n; ++i) {
+        CheckpointExt e{};
+        EXPECT(wal::record_valid(recs[i]));
+        EXPECT(wal::internal::checkpoint_ext(recs[i], e));
+        EXPECT(e.id == 7u && e.index == i && e.count == n);
+        EXPECT(recs[i].global_seq == 500 + i && recs[i].commit_ts == 12345u);
+    }
+    CheckpointExt none{};
+    EXPECT(!wal::internal::checkpoint_ext(event_record(1), none));
+
+    CheckpointAssembler a;
+    for (size_t i = 0; i < n; ++i)
+        EXPECT(a.feed(recs[i]) == (i + 1 == n));
+    const Checkpoint& cp = a.last();
+    EXPECT(cp.id == 7u && cp.first_seq == 500u && cp.last_seq == 500 + n - 1 && cp.ts == 12345u);
+    EXPECT(cp.channels.size() == 2u);
+    const std::vector<uint8_t>* c = cp.state(kChannelController);
+    const std::vector<uint8_t>* v = cp.state(kChannelValve);
+    EXPECT(c != nullptr && c->size() == sizeof(cs) && std::memcmp(c->data(), &cs, sizeof(cs)) == 0);
+    EXPECT(v != nullptr && v->size() == sizeof(vs) && std::memcmp(v->data(), &vs, sizeof(vs)) == 0);
+    EXPECT(cp.state(99) == nullptr);
+
+    // A gap or an interleaved record discards the checkpoint in progress.
+    CheckpointAssembler b;
+    for (size_t i = 0; i < n; ++i) {
+        if (i == 3)
+            EXPECT(!b.feed(event_record(503)));
+        EXPECT(!b.feed(recs[i]));
+    }
+    EXPECT(!b.found() && !b.pending());
+}
+
+TEST(test_failed_read_fails_build)
+{
+    Graph g;
+    g.publisher.controller->write(controller_at(1));
+    g.publisher.valve->write(ValveState{5, 1, 0});
+    EXPECT(g.builder.add(12, CheckpointSource{nullptr, 4, always_failed}));
+
+    // One unreadable channel: no checkpoint at all, nothing appended.
+    std::vector<LogRecordV2> recs;
+    recs.push_back(event_record(1));
+    CheckpointStamp stamp;
+    EXPECT(g.builder.build(stamp, recs) == 0u);
+    EXPECT(recs.size() == 1u);
+
+    // Port: "nothing published" only on the primitive's word; misses of a
+    // reader that cannot tell are failures, first read or not.
+    using Port = CheckpointPort<FlakyReader, ValveState>;
+    Port port{kPortValve};
+    ValveState v{};
+    EXPECT(port.snapshot(v) == SnapshotResult::Failed);
+    EXPECT(port.bind_port(kPortValve, FlakyReader{}) == BindResult::ok);
+    EXPECT(port.snapshot(v) == SnapshotResult::Failed);
+
+    // Real primitives: unpublished channels are Empty and left out; a
+    // published one is taken.
+    Graph fresh;
+    ControllerState cs{};
+    EXPECT(fresh.controller_port.snapshot(cs) == SnapshotResult::Empty);
+    EXPECT(fresh.valve_port.snapshot(v) == SnapshotResult::Empty);
+    fresh.publisher.valve->write(ValveState{9, 0, 0});
+    EXPECT(fresh.valve_port.snapshot(v) == SnapshotResult::Taken && v.position == 9);
+    EXPECT(fresh.builder.build(stamp, recs) > 0u);
+    recs.resize(1);
+
+    Port flaky{kPortValve};
+    EXPECT(flaky.bind_port(kPortValve, FlakyReader{1, 0}) == BindResult::ok);
+    EXPECT(flaky.snapshot(v) == SnapshotResult::Taken && v.position == 1);
+    EXPECT(flaky.snapshot(v) == SnapshotResult::Failed);
+
+    CheckpointBuilder b;
+    EXPECT(b.add(kChannelValve, flaky.source()));
+    EXPECT(b.build(stamp, recs) == 0u);
+    EXPECT(recs.size() == 1u);
+}
+
+TEST(test_recovery_starts_from_last_complete_checkpoint)
+{
+    const std::string dir = make_tmp_dir("wal_checkpoint");
+    Graph g;
+
+    // 8 segments of 1000 records; a checkpoint every 1500 records, starting
+    // 5 records before a roll every other time. The last one is torn.
+    std::vector<LogRecordV2> wal;
+    uint32_t id = 0;
+    std::vector<ControllerState> states;
+    while (wal.size() < 8000) {
+        const uint64_t seq = wal.size();
+        if (seq % 1500 == 1495) {
+            states.push_back(controller_at(id));
+            g.publisher.controller->write(states.back());
+            g.publisher.valve->write(ValveState{static_cast<uint16_t>(id), 0, 0});
+            CheckpointStamp stamp;
+            stamp.id = id++;
+            stamp.first_seq = seq;
+            stamp.ts = seq;
+            EXPECT(g.builder.build(stamp, wal) > 0u);
+        } else {
+            wal.push_back(event_record(seq));
+        }
+    }
+    // Checkpoints start at 1495, 2995, 4495, 5995 and 7495; tear the last
+    // one after its second record.
+    wal.resize(7497);
+    for (unsigned s = 0; s < 8; ++s) {
+        const size_t from = s * 1000u;
+        const size_t to = from + 1000u < wal.size() ? from + 1000u : wal.size();
+        write_records(segment_name(dir, s + 1),
+                      std::vector<LogRecordV2>(wal.begin() + static_cast<long>(from), wal.begin() + static_cast<long>(to)));
+    }
+
+    CheckpointRecovery rec;
+    EXPECT(wal::internal::recover_checkpoint(dir.c_str(), rec));
+    EXPECT(rec.found && rec.wal_found && rec.next_global_seq == 7497u);
+    EXPECT(rec.checkpoint.id == 3u && rec.checkpoint.first_seq == 5995u);
+    EXPECT(rec.resume_seq == rec.checkpoint.last_seq + 1 && rec.resume_seq > 6000u);
+    const std::vector<uint8_t>* c = rec.checkpoint.state(kChannelController);
+    EXPECT(c != nullptr && std::memcmp(c->data(), &states[3], sizeof(ControllerState)) == 0);
+    // Segments 8, 7 and 6 (plus 7's leading fragment) — not the whole WAL.
+    EXPECT(rec.segments_scanned == 3u && rec.records_scanned < 3000u);
+
+    remove_tree(dir);
+}
+
+TEST(test_recovery_without_checkpoint)
+{
+    const std::string dir = make_tmp_dir("wal_checkpoint");
+    std::vector<LogRecordV2> a;
+    std::vector<LogRecordV2> b;
+    for (uint64_t s = 100; s < 200; ++s)
+        a.push_back(event_record(s));
+    for (uint64_t s = 200; s < 250; ++s)
+        b.push_back(event_record(s));
+    write_records(segment_name(dir, 1), a);
+    write_records(segment_name(dir, 2), b);
+
+    CheckpointRecovery rec;
+    EXPECT(wal::internal::recover_checkpoint(dir.c_str(), rec));
+    EXPECT(!rec.found && rec.wal_found);
+    EXPECT(rec.resume_seq == 100u && rec.next_global_seq == 250u);
+    EXPECT(rec.segments_scanned == 2u && rec.records_scanned == 150u);
+
+    EXPECT(!wal::internal::recover_checkpoint((dir + "/missing").c_str(), rec));
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void checkpoint_tests()
+{
+    std::printf("\n--- checkpoint ---\n");
+
+    RUN(test_build_and_reassemble);
+    RUN(test_failed_read_fails_build);
+    RUN(test_recovery_starts_from_last_complete_checkpoint);
+    RUN(test_recovery_without_checkpoint);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
@@ -0,0 +1,138 @@
+#include "codec/record_codec.hpp"
+#include "test_harness.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using wal::LogRecordV2;
+using wal::internal::CrcKernel;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static LogRecordV2 sample_record(uint64_t k)
+{
+    LogRecordV2 r{};
+    r.version = wal::kLogRecordVersion;
+    r.event_type = static_cast<uint8_t>(k * 3);
+    r.flags = static_cast<uint8_t>(k >> 2);
+    r.producer_id = static_cast<uint8_t>(k % 7);
+    r.global_seq = k * 0x9E3779B97F4A7C15ull;
+    r.commit_ts = k * 11;
+    r.event_ts = k * 13;
+    r.producer_seq = ~k;
+    for (size_t i = 0; i < sizeof(r.reserved); ++i)
+        r.reserved[i] = static_cast<uint8_t>(k + i);
+    for (size_t i = 0; i < sizeof(r.payload); ++i)
+        r.payload[i] = static_cast<uint8_t>(k * 5 + i);
+    return r;
+}
+
+static uint64_t le64_at(const uint8_t* b, size_t off)
+{
+    uint64_t v = 0;
+    for (size_t i = 0; i < 8; ++i)
+        v |= static_cast<uint64_t>(b[off + i]) << (8 * i);
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_byte_layout_and_roundtrip)
+{
+    LogRecordV2 r{};
+    r.version = wal::kLogRecordVersion;
+    r.event_type = 0x21;
+    r.flags = 0x42;
+    r.producer_id = 0x63;
+    r.global_seq = 0x0102030405060708ull;
+    r.commit_ts = 0x1112131415161718ull;
+    r.event_ts = 0x2122232425262728ull;
+    r.producer_seq = 0x3132333435363738ull;
+    r.reserved[0] = 0xA0;
+    r.reserved[9] = 0xA9;
+    r.payload[0] = 0xB0;
+    r.payload[13] = 0xBD;
+
+    uint8_t b[wal::internal::kRecordBytes];
+    const uint32_t crc = wal::internal::encode_record(r, b);
+    EXPECT(crc == wal::record_crc(r));
+    EXPECT(b[0] == static_cast<uint8_t>(crc) && b[3] == static_cast<uint8_t>(crc >> 24));
+    EXPECT(b[4] == wal::kLogRecordVersion && b[5] == 0x21 && b[6] == 0x42 && b[7] == 0x63);
+    EXPECT(b[8] == 0x08 && b[15] == 0x01);
+    EXPECT(le64_at(b, 16) == r.commit_ts && le64_at(b, 24) == r.event_ts && le64_at(b, 32) == r.producer_seq);
+    EXPECT(b[40] == 0xA0 && b[49] == 0xA9 && b[50] == 0xB0 && b[63] == 0xBD);
+
+    LogRecordV2 back{};
+    EXPECT(wal::internal::decode_record(b, back));
+    r.crc32 = crc;
+    EXPECT(std::memcmp(&back, &r, sizeof(r)) == 0);
+
+    b[33] ^= 0x10;
+    EXPECT(!wal::internal::decode_record(b, back));
+    b[33] ^= 0x10;
+    b[4] = 3;
+    EXPECT(!wal::internal::decode_record(b, back));
+}
+
+TEST(test_batch_kernels_match_reference)
+{
+    const CrcKernel kernels[] = {CrcKernel::Auto, CrcKernel::Table, CrcKernel::Sse42, CrcKernel::ArmCrc};
+    EXPECT(wal::internal::crc_kernel_available(wal::internal::best_crc_kernel()));
+    std::printf("(best=%s) ", wal::internal::crc_kernel_name(wal::internal::best_crc_kernel()));
+
+    for (CrcKernel k : kernels) {
+        if (!wal::internal::crc_kernel_available(k))
+            continue;
+        // Counts around the 3-way interleave and the internal batch size.
+        for (size_t n : {size_t{0}, size_t{1}, size_t{2}, size_t{3}, size_t{4}, size_t{5}, size_t{191}, size_t{192}, size_t{193}, size_t{1000}}) {
+            std::vector<LogRecordV2> recs(n);
+            for (size_t i = 0; i < n; ++i)
+                recs[i] = sample_record(i + n);
+
+            std::vector<uint8_t> bytes(n * wal::internal::kRecordBytes);
+            wal::internal::encode_records(recs.data(), n, bytes.data(), k);
+            wal::internal::seal_records(recs.data(), n, k);
+            bool ok = true;
+            for (size_t i = 0; i < n; ++i) {
+                uint8_t one[wal::internal::kRecordBytes];
+                ok = ok && recs[i].crc32 == wal::record_crc(recs[i]);
+                ok = ok && wal::internal::encode_record(recs[i], one) == recs[i].crc32;
+                ok = ok && std::memcmp(one, bytes.data() + i * wal::internal::kRecordBytes, sizeof(one)) == 0;
+            }
+            EXPECT(ok);
+            EXPECT(wal::internal::valid_prefix(recs.data(), n, k) == n);
+
+            if (n > 4) {
+                const size_t bad = n - 3;
+                recs[bad].payload[7] ^= 1;
+                EXPECT(wal::internal::valid_prefix(recs.data(), n, k) == bad);
+                recs[bad].payload[7] ^= 1;
+                recs[1].version = 1;
+                EXPECT(wal::internal::valid_prefix(recs.data(), n, k) == 1u);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void codec_tests()
+{
+    std::printf("\n--- codec ---\n");
+
+    RUN(test_byte_layout_and_roundtrip);
+    RUN(test_batch_kernels_match_reference);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
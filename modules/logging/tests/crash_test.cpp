@@ -0,0 +1,370 @@
+#include "backend/backend.hpp"
+#include "codec/record_codec.hpp"
+#include "recovery/recovery.hpp"
+#include "test_harness.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using wal::LogRecordV2;
+using wal::internal::Backend;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// Crash-consistency fault injection.
+//
+// CrashBackend records what a device would see — page writes between
+// fdatasync barriers — instead of doing I/O. A crash point picks a barrier
+// interval, lands an arbitrary subset of its page writes in arbitrary order,
+// tears some of them (sector prefix, byte prefix, or a scattered subset of
+// sectors) and picks the file size before or after the interval. The §11
+// scanner then runs over the image and the invariants are checked:
+//  - every acknowledged record is in the valid prefix;
+//  - the valid prefix is exactly what was written (no false-valid tail);
+//  - global_seq increases along the prefix.
+//
+// WAL_CRASH_POINTS=<n> runs a longer fuzz loop than the default.
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr uint32_t kPageBytes = 4096;
+constexpr uint32_t kSectorBytes = 512;
+constexpr uint64_t kSegmentRecords = 1024;  // 64 KiB per workload
+constexpr uint64_t kMaxBatch = 150;
+
+enum class Tear : uint8_t {
+    Sector,   // a prefix of the page's sectors (sector-atomic device)
+    Byte,     // a prefix of the page's bytes
+    Scatter,  // any subset of the page's sectors (reordered sector writes)
+};
+
+struct Rng {
+    uint64_t s;
+    uint64_t next() noexcept
+    {
+        s += 0x9E3779B97F4A7C15ull;
+        uint64_t z = s;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    uint64_t below(uint64_t n) noexcept { return next() % n; }
+};
+
+// Backend over a device model: submit() is "pwrite + fdatasync" expressed as
+// whole-page writes followed by a barrier. `padded` pages are zero-filled to
+// the page boundary and the file size is page-aligned (DirectFileBackend);
+// otherwise the size ends at the last record (FileBackend).
+class CrashBackend final : public Backend {
+public:
+    struct PageWrite {
+        uint64_t page;
+        size_t data;   // offset of the page contents in pool_
+    };
+
+    struct Epoch {
+        size_t first_op = 0;
+        size_t end_op = 0;
+        uint64_t size_before = 0;
+        uint64_t size_after = 0;
+        uint64_t acked_before = 0;   // records acknowledged when the interval starts
+    };
+
+    explicit CrashBackend(bool padded) noexcept : padded_(padded) {}
+
+    bool open_segment(const char*) noexcept override
+    {
+        file_.clear();
+        pool_.clear();
+        ops_.clear();
+        epochs_.clear();
+        acked_ = 0;
+        open_ = true;
+        return true;
+    }
+
+    bool submit(const LogRecordV2* records, size_t count) noexcept override
+    {
+        if (!open_)
+            return false;
+        Epoch e{};
+        e.first_op = ops_.size();
+        e.size_before = size_;
+        e.acked_before = acked_;
+
+        const uint64_t from = file_.size();
+        const auto* p = reinterpret_cast<const uint8_t*>(records);
+        file_.insert(file_.end(), p, p + count * sizeof(LogRecordV2));
+        const uint64_t to = file_.size();
+        for (uint64_t page = from / kPageBytes; page * kPageBytes < to; ++page) {
+            const size_t at = pool_.size();
+            pool_.resize(at + kPageBytes, 0);
+            const uint64_t end = (page + 1) * kPageBytes < to ? (page + 1) * kPageBytes : to;
+            std::memcpy(pool_.data() + at, file_.data() + page * kPageBytes, end - page * kPageBytes);
+            ops_.push_back(PageWrite{page, at});
+        }
+        size_ = padded_ ? (to + kPageBytes - 1) / kPageBytes * kPageBytes : to;
+
+        e.end_op = ops_.size();
+        e.size_after = size_;
+        epochs_.push_back(e);
+        acked_ += count;
+        return true;
+    }
+
+    uint64_t poll() noexcept override { return acked_; }
+    uint64_t drain() noexcept override { return acked_; }
+    void close_segment() noexcept override { open_ = false; }
+    [[nodiscard]] uint64_t durable() const noexcept override { return acked_; }
+    [[nodiscard]] bool failed() const noexcept override { return false; }
+
+    [[nodiscard]] const std::vector<uint8_t>& written() const noexcept { return file_; }
+    [[nodiscard]] const std::vector<Epoch>& epochs() const noexcept { return epochs_; }
+    [[nodiscard]] const PageWrite& op(size_t i) const noexcept { return ops_[i]; }
+    [[nodiscard]] const uint8_t* page_data(const PageWrite& w) const noexcept { return pool_.data() + w.data; }
+    [[nodiscard]] uint64_t max_size() const noexcept { return size_ + kPageBytes; }
+
+private:
+    bool padded_;
+    bool open_ = false;
+    std::vector<uint8_t> file_;     // records in submission order (page cache view)
+    std::vector<uint8_t> pool_;     // page contents per write
+    std::vector<PageWrite> ops_;
+    std::vector<Epoch> epochs_;
+    uint64_t size_ = 0;
+    uint64_t acked_ = 0;
+};
+
+// Crash points over one recorded workload.
+class CrashSim {
+public:
+    explicit CrashSim(const CrashBackend& dev) : dev_(dev)
+    {
+        // Media image at the start of each barrier interval.
+        const size_t bytes = dev.max_size() / sizeof(LogRecordV2) * sizeof(LogRecordV2) + kPageBytes;
+        std::vector<uint8_t> image(bytes, 0);
+        for (const auto& e : dev.epochs()) {
+            starts_.push_back(image);
+            for (size_t i = e.first_op; i < e.end_op; ++i)
+                std::memcpy(image.data() + dev.op(i).page * kPageBytes, dev.page_data(dev.op(i)), kPageBytes);
+        }
+        work_.resize(bytes / sizeof(LogRecordV2));
+        order_.reserve(64);
+    }
+
+    struct Outcome {
+        uint64_t prefix = 0;
+        uint64_t acked = 0;
+        uint64_t bytes = 0;   // file size after the crash
+    };
+
+    // One crash point; EXPECTs the invariants.
+    Outcome crash(Rng& rng, Tear tear)
+    {
+        const auto& epochs = dev_.epochs();
+        const auto& e = epochs[rng.below(epochs.size())];
+        auto* img = reinterpret_cast<uint8_t*>(work_.data());
+        const std::vector<uint8_t>& start = starts_[static_cast<size_t>(&e - epochs.data())];
+        std::memcpy(img, start.data(), e.size_after + kPageBytes);
+
+        order_.clear();
+        for (size_t i = e.first_op; i < e.end_op; ++i)
+            order_.push_back(i);
+        for (size_t i = order_.size(); i > 1; --i)
+            std::swap(order_[i - 1], order_[rng.below(i)]);
+
+        for (const size_t i : order_) {
+            const auto& w = dev_.op(i);
+            uint8_t* dst = img + w.page * kPageBytes;
+            const uint8_t* src = dev_.page_data(w);
+            switch (rng.below(4)) {
+            case 0:
+                break; // never reached the media
+            case 1:
+                tear_page(rng, tear, dst, src);
+                break;
+            default:
+                std::memcpy(dst, src, kPageBytes);
+                break;
+            }
+        }
+
+        // The size update is a separate metadata write: either side of it.
+        Outcome out{};
+        out.bytes = rng.below(2) != 0 ? e.size_after : e.size_before;
+        out.acked = e.acked_before;
+        const size_t n = static_cast<size_t>(out.bytes / sizeof(LogRecordV2));
+        out.prefix = wal::internal::valid_prefix(work_.data(), n);
+
+        EXPECT(out.prefix >= out.acked);
+        EXPECT(out.prefix * sizeof(LogRecordV2) <= dev_.written().size());
+        EXPECT(std::memcmp(img, dev_.written().data(), out.prefix * sizeof(LogRecordV2)) == 0);
+        for (uint64_t i = 1; i < out.prefix; ++i)
+            EXPECT(work_[i].global_seq > work_[i - 1].global_seq);
+        return out;
+    }
+
+    // The image of the last crash point.
+    [[nodiscard]] const uint8_t* image() const noexcept { return reinterpret_cast<const uint8_t*>(work_.data()); }
+
+private:
+    static void tear_page(Rng& rng, Tear tear, uint8_t* dst, const uint8_t* src) noexcept
+    {
+        switch (tear) {
+        case Tear::Sector:
+            std::memcpy(dst, src, rng.below(kPageBytes / kSectorBytes) * kSectorBytes);
+            break;
+        case Tear::Byte:
+            std::memcpy(dst, src, rng.below(kPageBytes));
+            break;
+        case Tear::Scatter: {
+            const uint64_t mask = rng.next();
+            for (uint32_t s = 0; s < kPageBytes / kSectorBytes; ++s) {
+                if ((mask >> s) & 1u)
+                    std::memcpy(dst + s * kSectorBytes, src + s * kSectorBytes, kSectorBytes);
+            }
+            break;
+        }
+        }
+    }
+
+    const CrashBackend& dev_;
+    std::vector<std::vector<uint8_t>> starts_;
+    std::vector<LogRecordV2> work_;
+    std::vector<size_t> order_;
+};
+
+// Sealed records with consecutive global_seq, submitted in random batches.
+void run_workload(Rng& rng, Backend& b)
+{
+    EXPECT(b.open_segment("crash.seg"));
+    LogRecordV2 batch[kMaxBatch];
+    for (uint64_t seq = 1; seq <= kSegmentRecords;) {
+        uint64_t n = 1 + rng.below(kMaxBatch);
+        if (n > kSegmentRecords + 1 - seq)
+            n = kSegmentRecords + 1 - seq;
+        for (uint64_t i = 0; i < n; ++i) {
+            LogRecordV2 r{};
+            r.version = wal::kLogRecordVersion;
+            r.global_seq = seq + i;
+            r.producer_seq = seq + i;
+            r.commit_ts = (seq + i) * 10;
+            const uint64_t noise = rng.next();
+            std::memcpy(r.payload, &noise, sizeof(noise));
+            batch[i] = r;
+        }
+        wal::internal::seal_records(batch, n);
+        EXPECT(b.submit(batch, n));
+        seq += n;
+    }
+}
+
+// The same image through the file-based §11 scanner.
+void check_file_scan(const std::string& path, const uint8_t* image, const CrashSim::Outcome& o)
+{
+    FILE* f = std::fopen(path.c_str(), "wb");
+    EXPECT(f != nullptr);
+    EXPECT(o.bytes == 0 || std::fwrite(image, o.bytes, 1, f) == 1);
+    EXPECT(std::fclose(f) == 0);
+
+    wal::internal::SegmentScan scan{};
+    EXPECT(wal::internal::scan_segment(path.c_str(), scan));
+    EXPECT(scan.records == o.prefix);
+    EXPECT(scan.truncated == (o.bytes != o.prefix * sizeof(LogRecordV2)));
+    EXPECT(o.prefix == 0 || scan.last_seq == o.prefix);
+}
+
+uint64_t crash_points() noexcept
+{
+    if (const char* env = std::getenv("WAL_CRASH_POINTS")) {
+        const uint64_t n = std::strtoull(env, nullptr, 10);
+        if (n != 0)
+            return n;
+    }
+    return 200000;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_crash_model_boundaries)
+{
+    // Both file models, every tear kind, one fixed workload.
+    for (const bool padded : {true, false}) {
+        Rng rng{7};
+        CrashBackend dev{padded};
+        run_workload(rng, dev);
+        EXPECT(dev.durable() == kSegmentRecords);
+        EXPECT(dev.written().size() == kSegmentRecords * sizeof(LogRecordV2));
+
+        CrashSim sim{dev};
+        uint64_t full = 0;
+        for (int i = 0; i < 20000; ++i) {
+            const auto o = sim.crash(rng, static_cast<Tear>(i % 3));
+            if (o.prefix == kSegmentRecords)
+                ++full;
+        }
+        EXPECT(full > 0); // the last interval landed whole at least once
+    }
+}
+
+TEST(test_crash_fuzz)
+{
+    const std::string dir = make_tmp_dir("wal_crash");
+    const std::string path = dir + "/00000001_00000001.seg";
+
+    const uint64_t points = crash_points();
+    constexpr uint64_t kPerWorkload = 4096;
+    constexpr uint64_t kFileEvery = 1024;
+    Rng rng{0xC0FFEEull};
+    uint64_t done = 0;
+    uint64_t torn_tails = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    while (done < points) {
+        CrashBackend dev{rng.below(2) != 0};
+        run_workload(rng, dev);
+        CrashSim sim{dev};
+        const Tear tear = static_cast<Tear>(rng.below(3));
+        for (uint64_t i = 0; i < kPerWorkload && done < points; ++i, ++done) {
+            const auto o = sim.crash(rng, tear);
+            if (o.bytes != o.prefix * sizeof(LogRecordV2))
+                ++torn_tails;
+            if (done % kFileEvery == 0)
+                check_file_scan(path, sim.image(), o);
+        }
+    }
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    EXPECT(torn_tails > 0);
+    std::printf("(%llu points, %.0f/min) ", static_cast<unsigned long long>(done), s > 0 ? done / s * 60.0 : 0.0);
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void crash_tests()
+{
+    std::printf("\n--- crash consistency ---\n");
+
+    RUN(test_crash_model_boundaries);
+    RUN(test_crash_fuzz);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
@@ -0,0 +1,480 @@
+#include "writers_dispatcher.hpp"
+#include "checkpoint/checkpoint.hpp"
+#include "model/channel_wrapper.hpp"
+#include "stam/primitives/spmc_snapshot_smp.hpp"
+#include "test_harness.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using stam::model::BindResult;
+using stam::model::PortName;
+using wal::DispatcherConfig;
+using wal::Lane;
+using wal::LogRecordV2;
+using wal::SubmitResult;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr uint8_t kTelemetry = 0x01;
+constexpr uint8_t kTrip = 0x07;
+
+// Stands in for the Writer; refuses pushes once it holds `limit` records.
+struct VectorSink {
+    std::vector<LogRecordV2> records;
+    std::vector<size_t> flushed_at;
+    size_t limit = std::numeric_limits<size_t>::max();
+
+    bool push(const LogRecordV2& r) noexcept
+    {
+        if (records.size() >= limit)
+            return false;
+        records.push_back(r);
+        return true;
+    }
+
+    bool flush() noexcept
+    {
+        flushed_at.push_back(records.size());
+        return true;
+    }
+};
+
+using loss_channel_t = stam::model::ChannelWrapper<stam::primitives::SPMCSnapshotSmp<wal::LossSnapshot, 1>>;
+
+inline constexpr PortName kPortLoss{"LOSS"};
+
+// Reader side of the loss channel (stands in for the supervisor).
+struct Supervisor {
+    BindResult bind_port(PortName name, loss_channel_t::reader_t&& r) noexcept
+    {
+        if (!(name == kPortLoss))
+            return BindResult::unknown_port;
+        reader.emplace(std::move(r));
+        return BindResult::ok;
+    }
+
+    std::optional<loss_channel_t::reader_t> reader;
+};
+
+} // namespace
+
+static LogRecordV2 make_record(uint8_t producer, uint8_t flags, uint64_t pseq)
+{
+    LogRecordV2 r{};
+    r.version = wal::kLogRecordVersion;
+    r.event_type = 3;
+    r.flags = flags;
+    r.producer_id = producer;
+    r.producer_seq = pseq;
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_critical_lane_drains_first)
+{
+    auto d = std::make_unique<wal::WritersDispatcher<4, 16, 1024>>(DispatcherConfig{}, 1000);
+    VectorSink sink;
+
+    for (uint64_t i = 0; i < 500; ++i)
+        EXPECT(d->submit(make_record(0, kTelemetry, i)) == SubmitResult::Ok);
+    for (uint64_t i = 0; i < 3; ++i)
+        EXPECT(d->submit(make_record(2, kTrip, i)) == SubmitResult::Ok);
+    EXPECT(d->submit(make_record(9, kTrip, 0)) == SubmitResult::BadProducer);
+
+    const wal::DrainResult r = d->drain(sink, 77);
+    EXPECT(r.ok && r.critical == 3u && r.bulk == 64u);
+    EXPECT(sink.records.size() == 67u);
+    EXPECT(sink.flushed_at.size() == 1u && sink.flushed_at[0] == 3u);
+    for (size_t i = 0; i < sink.records.size(); ++i) {
+        const LogRecordV2& rec = sink.records[i];
+        EXPECT(wal::record_valid(rec) && rec.global_seq == 1000 + i && rec.commit_ts == 77u);
+        EXPECT((rec.producer_id == 2) == (i < 3));
+    }
+
+    // A trip submitted behind the backlog still goes out on the next pass.
+    EXPECT(d->submit(make_record(2, kTrip, 3)) == SubmitResult::Ok);
+    sink.records.clear();
+    (void)d->drain(sink, 78);
+    EXPECT(sink.records.front().producer_id == 2 && sink.records.front().producer_seq == 3u);
+
+    while (d->drain(sink, 79).bulk != 0) {
+    }
+    const wal::LaneStats bulk = d->lane_stats(Lane::Bulk);
+    const wal::LaneStats crit = d->lane_stats(2, Lane::Critical);
+    EXPECT(bulk.submitted == 500u && bulk.drained == 500u && bulk.overflow == 0u);
+    EXPECT(crit.submitted == 4u && crit.drained == 4u);
+    EXPECT(d->next_global_seq() == 1000u + 504u);
+}
+
+TEST(test_overflow_is_accounted_per_lane)
+{
+    auto d = std::make_unique<wal::WritersDispatcher<2, 8, 64>>();
+
+    // Telemetry burst: the bulk lane fills, the critical lane stays open.
+    size_t refused = 0;
+    for (uint64_t i = 0; i < 200; ++i) {
+        if (d->submit(make_record(1, kTelemetry, i)) == SubmitResult::Overflow)
+            ++refused;
+    }
+    EXPECT(refused == 200u - 63u);
+    for (uint64_t i = 0; i < 7; ++i)
+        EXPECT(d->submit(make_record(1, kTrip, 200 + i)) == SubmitResult::Ok);
+    EXPECT(d->submit(make_record(1, kTrip, 207)) == SubmitResult::Overflow);
+
+    const wal::LaneStats bulk = d->lane_stats(1, Lane::Bulk);
+    const wal::LaneStats crit = d->lane_stats(1, Lane::Critical);
+    EXPECT(bulk.submitted == 63u && bulk.overflow == 137u);
+    EXPECT(crit.submitted == 7u && crit.overflow == 1u);
+    EXPECT(d->lane_stats(0, Lane::Bulk).submitted == 0u);
+
+    VectorSink sink;
+    const wal::DrainResult r = d->drain(sink, 1);
+    EXPECT(r.critical == 7u && r.bulk == 63u);
+    for (size_t i = 0; i < 7; ++i)
+        EXPECT(sink.records[i].producer_seq == 200 + i);
+
+    // Everything was drained and the bulk lane seen empty: 63..199 is one
+    // loss record at the end of the pass.
+    EXPECT(r.losses == 1u && sink.records.size() == 71u);
+    uint64_t first = 0;
+    uint64_t count = 0;
+    EXPECT(wal::loss_ext(sink.records.back(), first, count));
+    EXPECT(first == 63u && count == 137u && sink.records.back().producer_id == 1);
+    EXPECT(wal::record_valid(sink.records.back()) && sink.records.back().global_seq == 70u);
+    EXPECT(d->loss().lost_total == 137u && d->loss().lost[1] == 137u && d->loss().gaps == 1u);
+    EXPECT(d->loss().late == 0u);
+    EXPECT(d->drain(sink, 2).losses == 0u);
+}
+
+TEST(test_refused_records_are_retried)
+{
+    auto d = std::make_unique<wal::WritersDispatcher<2, 16, 1024>>();
+    VectorSink sink;
+    sink.limit = 10;
+
+    for (uint64_t i = 0; i < 4; ++i)
+        EXPECT(d->submit(make_record(1, kTrip, i)) == SubmitResult::Ok);
+    for (uint64_t i = 0; i < 300; ++i)
+        EXPECT(d->submit(make_record(0, kTelemetry, i)) == SubmitResult::Ok);
+
+    // The sink stops taking records: the pass stops popping and keeps the
+    // refused tail instead of dropping it.
+    wal::DrainResult r = d->drain(sink, 1);
+    EXPECT(!r.ok && sink.records.size() == 10u);
+    EXPECT(r.critical == 4u && r.bulk == 64u);
+    EXPECT(d->held() == 58u && d->next_global_seq() == 68u);
+    const size_t held = d->held();
+
+    // Still refused: nothing more is popped.
+    r = d->drain(sink, 2);
+    EXPECT(!r.ok && r.critical == 0u && r.bulk == 0u && d->held() == held);
+
+    // A trip submitted meanwhile waits in its lane until the tail is out.
+    EXPECT(d->submit(make_record(1, kTrip, 4)) == SubmitResult::Ok);
+    sink.limit = std::numeric_limits<size_t>::max();
+    uint32_t losses = 0;
+    for (uint64_t tick = 3; tick < 20; ++tick) {
+        r = d->drain(sink, tick);
+        EXPECT(r.ok);
+        losses += r.losses;
+    }
+    EXPECT(losses == 0u && d->held() == 0u && d->loss().lost_total == 0u);
+    EXPECT(sink.records.size() == 305u);
+
+    uint64_t next[2] = {};
+    for (size_t i = 0; i < sink.records.size(); ++i) {
+        const LogRecordV2& rec = sink.records[i];
+        EXPECT(wal::record_valid(rec) && rec.global_seq == i);
+        EXPECT(rec.producer_seq == next[rec.producer_id]++);
+    }
+    EXPECT(next[0] == 300u && next[1] == 5u);
+}
+
+TEST(test_append_block_is_contiguous)
+{
+    DispatcherConfig cfg;
+    cfg.bulk_budget = 16;
+    auto d = std::make_unique<wal::WritersDispatcher<2, 8, 256>>(cfg);
+    VectorSink sink;
+
+    // A checkpoint of one 300-byte state channel (28 records).
+    struct State {
+        uint8_t bytes[300];
+    };
+    State state;
+    for (size_t i = 0; i < sizeof(state.bytes); ++i)
+        state.bytes[i] = static_cast<uint8_t>(i * 7);
+    wal::internal::CheckpointBuilder builder;
+    EXPECT(builder.add(9, {&state, sizeof(State), [](void* p, uint8_t* out) noexcept {
+                               std::memcpy(out, p, sizeof(State));
+                               return wal::internal::SnapshotResult::Taken;
+                           }}));
+    std::vector<LogRecordV2> block;
+    EXPECT(builder.build({1, 0, 0, 0, 0}, block) == 28u);
+
+    // Telemetry of both producers is still queued around the checkpoint.
+    for (uint64_t i = 0; i < 100; ++i) {
+        EXPECT(d->submit(make_record(0, kTelemetry, i)) == SubmitResult::Ok);
+        EXPECT(d->submit(make_record(1, kTelemetry, i)) == SubmitResult::Ok);
+    }
+    EXPECT(d->drain(sink, 1).bulk == 16u);
+    EXPECT(d->append_block(sink, block.data(), block.size(), 2));
+    while (d->drain(sink, 3).bulk != 0) {
+    }
+    EXPECT(d->next_global_seq() == 228u && sink.records.size() == 228u);
+
+    wal::internal::CheckpointAssembler assembler;
+    for (size_t i = 0; i < sink.records.size(); ++i) {
+        EXPECT(wal::record_valid(sink.records[i]) && sink.records[i].global_seq == i);
+        (void)assembler.feed(sink.records[i]);
+    }
+    EXPECT(assembler.found() && assembler.last().first_seq == 16u && assembler.last().last_seq == 43u);
+    const std::vector<uint8_t>* got = assembler.last().state(9);
+    EXPECT(got != nullptr && got->size() == sizeof(State));
+    EXPECT(std::memcmp(got->data(), state.bytes, sizeof(State)) == 0);
+
+    // Refused half way: the block is abandoned there without a seq hole.
+    sink.limit = sink.records.size() + 5;
+    EXPECT(!d->append_block(sink, block.data(), block.size(), 4));
+    EXPECT(d->next_global_seq() == 233u && d->held() == 0u);
+}
+
+TEST(test_gap_detector_merges_lanes)
+{
+    struct Gap {
+        uint8_t producer;
+        uint64_t first;
+        uint64_t count;
+    };
+    std::vector<Gap> gaps;
+    auto on_gap = [&](uint8_t p, uint64_t first, uint64_t count) noexcept { gaps.push_back({p, first, count}); };
+    auto det = std::make_unique<wal::GapDetector<4>>();
+
+    // Trips 5 and 40 ran ahead; telemetry 0..4, 6..9 and 12 arrived.
+    det->critical(0, 5, on_gap);
+    det->critical(0, 40, on_gap);
+    for (uint64_t s : {0u, 1u, 2u, 3u, 4u, 6u, 7u, 8u, 9u, 12u})
+        det->bulk(0, s);
+    det->end_pass(0, on_gap);
+    EXPECT(gaps.size() == 1u && gaps[0].first == 10u && gaps[0].count == 2u);
+
+    // 13..39 may still be queued as telemetry: nothing more until the bulk
+    // lane moves or is seen empty.
+    det->end_pass(0, on_gap);
+    EXPECT(gaps.size() == 1u);
+    det->bulk(0, 20);
+    det->bulk_empty(0);
+    det->end_pass(0, on_gap);
+    EXPECT(gaps.size() == 3u);
+    EXPECT(gaps[1].first == 13u && gaps[1].count == 7u);
+    EXPECT(gaps[2].first == 21u && gaps[2].count == 19u);
+    EXPECT(det->lost(0) == 28u && det->late() == 0u);
+
+    // Late and re-based producers.
+    det->bulk(0, 30);
+    EXPECT(det->late() == 1u);
+    det->reset(3, 500);
+    det->bulk(3, 500);
+    det->end_pass(3, on_gap);
+    EXPECT(gaps.size() == 3u && det->lost(3) == 0u);
+
+    // Too many trips ahead: the oldest one forces the frontier.
+    gaps.clear();
+    for (uint64_t k = 0; k <= wal::GapDetector<4>::kAhead; ++k)
+        det->critical(1, 100 + 2 * k, on_gap);
+    EXPECT(gaps.size() == 1u && gaps[0].first == 0u && gaps[0].count == 100u);
+    det->bulk(1, 99);
+    EXPECT(det->late() == 2u);
+}
+
+TEST(test_loss_counters_are_published)
+{
+    auto channel = std::make_unique<loss_channel_t>();
+    wal::LossPort<loss_channel_t::writer_t> port{kPortLoss};
+    Supervisor supervisor;
+    EXPECT(channel->bind_writer(port, kPortLoss) == BindResult::ok);
+    EXPECT(channel->bind_reader(supervisor, kPortLoss) == BindResult::ok);
+    EXPECT(port.is_fully_bound() && channel->is_fully_bound());
+
+    auto d = std::make_unique<wal::WritersDispatcher<2, 8, 64>>();
+    d->attach_loss_publisher(port.publisher());
+    VectorSink sink;
+    wal::LossSnapshot s;
+
+    // Nothing lost yet: nothing published.
+    EXPECT(d->submit(make_record(0, kTelemetry, 0)) == SubmitResult::Ok);
+    (void)d->drain(sink, 1);
+    EXPECT(!supervisor.reader->try_read(s));
+
+    EXPECT(d->submit(make_record(0, kTelemetry, 4)) == SubmitResult::Ok);
+    EXPECT(d->submit(make_record(1, kTrip, 9)) == SubmitResult::Ok);
+    (void)d->drain(sink, 2);
+    EXPECT(supervisor.reader->try_read(s));
+    EXPECT(s.lost_total == 12u && s.gaps == 2u && s.late == 0u);
+    EXPECT(s.lost[0] == 3u && s.lost[1] == 9u);
+}
+
+TEST(test_coordinator_parks_until_submit)
+{
+    auto d = std::make_unique<wal::WritersDispatcher<2, 8, 64>>();
+    VectorSink sink;
+    std::atomic<size_t> drained{0};
+    std::atomic<bool> stop{false};
+
+    // Park right away, bounded so a lost wakeup fails instead of hanging.
+    std::thread coordinator([&] {
+        const stam::primitives::DoorbellPolicy policy{64, 1, 2000000};
+        uint64_t tick = 0;
+        while (!stop.load(std::memory_order_acquire)) {
+            if (!d->wait(policy))
+                continue;
+            const wal::DrainResult r = d->drain(sink, ++tick);
+            drained.fetch_add(r.critical + r.bulk, std::memory_order_release);
+        }
+    });
+
+    const auto deadline = [] { return std::chrono::steady_clock::now() + std::chrono::seconds(1); };
+    for (uint64_t i = 0; i < 3; ++i) {
+        while (d->parks() == i)
+            std::this_thread::yield();
+        EXPECT(d->submit(make_record(1, i == 1 ? kTrip : kTelemetry, i)) == SubmitResult::Ok);
+        const auto until = deadline();
+        while (drained.load(std::memory_order_acquire) != i + 1 && std::chrono::steady_clock::now() < until)
+            std::this_thread::yield();
+        EXPECT(drained.load(std::memory_order_acquire) == i + 1);
+    }
+
+    stop.store(true, std::memory_order_release);
+    EXPECT(d->submit(make_record(0, kTelemetry, 0)) == SubmitResult::Ok);
+    coordinator.join();
+    EXPECT(d->parks() >= 3u);
+    EXPECT(sink.records.size() >= 3u && sink.records[1].producer_seq == 1u);
+}
+
+TEST(test_concurrent_producers_strict_priority)
+{
+    constexpr size_t kProducers = 3;
+    constexpr uint64_t kPerProducer = 60000;
+    DispatcherConfig cfg;
+    cfg.bulk_budget = 256;
+    auto d = std::make_unique<wal::WritersDispatcher<kProducers, 64, 1024>>(cfg);
+    std::atomic<unsigned> done{0};
+
+    // Every 100th record is a trip.
+    std::vector<std::thread> producers;
+    std::vector<uint64_t> refused(kProducers, 0);
+    std::vector<uint64_t> retries(kProducers, 0);
+    for (size_t p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            for (uint64_t i = 0; i < kPerProducer; ++i) {
+                const uint8_t flags = i % 100 == 0 ? kTrip : kTelemetry;
+                if (d->submit(make_record(static_cast<uint8_t>(p), flags, i)) != SubmitResult::Ok)
+                    ++refused[p];
+            }
+            // A last record that gets through, so every refusal is a gap.
+            while (d->submit(make_record(static_cast<uint8_t>(p), kTelemetry, kPerProducer)) != SubmitResult::Ok)
+                ++retries[p];
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+
+    VectorSink sink;
+    sink.records.reserve(kProducers * kPerProducer);
+    for (uint64_t pass = 0;; ++pass) {
+        const bool finished = done.load(std::memory_order_acquire) == kProducers;
+        const wal::DrainResult r = d->drain(sink, pass);
+        EXPECT(r.ok);
+        if (finished && r.critical == 0 && r.bulk == 0)
+            break;
+    }
+    for (std::thread& t : producers)
+        t.join();
+
+    // Within a pass (one commit_ts): trips queued at its start, telemetry,
+    // then trips swept at its end — never telemetry after the sweep. Per
+    // producer and lane, FIFO.
+    uint64_t last[kProducers][wal::kLaneCount] = {};
+    bool seen[kProducers][wal::kLaneCount] = {};
+    int phase = 0;
+    uint64_t pass = 0;
+    uint64_t delivered = 0;
+    uint64_t reported = 0;
+    for (size_t i = 0; i < sink.records.size(); ++i) {
+        const LogRecordV2& r = sink.records[i];
+        EXPECT(r.global_seq == i && wal::record_valid(r));
+        uint64_t first = 0;
+        uint64_t count = 0;
+        if (wal::loss_ext(r, first, count)) {
+            reported += count;
+            continue;
+        }
+        ++delivered;
+        if (r.commit_ts != pass) {
+            pass = r.commit_ts;
+            phase = 0;
+        }
+        const size_t lane = r.flags == kTrip ? 0 : 1;
+        if (lane == 1) {
+            EXPECT(phase != 2);
+            phase = 1;
+        } else if (phase == 1) {
+            phase = 2;
+        }
+        EXPECT(!seen[r.producer_id][lane] || r.producer_seq > last[r.producer_id][lane]);
+        seen[r.producer_id][lane] = true;
+        last[r.producer_id][lane] = r.producer_seq;
+    }
+
+    uint64_t total_refused = 0;
+    uint64_t total_retries = 0;
+    for (size_t p = 0; p < kProducers; ++p) {
+        total_refused += refused[p];
+        total_retries += retries[p];
+    }
+    const wal::LaneStats crit = d->lane_stats(Lane::Critical);
+    const wal::LaneStats bulk = d->lane_stats(Lane::Bulk);
+    EXPECT(delivered + total_refused == kProducers * (kPerProducer + 1));
+    EXPECT(reported == total_refused && d->loss().lost_total == total_refused && d->loss().late == 0u);
+    EXPECT(crit.submitted + crit.overflow == kProducers * (kPerProducer / 100));
+    EXPECT(crit.drained == crit.submitted && bulk.drained == bulk.submitted);
+    EXPECT(crit.overflow + bulk.overflow == total_refused + total_retries);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void dispatcher_tests()
+{
+    std::printf("\n--- dispatcher ---\n");
+
+    RUN(test_critical_lane_drains_first);
+    RUN(test_overflow_is_accounted_per_lane);
+    RUN(test_refused_records_are_retried);
+    RUN(test_append_block_is_contiguous);
+    RUN(test_gap_detector_merges_lanes);
+    RUN(test_loss_counters_are_published);
+    RUN(test_coordinator_parks_until_submit);
+    RUN(test_concurrent_producers_strict_priority);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
@@ -0,0 +1,255 @@
+#include "fragment/fragment.hpp"
+#include "tail/tailer.hpp"
+#include "test_harness.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+using wal::LogRecordV2;
+using wal::internal::AssembledEvent;
+using wal::internal::FragmentAssembler;
+using wal::internal::FragmentResult;
+using wal::internal::Tailer;
+using wal::internal::TailerOptions;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static std::vector<uint8_t> event_bytes(size_t n, uint8_t seed)
+{
+    std::vector<uint8_t> v(n);
+    for (size_t i = 0; i < n; ++i)
+        v[i] = static_cast<uint8_t>(seed * 31 + i * 7);
+    return v;
+}
+
+namespace {
+
+// Commit side: global order, commit time, CRC.
+struct Sequencer {
+    uint64_t seq = 0;
+    uint64_t pseq[4] = {};
+
+    void commit(LogRecordV2& r, std::vector<LogRecordV2>& wal)
+    {
+        r.global_seq = seq++;
+        r.commit_ts = r.global_seq * 2;
+        r.crc32 = wal::record_crc(r);
+        wal.push_back(r);
+    }
+
+    // Splits into fragments and returns them, committed in the caller's order.
+    std::vector<LogRecordV2> split(uint8_t producer, uint8_t type, const std::vector<uint8_t>& bytes)
+    {
+        LogRecordV2 proto{};
+        proto.version = wal::kLogRecordVersion;
+        proto.event_type = type;
+        proto.producer_id = producer;
+        proto.event_ts = seq;
+        proto.producer_seq = pseq[producer];
+        LogRecordV2 frags[wal::internal::kMaxFragments];
+        const size_t n = wal::internal::encode_fragments(proto, bytes.data(), bytes.size(), frags, wal::internal::kMaxFragments);
+        EXPECT(n == wal::internal::fragment_count(bytes.size()));
+        pseq[producer] += n;
+        return {frags, frags + n};
+    }
+
+    LogRecordV2 plain(uint8_t producer)
+    {
+        LogRecordV2 r{};
+        r.version = wal::kLogRecordVersion;
+        r.event_type = 1;
+        r.producer_id = producer;
+        r.producer_seq = pseq[producer]++;
+        std::memset(r.payload, 0xAB, sizeof(r.payload));
+        return r;
+    }
+};
+
+struct Expected {
+    uint8_t producer;
+    std::vector<uint8_t> bytes;
+};
+
+} // namespace
+
+// Three producers interleaving fragmented events (15..512 bytes) with plain
+// records from producer 3. Returns the WAL and the events in completion order.
+static std::vector<LogRecordV2> interleaved_wal(std::vector<Expected>& events)
+{
+    Sequencer sq;
+    std::vector<LogRecordV2> wal;
+    std::vector<std::vector<LogRecordV2>> open(3);
+    std::vector<std::vector<uint8_t>> payloads(3);
+    size_t next_len = 15;
+    for (int round = 0; round < 400; ++round) {
+        for (uint8_t p = 0; p < 3; ++p) {
+            if (open[p].empty()) {
+                payloads[p] = event_bytes(next_len, static_cast<uint8_t>(round + p));
+                open[p] = sq.split(p, static_cast<uint8_t>(20 + p), payloads[p]);
+                next_len = next_len == 512 ? 15 : std::min<size_t>(next_len + 37, 512);
+            }
+            // One or two fragments per turn so the producers drift apart.
+            const size_t take = (round + p) % 3 == 0 ? 2 : 1;
+            for (size_t k = 0; k < take && !open[p].empty(); ++k) {
+                sq.commit(open[p].front(), wal);
+                open[p].erase(open[p].begin());
+                if (open[p].empty())
+                    events.push_back({p, payloads[p]});
+            }
+        }
+        LogRecordV2 r = sq.plain(3);
+        sq.commit(r, wal);
+        events.push_back({3, std::vector<uint8_t>(14, 0xAB)});
+    }
+    return wal;
+}
+
+static bool same_event(const AssembledEvent& ev, const Expected& e)
+{
+    return ev.producer_id == e.producer && ev.length == e.bytes.size()
+        && std::memcmp(ev.data, e.bytes.data(), e.bytes.size()) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_split_and_reassemble_sizes)
+{
+    for (size_t len : {size_t{1}, size_t{14}, size_t{15}, size_t{64}, size_t{200}, size_t{512}}) {
+        Sequencer sq;
+        const std::vector<uint8_t> bytes = event_bytes(len, static_cast<uint8_t>(len));
+        std::vector<LogRecordV2> frags = sq.split(2, 40, bytes);
+        EXPECT(frags.size() == (len + 13) / 14);
+
+        FragmentAssembler a;
+        AssembledEvent ev;
+        for (size_t i = 0; i < frags.size(); ++i) {
+            std::vector<LogRecordV2> wal;
+            sq.commit(frags[i], wal);
+            EXPECT(wal::record_valid(wal[0]));
+            const FragmentResult r = a.feed(wal[0], ev);
+            EXPECT(r == (i + 1 == frags.size() ? FragmentResult::Complete : FragmentResult::Pending));
+        }
+        EXPECT(ev.length == len && ev.event_type == 40 && ev.producer_id == 2);
+        EXPECT(ev.first_seq == 0u && ev.last_seq == frags.size() - 1);
+        EXPECT(std::memcmp(ev.data, bytes.data(), len) == 0);
+    }
+
+    LogRecordV2 proto{};
+    LogRecordV2 out[wal::internal::kMaxFragments + 1];
+    const std::vector<uint8_t> big = event_bytes(513, 1);
+    EXPECT(wal::internal::encode_fragments(proto, big.data(), 0, out, 40) == 0u);
+    EXPECT(wal::internal::encode_fragments(proto, big.data(), 513, out, 40) == 0u);
+    EXPECT(wal::internal::encode_fragments(proto, big.data(), 64, out, 4) == 0u);
+    EXPECT(wal::internal::encode_fragments(proto, big.data(), 64, out, 5) == 5u);
+}
+
+TEST(test_interleaved_producers_and_lost_fragment)
+{
+    std::vector<Expected> expect;
+    const std::vector<LogRecordV2> wal = interleaved_wal(expect);
+
+    FragmentAssembler a;
+    size_t k = 0;
+    wal::internal::assemble_events(std::span<const LogRecordV2>(wal), a, [&](const AssembledEvent& ev) {
+        EXPECT(k < expect.size() && same_event(ev, expect[k]));
+        ++k;
+    });
+    EXPECT(k == expect.size() && a.dropped() == 0u);
+
+    // Lose one middle fragment of producer 1: that event is dropped, everything
+    // else still comes through.
+    std::vector<LogRecordV2> lossy = wal;
+    size_t victim = 0;
+    for (size_t i = 0; i < lossy.size(); ++i) {
+        if (lossy[i].producer_id == 1 && lossy[i].reserved[2] == 1 && lossy[i].reserved[3] > 2 && i > 300) {
+            victim = i;
+            break;
+        }
+    }
+    EXPECT(victim != 0);
+    lossy.erase(lossy.begin() + static_cast<long>(victim));
+    FragmentAssembler b;
+    size_t events = 0;
+    wal::internal::assemble_events(std::span<const LogRecordV2>(lossy), b, [&](const AssembledEvent&) { ++events; });
+    EXPECT(events == expect.size() - 1);
+    EXPECT(b.dropped() >= 1u);
+
+    // A corrupted event (CRC of the whole event) is not delivered.
+    std::vector<LogRecordV2> bad = wal;
+    bad[victim].payload[0] ^= 1;
+    bad[victim].crc32 = wal::record_crc(bad[victim]);
+    FragmentAssembler c;
+    events = 0;
+    wal::internal::assemble_events(std::span<const LogRecordV2>(bad), c, [&](const AssembledEvent&) { ++events; });
+    EXPECT(events == expect.size() - 1 && c.dropped() == 1u);
+}
+
+TEST(test_recovery_and_tailer_paths)
+{
+    const std::string dir = make_tmp_dir("wal_fragment");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    std::vector<Expected> expect;
+    std::vector<LogRecordV2> wal = interleaved_wal(expect);
+    write_records(seg, wal);
+
+    // Recovery: visit the segment as events.
+    struct Ctx {
+        const std::vector<Expected>* expect;
+        size_t k;
+    } ctx{&expect, 0};
+    FragmentAssembler a;
+    EXPECT(wal::internal::visit_segment_events(seg.c_str(), a,
+        [](void* p, const AssembledEvent& ev) noexcept {
+            auto& c = *static_cast<Ctx*>(p);
+            if (c.k >= c.expect->size() || !same_event(ev, (*c.expect)[c.k]))
+                return false;
+            ++c.k;
+            return true;
+        }, &ctx));
+    EXPECT(ctx.k == expect.size());
+
+    // Tailer: small batches cut events across calls; the assembler carries them.
+    Tailer t;
+    TailerOptions opt;
+    opt.max_batch = 5;
+    EXPECT(t.open(dir.c_str(), opt));
+    FragmentAssembler b;
+    size_t k = 0;
+    EXPECT(t.follow([&](std::span<const LogRecordV2> batch) {
+        wal::internal::assemble_events(batch, b, [&](const AssembledEvent& ev) {
+            EXPECT(k < expect.size() && same_event(ev, expect[k]));
+            ++k;
+        });
+        return true;
+    }, 0));
+    EXPECT(k == expect.size() && b.dropped() == 0u);
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void fragment_tests()
+{
+    std::printf("\n--- fragment ---\n");
+
+    RUN(test_split_and_reassemble_sizes);
+    RUN(test_interleaved_producers_and_lost_fragment);
+    RUN(test_recovery_and_tailer_paths);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
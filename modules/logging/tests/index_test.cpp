@@ -0,0 +1,316 @@
+#include "backend/file_backend.hpp"
+#include "index/segment_index.hpp"
+#include "recovery/recovery.hpp"
+#include "writer/writer.hpp"
+#include "test_harness.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+using wal::LogRecordV2;
+using wal::internal::FileBackend;
+using wal::internal::RecoveryResult;
+using wal::internal::SegmentIndex;
+using wal::internal::SegmentIndexWriter;
+using wal::internal::SegmentScan;
+using wal::internal::Writer;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+// Three records per tick: commit_ts has runs of equal values.
+static uint64_t ts_of(uint64_t seq) { return 5000 + seq / 3; }
+
+static LogRecordV2 index_record(uint64_t seq) { return sealed_record(seq, ts_of(seq)); }
+
+static void write_segment(const std::string& path, uint64_t first, uint64_t count, SegmentIndexWriter* idx)
+{
+    FileBackend b;
+    EXPECT(b.open_segment(path.c_str()));
+    auto w = std::make_unique<Writer>(b);
+    w->attach_index(idx);
+    for (uint64_t i = 0; i < count; ++i)
+        EXPECT(w->push(index_record(first + i)));
+    EXPECT(w->flush());
+    b.close_segment();
+}
+
+static void append_bytes(const std::string& path, const void* data, size_t bytes)
+{
+    FILE* f = std::fopen(path.c_str(), "ab");
+    EXPECT(f != nullptr);
+    EXPECT(std::fwrite(data, 1, bytes, f) == bytes);
+    std::fclose(f);
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_index_path)
+{
+    EXPECT(wal::internal::segment_index_path("/w/00000001_00000002.seg") == "/w/00000001_00000002.idx");
+    EXPECT(wal::internal::segment_index_path("/w/raw") == "/w/raw.idx");
+}
+
+TEST(test_writer_builds_index_incrementally)
+{
+    const std::string dir = make_tmp_dir("wal_index");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string idx = wal::internal::segment_index_path(seg);
+
+    SegmentIndexWriter iw;
+    EXPECT(iw.open(idx.c_str(), 16, 0));
+    write_segment(seg, 100, 1000, &iw);
+    EXPECT(iw.records() == 1000u);
+    EXPECT(iw.entries() == 63u); // ceil(1000 / 16)
+    iw.close();
+
+    SegmentIndex index;
+    EXPECT(index.load(idx.c_str()));
+    EXPECT(index.stride() == 16u);
+    EXPECT(index.entries().size() == 63u);
+    EXPECT(index.entries()[0].global_seq == 100u);
+    EXPECT(index.entries()[62].global_seq == 100u + 62u * 16u);
+    EXPECT(index.entries()[62].offset == 62u * 16u * sizeof(LogRecordV2));
+    EXPECT(index.entries()[62].commit_ts == ts_of(100 + 62 * 16));
+
+    // Seek lands on the entry at or before the target.
+    EXPECT(index.seek_seq(0) == 0u);
+    EXPECT(index.seek_seq(100 + 16) == 16u * sizeof(LogRecordV2));
+    EXPECT(index.seek_seq(100 + 31) == 16u * sizeof(LogRecordV2));
+    EXPECT(index.seek_seq(5000) == 62u * 16u * sizeof(LogRecordV2));
+
+    for (uint64_t seq : {100u, 101u, 116u, 555u, 1099u}) {
+        LogRecordV2 r{};
+        uint64_t off = 0;
+        EXPECT(wal::internal::find_by_seq(seg.c_str(), &index, seq, r, &off));
+        EXPECT(r.global_seq == seq);
+        EXPECT(off == (seq - 100) * sizeof(LogRecordV2));
+    }
+    LogRecordV2 r{};
+    EXPECT(!wal::internal::find_by_seq(seg.c_str(), &index, 99, r));
+    EXPECT(!wal::internal::find_by_seq(seg.c_str(), &index, 1100, r));
+
+    // First record of a tick, even when the tick straddles an index entry.
+    for (uint64_t seq : {100u, 300u, 402u, 1098u}) {
+        EXPECT(wal::internal::find_by_ts(seg.c_str(), &index, ts_of(seq), r));
+        EXPECT(r.commit_ts == ts_of(seq));
+        EXPECT(r.global_seq == std::max<uint64_t>(100, seq / 3 * 3));
+    }
+    EXPECT(!wal::internal::find_by_ts(seg.c_str(), &index, ts_of(1099) + 1, r));
+
+    remove_tree(dir);
+}
+
+TEST(test_index_writer_resume_trims_stale_tail)
+{
+    const std::string dir = make_tmp_dir("wal_index");
+    const std::string idx = dir + "/00000001_00000001.idx";
+
+    SegmentIndexWriter iw;
+    EXPECT(iw.open(idx.c_str(), 8, 0));
+    for (uint64_t i = 0; i < 100; ++i)
+        EXPECT(iw.add(index_record(i)));
+    iw.close();
+
+    // Segment recovered to 40 records: entries 0..4 kept, the rest trimmed.
+    EXPECT(iw.open(idx.c_str(), 8, 40));
+    EXPECT(iw.entries() == 5u);
+    EXPECT(iw.add(index_record(1000))); // record 40 → entry 5
+    iw.close();
+
+    SegmentIndex index;
+    EXPECT(index.load(idx.c_str()));
+    EXPECT(index.entries().size() == 6u);
+    EXPECT(index.entries()[5].global_seq == 1000u);
+    EXPECT(index.entries()[5].offset == 40u * sizeof(LogRecordV2));
+
+    // Different stride or too few entries: caller must rebuild.
+    EXPECT(!iw.open(idx.c_str(), 16, 40));
+    EXPECT(!iw.open(idx.c_str(), 8, 1000));
+
+    remove_tree(dir);
+}
+
+TEST(test_scan_stops_at_first_invalid_record)
+{
+    const std::string dir = make_tmp_dir("wal_index");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    write_segment(seg, 1, 300, nullptr);
+
+    SegmentScan scan{};
+    EXPECT(wal::internal::scan_segment(seg.c_str(), scan));
+    EXPECT(scan.records == 300u && scan.first_seq == 1u && scan.last_seq == 300u && !scan.truncated);
+
+    // Torn tail: half a record.
+    const LogRecordV2 extra = index_record(301);
+    append_bytes(seg, &extra, 32);
+    EXPECT(wal::internal::scan_segment(seg.c_str(), scan));
+    EXPECT(scan.records == 300u && scan.truncated);
+
+    // Corrupt record 200: everything from there on is ignored (§11).
+    FILE* f = std::fopen(seg.c_str(), "r+b");
+    EXPECT(f != nullptr);
+    EXPECT(std::fseek(f, 199 * 64 + 60, SEEK_SET) == 0);
+    EXPECT(std::fputc(0xA5, f) != EOF);
+    std::fclose(f);
+    EXPECT(wal::internal::scan_segment(seg.c_str(), scan));
+    EXPECT(scan.records == 199u && scan.last_seq == 199u && scan.truncated);
+
+    LogRecordV2 r{};
+    EXPECT(!wal::internal::find_by_seq(seg.c_str(), nullptr, 250, r));
+
+    remove_tree(dir);
+}
+
+TEST(test_recovery_rebuilds_missing_index)
+{
+    const std::string dir = make_tmp_dir("wal_index");
+    const std::string seg1 = dir + "/00000001_00000001.seg";
+    const std::string seg2 = dir + "/00000001_00000002.seg";
+    const std::string seg3 = dir + "/00000002_00000001.seg";
+
+    SegmentIndexWriter iw;
+    EXPECT(iw.open(wal::internal::segment_index_path(seg1).c_str(), 32, 0));
+    write_segment(seg1, 1, 500, &iw);
+    iw.close();
+    write_segment(seg2, 501, 500, nullptr); // no index written
+    write_segment(seg3, 1001, 77, nullptr);
+
+    RecoveryResult res{};
+    EXPECT(wal::internal::recover_directory(dir.c_str(), res, 32));
+    EXPECT(res.segments == 3u);
+    EXPECT(res.records == 1077u);
+    EXPECT(res.indexes_rebuilt == 2u);
+    EXPECT(res.found && res.last_seq == 1077u && res.next_global_seq == 1078u);
+    EXPECT(::access((dir + "/00000001_00000002.idx.tmp").c_str(), F_OK) != 0);
+
+    SegmentIndex index;
+    EXPECT(index.load(wal::internal::segment_index_path(seg2).c_str()));
+    EXPECT(index.entries().size() == 16u); // ceil(500 / 32)
+    LogRecordV2 r{};
+    EXPECT(wal::internal::find_by_seq(seg2.c_str(), &index, 777, r));
+    EXPECT(r.global_seq == 777u);
+
+    // Second pass: every index is current.
+    EXPECT(wal::internal::recover_directory(dir.c_str(), res, 32));
+    EXPECT(res.indexes_rebuilt == 0u);
+
+    // A different stride is a rebuild.
+    bool rebuilt = false;
+    EXPECT(wal::internal::ensure_segment_index(seg1.c_str(), 64, &rebuilt));
+    EXPECT(rebuilt);
+
+    remove_tree(dir);
+}
+
+TEST(test_recovery_cuts_torn_tail_before_append)
+{
+    const std::string dir = make_tmp_dir("wal_index");
+    const std::string seg1 = dir + "/00000001_00000001.seg";
+    const std::string seg2 = dir + "/00000001_00000002.seg";
+    write_segment(seg1, 1, 100, nullptr);
+    write_segment(seg2, 101, 100, nullptr);
+
+    // Crash: half a record at the end of the active segment.
+    const LogRecordV2 extra = index_record(201);
+    append_bytes(seg2, &extra, 32);
+
+    RecoveryResult res{};
+    EXPECT(wal::internal::recover_directory(dir.c_str(), res, 32));
+    EXPECT(res.tail_truncated && res.records == 200u && res.next_global_seq == 201u);
+    write_segment(seg2, 201, 50, nullptr);
+
+    SegmentScan scan{};
+    EXPECT(wal::internal::scan_segment(seg2.c_str(), scan));
+    EXPECT(scan.records == 150u && scan.last_seq == 250u && !scan.truncated);
+
+    // Crash: an invalid full record in the middle hides everything after it.
+    FILE* f = std::fopen(seg2.c_str(), "r+b");
+    EXPECT(f != nullptr);
+    EXPECT(std::fseek(f, 119 * 64 + 60, SEEK_SET) == 0);
+    EXPECT(std::fputc(0xA5, f) != EOF);
+    std::fclose(f);
+
+    EXPECT(wal::internal::recover_directory(dir.c_str(), res, 32));
+    EXPECT(res.tail_truncated && res.last_seq == 219u && res.indexes_rebuilt == 1u);
+    write_segment(seg2, 220, 10, nullptr);
+
+    EXPECT(wal::internal::scan_segment(seg2.c_str(), scan));
+    EXPECT(scan.records == 129u && scan.last_seq == 229u && !scan.truncated);
+    SegmentIndex index;
+    EXPECT(index.load(wal::internal::segment_index_path(seg2).c_str()));
+    LogRecordV2 r{};
+    EXPECT(wal::internal::find_by_seq(seg2.c_str(), &index, 225, r));
+    EXPECT(r.global_seq == 225u);
+
+    // Recovered and clean: nothing left to cut.
+    EXPECT(wal::internal::recover_directory(dir.c_str(), res, 32));
+    EXPECT(!res.tail_truncated && res.records == 229u);
+
+    remove_tree(dir);
+}
+
+TEST(test_find_survives_stale_index)
+{
+    const std::string dir = make_tmp_dir("wal_index");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    const std::string idx = wal::internal::segment_index_path(seg);
+
+    // Index of a segment that was later replaced by one starting further on.
+    SegmentIndexWriter iw;
+    EXPECT(iw.open(idx.c_str(), 16, 0));
+    for (uint64_t i = 0; i < 400; ++i)
+        EXPECT(iw.add(index_record(1 + i)));
+    iw.close();
+    write_segment(seg, 201, 400, nullptr);
+
+    SegmentIndex index;
+    EXPECT(index.load(idx.c_str()));
+    LogRecordV2 r{};
+    uint64_t off = 0;
+    EXPECT(wal::internal::find_by_seq(seg.c_str(), &index, 250, r, &off));
+    EXPECT(r.global_seq == 250u && off == 49u * sizeof(LogRecordV2));
+    EXPECT(wal::internal::find_by_ts(seg.c_str(), &index, ts_of(210), r));
+    EXPECT(r.global_seq == 210u);
+
+    // Shortened again: the hint for 320 now points past the end of the file.
+    std::remove(seg.c_str());
+    write_segment(seg, 301, 50, nullptr);
+    EXPECT(wal::internal::find_by_seq(seg.c_str(), &index, 320, r, &off));
+    EXPECT(r.global_seq == 320u && off == 19u * sizeof(LogRecordV2));
+    EXPECT(wal::internal::find_by_ts(seg.c_str(), &index, ts_of(330), r));
+    EXPECT(r.commit_ts == ts_of(330));
+    EXPECT(!wal::internal::find_by_seq(seg.c_str(), &index, 351, r));
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void index_tests()
+{
+    std::printf("\n--- index ---\n");
+
+    RUN(test_index_path);
+    RUN(test_writer_builds_index_incrementally);
+    RUN(test_index_writer_resume_trims_stale_tail);
+    RUN(test_scan_stops_at_first_invalid_record);
+    RUN(test_recovery_rebuilds_missing_index);
+    RUN(test_recovery_cuts_torn_tail_before_append);
+    RUN(test_find_survives_stale_index);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
@@ -0,0 +1,37 @@
+#include <cstdio>
+
+void backend_tests();
+void index_tests();
+void query_tests();
+void archive_tests();
+void replay_tests();
+void tail_tests();
+void checkpoint_tests();
+void fragment_tests();
+void codec_tests();
+void dispatcher_tests();
+void crash_tests();
+void retention_tests();
+void schema_tests();
+
+int main()
+{
+    std::printf("=== WAL logging module tests ===\n");
+
+    backend_tests();
+    index_tests();
+    query_tests();
+    archive_tests();
+    replay_tests();
+    tail_tests();
+    checkpoint_tests();
+    fragment_tests();
+    codec_tests();
+    dispatcher_tests();
+    crash_tests();
+    retention_tests();
+    schema_tests();
+
+    std::printf("\n=== ALL TESTS PASSED ===\n");
+    return 0;
+}
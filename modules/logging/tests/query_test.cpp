@@ -0,0 +1,219 @@
+#include "query/query.hpp"
+#include "query/query_kernels.hpp"
+#include "test_harness.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using wal::LogRecordV2;
+using wal::internal::ByteSet;
+using wal::internal::CompiledFilter;
+using wal::internal::FilterKernelFn;
+using wal::internal::QueryFilter;
+using wal::internal::QueryKernel;
+using wal::internal::QueryMatch;
+using wal::internal::QueryOptions;
+using wal::internal::QueryStats;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static uint64_t g_rng = 0x9E3779B97F4A7C15ull;
+
+static uint64_t next_rand()
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return g_rng;
+}
+
+// Record `seq`: type = seq % 7, producer = seq % 5, flags = seq % 16, ts = seq / 2.
+static LogRecordV2 record_at(uint64_t seq)
+{
+    return sealed_record(seq, seq / 2, static_cast<uint8_t>(seq % 7), static_cast<uint8_t>(seq % 5),
+                         static_cast<uint8_t>(seq % 16));
+}
+
+static std::vector<LogRecordV2> make_range(uint64_t first, uint64_t count)
+{
+    std::vector<LogRecordV2> v;
+    for (uint64_t i = 0; i < count; ++i)
+        v.push_back(record_at(first + i));
+    return v;
+}
+
+static std::vector<uint32_t> run_kernel(FilterKernelFn fn, const std::vector<LogRecordV2>& recs, const CompiledFilter& f)
+{
+    std::vector<uint32_t> out(recs.size());
+    out.resize(fn(recs.data(), recs.size(), f, out.data()));
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Kernels
+// ---------------------------------------------------------------------------
+
+TEST(test_kernels_agree_with_scalar)
+{
+    // Random headers and times, including invalid versions and wrapped timestamps.
+    std::vector<LogRecordV2> recs(1031); // not a multiple of the vector width
+    for (LogRecordV2& r : recs) {
+        const uint64_t x = next_rand();
+        r = LogRecordV2{};
+        r.version = (x & 15u) == 0 ? 1 : wal::kLogRecordVersion;
+        r.event_type = static_cast<uint8_t>(x >> 8);
+        r.flags = static_cast<uint8_t>(x >> 16);
+        r.producer_id = static_cast<uint8_t>((x >> 24) & 7u);
+        r.commit_ts = ~uint64_t{0} - 500 + ((x >> 32) & 1023u);
+        r.global_seq = (x >> 40) & 4095u;
+    }
+
+    std::vector<QueryFilter> filters(5);
+    filters[1].event_types = ByteSet::none();
+    for (unsigned t = 0; t < 256; t += 3)
+        filters[1].event_types.add(static_cast<uint8_t>(t));
+    filters[1].producers = ByteSet::none();
+    filters[1].producers.add(2);
+    filters[1].producers.add(5);
+    filters[2].flags_mask = 0xC0;
+    filters[2].flags_value = 0x40;
+    filters[2].severity_mask = 0x07;
+    filters[2].min_severity = 5;
+    filters[3].by_ts = true;
+    filters[3].ts_from = ~uint64_t{0} - 100; // range straddles the wrap
+    filters[3].ts_to = 300;
+    filters[4].by_seq = true;
+    filters[4].seq_from = 1000;
+    filters[4].seq_to = 3000;
+    filters[4].by_ts = true;
+    filters[4].ts_from = ~uint64_t{0} - 400;
+    filters[4].ts_to = ~uint64_t{0};
+
+    const FilterKernelFn scalar = wal::internal::filter_kernel(QueryKernel::Scalar);
+    EXPECT(scalar != nullptr);
+    for (const QueryFilter& qf : filters) {
+        CompiledFilter f{};
+        wal::internal::compile_filter(qf, f);
+        const std::vector<uint32_t> expect = run_kernel(scalar, recs, f);
+        EXPECT(!expect.empty() && expect.size() < recs.size());
+        for (QueryKernel k : {QueryKernel::Avx2, QueryKernel::Neon, QueryKernel::Auto}) {
+            const FilterKernelFn fn = wal::internal::filter_kernel(k);
+            if (fn != nullptr)
+                EXPECT(run_kernel(fn, recs, f) == expect);
+        }
+    }
+    std::printf("(best=%s) ", wal::internal::query_kernel_name(wal::internal::best_query_kernel()));
+}
+
+TEST(test_zero_padding_never_matches)
+{
+    std::vector<LogRecordV2> recs(64); // all zero
+    QueryFilter any;
+    CompiledFilter f{};
+    wal::internal::compile_filter(any, f);
+    EXPECT(run_kernel(wal::internal::filter_kernel(QueryKernel::Auto), recs, f).empty());
+}
+
+// ---------------------------------------------------------------------------
+// run_query
+// ---------------------------------------------------------------------------
+
+TEST(test_query_across_segments_in_order)
+{
+    const std::string dir = make_tmp_dir("wal_query");
+    std::vector<std::string> segs;
+    for (uint64_t s = 0; s < 6; ++s) {
+        segs.push_back(dir + "/00000001_0000000" + std::to_string(s + 1) + ".seg");
+        write_records(segs.back(), make_range(1 + s * 5000, 5000));
+    }
+
+    QueryFilter qf;
+    qf.event_types = ByteSet::none();
+    qf.event_types.add(3);
+    qf.by_ts = true;
+    qf.ts_from = 2000;   // seq 4000..
+    qf.ts_to = 12000;    // ..23999
+
+    QueryOptions opt;
+    opt.threads = 3;
+    std::vector<QueryMatch> out;
+    QueryStats st;
+    EXPECT(wal::internal::run_query(segs, qf, opt, out, &st));
+    EXPECT(st.segments == 6u && st.records == 30'000u && st.invalid == 0u);
+
+    uint64_t expect = 0;
+    for (uint64_t seq = 4000; seq < 24000; ++seq)
+        expect += seq % 7 == 3 ? 1u : 0u;
+    EXPECT(out.size() == expect && st.matches == expect);
+    for (size_t i = 0; i < out.size(); ++i) {
+        EXPECT(out[i].record.event_type == 3);
+        EXPECT(out[i].offset == (out[i].record.global_seq - 1 - out[i].segment * 5000u) * sizeof(LogRecordV2));
+        if (i > 0)
+            EXPECT(out[i].record.global_seq > out[i - 1].record.global_seq);
+    }
+
+    opt.limit = 10;
+    EXPECT(wal::internal::run_query(segs, qf, opt, out, &st));
+    EXPECT(out.size() == 10u && out.front().record.global_seq == 4000u);
+
+    segs.push_back(dir + "/missing.seg");
+    opt.limit = 0;
+    EXPECT(!wal::internal::run_query(segs, qf, opt, out, &st));
+    EXPECT(out.size() == expect); // the others are still scanned
+
+    remove_tree(dir);
+}
+
+TEST(test_query_stops_at_invalid_record)
+{
+    const std::string dir = make_tmp_dir("wal_query");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    std::vector<LogRecordV2> recs = make_range(0, 3000);
+    recs[1001].payload[0] ^= 1;  // type 0: does not match the filter
+    recs[2003].payload[0] ^= 1;  // type 1: matches
+    write_records(seg, recs);
+
+    QueryFilter qf;
+    qf.event_types = ByteSet::none();
+    qf.event_types.add(1);
+    std::vector<QueryMatch> out;
+    QueryStats st;
+
+    // CRC on matches only: the corrupt non-match at 1001 goes unnoticed.
+    QueryOptions opt;
+    EXPECT(wal::internal::run_query({seg}, qf, opt, out, &st));
+    EXPECT(st.invalid == 1u && st.records == 2003u);
+    EXPECT(out.back().record.global_seq < 2003u && out.back().record.global_seq > 1001u);
+
+    // verify_all: exact §11 prefix.
+    opt.verify_all = true;
+    EXPECT(wal::internal::run_query({seg}, qf, opt, out, &st));
+    EXPECT(st.invalid == 1u && st.records == 1001u);
+    EXPECT(out.back().record.global_seq < 1001u);
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void query_tests()
+{
+    std::printf("\n--- query ---\n");
+
+    RUN(test_kernels_agree_with_scalar);
+    RUN(test_zero_padding_never_matches);
+    RUN(test_query_across_segments_in_order);
+    RUN(test_query_stops_at_invalid_record);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
@@ -0,0 +1,374 @@
+#include "archive/archive.hpp"
+#include "checkpoint/checkpoint.hpp"
+#include "fragment/fragment.hpp"
+#include "gap_detector.hpp"
+#include "model/channel_wrapper.hpp"
+#include "recovery/recovery.hpp"
+#include "replay/replay.hpp"
+#include "stam/primitives/mailbox2slot_smp.hpp"
+#include "stam/primitives/spsc_ring.hpp"
+#include "test_harness.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+using wal::LogRecordV2;
+using wal::internal::ReplayClock;
+using wal::internal::Replayer;
+using wal::internal::ReplayOptions;
+using wal::internal::ReplayPort;
+using wal::internal::ReplayStats;
+using stam::model::BindResult;
+using stam::model::PortName;
+using stam::model::tick_t;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+constexpr uint8_t kTypeLevel = 1;    // producer 0 → ring, value = seq
+constexpr uint8_t kTypeSetpoint = 2; // producer 1 → mailbox, value = seq * 10
+
+// Record `seq`: types 1, 2, 3 (unrouted) round-robin, commit_ts = 1000 + 7 * seq,
+// event_ts two units earlier except every fifth record (late producer clock).
+static LogRecordV2 record_at(uint64_t seq)
+{
+    LogRecordV2 r = sealed_record(seq, 1000 + 7 * seq, static_cast<uint8_t>(1 + seq % 3), static_cast<uint8_t>(seq % 3));
+    r.event_ts = seq % 5 == 0 ? r.commit_ts - 30 : r.commit_ts - 2;
+    const uint64_t value = r.event_type == kTypeSetpoint ? seq * 10 : seq;
+    std::memcpy(r.payload, &value, sizeof(value));
+    r.crc32 = wal::record_crc(r);
+    return r;
+}
+
+static void write_range(const std::string& path, uint64_t first, uint64_t count)
+{
+    std::vector<LogRecordV2> recs;
+    for (uint64_t i = 0; i < count; ++i)
+        recs.push_back(record_at(first + i));
+    write_records(path, recs);
+}
+
+namespace {
+
+using ring_channel_t = stam::model::ChannelWrapper<stam::primitives::SPSCRing<uint32_t, 64>>;
+using mailbox_channel_t = stam::model::ChannelWrapper<stam::primitives::Mailbox2SlotSmp<uint32_t>>;
+
+inline constexpr PortName kPortLevel{"LVL0"};
+inline constexpr PortName kPortSetpoint{"SPT0"};
+
+// Consumer task: drains the ring and samples the mailbox every step, logging
+// (now, value) pairs — the trace two replays must agree on.
+struct Consumer {
+    void step(tick_t now) noexcept
+    {
+        uint32_t v;
+        while (level_->pop(v))
+            trace.push_back(uint64_t{now} << 32 | v);
+        if (setpoint_->try_read(v) && v != last_setpoint) {
+            last_setpoint = v;
+            trace.push_back(uint64_t{now} << 32 | v | 0x80000000u);
+        }
+        last_now = now;
+        ++steps;
+    }
+
+    BindResult bind_port(PortName name, ring_channel_t::reader_t&& r) noexcept
+    {
+        if (!(name == kPortLevel))
+            return BindResult::unknown_port;
+        level_.emplace(std::move(r));
+        return BindResult::ok;
+    }
+
+    BindResult bind_port(PortName name, mailbox_channel_t::reader_t&& r) noexcept
+    {
+        if (!(name == kPortSetpoint))
+            return BindResult::unknown_port;
+        setpoint_.emplace(std::move(r));
+        return BindResult::ok;
+    }
+
+    std::vector<uint64_t> trace;
+    uint32_t last_setpoint = 0;
+    tick_t last_now = 0;
+    uint64_t steps = 0;
+
+private:
+    std::optional<ring_channel_t::reader_t> level_;
+    std::optional<mailbox_channel_t::reader_t> setpoint_;
+};
+
+// Bootstrapped graph: replay ports stand in for the recorded producers.
+struct Graph {
+    Graph()
+    {
+        EXPECT(level.bind_writer(level_port, kPortLevel) == BindResult::ok);
+        EXPECT(level.bind_reader(consumer, kPortLevel) == BindResult::ok);
+        EXPECT(setpoint.bind_writer(setpoint_port, kPortSetpoint) == BindResult::ok);
+        EXPECT(setpoint.bind_reader(consumer, kPortSetpoint) == BindResult::ok);
+        EXPECT(level.is_fully_bound() && setpoint.is_fully_bound());
+        EXPECT(replayer.route(kTypeLevel, 0, level_port.sink()));
+        EXPECT(replayer.route(kTypeSetpoint, setpoint_port.sink()));
+    }
+
+    ring_channel_t level;
+    mailbox_channel_t setpoint;
+    ReplayPort<ring_channel_t::writer_t, uint32_t> level_port{kPortLevel};
+    ReplayPort<mailbox_channel_t::writer_t, uint32_t> setpoint_port{kPortSetpoint};
+    Consumer consumer;
+    Replayer replayer;
+};
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_replay_is_deterministic)
+{
+    const std::string dir = make_tmp_dir("wal_replay");
+    write_range(dir + "/00000001_00000001.seg", 0, 3000);
+    write_range(dir + "/00000001_00000002.seg", 3000, 3000);
+    std::vector<std::string> segs;
+    EXPECT(wal::internal::list_segments(dir.c_str(), segs) && segs.size() == 2);
+
+    ReplayOptions opt;
+    opt.tick_units = 10;
+    std::vector<uint64_t> first;
+    for (int pass = 0; pass < 2; ++pass) {
+        Graph g;
+        ReplayStats st;
+        EXPECT(g.replayer.run(segs, wal::internal::make_replay_tick(g.consumer), opt, &st));
+        EXPECT(st.records == 6000u && st.first_seq == 0u && st.last_seq == 5999u && st.sources == 2u);
+        EXPECT(st.injected == 4000u && st.unrouted == 2000u && st.rejected == 0u);
+        // 7 units per record over 10-unit ticks: every tick through the last record's.
+        EXPECT(st.ticks == 5999u * 7u / 10u + 1u && g.consumer.steps == st.ticks);
+        EXPECT(g.consumer.last_now == 5999u * 7u / 10u);
+        if (pass == 0)
+            first = g.consumer.trace;
+        else
+            EXPECT(g.consumer.trace == first);
+    }
+
+    // Each level sample is consumed on the tick its commit_ts falls in.
+    size_t levels = 0;
+    for (uint64_t e : first) {
+        const uint32_t v = static_cast<uint32_t>(e);
+        if ((v & 0x80000000u) != 0)
+            continue;
+        EXPECT(v % 3 == 0);
+        EXPECT((e >> 32) == v * 7u / 10u);
+        ++levels;
+    }
+    EXPECT(levels == 2000u);
+
+    remove_tree(dir);
+}
+
+TEST(test_replay_window_clock_and_archive)
+{
+    const std::string dir = make_tmp_dir("wal_replay");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    write_range(seg, 0, 5000);
+    EXPECT(wal::internal::rebuild_segment_index(seg.c_str(), 256));
+
+    ReplayOptions opt;
+    opt.seq_from = 2001;
+    opt.seq_to = 2400;
+
+    // Window through the index, then the same window from the archive.
+    std::vector<uint64_t> trace;
+    {
+        Graph g;
+        ReplayStats st;
+        EXPECT(g.replayer.run({seg}, wal::internal::make_replay_tick(g.consumer), opt, &st));
+        EXPECT(st.records == 399u && st.first_seq == 2001u && st.last_seq == 2399u);
+        EXPECT(g.consumer.trace.front() == 2001u); // tick 0, first level sample
+        trace = g.consumer.trace;
+    }
+    const std::string arc = wal::internal::archive_path(seg);
+    EXPECT(wal::internal::archive_segment(seg.c_str(), arc.c_str(), 512));
+    {
+        Graph g;
+        ReplayStats st;
+        EXPECT(g.replayer.run({arc}, wal::internal::make_replay_tick(g.consumer), opt, &st));
+        EXPECT(st.records == 399u && st.first_seq == 2001u);
+        EXPECT(g.consumer.trace == trace);
+    }
+
+    // event_ts clock: late records are clamped, the clock never runs back.
+    {
+        Graph g;
+        ReplayStats st;
+        opt.clock = ReplayClock::Event;
+        EXPECT(g.replayer.run({seg}, wal::internal::make_replay_tick(g.consumer), opt, &st));
+        EXPECT(st.records == 399u);
+        for (size_t i = 1; i < g.consumer.trace.size(); ++i)
+            EXPECT((g.consumer.trace[i] >> 32) >= (g.consumer.trace[i - 1] >> 32));
+    }
+
+    remove_tree(dir);
+}
+
+TEST(test_replay_pacing)
+{
+    const std::string dir = make_tmp_dir("wal_replay");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    write_range(seg, 0, 300); // 2093 units ≈ 209 ms of plant time
+
+    ReplayOptions opt;
+    opt.tick_units = 100;
+    using clock = std::chrono::steady_clock;
+    auto elapsed_ms = [&](double speed) {
+        Graph g;
+        ReplayStats st;
+        opt.speed = speed;
+        const auto t0 = clock::now();
+        EXPECT(g.replayer.run({seg}, wal::internal::make_replay_tick(g.consumer), opt, &st));
+        EXPECT(st.records == 300u && st.ticks == 21u);
+        return std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    };
+
+    const double real = elapsed_ms(1.0);   // 21 ticks of 10 ms
+    const double fast = elapsed_ms(5.0);
+    const double max = elapsed_ms(0.0);
+    std::printf("(1x %.0f ms, 5x %.0f ms, max %.1f ms) ", real, fast, max);
+    EXPECT(real >= 210.0);
+    EXPECT(fast >= 42.0 && fast < real);
+    EXPECT(max < fast);
+
+    remove_tree(dir);
+}
+
+TEST(test_replay_stops_on_seq_regression)
+{
+    const std::string dir = make_tmp_dir("wal_replay");
+    const std::string a = dir + "/00000001_00000001.seg";
+    const std::string b = dir + "/00000001_00000002.seg";
+    write_range(a, 0, 100);
+    write_range(b, 50, 100); // overlaps: out of order
+
+    Graph g;
+    ReplayStats st;
+    EXPECT(!g.replayer.run({a, b}, wal::internal::make_replay_tick(g.consumer), {}, &st));
+    EXPECT(st.out_of_order && st.records == 100u && st.last_seq == 99u);
+    EXPECT(g.consumer.steps == st.ticks && st.ticks > 0u);
+
+    EXPECT(!g.replayer.run({dir + "/missing.seg"}, wal::internal::make_replay_tick(g.consumer), {}, &st));
+    EXPECT(!st.out_of_order && st.records == 0u && st.sources == 0u);
+
+    remove_tree(dir);
+}
+
+TEST(test_replay_skips_extension_records)
+{
+    // Plain records 0..8, a checkpoint of the level channel (id = kTypeLevel,
+    // producer 0: it would hit the level route), a fragmented event with a
+    // plain record between its fragments, a loss record (event_type 0),
+    // plain records 17..20.
+    std::vector<LogRecordV2> recs;
+    for (uint64_t s = 0; s < 9; ++s)
+        recs.push_back(record_at(s));
+
+    uint8_t state[30];
+    for (size_t i = 0; i < sizeof(state); ++i)
+        state[i] = static_cast<uint8_t>(0xA0 + i);
+    wal::internal::CheckpointBuilder builder;
+    EXPECT(builder.add(kTypeLevel, {state, sizeof(state), [](void* p, uint8_t* out) noexcept {
+                                        std::memcpy(out, p, 30);
+                                        return wal::internal::SnapshotResult::Taken;
+                                    }}));
+    EXPECT(builder.build({1, 9, 0, 1000 + 7 * 9, 0}, recs) == 3u);
+
+    uint8_t big[40];
+    for (size_t i = 0; i < sizeof(big); ++i)
+        big[i] = static_cast<uint8_t>(i * 3);
+    LogRecordV2 proto{};
+    proto.version = wal::kLogRecordVersion;
+    proto.event_type = 5;
+    proto.producer_id = 2;
+    LogRecordV2 frags[3];
+    EXPECT(wal::internal::encode_fragments(proto, big, sizeof(big), frags, 3) == 3u);
+    recs.push_back(frags[0]);
+    recs.push_back(record_at(13));
+    recs.push_back(frags[1]);
+    recs.push_back(frags[2]);
+    recs.push_back(wal::make_loss_record(1, 100, 5, 0));
+    for (uint64_t s = 17; s < 21; ++s)
+        recs.push_back(record_at(s));
+    for (uint64_t s = 12; s < 17; ++s) {
+        if (s == 13)
+            continue;
+        recs[s].global_seq = s;
+        recs[s].commit_ts = 1000 + 7 * s;
+        recs[s].crc32 = wal::record_crc(recs[s]);
+    }
+
+    const std::string dir = make_tmp_dir("wal_replay");
+    const std::string seg = dir + "/00000001_00000001.seg";
+    write_records(seg, recs);
+
+    // Whole events of types 0 and 5, as the replay hands them out.
+    struct Catcher {
+        std::vector<std::vector<uint8_t>> events;
+
+        wal::internal::ReplaySink sink() noexcept
+        {
+            return {this, [](void* p, const wal::internal::AssembledEvent& ev) noexcept {
+                        static_cast<Catcher*>(p)->events.emplace_back(ev.data, ev.data + ev.length);
+                        return true;
+                    }};
+        }
+    };
+    Catcher loss;
+    Catcher wide;
+
+    Graph g;
+    EXPECT(g.replayer.route(0, loss.sink()));
+    EXPECT(g.replayer.route(5, wide.sink()));
+    ReplayStats st;
+    EXPECT(g.replayer.run({seg}, wal::internal::make_replay_tick(g.consumer), {}, &st));
+    EXPECT(st.records == 21u && st.skipped == 4u && st.dropped == 0u);
+    EXPECT(st.injected == 4u + 5u + 1u && st.unrouted == 5u && st.rejected == 0u);
+
+    EXPECT(loss.events.empty());
+    EXPECT(wide.events.size() == 1u && wide.events[0].size() == sizeof(big));
+    EXPECT(std::memcmp(wide.events[0].data(), big, sizeof(big)) == 0);
+
+    // Only the recorded level samples reached the level channel.
+    std::vector<uint32_t> levels;
+    for (uint64_t e : g.consumer.trace) {
+        if ((e & 0x80000000u) == 0)
+            levels.push_back(static_cast<uint32_t>(e));
+    }
+    EXPECT((levels == std::vector<uint32_t>{0, 3, 6, 18}));
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void replay_tests()
+{
+    std::printf("\n--- replay ---\n");
+
+    RUN(test_replay_is_deterministic);
+    RUN(test_replay_window_clock_and_archive);
+    RUN(test_replay_pacing);
+    RUN(test_replay_stops_on_seq_regression);
+    RUN(test_replay_skips_extension_records);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
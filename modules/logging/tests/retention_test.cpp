@@ -0,0 +1,304 @@
+#include "retention/retention.hpp"
+#include "test_harness.hpp"
+
+#include "index/segment_index.hpp"
+#include "log_record.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using wal::LogRecordV2;
+using wal::internal::RetentionBudget;
+using wal::internal::RetentionManager;
+using wal::internal::RetentionPolicy;
+using wal::internal::RetentionTick;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static std::string seg_name(const std::string& dir, uint32_t n)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "/00000001_%08u.seg", n);
+    return dir + name;
+}
+
+static bool exists(const std::string& path)
+{
+    struct stat st{};
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+static int64_t file_size(const std::string& path)
+{
+    struct stat st{};
+    return ::stat(path.c_str(), &st) == 0 ? static_cast<int64_t>(st.st_size) : -1;
+}
+
+// Segment `n` of `count` sealed records: global_seq from `first`,
+// commit_ts from `ts`.
+static bool write_segment(const std::string& dir, uint32_t n, uint64_t first, uint64_t count, uint64_t ts)
+{
+    std::vector<LogRecordV2> recs;
+    for (uint64_t i = 0; i < count; ++i)
+        recs.push_back(sealed_record(first + i, ts + i, 1));
+    write_records(seg_name(dir, n), recs);
+    return true;
+}
+
+// Five segments of 100 records: seq 1..500, segment k spans commit_ts
+// 1000k .. 1000k + 99.
+static void write_five(const std::string& dir)
+{
+    for (uint32_t k = 1; k <= 5; ++k)
+        EXPECT(write_segment(dir, k, 1 + (k - 1) * 100, 100, 1000 * k));
+}
+
+static constexpr uint64_t kSegBytes = 100 * sizeof(LogRecordV2);
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_retention_max_bytes_spread_over_ticks)
+{
+    const std::string dir = make_tmp_dir("wal_retention");
+    write_five(dir);
+    FILE* idx = std::fopen(wal::internal::segment_index_path(seg_name(dir, 1)).c_str(), "wb");
+    EXPECT(idx != nullptr);
+    std::fclose(idx);
+
+    RetentionPolicy policy;
+    policy.max_bytes = 3 * kSegBytes;
+    RetentionManager rm(dir.c_str(), policy);   // one retirement per tick
+
+    RetentionTick t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 1 && t.deferred && !t.pinned);
+    EXPECT(t.bytes_freed == kSegBytes);
+    EXPECT(!exists(seg_name(dir, 1)));
+    EXPECT(!exists(wal::internal::segment_index_path(seg_name(dir, 1))));
+    EXPECT(exists(seg_name(dir, 2)));
+
+    t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 1 && !t.deferred);
+    EXPECT(rm.wal_bytes() == 3 * kSegBytes);
+
+    // At the limit: nothing more to do.
+    t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 0 && !t.deferred);
+    EXPECT(exists(seg_name(dir, 3)) && exists(seg_name(dir, 5)));
+    EXPECT(rm.stats().retired == 2 && rm.stats().bytes_freed == 2 * kSegBytes);
+
+    remove_tree(dir);
+}
+
+TEST(test_retention_byte_budget)
+{
+    const std::string dir = make_tmp_dir("wal_retention");
+    write_five(dir);
+
+    RetentionPolicy policy;
+    policy.max_bytes = 1;
+    RetentionBudget budget;
+    budget.segments = 10;
+    budget.bytes = 2 * kSegBytes;
+    RetentionManager rm(dir.c_str(), policy, budget);
+
+    RetentionTick t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 2 && t.deferred);
+    t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 2 && !t.deferred);
+
+    // The newest segment stays, however far over the limit.
+    t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 0);
+    EXPECT(exists(seg_name(dir, 5)));
+    EXPECT(rm.wal_bytes() == kSegBytes);
+
+    remove_tree(dir);
+}
+
+TEST(test_retention_max_age)
+{
+    const std::string dir = make_tmp_dir("wal_retention");
+    write_five(dir);
+
+    RetentionPolicy policy;
+    policy.max_age_ticks = 1500;
+    RetentionBudget budget;
+    budget.segments = 10;
+    RetentionManager rm(dir.c_str(), policy, budget);
+
+    // Cutoff 2600: segments 1 (last ts 1099) and 2 (last ts 2099) expired.
+    RetentionTick t = rm.tick(4100);
+    EXPECT(t.ok && t.retired == 2 && !t.deferred);
+    EXPECT(!exists(seg_name(dir, 2)) && exists(seg_name(dir, 3)));
+
+    // Everything expired: the newest segment is still kept.
+    t = rm.tick(100000);
+    EXPECT(t.ok && t.retired == 2);
+    EXPECT(exists(seg_name(dir, 5)));
+
+    remove_tree(dir);
+}
+
+TEST(test_retention_checkpoint_pin)
+{
+    const std::string dir = make_tmp_dir("wal_retention");
+    write_five(dir);
+
+    RetentionPolicy policy;
+    policy.max_bytes = 1;
+    policy.keep_since_checkpoint = true;
+    RetentionBudget budget;
+    budget.segments = 10;
+    RetentionManager rm(dir.c_str(), policy, budget);
+
+    // No checkpoint known yet: nothing may go.
+    RetentionTick t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 0 && t.pinned);
+
+    // Checkpoint starts at seq 250 (segment 3): segments 1 and 2 may go.
+    rm.note_checkpoint(250);
+    t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 2 && t.pinned);
+    EXPECT(!exists(seg_name(dir, 2)) && exists(seg_name(dir, 3)));
+
+    // Checkpoint at the first record of segment 4: segment 3 goes too.
+    rm.note_checkpoint(301);
+    t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 1 && t.pinned);
+    EXPECT(exists(seg_name(dir, 4)));
+
+    remove_tree(dir);
+}
+
+TEST(test_retention_recycle_pool)
+{
+    const std::string dir = make_tmp_dir("wal_retention");
+    write_five(dir);
+
+    RetentionPolicy policy;
+    policy.max_bytes = 1;
+    policy.recycle_max = 2;
+    RetentionBudget budget;
+    budget.segments = 10;
+    {
+        RetentionManager rm(dir.c_str(), policy, budget);
+        const RetentionTick t = rm.tick(0);
+        EXPECT(t.ok && t.retired == 4);
+        EXPECT(rm.stats().recycled == 2 && rm.stats().deleted == 2);
+    }
+    EXPECT(file_size(dir + "/recycle_0.free") == 0);
+    EXPECT(file_size(dir + "/recycle_1.free") == 0);
+    EXPECT(!exists(dir + "/recycle_2.free"));
+
+    // The next segment reuses a pooled file; after a restart the pool
+    // refills without clobbering the remaining entry.
+    const std::string next = seg_name(dir, 6);
+    EXPECT(wal::internal::take_recycled_segment(dir.c_str(), next.c_str()));
+    EXPECT(file_size(next) == 0);
+    EXPECT(write_segment(dir, 6, 501, 100, 6000));
+    EXPECT(write_segment(dir, 7, 601, 100, 7000));
+    {
+        RetentionManager rm(dir.c_str(), policy, budget);
+        const RetentionTick t = rm.tick(0);
+        EXPECT(t.ok && t.retired == 2);
+        EXPECT(rm.stats().recycled == 1 && rm.stats().deleted == 1);
+    }
+    EXPECT(wal::internal::take_recycled_segment(dir.c_str(), seg_name(dir, 8).c_str()));
+    EXPECT(wal::internal::take_recycled_segment(dir.c_str(), seg_name(dir, 9).c_str()));
+    EXPECT(!wal::internal::take_recycled_segment(dir.c_str(), seg_name(dir, 10).c_str()));
+
+    remove_tree(dir);
+}
+
+TEST(test_retention_recycle_keeps_mapped_segment)
+{
+    const std::string dir = make_tmp_dir("wal_retention");
+    write_five(dir);
+
+    // A reader (Tailer, query scan) still maps the oldest segment.
+    const int fd = ::open(seg_name(dir, 1).c_str(), O_RDONLY | O_CLOEXEC);
+    EXPECT(fd >= 0);
+    void* map = ::mmap(nullptr, kSegBytes, PROT_READ, MAP_SHARED, fd, 0);
+    EXPECT(map != MAP_FAILED);
+    ::close(fd);
+
+    RetentionPolicy policy;
+    policy.max_bytes = 4 * kSegBytes;
+    policy.recycle_max = 1;
+    RetentionManager rm(dir.c_str(), policy, RetentionBudget{});
+    const RetentionTick t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 1);
+    EXPECT(rm.stats().recycled == 1);
+    EXPECT(!exists(seg_name(dir, 1)) && file_size(dir + "/recycle_0.free") == 0);
+
+    // The mapping still sees the retired records: the pooled file is a
+    // new inode, the old one was not truncated under the reader.
+    const auto* recs = static_cast<const LogRecordV2*>(map);
+    EXPECT(wal::record_valid(recs[0]) && recs[0].global_seq == 1u);
+    EXPECT(wal::record_valid(recs[99]) && recs[99].global_seq == 100u);
+    ::munmap(map, kSegBytes);
+
+    remove_tree(dir);
+}
+
+TEST(test_retention_archives_before_delete)
+{
+    const std::string dir = make_tmp_dir("wal_retention");
+    const std::string arc = make_tmp_dir("wal_retention");
+    write_five(dir);
+
+    RetentionPolicy policy;
+    policy.max_bytes = 4 * kSegBytes;
+    policy.archive_dir = arc;
+    policy.recycle_max = 0;
+    RetentionManager rm(dir.c_str(), policy);
+
+    const RetentionTick t = rm.tick(0);
+    EXPECT(t.ok && t.retired == 1);
+    EXPECT(rm.stats().archived == 1 && rm.stats().deleted == 1);
+    EXPECT(!exists(seg_name(dir, 1)));
+    EXPECT(file_size(arc + "/00000001_00000001.arc") > 0);
+
+    // Archive target unusable: the segment is kept and the tick reports it.
+    remove_tree(arc);
+    RetentionPolicy broken = policy;
+    broken.max_bytes = 1;
+    RetentionManager rm2(dir.c_str(), broken);
+    const RetentionTick t2 = rm2.tick(0);
+    EXPECT(!t2.ok && t2.retired == 0);
+    EXPECT(exists(seg_name(dir, 2)));
+    EXPECT(rm2.stats().errors == 1);
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void retention_tests()
+{
+    std::printf("\n--- retention ---\n");
+
+    RUN(test_retention_max_bytes_spread_over_ticks);
+    RUN(test_retention_byte_budget);
+    RUN(test_retention_max_age);
+    RUN(test_retention_checkpoint_pin);
+    RUN(test_retention_recycle_pool);
+    RUN(test_retention_recycle_keeps_mapped_segment);
+    RUN(test_retention_archives_before_delete);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
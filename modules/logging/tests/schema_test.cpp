@@ -0,0 +1,331 @@
+#include "schema/event_schema.hpp"
+#include "test_harness.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using wal::LogRecordV2;
+using wal::internal::AssembledEvent;
+using wal::internal::EventDesc;
+using wal::internal::EventRegistry;
+using wal::internal::EventTraits;
+using wal::internal::FieldDesc;
+using wal::internal::FieldKind;
+using wal::internal::FragmentAssembler;
+using wal::internal::FragmentResult;
+using wal::internal::SchemaSet;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+namespace {
+
+enum class Mode : uint8_t { Idle = 0, Heat = 1, Hold = 2 };
+
+// 10 wire bytes (the struct has 12): one record.
+struct MotorCurrent {
+    uint16_t axis;
+    int32_t  milliamps;
+    float    temp_c;
+};
+
+// 3 + 8 + 8 + 2 = 21 wire bytes: two fragments.
+struct PhaseChange {
+    Mode     mode;
+    bool     manual;
+    char     tag[1];
+    double   setpoint;
+    int16_t  samples[4];
+    uint8_t  crc[2];
+};
+
+// 4 + 200 wire bytes: 15 fragments.
+struct Trace {
+    uint32_t id;
+    char     text[200];
+};
+
+} // namespace
+
+template <>
+struct wal::internal::EventSchema<MotorCurrent> {
+    static constexpr uint8_t type = 0x10;
+    static constexpr const char* name = "motor_current";
+    static constexpr FieldDesc fields[] = {
+        WAL_EVENT_FIELD(MotorCurrent, axis),
+        WAL_EVENT_FIELD(MotorCurrent, milliamps),
+        WAL_EVENT_FIELD(MotorCurrent, temp_c),
+    };
+};
+
+template <>
+struct wal::internal::EventSchema<PhaseChange> {
+    static constexpr uint8_t type = 0x11;
+    static constexpr const char* name = "phase_change";
+    static constexpr FieldDesc fields[] = {
+        WAL_EVENT_FIELD(PhaseChange, mode),
+        WAL_EVENT_FIELD(PhaseChange, manual),
+        WAL_EVENT_FIELD(PhaseChange, tag),
+        WAL_EVENT_FIELD(PhaseChange, setpoint),
+        WAL_EVENT_FIELD(PhaseChange, samples),
+        WAL_EVENT_FIELD(PhaseChange, crc),
+    };
+};
+
+template <>
+struct wal::internal::EventSchema<Trace> {
+    static constexpr uint8_t type = 0x12;
+    static constexpr const char* name = "trace";
+    static constexpr FieldDesc fields[] = {
+        WAL_EVENT_FIELD(Trace, id),
+        WAL_EVENT_FIELD(Trace, text),
+    };
+};
+
+using Registry = EventRegistry<MotorCurrent, PhaseChange, Trace>;
+
+// Compile-time facts: fit, fragment counts, reflection lookup.
+static_assert(EventTraits<MotorCurrent>::wire_bytes == 10 && EventTraits<MotorCurrent>::records == 1);
+static_assert(EventTraits<PhaseChange>::wire_bytes == 21 && EventTraits<PhaseChange>::records == 2);
+static_assert(EventTraits<Trace>::wire_bytes == 204 && EventTraits<Trace>::records == 15);
+static_assert(EventTraits<PhaseChange>::wire_fields[3].offset == 3);
+static_assert(Registry::find(0x11) != nullptr && Registry::find(0x11)->field_count == 6);
+static_assert(Registry::find(0x13) == nullptr);
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static LogRecordV2 proto(uint8_t producer, uint64_t pseq)
+{
+    LogRecordV2 r{};
+    r.version = wal::kLogRecordVersion;
+    r.producer_id = producer;
+    r.producer_seq = pseq;
+    r.event_ts = 777;
+    return r;
+}
+
+static PhaseChange sample_phase()
+{
+    PhaseChange p{};
+    p.mode = Mode::Hold;
+    p.manual = true;
+    p.tag[0] = 'B';
+    p.setpoint = 65.5;
+    p.samples[0] = -3;
+    p.samples[1] = 0;
+    p.samples[2] = 300;
+    p.samples[3] = -32768;
+    p.crc[0] = 0xAB;
+    p.crc[1] = 0x01;
+    return p;
+}
+
+// Commit `recs` in order: global_seq from `seq`, sealed.
+static void commit(LogRecordV2* recs, size_t n, uint64_t& seq)
+{
+    for (size_t i = 0; i < n; ++i) {
+        recs[i].global_seq = seq++;
+        recs[i].commit_ts = 1000 + recs[i].global_seq;
+        recs[i].crc32 = wal::record_crc(recs[i]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_single_record_roundtrip_and_layout)
+{
+    const MotorCurrent in{3, -1200, 36.5f};
+    LogRecordV2 rec;
+    EXPECT(wal::internal::encode_event(proto(2, 9), in, &rec) == 1);
+    EXPECT(rec.event_type == 0x10);
+    EXPECT(rec.producer_id == 2 && rec.producer_seq == 9 && rec.event_ts == 777);
+
+    // Packed little-endian, no struct padding, rest of the payload zero.
+    EXPECT(rec.payload[0] == 3 && rec.payload[1] == 0);
+    int32_t ma = 0;
+    std::memcpy(&ma, rec.payload + 2, sizeof(ma));
+    EXPECT(ma == -1200);
+    for (size_t i = 10; i < sizeof(rec.payload); ++i)
+        EXPECT(rec.payload[i] == 0);
+
+    MotorCurrent out{};
+    EXPECT(wal::internal::decode_event(rec, out));
+    EXPECT(out.axis == 3 && out.milliamps == -1200 && out.temp_c == 36.5f);
+
+    // Other type, or a fragment of one: not this event.
+    LogRecordV2 other = rec;
+    other.event_type = 0x11;
+    EXPECT(!wal::internal::decode_event(other, out));
+    other = rec;
+    other.reserved[0] = wal::internal::kExtFragment;
+    EXPECT(!wal::internal::decode_event(other, out));
+}
+
+TEST(test_fragmented_roundtrip_through_assembler)
+{
+    const PhaseChange phase = sample_phase();
+    Trace trace{};
+    trace.id = 0xC0FFEE;
+    std::snprintf(trace.text, sizeof(trace.text), "mash step %d reached after %d s", 3, 1260);
+
+    // Producer 1: a phase change; producer 2: a trace; interleaved with a
+    // plain motor record of producer 3.
+    LogRecordV2 a[wal::internal::kEventRecords<PhaseChange>];
+    LogRecordV2 b[wal::internal::kEventRecords<Trace>];
+    LogRecordV2 m;
+    EXPECT(wal::internal::encode_event(proto(1, 100), phase, a) == 2);
+    EXPECT(wal::internal::encode_event(proto(2, 50), trace, b) == 15);
+    EXPECT(wal::internal::encode_event(proto(3, 1), MotorCurrent{1, 5, 20.0f}, &m) == 1);
+
+    std::vector<LogRecordV2> stream;
+    stream.push_back(a[0]);
+    for (size_t i = 0; i < 8; ++i)
+        stream.push_back(b[i]);
+    stream.push_back(m);
+    stream.push_back(a[1]);
+    for (size_t i = 8; i < 15; ++i)
+        stream.push_back(b[i]);
+    uint64_t seq = 1;
+    commit(stream.data(), stream.size(), seq);
+
+    FragmentAssembler assembler;
+    int motors = 0, phases = 0, traces = 0;
+    wal::internal::assemble_events(stream, assembler, [&](const AssembledEvent& ev) {
+        const bool known = Registry::dispatch(ev, [&](const auto& v) {
+            using T = std::remove_cvref_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, MotorCurrent>) {
+                EXPECT(v.axis == 1 && v.milliamps == 5);
+                ++motors;
+            } else if constexpr (std::is_same_v<T, PhaseChange>) {
+                EXPECT(v.mode == Mode::Hold && v.manual && v.tag[0] == 'B');
+                EXPECT(v.setpoint == 65.5);
+                EXPECT(v.samples[2] == 300 && v.samples[3] == -32768);
+                EXPECT(v.crc[0] == 0xAB && v.crc[1] == 0x01);
+                ++phases;
+            } else {
+                EXPECT(v.id == 0xC0FFEE);
+                EXPECT(std::strcmp(v.text, "mash step 3 reached after 1260 s") == 0);
+                ++traces;
+            }
+        });
+        EXPECT(known);
+    });
+    EXPECT(motors == 1 && phases == 1 && traces == 1);
+    EXPECT(assembler.dropped() == 0);
+}
+
+TEST(test_decode_rejects_wrong_length_and_type)
+{
+    uint8_t data[32] = {};
+    AssembledEvent ev;
+    ev.event_type = 0x11;
+    ev.data = data;
+    ev.length = 20;                  // PhaseChange needs 21
+    PhaseChange p;
+    EXPECT(!wal::internal::decode_event(ev, p));
+    ev.length = 21;
+    EXPECT(wal::internal::decode_event(ev, p));
+
+    ev.event_type = 0x42;            // unregistered
+    EXPECT(!Registry::dispatch(ev, [](const auto&) {}));
+
+    // A one-record type also decodes from a plain record view (14 bytes).
+    ev.event_type = 0x10;
+    ev.length = static_cast<uint16_t>(wal::internal::kFragmentBytes);
+    MotorCurrent mc;
+    EXPECT(wal::internal::decode_event(ev, mc));
+}
+
+TEST(test_format_event_from_reflection)
+{
+    uint8_t wire[EventTraits<PhaseChange>::wire_bytes];
+    wal::internal::pack_event(sample_phase(), wire);
+    const EventDesc* d = Registry::find(0x11);
+    EXPECT(d != nullptr);
+    const std::string s = wal::internal::format_event(*d, wire, sizeof(wire));
+    EXPECT(s == "phase_change{mode=2 manual=true tag=\"B\" setpoint=65.5 samples=[-3,0,300,-32768] crc=ab01}");
+
+    // A short buffer ends the field list.
+    const std::string cut = wal::internal::format_event(*d, wire, 5);
+    EXPECT(cut == "phase_change{mode=2 manual=true tag=\"B\" ...}");
+
+    LogRecordV2 rec;
+    (void)wal::internal::encode_event(proto(0, 0), MotorCurrent{7, -5, 1.25f}, &rec);
+    EXPECT(wal::internal::format_event(*Registry::find(0x10), rec.payload, sizeof(rec.payload))
+           == "motor_current{axis=7 milliamps=-5 temp_c=1.25}");
+}
+
+TEST(test_schema_file_roundtrip)
+{
+    const std::string text = wal::internal::schema_text(Registry::table);
+    EXPECT(text.rfind("# wal event schema v1\n", 0) == 0);
+    EXPECT(text.find("event 16 motor_current 10 1\n") != std::string::npos);
+    EXPECT(text.find("field samples i16 11 8\n") != std::string::npos);
+
+    SchemaSet set;
+    EXPECT(set.parse(text));
+    EXPECT(set.table().size() == Registry::table.size());
+    for (const EventDesc& want : Registry::table) {
+        const EventDesc* got = set.find(want.type);
+        EXPECT(got != nullptr);
+        EXPECT(std::strcmp(got->name, want.name) == 0);
+        EXPECT(got->wire_bytes == want.wire_bytes && got->records == want.records);
+        EXPECT(got->field_count == want.field_count);
+        for (size_t i = 0; i < want.field_count; ++i) {
+            EXPECT(std::strcmp(got->fields[i].name, want.fields[i].name) == 0);
+            EXPECT(got->fields[i].kind == want.fields[i].kind);
+            EXPECT(got->fields[i].offset == want.fields[i].offset);
+            EXPECT(got->fields[i].size == want.fields[i].size);
+        }
+    }
+
+    // Formatting from the loaded table matches the compiled one.
+    uint8_t wire[EventTraits<PhaseChange>::wire_bytes];
+    wal::internal::pack_event(sample_phase(), wire);
+    EXPECT(wal::internal::format_event(*set.find(0x11), wire, sizeof(wire))
+           == wal::internal::format_event(*Registry::find(0x11), wire, sizeof(wire)));
+}
+
+TEST(test_schema_file_rejects_inconsistent)
+{
+    SchemaSet set;
+    EXPECT(set.parse("# empty\n"));
+    EXPECT(set.table().empty());
+
+    EXPECT(!set.parse("event 1 a 4 1\nfield x u16 0 2\n"));                    // sizes do not add up
+    EXPECT(!set.parse("event 1 a 4 1\nfield x u16 0 2\nfield y u16 1 2\n"));   // gap / overlap
+    EXPECT(!set.parse("event 1 a 2 1\nfield x u32 0 2\n"));                    // partial element
+    EXPECT(!set.parse("event 1 a 20 1\nfield x bytes 0 20\n"));                // 20 bytes are 2 records
+    EXPECT(!set.parse("event 1 a 2 1\nfield x u16 0 2\nevent 1 b 2 1\nfield y u16 0 2\n")); // duplicate
+    EXPECT(!set.parse("event 1 a 2 1\n"));                                     // no fields
+    EXPECT(!set.parse("field x u16 0 2\n"));                                   // field outside an event
+    EXPECT(!set.parse("event 1 a 2 1\nfield x u128 0 2\n"));                   // unknown kind
+    EXPECT(!set.parse("event 300 a 2 1\nfield x u16 0 2\n"));                  // type out of range
+
+    EXPECT(!set.load("/nonexistent/schema.txt"));
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void schema_tests()
+{
+    std::printf("\n--- schema ---\n");
+
+    RUN(test_single_record_roundtrip_and_layout);
+    RUN(test_fragmented_roundtrip_through_assembler);
+    RUN(test_decode_rejects_wrong_length_and_type);
+    RUN(test_format_event_from_reflection);
+    RUN(test_schema_file_roundtrip);
+    RUN(test_schema_file_rejects_inconsistent);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
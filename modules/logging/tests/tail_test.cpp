@@ -0,0 +1,247 @@
+#include "backend/file_backend.hpp"
+#include "tail/tailer.hpp"
+#include "writer/writer.hpp"
+#include "test_harness.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using wal::LogRecordV2;
+using wal::internal::FileBackend;
+using wal::internal::Tailer;
+using wal::internal::TailerOptions;
+using wal::internal::Writer;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static std::string segment_name(const std::string& dir, unsigned part)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "/00000001_%08x.seg", part);
+    return dir + name;
+}
+
+static LogRecordV2 make_record(uint64_t seq)
+{
+    return sealed_record(seq, seq * 3, static_cast<uint8_t>(seq % 11));
+}
+
+static void append_bytes(const std::string& path, const void* data, size_t bytes)
+{
+    FILE* f = std::fopen(path.c_str(), "ab");
+    EXPECT(f != nullptr);
+    EXPECT(std::fwrite(data, 1, bytes, f) == bytes);
+    std::fclose(f);
+}
+
+static void write_bytes_at(const std::string& path, long offset, const void* data, size_t bytes)
+{
+    FILE* f = std::fopen(path.c_str(), "r+b");
+    EXPECT(f != nullptr);
+    EXPECT(std::fseek(f, offset, SEEK_SET) == 0);
+    EXPECT(std::fwrite(data, 1, bytes, f) == bytes);
+    std::fclose(f);
+}
+
+static size_t take(Tailer& t, std::vector<uint64_t>& seqs)
+{
+    std::span<const LogRecordV2> batch;
+    size_t n = 0;
+    for (;;) {
+        EXPECT(t.next(batch));
+        if (batch.empty())
+            return n;
+        for (const LogRecordV2& r : batch)
+            seqs.push_back(r.global_seq);
+        n += batch.size();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+TEST(test_follow_live_writer_across_segments)
+{
+    const std::string dir = make_tmp_dir("wal_tail");
+    const int doorbell = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    EXPECT(doorbell >= 0);
+
+    constexpr uint64_t kSegments = 3;
+    constexpr uint64_t kPerSegment = 2500;
+    constexpr uint64_t kTotal = kSegments * kPerSegment;
+
+    Tailer tailer;
+    TailerOptions opt;
+    opt.doorbell_fd = doorbell;
+    opt.max_batch = 256;
+    EXPECT(tailer.open(dir.c_str(), opt)); // empty directory: waits for the first segment
+
+    std::vector<uint64_t> seqs;
+    uint64_t wakes = 0;
+    std::thread consumer([&] {
+        const bool ok = tailer.follow([&](std::span<const LogRecordV2> batch) {
+            EXPECT(batch.size() <= 256u);
+            for (const LogRecordV2& r : batch) {
+                EXPECT(wal::record_valid(r));
+                seqs.push_back(r.global_seq);
+            }
+            ++wakes;
+            return seqs.size() < kTotal;
+        }, 5000);
+        EXPECT(ok);
+    });
+
+    FileBackend backend;
+    Writer w{backend};
+    w.attach_doorbell(doorbell);
+    uint64_t seq = 0;
+    for (uint64_t s = 0; s < kSegments; ++s) {
+        EXPECT(backend.open_segment(segment_name(dir, static_cast<unsigned>(s + 1)).c_str()));
+        for (uint64_t i = 0; i < kPerSegment; ++i) {
+            EXPECT(w.push(make_record(seq++)));
+            if (seq % 100 == 0) {
+                EXPECT(w.flush());
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+        EXPECT(w.flush());
+        backend.close_segment();
+    }
+
+    consumer.join();
+    EXPECT(seqs.size() == kTotal);
+    for (uint64_t i = 0; i < kTotal; ++i)
+        EXPECT(seqs[i] == i);
+    EXPECT(tailer.delivered() == kTotal && tailer.last_seq() == kTotal - 1);
+    EXPECT(tailer.segment() == segment_name(dir, 3));
+    std::printf("(%llu batches) ", static_cast<unsigned long long>(wakes));
+
+    ::close(doorbell);
+    remove_tree(dir);
+}
+
+TEST(test_torn_and_padded_tail_is_reread)
+{
+    const std::string dir = make_tmp_dir("wal_tail");
+    const std::string seg = segment_name(dir, 1);
+    std::vector<LogRecordV2> recs;
+    for (uint64_t i = 0; i < 20; ++i)
+        recs.push_back(make_record(100 + i));
+
+    // 10 records, then half of the 11th.
+    append_bytes(seg, recs.data(), 10 * sizeof(LogRecordV2) + 32);
+    Tailer t;
+    EXPECT(t.open(dir.c_str()));
+    std::vector<uint64_t> seqs;
+    EXPECT(take(t, seqs) == 10u);
+
+    // Completing the record wakes the tailer (inotify) and delivers it.
+    write_bytes_at(seg, 10 * sizeof(LogRecordV2) + 32, reinterpret_cast<const uint8_t*>(&recs[10]) + 32, 32);
+    EXPECT(t.wait(1000));
+    EXPECT(take(t, seqs) == 1u);
+
+    // Zero padding up to a page boundary (direct I/O tail) is not delivered...
+    std::vector<uint8_t> zeros(4096 - 11 * sizeof(LogRecordV2), 0);
+    append_bytes(seg, zeros.data(), zeros.size());
+    EXPECT(t.wait(1000));
+    EXPECT(take(t, seqs) == 0u);
+
+    // ...until the tail page is rewritten with records.
+    write_bytes_at(seg, 11 * sizeof(LogRecordV2), &recs[11], 9 * sizeof(LogRecordV2));
+    EXPECT(t.wait(1000));
+    EXPECT(take(t, seqs) == 9u);
+    EXPECT(seqs.size() == 20u && seqs.front() == 100u && seqs.back() == 119u);
+
+    // A corrupt record in a finished segment ends it (§11); the tailer moves on.
+    LogRecordV2 bad = make_record(120);
+    bad.payload[3] ^= 1;
+    write_bytes_at(seg, 20 * sizeof(LogRecordV2), &bad, sizeof(bad));
+    const LogRecordV2 next = make_record(121);
+    append_bytes(segment_name(dir, 2), &next, sizeof(next));
+    EXPECT(t.wait(1000));
+    EXPECT(take(t, seqs) == 1u && seqs.back() == 121u);
+    EXPECT(t.segment() == segment_name(dir, 2));
+
+    remove_tree(dir);
+}
+
+TEST(test_start_position_and_wakeups)
+{
+    const std::string dir = make_tmp_dir("wal_tail");
+    std::vector<LogRecordV2> recs;
+    for (uint64_t i = 0; i < 300; ++i)
+        recs.push_back(make_record(i));
+    append_bytes(segment_name(dir, 1), recs.data(), 100 * sizeof(LogRecordV2));
+    append_bytes(segment_name(dir, 2), &recs[100], 100 * sizeof(LogRecordV2));
+    append_bytes(segment_name(dir, 3), &recs[200], 100 * sizeof(LogRecordV2));
+
+    {
+        Tailer t;
+        TailerOptions opt;
+        opt.from_seq = 150;
+        EXPECT(t.open(dir.c_str(), opt));
+        EXPECT(t.segment() == segment_name(dir, 2));
+        std::vector<uint64_t> seqs;
+        EXPECT(take(t, seqs) == 150u && seqs.front() == 150u && seqs.back() == 299u);
+    }
+    {
+        Tailer t;
+        TailerOptions opt;
+        opt.from_end = true;
+        EXPECT(t.open(dir.c_str(), opt));
+        std::vector<uint64_t> seqs;
+        EXPECT(take(t, seqs) == 0u);
+
+        // Idle: wait() sleeps until its timeout, no spinning.
+        const auto t0 = std::chrono::steady_clock::now();
+        EXPECT(!t.wait(50));
+        EXPECT(std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(50));
+
+        const LogRecordV2 r = make_record(300);
+        append_bytes(segment_name(dir, 3), &r, sizeof(r));
+        EXPECT(t.wait(1000));
+        EXPECT(take(t, seqs) == 1u && seqs[0] == 300u);
+
+        // stop() from another thread ends a blocked follow().
+        std::thread stopper([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            t.stop();
+        });
+        EXPECT(t.follow([](std::span<const LogRecordV2>) { return true; }));
+        stopper.join();
+    }
+
+    Tailer t;
+    EXPECT(!t.open((dir + "/missing").c_str()));
+
+    remove_tree(dir);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point
+// ---------------------------------------------------------------------------
+
+void tail_tests()
+{
+    std::printf("\n--- tail ---\n");
+
+    RUN(test_follow_live_writer_across_segments);
+    RUN(test_torn_and_padded_tail_is_reread);
+    RUN(test_start_position_and_wakeups);
+
+    std::printf("\n  passed: %d / %d\n", g_passed, g_total);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+// Minimal test harness for module_logging tests (same conventions as
+// primitives/tests/test_harness.hpp: EXPECT aborts on the first failure).
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ftw.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "log_record.hpp"
+
+#define TEST(name) static void name()
+
+#define RUN(name)                                              \
+    do {                                                       \
+        ++g_total;                                             \
+        std::printf("  %-60s", #name " ");                     \
+        std::fflush(stdout);                                   \
+        name();                                                \
+        ++g_passed;                                            \
+        std::printf("PASS\n");                                 \
+    } while (0)
+
+#define EXPECT(cond)                                                   \
+    do {                                                               \
+        if (!(cond)) {                                                 \
+            std::printf("FAIL\n  assertion failed: %s\n"              \
+                        "  at %s:%d\n", #cond, __FILE__, __LINE__);   \
+            std::abort();                                              \
+        }                                                              \
+    } while (0)
+
+// Fresh directory /tmp/<prefix>_XXXXXX for one test.
+inline std::string make_tmp_dir(const char* prefix)
+{
+    std::string tmpl = std::string{"/tmp/"} + prefix + "_XXXXXX";
+    const char* dir = ::mkdtemp(tmpl.data());
+    EXPECT(dir != nullptr);
+    return tmpl;
+}
+
+// Delete `dir` and everything below it (best effort, symlinks not followed).
+inline void remove_tree(const std::string& dir)
+{
+    const auto unlink_one = [](const char* path, const struct stat*, int, struct FTW*) {
+        (void)::remove(path);
+        return 0;
+    };
+    (void)::nftw(dir.c_str(), unlink_one, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+// Valid record (version and CRC set) at global_seq `seq`: producer_seq = seq,
+// commit_ts = event_ts = `ts`, payload[0..7] = seq.
+inline wal::LogRecordV2 sealed_record(uint64_t seq, uint64_t ts, uint8_t event_type = 0,
+                                      uint8_t producer_id = 0, uint8_t flags = 0)
+{
+    wal::LogRecordV2 r{};
+    r.version = wal::kLogRecordVersion;
+    r.event_type = event_type;
+    r.flags = flags;
+    r.producer_id = producer_id;
+    r.global_seq = seq;
+    r.commit_ts = ts;
+    r.event_ts = ts;
+    r.producer_seq = seq;
+    std::memcpy(r.payload, &seq, sizeof(seq));
+    r.crc32 = wal::record_crc(r);
+    return r;
+}
+
+// Write `recs` to a new file `path` (a segment image, as the backend lays it out).
+inline void write_records(const std::string& path, const std::vector<wal::LogRecordV2>& recs)
+{
+    FILE* f = std::fopen(path.c_str(), "wb");
+    EXPECT(f != nullptr);
+    EXPECT(std::fwrite(recs.data(), sizeof(wal::LogRecordV2), recs.size(), f) == recs.size());
+    std::fclose(f);
+}
@@ -22,7 +22,8 @@
  *  - read() retries internally until a stable snapshot is obtained
  *    (lock-free, O(1) average, retry-loop under write contention).
  *  - Before the first write(), read() returns value-initialized T.
- *    "No data yet" is semantically indistinguishable from a valid zero snapshot.
+ *    "No data yet" is semantically indistinguishable from a valid zero snapshot;
+ *    reader.has_value() tells whether anything was written.
  *
  * SEQLOCK TRADE-OFF:
  *  - Reader may transiently observe torn intermediate bytes during a concurrent
@@ -36,6 +37,16 @@
  * PROGRESS:
  *  - write(): wait-free, O(1). 2 atomic RMW + payload copy.
  *  - read():  lock-free. 2 acquire loads + payload copy per attempt.
+ *  - try_read_bounded(out, max_attempts): wait-free, at most max_attempts
+ *    attempts. On exhaustion returns false and leaves out untouched, so the
+ *    caller keeps its previous stable copy (hard WCET bound for control loops).
+ *
+ * RETRY STATISTICS (optional):
+ *  - reader.attach_stats(&stats) binds a reader-owned DoubleBufferSeqLockRetryStats.
+ *    Every read()/try_read_bounded() then records its attempt count in a
+ *    log2 histogram (and bounded reads that ran out of attempts in `exhausted`).
+ *  - Counters are written only by the reader (relaxed load + store, no RMW);
+ *    any thread may sample them with relaxed loads.
  *
  * MISUSE GUARDS:
  *  - writer() may be issued at most once per primitive lifetime.
@@ -80,6 +91,48 @@ template <typename T> class DoubleBufferSeqLockReader;
 template <typename T> class DoubleBufferSeqLockTest;
 #endif
 
+// ============================================================================
+// Retry statistics (reader-owned, optional)
+// ============================================================================
+
+// Attempt-count histogram for one reader.
+//   buckets[0]            : 1 attempt (no contention)
+//   buckets[b], b >= 1    : attempts in (2^(b-1), 2^b]
+//   buckets[kBuckets - 1] : everything above 2^(kBuckets - 2)
+//   exhausted             : try_read_bounded() calls that returned false
+struct DoubleBufferSeqLockRetryStats final
+{
+    static constexpr uint32_t kBuckets = 8u;
+
+    std::atomic<uint32_t> buckets[kBuckets]{};
+    std::atomic<uint32_t> exhausted{0};
+
+    static constexpr uint32_t bucket_of(uint32_t attempts) noexcept
+    {
+        uint32_t b = 0;
+        uint32_t bound = 1u;
+        while (b + 1u < kBuckets && attempts > bound)
+        {
+            ++b;
+            bound <<= 1u;
+        }
+        return b;
+    }
+
+    // Single-writer increment (reader thread only).
+    static void bump(std::atomic<uint32_t> &c) noexcept
+    {
+        c.store(c.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+    }
+
+    void record(uint32_t attempts, bool ok) noexcept
+    {
+        bump(buckets[bucket_of(attempts)]);
+        if (!ok)
+            bump(exhausted);
+    }
+};
+
 // ============================================================================
 // Core (shared state carrier)
 // ============================================================================
@@ -106,10 +159,12 @@ template <typename T> class DoubleBufferSeqLockCore final
 
   private:
     // seq: sequence counter. Even = quiescent. Odd = write in progress.
+    // written: set once by the first write() (seq itself wraps back to 0).
     // Isolated on its own cacheline: writer and reader both touch it on every op.
     struct alignas(SYS_CACHELINE_BYTES) SeqLine final
     {
         std::atomic<uint32_t> seq{0};
+        std::atomic<bool> written{false};
     };
     SeqLine ctrl;
 
@@ -120,11 +175,14 @@ template <typename T> class DoubleBufferSeqLockCore final
     };
     Slot slot;
 
-    void read(T &out) noexcept
+    // Returns the number of attempts taken (>= 1).
+    uint32_t read(T &out) noexcept
     {
+        uint32_t attempts = 0;
         uint32_t s1, s2;
         for (;;)
         {
+            ++attempts;
             s1 = ctrl.seq.load(std::memory_order_acquire);
             if (s1 & 1u)
                 continue; // writer active
@@ -135,13 +193,53 @@ template <typename T> class DoubleBufferSeqLockCore final
             if (s1 == s2)
                 break; // consistent snapshot
         }
+        return attempts;
     }
 
+    // Same protocol, at most max_attempts attempts (max_attempts == 0 is treated as 1).
+    // Copies into a local so that out is untouched on failure.
+    // Returns the number of attempts taken; *ok reports success.
+    uint32_t read_bounded(T &out, uint32_t max_attempts, bool *ok) noexcept
+    {
+        const uint32_t limit = max_attempts == 0u ? 1u : max_attempts;
+        T tmp;
+        for (uint32_t attempts = 1u;; ++attempts)
+        {
+            const uint32_t s1 = ctrl.seq.load(std::memory_order_acquire);
+            if ((s1 & 1u) == 0u)
+            {
+                tmp = slot.value;
+                const uint32_t s2 = ctrl.seq.load(std::memory_order_acquire);
+                if (s1 == s2)
+                {
+                    out = tmp;
+                    *ok = true;
+                    return attempts;
+                }
+            }
+            if (attempts >= limit)
+            {
+                *ok = false;
+                return attempts;
+            }
+        }
+    }
+
+    // Writer-only flag to avoid repeated written.store(true) on the hot path.
+    bool writer_written_ = false;
+
+    bool has_value() const noexcept { return ctrl.written.load(std::memory_order_acquire); }
+
     void write(const T &value) noexcept
     {
         ctrl.seq.fetch_add(1u, std::memory_order_release);
         slot.value = value;
         ctrl.seq.fetch_add(1u, std::memory_order_release);
+        if (!writer_written_)
+        {
+            ctrl.written.store(true, std::memory_order_release);
+            writer_written_ = true;
+        }
     }
 };
 
@@ -181,16 +279,45 @@ template <typename T> class DoubleBufferSeqLockReader final
     DoubleBufferSeqLockReader(DoubleBufferSeqLockReader &&) noexcept = default;
     DoubleBufferSeqLockReader &operator=(DoubleBufferSeqLockReader &&) noexcept = default;
 
-    void read(T &out) noexcept { core_.read(out); }
+    void read(T &out) noexcept
+    {
+        const uint32_t attempts = core_.read(out);
+        if (stats_ != nullptr)
+            stats_->record(attempts, true);
+    }
 
     [[nodiscard]] bool try_read(T &out) noexcept
     {
-        core_.read(out);
+        read(out);
         return true;
     }
 
+    // true once the writer has written (stays true): before that, reads
+    // return a value-initialized T.
+    [[nodiscard]] bool has_value() const noexcept { return core_.has_value(); }
+
+    // Wait-free read with a hard attempt bound.
+    // false → writer kept the slot busy for max_attempts attempts; out is untouched.
+    [[nodiscard]] bool try_read_bounded(T &out, uint32_t max_attempts) noexcept
+    {
+        bool ok = false;
+        const uint32_t attempts = core_.read_bounded(out, max_attempts, &ok);
+        if (stats_ != nullptr)
+            stats_->record(attempts, ok);
+        return ok;
+    }
+
+    // Bind retry statistics (bootstrap only, at most once). stats must outlive the reader.
+    void attach_stats(DoubleBufferSeqLockRetryStats *stats) noexcept
+    {
+        assert(stats != nullptr);
+        assert(stats_ == nullptr); // bind exactly once
+        stats_ = stats;
+    }
+
   private:
     DoubleBufferSeqLockCore<T> &core_;
+    DoubleBufferSeqLockRetryStats *stats_ = nullptr;
 };
 
 // ============================================================================
@@ -0,0 +1,349 @@
+#pragma once
+
+#include "stam/stam.hpp"
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include "stam/sys/sys_align.hpp"    // SYS_CACHELINE_ALIGN
+#include "stam/sys/sys_arch.hpp"     // SYS_ARCH_X86, SYS_ARCH_ARM
+#include "stam/sys/sys_platform.hpp" // SYS_OS_LINUX
+
+#if SYS_OS_LINUX
+  #include <ctime>
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace stam::primitives
+{
+
+    /*
+     * Doorbell — spin-then-park wakeup of non-RT consumers (eventcount).
+     *
+     * The primitives are poll-only: a non-RT consumer either burns a core or
+     * sleeps a fixed period and pays it in latency. A Doorbell lets it block
+     * instead, without putting a syscall on the producer's common path:
+     *
+     *   producer:  publish (push / write) ... ring()
+     *   consumer:  wait(ready, policy)  — ready() is "there is something to read"
+     *
+     * ring() is a full fence plus one relaxed load of the futex word; only when
+     * a consumer has set the word's waiting bit does it claim the wake — a CAS
+     * that clears the bit and bumps the epoch — and issue FUTEX_WAKE. Ringers
+     * that find the bit already cleared return, so one park costs the
+     * producers one syscall in total, however many of them ring before the
+     * consumer runs again. wait() spins with a CPU relax hint, then yields,
+     * then parks on the futex word; the park re-checks ready() after setting
+     * the bit, so a ring() that raced with it is never lost (Dekker pairing of
+     * the two fences).
+     *
+     * CONTRACT:
+     *  - any number of producers may ring(); any number of consumers may wait()
+     *  - ring() after every publication the consumers' ready() depends on
+     *  - ready() reads only state that the publication made visible
+     *  - consumers are non-RT (wait() may block in the kernel)
+     *
+     * RT APPLICABILITY:
+     *  - ring(), nobody parked: wait-free, O(1), no RMW, no syscall
+     *  - ring(), consumer parked: one CAS + FUTEX_WAKE (bounded, non-blocking)
+     *    for the ringer that claims the wake, at most once per park; every
+     *    other ringer: lock-free, no syscall
+     *  - wait(): NOT RT-safe (blocks)
+     *
+     * PLATFORM:
+     *  - Linux: futex on a 32-bit word; not FUTEX_PRIVATE, so a Doorbell placed
+     *    in a ShmChannel region wakes consumers in other processes as well.
+     *  - elsewhere: the park degrades to a sleep of at most kFallbackParkUs.
+     */
+
+    struct DoorbellPolicy
+    {
+        uint32_t spin_iterations = 2048;   // relax-hint polls before yielding
+        uint32_t yield_iterations = 4;     // sched yields before parking
+        uint32_t park_timeout_us = 0;      // 0 = park until rung
+    };
+
+    namespace doorbell_detail
+    {
+        inline void cpu_relax() noexcept
+        {
+#if SYS_ARCH_X86 && (defined(__GNUC__) || defined(__clang__))
+            __builtin_ia32_pause();
+#elif SYS_ARCH_ARM && defined(__aarch64__)
+            asm volatile("yield" ::: "memory");
+#else
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+        }
+    } // namespace doorbell_detail
+
+    class Doorbell final
+    {
+    public:
+        static constexpr uint32_t kFallbackParkUs = 1000;
+
+        Doorbell() noexcept = default;
+
+        Doorbell(const Doorbell &) = delete;
+        Doorbell &operator=(const Doorbell &) = delete;
+
+        static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                      "std::atomic<uint32_t> must be lock-free (futex word)");
+
+        // Producer: call after the publication. Wakes every parked consumer.
+        //
+        // Memory ordering:
+        //  - seq_cst fence: orders the publication before the word_ load;
+        //    pairs with the fence in park(). Either this load sees the
+        //    consumer's waiting bit, or the consumer's ready() sees the
+        //    publication.
+        //  - CAS (bit set → clear, epoch + 1): exactly one ringer wins per
+        //    set bit; it changes the futex word, so a consumer between its
+        //    mark and FUTEX_WAIT returns at once instead of sleeping. A ringer
+        //    that loses sees the bit cleared by the winner, whose wake covers it.
+        void ring() noexcept
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint32_t w = word_.load(std::memory_order_relaxed);
+            while ((w & kWaiting) != 0u)
+            {
+                // w has the bit set: w + 1 clears it and carries into the epoch.
+                if (word_.compare_exchange_weak(w, w + 1u, std::memory_order_relaxed))
+                {
+                    wakes_.fetch_add(1u, std::memory_order_relaxed);
+#if SYS_OS_LINUX
+                    (void)::syscall(SYS_futex, &word_, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+                    return;
+                }
+            }
+        }
+
+        // Consumer: return once ready() holds (true), or when the park timed
+        // out or was woken with ready() still false (false: re-check stop
+        // conditions and wait again).
+        template <typename Ready>
+        [[nodiscard]] bool wait(Ready &&ready, const DoorbellPolicy &policy = {}) noexcept
+        {
+            for (uint32_t i = 0; i < policy.spin_iterations; ++i)
+            {
+                if (ready())
+                {
+                    return true;
+                }
+                doorbell_detail::cpu_relax();
+            }
+            for (uint32_t i = 0; i < policy.yield_iterations; ++i)
+            {
+                if (ready())
+                {
+                    return true;
+                }
+                std::this_thread::yield();
+            }
+            return park(ready, policy.park_timeout_us);
+        }
+
+        // Telemetry: parks entered so far (consumer side, relaxed).
+        [[nodiscard]] uint64_t parks() const noexcept { return parks_.load(std::memory_order_relaxed); }
+
+        // Telemetry: wakes issued by ring() so far (relaxed).
+        [[nodiscard]] uint64_t wakes() const noexcept { return wakes_.load(std::memory_order_relaxed); }
+
+    private:
+        // A set waiting bit outlives a park that ended without a ring (ready
+        // on re-check, timeout): the next ring() pays one wake for it.
+        template <typename Ready>
+        bool park(Ready &ready, uint32_t timeout_us) noexcept
+        {
+            const uint32_t expected = word_.fetch_or(kWaiting, std::memory_order_relaxed) | kWaiting;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ready())
+            {
+                return true;
+            }
+            parks_.fetch_add(1u, std::memory_order_relaxed);
+#if SYS_OS_LINUX
+            timespec ts{};
+            ts.tv_sec = static_cast<time_t>(timeout_us / 1000000u);
+            ts.tv_nsec = static_cast<long>(timeout_us % 1000000u) * 1000L;
+            // EAGAIN (epoch moved), EINTR, ETIMEDOUT: all end the park.
+            (void)::syscall(SYS_futex, &word_, FUTEX_WAIT, expected, timeout_us != 0u ? &ts : nullptr, nullptr, 0);
+#else
+            (void)expected;
+            const uint32_t us = timeout_us != 0u && timeout_us < kFallbackParkUs ? timeout_us : kFallbackParkUs;
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+#endif
+            return ready();
+        }
+
+        static constexpr uint32_t kWaiting = 1u;   // bit 0; the epoch counts in bits 1..31
+
+        // Futex word on a line of its own: producers only read it while
+        // nobody is parked.
+        SYS_CACHELINE_ALIGN std::atomic<uint32_t> word_{0};
+        std::atomic<uint64_t> parks_{0};
+        std::atomic<uint64_t> wakes_{0};
+    };
+
+    // ============================================================================
+    // Doorbelled<Primitive> — any channel primitive with a doorbell attached
+    // ============================================================================
+    /*
+     * Wraps SPSCRing, Mailbox2SlotSmp, SPMCSnapshotSmp, ... without touching
+     * their RT contracts. The writer view forwards push()/write()/publish() and
+     * then counts the publication and rings; the reader view forwards the
+     * read API and adds wait(policy), which returns once something was
+     * published since the previous wait() of this reader.
+     *
+     * The publication count is written by the single writer only (load +
+     * store, no RMW), so the writer's added cost is that store plus ring().
+     * A failed push() neither counts nor rings.
+     *
+     * Typical non-RT consumer:
+     *   while (!stop) { if (r.wait(policy)) drain(r); }
+     */
+
+    template <typename Primitive>
+    class Doorbelled;
+
+    template <typename Writer>
+    class DoorbelledWriter final
+    {
+    public:
+        DoorbelledWriter(Writer &&w, std::atomic<uint64_t> &published, Doorbell &bell) noexcept
+            : w_(std::move(w)), published_(&published), bell_(&bell) {}
+
+        DoorbelledWriter(const DoorbelledWriter &) = delete;
+        DoorbelledWriter &operator=(const DoorbelledWriter &) = delete;
+
+        // Move = transfer of producer role (not duplication).
+        DoorbelledWriter(DoorbelledWriter &&) noexcept = default;
+        DoorbelledWriter &operator=(DoorbelledWriter &&) noexcept = default;
+
+        template <typename T>
+        [[nodiscard]] bool push(const T &item) noexcept
+            requires requires(Writer &w, const T &v) { { w.push(v) } -> std::same_as<bool>; }
+        {
+            if (!w_.push(item))
+            {
+                return false;
+            }
+            announce();
+            return true;
+        }
+
+        template <typename T>
+        void write(const T &value) noexcept
+            requires requires(Writer &w, const T &v) { w.write(v); }
+        {
+            w_.write(value);
+            announce();
+        }
+
+        template <typename T>
+        void publish(const T &value) noexcept
+            requires requires(Writer &w, const T &v) { w.publish(v); }
+        {
+            w_.publish(value);
+            announce();
+        }
+
+        // Underlying writer (telemetry: full(), usable_capacity(), ...).
+        [[nodiscard]] Writer &inner() noexcept { return w_; }
+
+    private:
+        void announce() noexcept
+        {
+            published_->store(published_->load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+            bell_->ring();
+        }
+
+        Writer w_;
+        std::atomic<uint64_t> *published_;
+        Doorbell *bell_;
+    };
+
+    template <typename Reader>
+    class DoorbelledReader final
+    {
+    public:
+        DoorbelledReader(Reader &&r, std::atomic<uint64_t> &published, Doorbell &bell) noexcept
+            : r_(std::move(r)), published_(&published), bell_(&bell) {}
+
+        DoorbelledReader(const DoorbelledReader &) = delete;
+        DoorbelledReader &operator=(const DoorbelledReader &) = delete;
+
+        // Move = transfer of consumer role (not duplication).
+        DoorbelledReader(DoorbelledReader &&) noexcept = default;
+        DoorbelledReader &operator=(DoorbelledReader &&) noexcept = default;
+
+        template <typename T>
+        [[nodiscard]] bool pop(T &item) noexcept
+            requires requires(Reader &r, T &v) { { r.pop(v) } -> std::same_as<bool>; }
+        {
+            return r_.pop(item);
+        }
+
+        template <typename T>
+        [[nodiscard]] bool try_read(T &out) noexcept
+            requires requires(Reader &r, T &v) { { r.try_read(v) } -> std::same_as<bool>; }
+        {
+            return r_.try_read(out);
+        }
+
+        // Non-RT: block until a publication newer than the previous wait()
+        // (true), or the park ends without one (false).
+        [[nodiscard]] bool wait(const DoorbellPolicy &policy = {}) noexcept
+        {
+            const bool got = bell_->wait(
+                [this]() noexcept { return published_->load(std::memory_order_acquire) != seen_; }, policy);
+            if (got)
+            {
+                seen_ = published_->load(std::memory_order_acquire);
+            }
+            return got;
+        }
+
+        // Underlying reader (empty(), stats, ...).
+        [[nodiscard]] Reader &inner() noexcept { return r_; }
+
+    private:
+        Reader r_;
+        std::atomic<uint64_t> *published_;
+        Doorbell *bell_;
+        uint64_t seen_ = 0;
+    };
+
+    template <typename Primitive>
+    class Doorbelled final
+    {
+    public:
+        using writer_t = DoorbelledWriter<decltype(std::declval<Primitive &>().writer())>;
+        using reader_t = DoorbelledReader<decltype(std::declval<Primitive &>().reader())>;
+
+        static constexpr auto max_readers = Primitive::max_readers;
+
+        Doorbelled() noexcept = default;
+
+        Doorbelled(const Doorbelled &) = delete;
+        Doorbelled &operator=(const Doorbelled &) = delete;
+
+        // Issuance limits are the wrapped primitive's.
+        [[nodiscard]] writer_t writer() noexcept { return writer_t(inner_.writer(), published_, bell_); }
+        [[nodiscard]] reader_t reader() noexcept { return reader_t(inner_.reader(), published_, bell_); }
+
+        [[nodiscard]] Doorbell &doorbell() noexcept { return bell_; }
+        [[nodiscard]] Primitive &inner() noexcept { return inner_; }
+
+    private:
+        Primitive inner_{};
+        SYS_CACHELINE_ALIGN std::atomic<uint64_t> published_{0};
+        Doorbell bell_{};
+    };
+
+} // namespace stam::primitives
@@ -181,6 +181,12 @@ namespace stam::primitives
             ctrl.has_value.store(true, std::memory_order_release);
         }
 
+        // true once the first publish() is visible (stays true).
+        [[nodiscard]] bool has_value() const noexcept
+        {
+            return ctrl.has_value.load(std::memory_order_acquire);
+        }
+
         // Try to read the latest published snapshot (wait-free per invocation, O(1)).
         //
         // Returns false → no data published yet (has_value == false), or
@@ -286,6 +292,13 @@ namespace stam::primitives
             return core_.try_read(out);
         }
 
+        // true once the writer has published (stays true): tells "nothing
+        // published yet" apart from a lost race when try_read() returns false.
+        [[nodiscard]] bool has_value() const noexcept
+        {
+            return core_.has_value();
+        }
+
     private:
         Mailbox2SlotSmpCore<T> &core_;
     };
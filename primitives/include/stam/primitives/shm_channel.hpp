@@ -0,0 +1,416 @@
+#pragma once
+
+#include "stam/stam.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "stam/sys/sys_align.hpp"    // SYS_CACHELINE_BYTES
+#include "stam/sys/sys_mem.hpp"      // sys_mem_map_shared, sys_mem_policy
+#include "stam/sys/sys_platform.hpp" // SYS_OS_LINUX
+
+#if SYS_OS_LINUX
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace stam::primitives
+{
+
+    /*
+     * ShmChannel<Primitive> — places one channel primitive in shared memory so that
+     * its Writer and Reader(s) can live in different processes.
+     *
+     * Primitive is any wrapper of this library (SPSCRing<T, C>, SPMCSnapshotSmp<T, N>,
+     * Mailbox2SlotSmp<T>, ...). The wrapper object — Core plus writer()/reader()
+     * issuance guards — is constructed in the shared region, so issuance limits hold
+     * across all attached processes. Writer/Reader handles are process-local views
+     * of the shared Core (they store a reference into this process's mapping).
+     *
+     * LIFECYCLE (NON-RT, bootstrap only; all calls are syscalls):
+     *   owner:    auto ch = ShmChannel<Ring>::create("/stam_log");   // or create_anonymous()
+     *   peer:     auto ch = ShmChannel<Ring>::open("/stam_log");     // or attach(fd)
+     *   each:     auto w = ch.writer();  /  auto r = ch.reader();
+     *   teardown: ShmChannel<Ring>::unlink("/stam_log") once nobody needs to open it.
+     *
+     * REGION LAYOUT:
+     *   [ShmHeader (cacheline-aligned)][pad][Primitive]
+     *   The header is versioned: magic, format version, layout hash of Primitive
+     *   (type signature incl. payload type and capacity, sizeof, alignof),
+     *   object size, max_readers. open()/attach() refuse a region whose header does
+     *   not match the caller's Primitive exactly (ShmStatus).
+     *
+     * PUBLICATION:
+     *   The creator fills the header, constructs Primitive, then stores
+     *   state = ready (release). Peers load state (acquire) before touching the object.
+     *
+     * REQUIREMENTS:
+     *   - Primitive holds no pointers and no process-local resources
+     *     (true for every primitive in this library: plain data + lock-free atomics);
+     *   - all processes are built from the same headers with the same compiler
+     *     (the layout hash is compiler-specific by design);
+     *   - lock-free atomics are address-free, so they work across mappings.
+     *
+     * FAULT CONTAINMENT:
+     *   A crashed peer leaves the region intact; the surviving side keeps its mapping.
+     *   Reattaching a restarted reader is NOT supported by the issuance guards
+     *   (a new reader() counts against max_readers).
+     */
+
+    enum class ShmStatus : uint8_t
+    {
+        ok,
+        sys_error,        // shm_open / memfd_create / ftruncate / mmap failed (see errno)
+        too_small,        // region smaller than header + object
+        not_ready,        // creator has not finished construction
+        bad_magic,        // not a STAM shared channel
+        version_mismatch, // header format version differs
+        layout_mismatch,  // Primitive type / size / alignment / reader count differs
+    };
+
+    // Versioned region header. Plain data except for the ready flag.
+    struct alignas(SYS_CACHELINE_BYTES) ShmHeader final
+    {
+        static constexpr uint64_t kMagic = 0x314D48534D415453ull; // "STAMSHM1" (LE)
+        static constexpr uint32_t kVersion = 1u;
+        static constexpr uint32_t kStateReady = 1u;
+
+        uint64_t magic;
+        uint32_t version;
+        uint32_t header_bytes;
+        uint64_t layout_hash;
+        uint64_t object_offset;
+        uint64_t object_bytes;
+        uint32_t object_align;
+        uint32_t max_readers;
+        std::atomic<uint32_t> state; // 0 = initializing, kStateReady = constructed
+    };
+
+    namespace shm_detail
+    {
+        constexpr uint64_t fnv1a(const char *s, uint64_t h = 14695981039346656037ull) noexcept
+        {
+            while (*s != '\0')
+            {
+                h ^= static_cast<uint8_t>(*s++);
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+
+        constexpr uint64_t fnv1a_u64(uint64_t v, uint64_t h) noexcept
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                h ^= static_cast<uint8_t>(v >> (i * 8));
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+
+        // Type signature of P as spelled by the compiler (includes template arguments).
+        template <class P>
+        constexpr const char *type_signature() noexcept
+        {
+#if defined(_MSC_VER)
+            return __FUNCSIG__;
+#else
+            return __PRETTY_FUNCTION__;
+#endif
+        }
+
+        template <class P>
+        constexpr uint64_t layout_hash() noexcept
+        {
+            uint64_t h = fnv1a(type_signature<P>());
+            h = fnv1a_u64(sizeof(P), h);
+            h = fnv1a_u64(alignof(P), h);
+            h = fnv1a_u64(P::max_readers, h);
+            return h;
+        }
+
+        constexpr size_t round_up(size_t v, size_t a) noexcept { return (v + a - 1u) / a * a; }
+    } // namespace shm_detail
+
+    template <class Primitive>
+    class ShmChannel final
+    {
+    public:
+        static_assert(std::is_nothrow_default_constructible_v<Primitive>,
+                      "ShmChannel requires nothrow default constructible Primitive");
+        static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                      "std::atomic<uint32_t> must be lock-free (address-free) on this platform");
+
+        static constexpr uint32_t max_readers = Primitive::max_readers;
+        static constexpr uint64_t layout_hash = shm_detail::layout_hash<Primitive>();
+
+        static constexpr size_t object_offset =
+            shm_detail::round_up(sizeof(ShmHeader),
+                                 alignof(Primitive) > SYS_CACHELINE_BYTES ? alignof(Primitive)
+                                                                          : size_t{SYS_CACHELINE_BYTES});
+        static constexpr size_t required_bytes = object_offset + sizeof(Primitive);
+
+        ShmChannel() noexcept = default;
+        ~ShmChannel() { reset(); }
+
+        ShmChannel(const ShmChannel &) = delete;
+        ShmChannel &operator=(const ShmChannel &) = delete;
+
+        ShmChannel(ShmChannel &&o) noexcept
+            : region_(std::exchange(o.region_, stam::sys::sys_mem_region{})),
+              obj_(std::exchange(o.obj_, nullptr)),
+              fd_(std::exchange(o.fd_, -1)),
+              status_(o.status_)
+        {}
+
+        ShmChannel &operator=(ShmChannel &&o) noexcept
+        {
+            if (this != &o)
+            {
+                reset();
+                region_ = std::exchange(o.region_, stam::sys::sys_mem_region{});
+                obj_ = std::exchange(o.obj_, nullptr);
+                fd_ = std::exchange(o.fd_, -1);
+                status_ = o.status_;
+            }
+            return *this;
+        }
+
+        // Create a named region (shm_open, O_EXCL) and construct Primitive in it.
+        // name follows shm_open rules ("/name"). Fails if the name already exists.
+        [[nodiscard]] static ShmChannel create(const char *name,
+                                               const stam::sys::sys_mem_policy &policy = {}) noexcept
+        {
+            ShmChannel ch;
+#if SYS_OS_LINUX
+            const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd < 0)
+            {
+                ch.status_ = ShmStatus::sys_error;
+                return ch;
+            }
+            ch.fd_ = fd;
+            ch.init_owner(size_for(false), policy, false);
+            if (!ch)
+            {
+                (void)::shm_unlink(name);
+            }
+#else
+            (void)name;
+            (void)policy;
+            ch.status_ = ShmStatus::sys_error;
+#endif
+            return ch;
+        }
+
+        // Create an unnamed region (memfd_create). Share fd() with peers by fork()
+        // inheritance or SCM_RIGHTS; peers call attach(fd). The region disappears
+        // with the last fd / mapping. hugetlb policy requests MFD_HUGETLB.
+        [[nodiscard]] static ShmChannel create_anonymous(const stam::sys::sys_mem_policy &policy = {}) noexcept
+        {
+            ShmChannel ch;
+#if SYS_OS_LINUX
+            bool hugetlb = false;
+            int fd = -1;
+            if (policy.huge_pages == stam::sys::sys_huge_pages::hugetlb)
+            {
+                fd = ::memfd_create("stam_shm_channel", MFD_CLOEXEC | MFD_HUGETLB);
+                hugetlb = fd >= 0;
+            }
+            if (fd < 0)
+                fd = ::memfd_create("stam_shm_channel", MFD_CLOEXEC);
+            if (fd < 0)
+            {
+                ch.status_ = ShmStatus::sys_error;
+                return ch;
+            }
+            ch.fd_ = fd;
+            ch.init_owner(size_for(hugetlb), policy, hugetlb);
+#else
+            (void)policy;
+            ch.status_ = ShmStatus::sys_error;
+#endif
+            return ch;
+        }
+
+        // Open a named region created by create() (possibly in another process).
+        [[nodiscard]] static ShmChannel open(const char *name,
+                                             const stam::sys::sys_mem_policy &policy = {}) noexcept
+        {
+            ShmChannel ch;
+#if SYS_OS_LINUX
+            const int fd = ::shm_open(name, O_RDWR, 0);
+            if (fd < 0)
+            {
+                ch.status_ = ShmStatus::sys_error;
+                return ch;
+            }
+            ch.fd_ = fd;
+            ch.init_peer(policy);
+#else
+            (void)name;
+            (void)policy;
+            ch.status_ = ShmStatus::sys_error;
+#endif
+            return ch;
+        }
+
+        // Attach to a region by fd (inherited or received). The fd is duplicated;
+        // the caller keeps ownership of the one passed in.
+        [[nodiscard]] static ShmChannel attach(int fd, const stam::sys::sys_mem_policy &policy = {}) noexcept
+        {
+            ShmChannel ch;
+#if SYS_OS_LINUX
+            ch.fd_ = fd >= 0 ? ::fcntl(fd, F_DUPFD_CLOEXEC, 0) : -1;
+            if (ch.fd_ < 0)
+            {
+                ch.status_ = ShmStatus::sys_error;
+                return ch;
+            }
+            ch.init_peer(policy);
+#else
+            (void)fd;
+            (void)policy;
+            ch.status_ = ShmStatus::sys_error;
+#endif
+            return ch;
+        }
+
+        // Remove a named region; existing mappings stay valid.
+        static bool unlink(const char *name) noexcept
+        {
+#if SYS_OS_LINUX
+            return ::shm_unlink(name) == 0;
+#else
+            (void)name;
+            return false;
+#endif
+        }
+
+        // Unmap this process's view and close the fd. Does not destroy the shared object.
+        void reset() noexcept
+        {
+            obj_ = nullptr;
+            stam::sys::sys_mem_unmap(region_);
+#if SYS_OS_LINUX
+            if (fd_ >= 0)
+                (void)::close(fd_);
+#endif
+            fd_ = -1;
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept { return obj_ != nullptr; }
+        [[nodiscard]] ShmStatus status() const noexcept { return status_; }
+        [[nodiscard]] int fd() const noexcept { return fd_; }
+        [[nodiscard]] const stam::sys::sys_mem_region &region() const noexcept { return region_; }
+
+        // Handles issued from the shared wrapper: limits apply across all processes.
+        [[nodiscard]] auto writer() noexcept { return obj_->writer(); }
+        [[nodiscard]] auto reader() noexcept { return obj_->reader(); }
+
+        Primitive &channel() noexcept { return *obj_; }
+        const Primitive &channel() const noexcept { return *obj_; }
+
+    private:
+        static size_t size_for(bool hugetlb) noexcept
+        {
+            const size_t page = hugetlb ? size_t{SYS_HUGE_PAGE_SIZE} : stam::sys::detail::base_page_size();
+            return shm_detail::round_up(required_bytes, page);
+        }
+
+        ShmHeader *header() noexcept { return static_cast<ShmHeader *>(region_.addr); }
+
+#if SYS_OS_LINUX
+        void init_owner(size_t bytes, const stam::sys::sys_mem_policy &policy, bool hugetlb) noexcept
+        {
+            if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0)
+            {
+                status_ = ShmStatus::sys_error;
+                return;
+            }
+            region_ = stam::sys::sys_mem_map_shared(fd_, bytes, policy);
+            if (region_.addr == nullptr)
+            {
+                status_ = ShmStatus::sys_error;
+                return;
+            }
+            if (hugetlb)
+                region_.flags |= stam::sys::sys_mem_hugetlb;
+
+            // Start the header's lifetime (it holds an atomic) before filling it;
+            // state == 0 (initializing) until published.
+            ShmHeader *h = ::new (region_.addr) ShmHeader{};
+            h->magic = ShmHeader::kMagic;
+            h->version = ShmHeader::kVersion;
+            h->header_bytes = static_cast<uint32_t>(sizeof(ShmHeader));
+            h->layout_hash = layout_hash;
+            h->object_offset = object_offset;
+            h->object_bytes = sizeof(Primitive);
+            h->object_align = static_cast<uint32_t>(alignof(Primitive));
+            h->max_readers = max_readers;
+
+            obj_ = ::new (static_cast<uint8_t *>(region_.addr) + object_offset) Primitive();
+            h->state.store(ShmHeader::kStateReady, std::memory_order_release);
+            status_ = ShmStatus::ok;
+        }
+
+        void init_peer(const stam::sys::sys_mem_policy &policy) noexcept
+        {
+            struct stat st{};
+            if (::fstat(fd_, &st) != 0)
+            {
+                status_ = ShmStatus::sys_error;
+                return;
+            }
+            const size_t bytes = static_cast<size_t>(st.st_size);
+            if (bytes < required_bytes)
+            {
+                status_ = ShmStatus::too_small;
+                return;
+            }
+            // The peer never constructs anything, so NUMA binding is left to the owner.
+            stam::sys::sys_mem_policy peer_policy = policy;
+            peer_policy.numa_node = -1;
+            region_ = stam::sys::sys_mem_map_shared(fd_, bytes, peer_policy);
+            if (region_.addr == nullptr)
+            {
+                status_ = ShmStatus::sys_error;
+                return;
+            }
+
+            status_ = validate(*header());
+            if (status_ != ShmStatus::ok)
+            {
+                stam::sys::sys_mem_unmap(region_);
+                return;
+            }
+            obj_ = std::launder(reinterpret_cast<Primitive *>(static_cast<uint8_t *>(region_.addr) + object_offset));
+        }
+#endif
+
+        static ShmStatus validate(const ShmHeader &h) noexcept
+        {
+            if (h.state.load(std::memory_order_acquire) != ShmHeader::kStateReady)
+                return ShmStatus::not_ready;
+            if (h.magic != ShmHeader::kMagic)
+                return ShmStatus::bad_magic;
+            if (h.version != ShmHeader::kVersion || h.header_bytes != sizeof(ShmHeader))
+                return ShmStatus::version_mismatch;
+            if (h.layout_hash != layout_hash || h.object_offset != object_offset ||
+                h.object_bytes != sizeof(Primitive) || h.object_align != alignof(Primitive) ||
+                h.max_readers != max_readers)
+                return ShmStatus::layout_mismatch;
+            return ShmStatus::ok;
+        }
+
+        stam::sys::sys_mem_region region_{};
+        Primitive *obj_ = nullptr;
+        int fd_ = -1;
+        ShmStatus status_ = ShmStatus::sys_error;
+    };
+
+} // namespace stam::primitives
@@ -0,0 +1,388 @@
+#pragma once
+
+#include "stam/stam.hpp"
+#include <cassert>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include "stam/sys/sys_align.hpp" // SYS_CACHELINE_BYTES, SYS_CACHELINE_ALIGN
+
+namespace stam::primitives
+{
+
+    /*
+     * SPMCSnapshotSeqLock<T, N, K> — SPMC snapshot channel, SMP-safe, load-only readers.
+     *
+     * CONTRACT (hard requirements):
+     *  - exactly 1 producer (writer) and up to N concurrent consumers (readers)
+     *  - writer: write-only; readers: read-only; roles must not be swapped
+     *  - writer is NOT re-entrant (no nested IRQ/NMI calling publish())
+     *  - T is trivially copyable (bounded, deterministic copy; no ctor/dtor)
+     *
+     * PLATFORM CONSTRAINT:
+     *  - Default/active profile: platform-optimized (same as Mailbox2SlotSmp /
+     *    DoubleBufferSeqLock): overlapping payload copies may occur and are
+     *    rejected by per-slot seq re-verify.
+     *  - SMP-safe. No preemption_disable needed.
+     *
+     * SEMANTICS:
+     *  - Snapshot / state channel, NOT a queue or log. Latest-wins.
+     *  - try_read() returns false if no data published yet, or if the slot it
+     *    copied was overwritten during the copy (single-shot: no internal retry).
+     *  - On false, out is left untouched (sticky-state strategy).
+     *
+     * PROTOCOL (K slots + per-slot seqlock, round-robin writer):
+     *  - Writer writes slot (published + 1) % K, never the published slot.
+     *  - To tear a reader copying slot i, the writer must come back to i,
+     *    i.e. complete K-1 further publishes during one reader copy. Larger K
+     *    buys a lower miss rate for large payloads / slow readers.
+     *  - Readers NEVER write shared state: no busy_mask, no refcnt, no RMW.
+     *    Control and seq lines stay shared-clean in reader caches between
+     *    publishes, so read cost does not grow with the number of readers.
+     *
+     * Compared to SPMCSnapshotSmp:
+     *  - SPMCSnapshotSmp: readers claim slots (fetch_or / fetch_add / fetch_sub),
+     *    the writer structurally never touches a claimed slot.
+     *  - SPMCSnapshotSeqLock: readers are load-only; a writer lapping a slow
+     *    reader turns into a miss (false) instead of being avoided.
+     *
+     * PROGRESS:
+     *  - publish():  wait-free, O(1). 2 seq stores + payload copy + 1-2 stores.
+     *  - try_read(): wait-free per invocation (single-shot), O(1).
+     *                5 atomic loads + payload copy. No RMW.
+     *
+     * MISUSE GUARDS:
+     *  - writer() may be issued at most once per primitive lifetime.
+     *  - reader() may be issued at most N times per primitive lifetime.
+     *  - Exceeding either limit triggers fail-fast (assert + abort).
+     *
+     * SPEC: primitives/docs/SPMCSnapshotSeqLock - RT Contract & Invariants.md (Rev 1.0)
+     */
+
+    // ============================================================================
+    // Forward declarations
+    // ============================================================================
+
+    template <typename T, uint32_t N, uint32_t K>
+    class SPMCSnapshotSeqLockWriter;
+    template <typename T, uint32_t N, uint32_t K>
+    class SPMCSnapshotSeqLockReader;
+#ifdef STAM_TEST
+    template <typename T, uint32_t N, uint32_t K>
+    class SPMCSnapshotSeqLockTest;
+#endif
+
+    // ============================================================================
+    // Core (shared state carrier)
+    // ============================================================================
+
+    template <typename T, uint32_t N, uint32_t K = 4>
+    class SPMCSnapshotSeqLockCore final
+    {
+    public:
+        static_assert(N >= 1,
+                      "SPMCSnapshotSeqLock requires at least 1 reader (N >= 1)");
+        static_assert(K >= 2,
+                      "SPMCSnapshotSeqLock requires at least 2 slots (K >= 2)");
+        static_assert(K <= 256,
+                      "SPMCSnapshotSeqLock: slot index must fit in uint8_t (K <= 256)");
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "SPMCSnapshotSeqLock requires trivially copyable T");
+        static_assert(SYS_CACHELINE_BYTES > 0,
+                      "SYS_CACHELINE_BYTES must be defined by the portability layer");
+        static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                      "std::atomic<uint32_t> must be lock-free on this platform");
+        static_assert(std::atomic<uint8_t>::is_always_lock_free,
+                      "std::atomic<uint8_t> must be lock-free on this platform");
+        static_assert(std::atomic<bool>::is_always_lock_free,
+                      "std::atomic<bool> must be lock-free on this platform");
+
+        friend class SPMCSnapshotSeqLockWriter<T, N, K>;
+        friend class SPMCSnapshotSeqLockReader<T, N, K>;
+#ifdef STAM_TEST
+        friend class SPMCSnapshotSeqLockTest<T, N, K>;
+#endif
+
+        SPMCSnapshotSeqLockCore() noexcept = default;
+
+        SPMCSnapshotSeqLockCore(const SPMCSnapshotSeqLockCore &) = delete;
+        SPMCSnapshotSeqLockCore &operator=(const SPMCSnapshotSeqLockCore &) = delete;
+
+    private:
+        // ---- Data slots --------------------------------------------------------
+
+        // Each slot occupies an integer number of cachelines: the writer filling
+        // slot j never invalidates lines readers are copying from slot i != j.
+        struct alignas(SYS_CACHELINE_BYTES) Slot final
+        {
+            T value;
+        };
+        static_assert(sizeof(Slot) % SYS_CACHELINE_BYTES == 0,
+                      "Slot must occupy an integer number of cachelines; "
+                      "consider padding T or using a wrapper");
+
+        Slot slots[K];
+
+        // ---- Per-slot sequence counters ----------------------------------------
+
+        // seq[i]: even = quiescent (slot i is stable), odd = write in progress.
+        // One cacheline each: the writer opening seq[j] does not invalidate
+        // seq[i] in the caches of readers verifying slot i.
+        struct alignas(SYS_CACHELINE_BYTES) SeqLine final
+        {
+            std::atomic<uint32_t> seq{0};
+        };
+        SeqLine seqs[K];
+
+        // ---- Control block -----------------------------------------------------
+
+        //   published   : writer stores (release); readers load (acquire).
+        //   initialized : writer stores true once (release); readers load (acquire).
+        // Written once per publish; read-only for readers.
+        struct alignas(SYS_CACHELINE_BYTES) Control final
+        {
+            std::atomic<uint8_t> published{0};
+            std::atomic<bool> initialized{false};
+        };
+        Control ctrl;
+
+        // Writer-only state (never read by readers).
+        uint8_t writer_pub_ = 0;
+        bool writer_initialized_ = false;
+
+        // Publish a new snapshot (wait-free, O(1)).
+        //
+        // Protocol:
+        //   Step 1: j = (published + 1) % K (writer-local cursor; j != published).
+        //   Step 2: seq[j] → odd (relaxed store), then release fence: the open
+        //           mark is ordered before every payload store of step 3.
+        //   Step 3: write slots[j].value (non-atomic; single writer).
+        //   Step 4: seq[j] → even (release): closes the write window.
+        //   Step 5: published.store(j, release).
+        //   Step 6: initialized.store(true, release). Once.
+        void publish(const T &value) noexcept
+        {
+            // Step 1: round-robin past the published slot.
+            const uint8_t j = static_cast<uint8_t>((writer_pub_ + 1u) % K);
+
+            // Step 2: open write window on slot j.
+            const uint32_t s = seqs[j].seq.load(std::memory_order_relaxed);
+            seqs[j].seq.store(s + 1u, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            // Step 3: write payload.
+            slots[j].value = value;
+
+            // Step 4: close write window.
+            seqs[j].seq.store(s + 2u, std::memory_order_release);
+
+            // Step 5: switch publication.
+            ctrl.published.store(j, std::memory_order_release);
+            writer_pub_ = j;
+
+            // Step 6: signal initialization (idempotent after the first call).
+            if (!writer_initialized_)
+            {
+                ctrl.initialized.store(true, std::memory_order_release);
+                writer_initialized_ = true;
+            }
+        }
+
+        // true once the first publish() is visible (stays true).
+        [[nodiscard]] bool has_value() const noexcept
+        {
+            return ctrl.initialized.load(std::memory_order_acquire);
+        }
+
+        // Try to read the latest published snapshot (wait-free per invocation, O(1)).
+        //
+        // Returns false → no data yet, slot i was (re)written during the copy,
+        //                 or it no longer holds the published value.
+        //                 out is untouched.
+        // Returns true  → out contains a consistent snapshot.
+        //
+        // Protocol (single-shot, load-only):
+        //   Step 1: initialized.load(acquire). If false → return false.
+        //   Step 2: i = published.load(acquire).
+        //   Step 3: s1 = seq[i].load(acquire). If odd → return false.
+        //   Step 4: copy slots[i].value into a local.
+        //   Step 5: acquire fence, then s2 = seq[i].load(acquire): the fence keeps
+        //           the payload loads of step 4 before the re-verify load.
+        //           If s1 != s2 → return false.
+        //   Step 6: published.load(relaxed) != i → return false. A reader that
+        //           stalled after step 2 may find slot i already rewritten and
+        //           closed but not yet published (the writer closes seq before
+        //           it switches published): that value is newer than the
+        //           published one, and accepting it would let the next read go
+        //           backwards.
+        //   Step 7: out = local; return true.
+        [[nodiscard]] bool try_read(T &out) const noexcept
+        {
+            // Step 1: before first publish no data is available.
+            if (!ctrl.initialized.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            // Step 2: load published slot index.
+            const uint8_t i = ctrl.published.load(std::memory_order_acquire);
+
+            // Step 3: writer lapped us and is rewriting slot i.
+            const uint32_t s1 = seqs[i].seq.load(std::memory_order_acquire);
+            if ((s1 & 1u) != 0u)
+            {
+                return false;
+            }
+
+            // Step 4: copy payload.
+            T tmp = slots[i].value;
+
+            // Step 5: re-verify.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint32_t s2 = seqs[i].seq.load(std::memory_order_acquire);
+            if (s1 != s2)
+            {
+                return false; // torn copy — discard
+            }
+
+            // Step 6: slot i still the published one (not a lapped, unpublished write).
+            if (ctrl.published.load(std::memory_order_relaxed) != i)
+            {
+                return false;
+            }
+
+            // Step 7: snapshot is stable.
+            out = tmp;
+            return true;
+        }
+    };
+
+    // ============================================================================
+    // Producer view
+    // ============================================================================
+
+    template <typename T, uint32_t N, uint32_t K = 4>
+    class SPMCSnapshotSeqLockWriter final
+    {
+    public:
+        explicit SPMCSnapshotSeqLockWriter(SPMCSnapshotSeqLockCore<T, N, K> &core) noexcept
+            : core_(core) {}
+
+        SPMCSnapshotSeqLockWriter(const SPMCSnapshotSeqLockWriter &) = delete;
+        SPMCSnapshotSeqLockWriter &operator=(const SPMCSnapshotSeqLockWriter &) = delete;
+
+        // Move = transfer of producer role (not duplication).
+        SPMCSnapshotSeqLockWriter(SPMCSnapshotSeqLockWriter &&) noexcept = default;
+        SPMCSnapshotSeqLockWriter &operator=(SPMCSnapshotSeqLockWriter &&) noexcept = default;
+
+        // Publish a new snapshot (wait-free, O(1)).
+        void write(const T &value) noexcept
+        {
+            core_.publish(value);
+        }
+
+    private:
+        SPMCSnapshotSeqLockCore<T, N, K> &core_;
+    };
+
+    // ============================================================================
+    // Consumer view
+    // ============================================================================
+
+    template <typename T, uint32_t N, uint32_t K = 4>
+    class SPMCSnapshotSeqLockReader final
+    {
+    public:
+        explicit SPMCSnapshotSeqLockReader(SPMCSnapshotSeqLockCore<T, N, K> &core) noexcept
+            : core_(core) {}
+
+        SPMCSnapshotSeqLockReader(const SPMCSnapshotSeqLockReader &) = delete;
+        SPMCSnapshotSeqLockReader &operator=(const SPMCSnapshotSeqLockReader &) = delete;
+
+        // Move = transfer of consumer role (not duplication).
+        SPMCSnapshotSeqLockReader(SPMCSnapshotSeqLockReader &&) noexcept = default;
+        SPMCSnapshotSeqLockReader &operator=(SPMCSnapshotSeqLockReader &&) noexcept = default;
+
+        // Try to read the latest published snapshot (wait-free per invocation, O(1)).
+        // Load-only: never writes shared state.
+        [[nodiscard]] bool try_read(T &out) noexcept
+        {
+            return core_.try_read(out);
+        }
+
+        // true once the writer has published (stays true): tells "nothing
+        // published yet" apart from a lost race when try_read() returns false.
+        [[nodiscard]] bool has_value() const noexcept
+        {
+            return core_.has_value();
+        }
+
+    private:
+        SPMCSnapshotSeqLockCore<T, N, K> &core_;
+    };
+
+    // ============================================================================
+    // Convenience wrapper
+    // ============================================================================
+
+    template <typename T, uint32_t N, uint32_t K = 4>
+    class SPMCSnapshotSeqLock final
+    {
+    public:
+        static constexpr uint32_t max_readers = N;
+        static constexpr uint32_t slot_count = K;
+
+        SPMCSnapshotSeqLock() = default;
+
+        SPMCSnapshotSeqLock(const SPMCSnapshotSeqLock &) = delete;
+        SPMCSnapshotSeqLock &operator=(const SPMCSnapshotSeqLock &) = delete;
+
+        // NOTE: writer() must be called at most once across the object's lifetime.
+        // reader() may be called up to N times; each call yields an independent
+        // consumer handle for the same Core.
+
+        [[nodiscard]] SPMCSnapshotSeqLockWriter<T, N, K> writer() noexcept
+        {
+            bool expected = false;
+            if (!issued_writer_.compare_exchange_strong(expected, true,
+                                                        std::memory_order_acq_rel,
+                                                        std::memory_order_acquire))
+            {
+                assert(false && "SPMCSnapshotSeqLock::writer() already issued");
+                std::abort();
+            }
+            return SPMCSnapshotSeqLockWriter<T, N, K>(core_);
+        }
+
+        [[nodiscard]] SPMCSnapshotSeqLockReader<T, N, K> reader() noexcept
+        {
+            uint32_t expected = issued_readers_.load(std::memory_order_acquire);
+            while (true)
+            {
+                if (expected >= N)
+                {
+                    assert(false && "SPMCSnapshotSeqLock::reader() limit exceeded");
+                    std::abort();
+                }
+                if (issued_readers_.compare_exchange_weak(expected, expected + 1u,
+                                                          std::memory_order_acq_rel,
+                                                          std::memory_order_acquire))
+                {
+                    break;
+                }
+            }
+            return SPMCSnapshotSeqLockReader<T, N, K>(core_);
+        }
+
+        SPMCSnapshotSeqLockCore<T, N, K> &core() noexcept { return core_; }
+        const SPMCSnapshotSeqLockCore<T, N, K> &core() const noexcept { return core_; }
+
+    private:
+        SPMCSnapshotSeqLockCore<T, N, K> core_;
+        std::atomic<bool> issued_writer_{false};
+        std::atomic<uint32_t> issued_readers_{0};
+    };
+
+} // namespace stam::primitives
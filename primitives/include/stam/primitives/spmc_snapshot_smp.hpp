@@ -40,6 +40,14 @@ namespace stam::primitives
      *  - That leaves at least 2 free slots; at most 1 of them equals published.
      *  - Therefore writer always finds a free, non-published slot. QED.
      *
+     * BUSY MASK WIDTH:
+     *  - K <= signal_mask_width: busy_mask is a single lock-free word (fast path,
+     *    one acquire load + one ctz in publish()).
+     *  - K >  signal_mask_width: busy_mask is an array of busy_mask_words words;
+     *    slot i lives in word i / busy_mask_bits. Readers still touch exactly one
+     *    word per claim/release; publish() scans at most busy_mask_words words
+     *    (<= 4 on 64-bit targets for N <= 254) and stops at the first candidate.
+     *
      * TORN READ EXCLUSION (structural):
      *  - Writer never writes to the published slot (I3).
      *  - Reader reads only the published slot, under busy_mask claim (I4).
@@ -51,7 +59,8 @@ namespace stam::primitives
      *  - busy_mask[i] == 0 ⇒ refcnt[i] == 0 (strictly).
      *
      * PROGRESS:
-     *  - publish(): wait-free, O(1). Bounded atomics + one payload copy.
+     *  - publish(): wait-free, O(1). Bounded atomics + one payload copy
+     *               (+ up to busy_mask_words acquire loads in the multi-word case).
      *  - try_read(): wait-free per invocation (single-shot), O(1).
      *               1 fetch_or + 1 fetch_add + 2 published loads +
      *               1 payload copy + 1 fetch_sub + optional fetch_and.
@@ -61,7 +70,7 @@ namespace stam::primitives
      *  - reader() may be issued at most N times per primitive lifetime.
      *  - Exceeding either limit triggers fail-fast (assert + abort).
      *
-     * SPEC: primitives/docs/SPMCSnapshotSmp - RT Contract & Invariants.md (Rev 1.1)
+     * SPEC: primitives/docs/SPMCSnapshotSmp - RT Contract & Invariants.md (Rev 1.2)
      */
 
     // ============================================================================
@@ -106,14 +115,13 @@ namespace stam::primitives
         static constexpr uint32_t K = N + 2;
         using busy_mask_word_t = stam::sys::signal_mask_t;
         static constexpr uint32_t busy_mask_bits = static_cast<uint32_t>(sizeof(busy_mask_word_t) * 8u);
+        // Number of busy_mask words; 1 selects the single-word fast path.
+        static constexpr uint32_t busy_mask_words = (K + busy_mask_bits - 1u) / busy_mask_bits;
 
         static_assert(N >= 1,
                       "SPMCSnapshotSmp requires at least 1 reader (N >= 1)");
-        static_assert(K <= busy_mask_bits,
-                      "SPMCSnapshotSmp: K = N+2 must fit in busy_mask word "
-                      "(N <= signal_mask_width - 2)");
         static_assert(N <= 254,
-                      "SPMCSnapshotSmp: N must fit in uint8_t refcnt (N <= 254)");
+                      "SPMCSnapshotSmp: N must fit in uint8_t refcnt and slot index (N <= 254)");
         static_assert(std::is_trivially_copyable_v<T>,
                       "SPMCSnapshotSmp requires trivially copyable T");
         static_assert(SYS_CACHELINE_BYTES > 0,
@@ -189,14 +197,15 @@ namespace stam::primitives
         // every publish() / try_read().
         //
         //   busy_mask   : readers set/clear bits; writer reads (acquire).
-        //                 Bit i == 1  ↔  slot i is currently claimed by ≥1 reader.
+        //                 Bit i % busy_mask_bits of word i / busy_mask_bits == 1
+        //                 ↔  slot i is currently claimed by ≥1 reader.
         //   published   : writer stores (release); readers load (acquire).
         //                 Always a valid slot index after the first publish().
         //   initialized : writer stores true once (release); readers load (acquire).
         //                 false → no data yet; true → data available forever.
         struct alignas(SYS_CACHELINE_BYTES) Control final
         {
-            std::atomic<busy_mask_word_t> busy_mask{0};
+            std::atomic<busy_mask_word_t> busy_mask[busy_mask_words]{};
             std::atomic<uint8_t> published{0};
             std::atomic<bool> initialized{false};
         };
@@ -218,6 +227,76 @@ namespace stam::primitives
         // Writer-only flag to avoid repeated initialized.store(true) on hot path.
         bool writer_initialized_ = false;
 
+        // Word / bit of slot i in busy_mask.
+        static constexpr uint32_t mask_word(uint32_t i) noexcept { return i / busy_mask_bits; }
+        static constexpr busy_mask_word_t mask_bit(uint32_t i) noexcept
+        {
+            return busy_mask_word_t{1} << (i % busy_mask_bits);
+        }
+
+        // Valid-slot bits of word w (the last word may be partially used).
+        static constexpr busy_mask_word_t word_valid_mask(uint32_t w) noexcept
+        {
+            const uint32_t used = (w + 1u < busy_mask_words) ? busy_mask_bits
+                                                              : K - w * busy_mask_bits;
+            return (used == busy_mask_bits) ? ~busy_mask_word_t{0}
+                                            : ((busy_mask_word_t{1} << used) - busy_mask_word_t{1});
+        }
+
+        // Steps 1-4 of publish(): select a free non-published slot.
+        SYS_FORCEINLINE uint8_t select_free_slot() const noexcept
+        {
+            if constexpr (busy_mask_words == 1u)
+            {
+                // Fast path: a single word covers all K slots.
+                const busy_mask_word_t busy = ctrl.busy_mask[0].load(std::memory_order_acquire);
+                const uint8_t pub = ctrl.published.load(std::memory_order_acquire);
+
+                constexpr busy_mask_word_t all_mask = word_valid_mask(0u);
+                const busy_mask_word_t candidates =
+                    (~busy) & ~(busy_mask_word_t{1} << pub) & all_mask;
+                return static_cast<uint8_t>(detail::ctz_mask_smp(candidates));
+            }
+            else
+            {
+                // Multi-word: first word with a candidate wins. Each word is
+                // observed independently (acquire); a claim set after our load
+                // is caught by the reader's re-verify / seq check, exactly as
+                // in the single-word case.
+                const uint8_t pub = ctrl.published.load(std::memory_order_acquire);
+                const uint32_t pub_word = mask_word(pub);
+
+                for (uint32_t w = 0; w < busy_mask_words; ++w)
+                {
+                    busy_mask_word_t candidates =
+                        ~ctrl.busy_mask[w].load(std::memory_order_acquire) & word_valid_mask(w);
+                    if (w == pub_word)
+                    {
+                        candidates &= ~mask_bit(pub);
+                    }
+                    if (candidates != 0u)
+                    {
+                        return static_cast<uint8_t>(w * busy_mask_bits +
+                                                    detail::ctz_mask_smp(candidates));
+                    }
+                }
+
+                // Unreachable by the Slot Availability Theorem.
+                assert(false && "SPMCSnapshotSmp: no free slot (theorem violated)");
+                return static_cast<uint8_t>(pub == 0u ? 1u : 0u);
+            }
+        }
+
+        // Release a reader claim on slot i. ORDER CRITICAL: refcnt before busy_mask (I5).
+        // Only the last reader (fetch_sub returns 1) clears the busy_mask bit.
+        SYS_FORCEINLINE void release_claim(uint8_t i) noexcept
+        {
+            if (refcnt[i].fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+            {
+                ctrl.busy_mask[mask_word(i)].fetch_and(~mask_bit(i), std::memory_order_release);
+            }
+        }
+
         // Publish a new snapshot (wait-free, O(1), bounded WCET).
         //
         // Slot selection (I3, W-NoOverwritePublished):
@@ -227,6 +306,7 @@ namespace stam::primitives
         //           Slots neither claimed by a reader nor published.
         //           By the Slot Availability Theorem, candidates != 0 for K=N+2.
         //   Step 4: j = ctz(candidates) — lowest-index free non-published slot.
+        //           Multi-word: per word, first word with candidates != 0.
         //
         // Write + publish:
         //   Step 5: slots[j] = value. Safe: j != pub (I3), busy_mask[j] == 0.
@@ -236,18 +316,8 @@ namespace stam::primitives
         //   Step 7: initialized.store(true, release). Idempotent after first call.
         void publish(const T &value) noexcept
         {
-            // Steps 1-2: observe busy and published.
-            const busy_mask_word_t busy = ctrl.busy_mask.load(std::memory_order_acquire);
-            const uint8_t pub = ctrl.published.load(std::memory_order_acquire);
-
-            // Steps 3-4: select a free non-published slot.
-            constexpr busy_mask_word_t all_mask =
-                (K == SPMCSnapshotSmpCore<T, N>::busy_mask_bits)
-                    ? ~busy_mask_word_t{0}
-                    : ((busy_mask_word_t{1} << K) - busy_mask_word_t{1});
-            const busy_mask_word_t candidates =
-                (~busy) & ~(busy_mask_word_t{1} << pub) & all_mask;
-            const uint8_t j = static_cast<uint8_t>(detail::ctz_mask_smp(candidates));
+            // Steps 1-4: observe busy and published, select a free non-published slot.
+            const uint8_t j = select_free_slot();
 
             // Step 5: seqlock begin for slot j (odd => writer in progress).
             (void)seq[j].value.fetch_add(1u, std::memory_order_release);
@@ -269,6 +339,12 @@ namespace stam::primitives
             }
         }
 
+        // true once the first publish() is visible (stays true).
+        [[nodiscard]] bool has_value() const noexcept
+        {
+            return ctrl.initialized.load(std::memory_order_acquire);
+        }
+
         // Try to read the latest published snapshot (wait-free per invocation, O(1)).
         //
         // Returns false → no data yet (before first publish), or publication
@@ -301,7 +377,7 @@ namespace stam::primitives
 
             // Step 3: set claim. ORDER CRITICAL: busy_mask before refcnt (I5).
             // busy_mask must be visible to writer before refcnt confirms the claim.
-            ctrl.busy_mask.fetch_or(busy_mask_word_t{1} << i, std::memory_order_acq_rel);
+            ctrl.busy_mask[mask_word(i)].fetch_or(mask_bit(i), std::memory_order_acq_rel);
             refcnt[i].fetch_add(1u, std::memory_order_acq_rel);
 
             // Step 4: re-verify that published has not changed.
@@ -311,11 +387,7 @@ namespace stam::primitives
             if (i2 != i)
             {
                 // Release claim (I5): refcnt before busy_mask.
-                if (refcnt[i].fetch_sub(1u, std::memory_order_acq_rel) == 1u)
-                {
-                    ctrl.busy_mask.fetch_and(~(busy_mask_word_t{1} << i),
-                                             std::memory_order_release);
-                }
+                release_claim(i);
                 return false;
             }
 
@@ -326,11 +398,7 @@ namespace stam::primitives
             if ((s1 & 1u) != 0u)
             {
                 // Writer in progress on slot i.
-                if (refcnt[i].fetch_sub(1u, std::memory_order_acq_rel) == 1u)
-                {
-                    ctrl.busy_mask.fetch_and(~(busy_mask_word_t{1} << i),
-                                             std::memory_order_release);
-                }
+                release_claim(i);
                 return false;
             }
 
@@ -339,23 +407,14 @@ namespace stam::primitives
             const uint32_t s2 = seq[i].value.load(std::memory_order_acquire);
             if (s2 != s1)
             {
-                if (refcnt[i].fetch_sub(1u, std::memory_order_acq_rel) == 1u)
-                {
-                    ctrl.busy_mask.fetch_and(~(busy_mask_word_t{1} << i),
-                                             std::memory_order_release);
-                }
+                release_claim(i);
                 return false;
             }
 
             out = tmp;
 
             // Step 6: release claim. ORDER CRITICAL: refcnt before busy_mask (I5).
-            // Only the last reader (fetch_sub returns 1) clears the busy_mask bit.
-            if (refcnt[i].fetch_sub(1u, std::memory_order_acq_rel) == 1u)
-            {
-                ctrl.busy_mask.fetch_and(~(busy_mask_word_t{1} << i),
-                                         std::memory_order_release);
-            }
+            release_claim(i);
             return true;
         }
     };
@@ -424,6 +483,13 @@ namespace stam::primitives
             return core_.try_read(out);
         }
 
+        // true once the writer has published (stays true): tells "nothing
+        // published yet" apart from a lost race when try_read() returns false.
+        [[nodiscard]] bool has_value() const noexcept
+        {
+            return core_.has_value();
+        }
+
     private:
         SPMCSnapshotSmpCore<T, N> &core_;
     };
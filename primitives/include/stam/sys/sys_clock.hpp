@@ -0,0 +1,250 @@
+#pragma once
+// sys_clock.hpp
+// Cheap monotonic timestamps for RT producers (event_ts stamping).
+//
+// Reads the CPU's constant-rate counter directly:
+//  - x86:   invariant TSC (CPUID 80000007h EDX[8]), lfence; rdtsc
+//  - ARM64: architected virtual counter CNTVCT_EL0, isb; mrs
+// and converts it with a precomputed multiply-shift, so a read costs a few
+// tens of cycles instead of a clock_gettime() call (20-50 ns on a good
+// clocksource, microseconds on a bad one).
+//
+// sys_clock::calibrate() (NON-RT, bootstrap) measures the counter against
+// CLOCK_MONOTONIC once and anchors it there: now_ns() is on the
+// CLOCK_MONOTONIC timebase, so stamps from this clock and from
+// clock_gettime() are comparable. Without a usable counter (other
+// architectures, no invariant TSC, implausible calibration) the clock falls
+// back to clock_gettime(CLOCK_MONOTONIC); source() tells which one is used.
+//
+// After calibrate() the object is read-only: share it by const reference
+// between producers on any core. The counter is synchronized across cores
+// (invariant TSC / generic timer) and the reads are ordered after earlier
+// loads, so a stamp never precedes an event the thread already observed.
+// A counter below the calibration anchor (unsynchronized core after
+// migration) reads as the anchor: time never goes backwards past it.
+//
+// Accuracy is that of the calibration window (about 1e-5 relative for the
+// default 20 ms); the counter does not follow NTP slewing after calibrate().
+
+#include <cerrno>
+#include <cstdint>
+#include "stam/sys/sys_platform.hpp"
+
+#if SYS_OS_LINUX || SYS_OS_UNIX || SYS_OS_APPLE
+  #include <time.h>
+  #define SYS_CLOCK_HAS_MONOTONIC 1
+#else
+  #include <chrono>
+  #define SYS_CLOCK_HAS_MONOTONIC 0
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  #include <cpuid.h>
+  #include <x86intrin.h>
+  #define SYS_CLOCK_TSC 1
+#else
+  #define SYS_CLOCK_TSC 0
+#endif
+
+#if defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+  #define SYS_CLOCK_CNTVCT 1
+#else
+  #define SYS_CLOCK_CNTVCT 0
+#endif
+
+namespace stam::sys {
+
+enum class sys_clock_source : uint8_t
+{
+    monotonic, // clock_gettime(CLOCK_MONOTONIC) on every read
+    tsc,       // x86 invariant TSC
+    cntvct,    // ARM64 CNTVCT_EL0
+};
+
+// Default tick of the WAL timestamps (docs/wal_format.md §6.1): 100 µs.
+inline constexpr uint64_t sys_clock_default_tick_ns = 100000u;
+
+// Monotonic time in ns (the reference and the fallback).
+inline uint64_t sys_monotonic_ns() noexcept
+{
+#if SYS_CLOCK_HAS_MONOTONIC
+    timespec ts{};
+    (void)::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + static_cast<uint64_t>(ts.tv_nsec);
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Raw counter source available on this CPU (monotonic = none).
+inline sys_clock_source sys_clock_counter_source() noexcept
+{
+#if SYS_CLOCK_TSC
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx) && eax >= 0x80000007u
+        && __get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)) != 0u)
+        return sys_clock_source::tsc;
+    return sys_clock_source::monotonic;
+#elif SYS_CLOCK_CNTVCT
+    return sys_clock_source::cntvct;
+#else
+    return sys_clock_source::monotonic;
+#endif
+}
+
+// Raw counter read, ordered after preceding loads. 0 without a counter.
+inline uint64_t sys_clock_counter() noexcept
+{
+#if SYS_CLOCK_TSC
+    _mm_lfence();
+    return __rdtsc();
+#elif SYS_CLOCK_CNTVCT
+    uint64_t v;
+    asm volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(v) : : "memory");
+    return v;
+#else
+    return 0u;
+#endif
+}
+
+namespace detail {
+
+// (v * mult) >> shift without overflow for any 64-bit v.
+inline uint64_t mul_shift(uint64_t v, uint64_t mult, uint32_t shift) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 u128;
+    return static_cast<uint64_t>((static_cast<u128>(v) * mult) >> shift);
+#else
+    return static_cast<uint64_t>(static_cast<long double>(v) * static_cast<long double>(mult)
+                                 / static_cast<long double>(1ull << shift));
+#endif
+}
+
+// mult / 2^shift ~= num / den with mult < 2^63 and the largest shift (<= 63)
+// that keeps it there: full precision for both fast and slow counters.
+inline void scale_for(uint64_t num, uint64_t den, uint64_t& mult, uint32_t& shift) noexcept
+{
+    const long double ratio = static_cast<long double>(num) / static_cast<long double>(den);
+    shift = 63;
+    long double m = ratio * static_cast<long double>(1ull << 63);
+    while (shift > 0 && m >= static_cast<long double>(1ull << 63)) {
+        --shift;
+        m /= 2;
+    }
+    mult = static_cast<uint64_t>(m + 0.5L);
+}
+
+// One counter/monotonic pair: the monotonic read bracketed by two counter
+// reads; the tightest of a few tries wins.
+inline void sample(uint64_t& counter, uint64_t& ns) noexcept
+{
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 5; ++i) {
+        const uint64_t a = sys_clock_counter();
+        const uint64_t t = sys_monotonic_ns();
+        const uint64_t b = sys_clock_counter();
+        if (b >= a && b - a < best) {
+            best = b - a;
+            counter = a + (b - a) / 2u;
+            ns = t;
+        }
+    }
+}
+
+} // namespace detail
+
+class sys_clock final
+{
+  public:
+    // Fallback clock (monotonic) until calibrate() is called.
+    sys_clock() noexcept = default;
+
+    // NON-RT: measure the counter over `window_ns` (sleeping) and switch to
+    // it if the rate is plausible (1 MHz .. 100 GHz). `tick_ns` sets the unit
+    // of now_ticks(). Returns the source in use.
+    sys_clock_source calibrate(uint64_t window_ns = 20000000u,
+                               uint64_t tick_ns = sys_clock_default_tick_ns) noexcept
+    {
+        tick_ns_ = tick_ns != 0u ? tick_ns : sys_clock_default_tick_ns;
+        source_ = sys_clock_source::monotonic;
+        hz_ = 0;
+        const sys_clock_source src = sys_clock_counter_source();
+        if (src == sys_clock_source::monotonic)
+            return source_;
+
+        uint64_t c0 = 0, t0 = 0, c1 = 0, t1 = 0;
+        detail::sample(c0, t0);
+#if SYS_CLOCK_HAS_MONOTONIC
+        timespec req{static_cast<time_t>(window_ns / 1000000000u), static_cast<long>(window_ns % 1000000000u)};
+        while (::nanosleep(&req, &req) != 0 && errno == EINTR) {
+        }
+#else
+        while (sys_monotonic_ns() - t0 < window_ns) {
+        }
+#endif
+        detail::sample(c1, t1);
+        if (c1 <= c0 || t1 <= t0)
+            return source_;
+
+        const uint64_t dc = c1 - c0;
+        const uint64_t dt = t1 - t0;
+        const long double hz = static_cast<long double>(dc) * 1e9L / static_cast<long double>(dt);
+        if (hz < 1e6L || hz > 1e11L)
+            return source_;
+
+        detail::scale_for(dt, dc, ns_mult_, ns_shift_);
+        detail::scale_for(dt, dc * tick_ns_, tick_mult_, tick_shift_);
+        counter0_ = c1;
+        ns0_ = t1;
+        tick0_ = t1 / tick_ns_;
+        // Sub-tick phase of the anchor, in counts, so that tick boundaries
+        // fall where the monotonic clock has them.
+        phase_ = static_cast<uint64_t>(static_cast<long double>(t1 % tick_ns_) * dc / dt);
+        hz_ = static_cast<uint64_t>(hz);
+        source_ = src;
+        return source_;
+    }
+
+    // RT-safe: nanoseconds on the CLOCK_MONOTONIC timebase.
+    [[nodiscard]] uint64_t now_ns() const noexcept
+    {
+        if (source_ == sys_clock_source::monotonic)
+            return sys_monotonic_ns();
+        return ns0_ + detail::mul_shift(elapsed(), ns_mult_, ns_shift_);
+    }
+
+    // RT-safe: monotonic time in ticks of `tick_ns` (WAL event_ts / commit_ts).
+    [[nodiscard]] uint64_t now_ticks() const noexcept
+    {
+        if (source_ == sys_clock_source::monotonic)
+            return sys_monotonic_ns() / tick_ns_;
+        return tick0_ + detail::mul_shift(elapsed() + phase_, tick_mult_, tick_shift_);
+    }
+
+    [[nodiscard]] sys_clock_source source() const noexcept { return source_; }
+    [[nodiscard]] uint64_t counter_hz() const noexcept { return hz_; }
+    [[nodiscard]] uint64_t tick_ns() const noexcept { return tick_ns_; }
+
+  private:
+    uint64_t elapsed() const noexcept
+    {
+        const uint64_t c = sys_clock_counter();
+        return c > counter0_ ? c - counter0_ : 0u;
+    }
+
+    sys_clock_source source_ = sys_clock_source::monotonic;
+    uint64_t tick_ns_ = sys_clock_default_tick_ns;
+    uint64_t counter0_ = 0;
+    uint64_t ns0_ = 0;
+    uint64_t tick0_ = 0;
+    uint64_t phase_ = 0;
+    uint64_t ns_mult_ = 0;
+    uint32_t ns_shift_ = 0;
+    uint64_t tick_mult_ = 0;
+    uint32_t tick_shift_ = 0;
+    uint64_t hz_ = 0;
+};
+
+} // namespace stam::sys
@@ -0,0 +1,350 @@
+#pragma once
+// sys_mem.hpp
+// Bootstrap-time backing storage for large channel objects (SPSCRing, SPMCSnapshotSmp, ...).
+//
+// Places an object in a dedicated mapping that can be:
+//  - backed by huge pages (MAP_HUGETLB, falling back to THP via MADV_HUGEPAGE),
+//  - bound to a NUMA node (mbind, typically the consumer's node),
+//  - pre-faulted (every page touched once, so the RT path takes no first-touch faults),
+//  - locked in RAM (mlock, so pages are never reclaimed or swapped).
+//
+// NON-RT: mapping, binding and locking are syscalls. Call during bootstrap only,
+// before the owning tasks start stepping. Access to the placed object is plain memory.
+//
+// Every step is best-effort: the region reports which steps actually took effect
+// (sys_mem_region::flags), and the caller decides whether a missing step is fatal.
+// On non-Linux targets the helper degrades to an aligned heap allocation.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "stam/sys/sys_platform.hpp"
+#include "stam/sys/sys_align.hpp"
+
+#if SYS_OS_LINUX
+  #include <sched.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#ifndef SYS_HUGE_PAGE_SIZE
+  // Default huge page size (x86_64 / ARM64 with 4K base pages).
+  #define SYS_HUGE_PAGE_SIZE (2u * 1024u * 1024u)
+#endif
+
+namespace stam::sys {
+
+enum class sys_huge_pages : uint8_t
+{
+    none,        // base pages only
+    transparent, // THP: 2M-aligned mapping + MADV_HUGEPAGE (no reservation needed)
+    hugetlb,     // MAP_HUGETLB from the reserved pool; falls back to transparent
+};
+
+struct sys_mem_policy
+{
+    sys_huge_pages huge_pages = sys_huge_pages::none;
+    int32_t numa_node = -1; // -1 = no binding; see sys_mem_current_node()
+    bool prefault = true;
+    bool lock = true;
+};
+
+// Steps that actually took effect for a region.
+enum sys_mem_flags : uint8_t
+{
+    sys_mem_hugetlb    = 1u << 0,
+    sys_mem_thp        = 1u << 1,
+    sys_mem_numa_bound = 1u << 2,
+    sys_mem_prefaulted = 1u << 3,
+    sys_mem_locked     = 1u << 4,
+    sys_mem_heap       = 1u << 5, // non-Linux fallback (aligned operator new)
+};
+
+struct sys_mem_region
+{
+    void *addr = nullptr;
+    size_t bytes = 0; // mapped length (rounded up to page / huge page size)
+    uint8_t flags = 0;
+
+    [[nodiscard]] bool has(sys_mem_flags f) const noexcept { return (flags & f) != 0u; }
+};
+
+namespace detail {
+
+inline size_t round_up(size_t v, size_t a) noexcept { return (v + a - 1u) / a * a; }
+
+inline size_t base_page_size() noexcept
+{
+#if SYS_OS_LINUX
+    const long ps = ::sysconf(_SC_PAGESIZE);
+    return ps > 0 ? static_cast<size_t>(ps) : size_t{SYS_PAGE_SIZE};
+#else
+    return SYS_PAGE_SIZE > 0u ? size_t{SYS_PAGE_SIZE} : size_t{SYS_CACHELINE_BYTES};
+#endif
+}
+
+#if SYS_OS_LINUX
+// mbind(2) constants (numaif.h is part of libnuma-dev and not always installed).
+inline constexpr int kMpolBind = 2;
+inline constexpr unsigned kMpolMfStrict = 1u << 0;
+inline constexpr unsigned kMpolMfMove = 1u << 1;
+
+inline bool numa_bind(void *addr, size_t bytes, int32_t node) noexcept
+{
+    constexpr size_t kMaskBits = sizeof(unsigned long) * 8u;
+    if (node < 0 || static_cast<size_t>(node) >= kMaskBits * 16u)
+        return false;
+    unsigned long mask[16] = {};
+    mask[static_cast<size_t>(node) / kMaskBits] = 1ul << (static_cast<size_t>(node) % kMaskBits);
+    const long rc = ::syscall(SYS_mbind, addr, bytes, kMpolBind, mask,
+                              static_cast<unsigned long>(kMaskBits * 16u),
+                              kMpolMfStrict | kMpolMfMove);
+    return rc == 0;
+}
+#endif
+
+} // namespace detail
+
+// NUMA node of the CPU the caller is running on (-1 if unknown).
+// Call from the consumer thread (after pinning it) to bind its channels locally.
+inline int32_t sys_mem_current_node() noexcept
+{
+#if SYS_OS_LINUX
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+        return static_cast<int32_t>(node);
+#endif
+    return -1;
+}
+
+// Map `bytes` of zeroed storage according to `policy`.
+// Returns a region with addr == nullptr if no storage could be obtained at all.
+[[nodiscard]] inline sys_mem_region sys_mem_map(size_t bytes, const sys_mem_policy &policy) noexcept
+{
+    sys_mem_region r{};
+    if (bytes == 0u)
+        return r;
+
+#if SYS_OS_LINUX
+    const size_t page = detail::base_page_size();
+    constexpr size_t huge = SYS_HUGE_PAGE_SIZE;
+
+    // 1) Reserved huge pages (fails without a hugetlb pool; fall through to THP).
+    if (policy.huge_pages == sys_huge_pages::hugetlb)
+    {
+        const size_t len = detail::round_up(bytes, huge);
+        void *p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            r.addr = p;
+            r.bytes = len;
+            r.flags |= sys_mem_hugetlb;
+        }
+    }
+
+    // 2) Transparent huge pages: over-map, trim to a huge-page boundary, advise.
+    if (r.addr == nullptr && policy.huge_pages != sys_huge_pages::none)
+    {
+        const size_t len = detail::round_up(bytes, huge);
+        void *raw = ::mmap(nullptr, len + huge, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED)
+        {
+            const auto base = reinterpret_cast<uintptr_t>(raw);
+            const uintptr_t aligned = detail::round_up(base, huge);
+            if (aligned > base)
+                (void)::munmap(raw, aligned - base);
+            const uintptr_t tail = aligned + len;
+            if (base + len + huge > tail)
+                (void)::munmap(reinterpret_cast<void *>(tail), base + len + huge - tail);
+
+            r.addr = reinterpret_cast<void *>(aligned);
+            r.bytes = len;
+            if (::madvise(r.addr, r.bytes, MADV_HUGEPAGE) == 0)
+                r.flags |= sys_mem_thp;
+        }
+    }
+
+    // 3) Base pages.
+    if (r.addr == nullptr)
+    {
+        const size_t len = detail::round_up(bytes, page);
+        void *p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            return sys_mem_region{};
+        r.addr = p;
+        r.bytes = len;
+    }
+
+    // Bind before the first touch so that pages are allocated on the target node.
+    if (policy.numa_node >= 0 && detail::numa_bind(r.addr, r.bytes, policy.numa_node))
+        r.flags |= sys_mem_numa_bound;
+
+    if (policy.prefault)
+    {
+        const size_t step = r.has(sys_mem_hugetlb) ? huge : page;
+        auto *b = static_cast<volatile uint8_t *>(r.addr);
+        for (size_t off = 0; off < r.bytes; off += step)
+            b[off] = 0u;
+        r.flags |= sys_mem_prefaulted;
+    }
+
+    if (policy.lock && ::mlock(r.addr, r.bytes) == 0)
+        r.flags |= sys_mem_locked;
+#else
+    (void)policy;
+    constexpr size_t align = SYS_CACHELINE_BYTES > 0 ? size_t{SYS_CACHELINE_BYTES} : alignof(std::max_align_t);
+    const size_t len = detail::round_up(bytes, align);
+    void *p = ::operator new(len, std::align_val_t{align}, std::nothrow);
+    if (p == nullptr)
+        return r;
+    std::memset(p, 0, len);
+    r.addr = p;
+    r.bytes = len;
+    r.flags = sys_mem_heap | sys_mem_prefaulted;
+#endif
+    return r;
+}
+
+// Map `bytes` of a shared-memory fd (memfd / shm_open) with MAP_SHARED and apply
+// `policy`. Used for cross-process channels; every process maps its own view.
+//  - huge pages: hugetlb is a property of the fd (MFD_HUGETLB), not of the mapping;
+//    `transparent` advises MADV_HUGEPAGE (effective if shmem THP is enabled);
+//  - prefault touches pages by READING them: another process may already be
+//    writing the object, so the view must never be written here;
+//  - NUMA binding applies to pages not yet allocated (i.e. on the creating side).
+// Returns a region with addr == nullptr if the mapping failed.
+[[nodiscard]] inline sys_mem_region sys_mem_map_shared(int fd, size_t bytes,
+                                                       const sys_mem_policy &policy) noexcept
+{
+    sys_mem_region r{};
+    if (bytes == 0u || fd < 0)
+        return r;
+
+#if SYS_OS_LINUX
+    void *p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+        return r;
+    r.addr = p;
+    r.bytes = bytes;
+
+    if (policy.huge_pages == sys_huge_pages::transparent && ::madvise(r.addr, r.bytes, MADV_HUGEPAGE) == 0)
+        r.flags |= sys_mem_thp;
+
+    if (policy.numa_node >= 0 && detail::numa_bind(r.addr, r.bytes, policy.numa_node))
+        r.flags |= sys_mem_numa_bound;
+
+    if (policy.prefault)
+    {
+        const size_t page = detail::base_page_size();
+        const auto *b = static_cast<const volatile uint8_t *>(r.addr);
+        for (size_t off = 0; off < r.bytes; off += page)
+            (void)b[off];
+        r.flags |= sys_mem_prefaulted;
+    }
+
+    if (policy.lock && ::mlock(r.addr, r.bytes) == 0)
+        r.flags |= sys_mem_locked;
+#else
+    (void)policy;
+#endif
+    return r;
+}
+
+inline void sys_mem_unmap(sys_mem_region &r) noexcept
+{
+    if (r.addr == nullptr)
+        return;
+#if SYS_OS_LINUX
+    if (r.has(sys_mem_locked))
+        (void)::munlock(r.addr, r.bytes);
+    (void)::munmap(r.addr, r.bytes);
+#else
+    constexpr size_t align = SYS_CACHELINE_BYTES > 0 ? size_t{SYS_CACHELINE_BYTES} : alignof(std::max_align_t);
+    ::operator delete(r.addr, std::align_val_t{align});
+#endif
+    r = sys_mem_region{};
+}
+
+// sys_placed<T> — owns one T constructed in a sys_mem_map() region.
+//
+// Typical bootstrap use (consumer thread pinned to its CPU):
+//
+//   stam::sys::sys_mem_policy pol{};
+//   pol.huge_pages = stam::sys::sys_huge_pages::hugetlb;
+//   pol.numa_node  = stam::sys::sys_mem_current_node();
+//   stam::sys::sys_placed<SPSCRing<Event, 65536>> ring{pol};
+//   auto w = ring->writer();
+//
+// T must be nothrow default constructible; its alignment must not exceed the page size.
+template <class T>
+class sys_placed final
+{
+  public:
+    static_assert(std::is_nothrow_default_constructible_v<T>,
+                  "sys_placed<T> requires nothrow default constructible T");
+    static_assert(alignof(T) <= SYS_PAGE_SIZE || SYS_PAGE_SIZE == 0u,
+                  "sys_placed<T>: alignof(T) exceeds the page size");
+
+    sys_placed() noexcept = default;
+
+    explicit sys_placed(const sys_mem_policy &policy) noexcept
+        : region_(sys_mem_map(sizeof(T), policy))
+    {
+        if (region_.addr != nullptr)
+            obj_ = ::new (region_.addr) T();
+    }
+
+    ~sys_placed() { reset(); }
+
+    sys_placed(const sys_placed &) = delete;
+    sys_placed &operator=(const sys_placed &) = delete;
+
+    sys_placed(sys_placed &&o) noexcept
+        : region_(std::exchange(o.region_, sys_mem_region{})), obj_(std::exchange(o.obj_, nullptr))
+    {}
+
+    sys_placed &operator=(sys_placed &&o) noexcept
+    {
+        if (this != &o)
+        {
+            reset();
+            region_ = std::exchange(o.region_, sys_mem_region{});
+            obj_ = std::exchange(o.obj_, nullptr);
+        }
+        return *this;
+    }
+
+    void reset() noexcept
+    {
+        if (obj_ != nullptr)
+        {
+            obj_->~T();
+            obj_ = nullptr;
+        }
+        sys_mem_unmap(region_);
+    }
+
+    [[nodiscard]] explicit operator bool() const noexcept { return obj_ != nullptr; }
+
+    T *get() noexcept { return obj_; }
+    const T *get() const noexcept { return obj_; }
+    T &operator*() noexcept { return *obj_; }
+    const T &operator*() const noexcept { return *obj_; }
+    T *operator->() noexcept { return obj_; }
+    const T *operator->() const noexcept { return obj_; }
+
+    [[nodiscard]] const sys_mem_region &region() const noexcept { return region_; }
+
+  private:
+    sys_mem_region region_{};
+    T *obj_ = nullptr;
+};
+
+} // namespace stam::sys
@@ -39,6 +39,12 @@ public:
     static const char* slot_addr(const DoubleBufferSeqLockCore<T>& core) noexcept {
         return reinterpret_cast<const char*>(&core.slot);
     }
+
+    // Open/close the write window without touching the payload
+    // (simulates a writer stalled mid-write).
+    static void seq_bump(DoubleBufferSeqLockCore<T>& core) noexcept {
+        core.ctrl.seq.fetch_add(1u, std::memory_order_relaxed);
+    }
 };
 
 } // namespace stam::primitives
@@ -354,6 +360,121 @@ TEST(test_stress_latest_wins_after_writer_done) {
     EXPECT(out.x == kFrames && out.y == kFrames);
 }
 
+// ---------------------------------------------------------------------------
+// Contract tests: bounded read / retry statistics
+// ---------------------------------------------------------------------------
+
+TEST(test_try_read_bounded_success) {
+    DoubleBufferSeqLock<Pod32> ch;
+    auto writer = ch.writer();
+    auto reader = ch.reader();
+
+    writer.write({4, -4});
+    Pod32 out{};
+    EXPECT(reader.try_read_bounded(out, 1));
+    EXPECT(out.x == 4 && out.y == -4);
+}
+
+TEST(test_try_read_bounded_exhausted_keeps_previous) {
+    DoubleBufferSeqLock<Pod32> ch;
+    auto writer = ch.writer();
+    auto reader = ch.reader();
+
+    writer.write({1, -1});
+    Pod32 out{};
+    EXPECT(reader.try_read_bounded(out, 4));
+
+    // Writer stalls mid-write: seq stays odd.
+    DoubleBufferSeqLockTest<Pod32>::seq_bump(ch.core());
+    EXPECT(!reader.try_read_bounded(out, 16));
+    EXPECT(!reader.try_read_bounded(out, 0)); // 0 behaves as 1 attempt
+    EXPECT(out.x == 1 && out.y == -1);        // previous stable copy retained
+
+    DoubleBufferSeqLockTest<Pod32>::seq_bump(ch.core());
+    EXPECT(reader.try_read_bounded(out, 1));
+}
+
+TEST(test_retry_stats_bucket_of) {
+    using Stats = DoubleBufferSeqLockRetryStats;
+    static_assert(Stats::bucket_of(1) == 0u);
+    static_assert(Stats::bucket_of(2) == 1u);
+    static_assert(Stats::bucket_of(3) == 2u);
+    static_assert(Stats::bucket_of(4) == 2u);
+    static_assert(Stats::bucket_of(5) == 3u);
+    static_assert(Stats::bucket_of(64) == 6u);
+    static_assert(Stats::bucket_of(65) == 7u);
+    static_assert(Stats::bucket_of(1'000'000) == Stats::kBuckets - 1u);
+}
+
+TEST(test_retry_stats_recorded) {
+    DoubleBufferSeqLock<Pod32> ch;
+    auto writer = ch.writer();
+    auto reader = ch.reader();
+    DoubleBufferSeqLockRetryStats stats;
+    reader.attach_stats(&stats);
+
+    writer.write({2, -2});
+    Pod32 out{};
+    reader.read(out);
+    EXPECT(reader.try_read_bounded(out, 8));
+    EXPECT(stats.buckets[0].load() == 2u);
+
+    DoubleBufferSeqLockTest<Pod32>::seq_bump(ch.core());
+    EXPECT(!reader.try_read_bounded(out, 3)); // 3 attempts → bucket 2
+    EXPECT(stats.buckets[2].load() == 1u);
+    EXPECT(stats.exhausted.load() == 1u);
+}
+
+// Bounded reads under concurrent writes: never torn, out untouched on miss.
+TEST(test_stress_try_read_bounded_no_torn_read) {
+    constexpr auto kDuration = std::chrono::milliseconds(150);
+
+    DoubleBufferSeqLock<Pod32> ch;
+    DoubleBufferSeqLockRetryStats stats;
+
+    std::atomic<bool> stop{false};
+    std::atomic<int>  torn{0};
+
+    std::thread writer_thread([&] {
+        auto writer = ch.writer();
+        int i = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            ++i;
+            writer.write({i, -i});
+        }
+    });
+
+    std::thread reader_thread([&] {
+        auto reader = ch.reader();
+        reader.attach_stats(&stats);
+        Pod32 out{};
+        while (!stop.load(std::memory_order_relaxed)) {
+            (void)reader.try_read_bounded(out, 4);
+            if (out.x != -out.y) {
+                torn.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    std::this_thread::sleep_for(kDuration);
+    stop.store(true, std::memory_order_release);
+
+    writer_thread.join();
+    reader_thread.join();
+
+    EXPECT(torn.load() == 0);
+    uint32_t calls = 0;
+    for (const auto& b : stats.buckets) {
+        calls += b.load();
+    }
+    EXPECT(calls > 0u);
+    // Attempts never exceed the bound: nothing lands above bucket_of(4).
+    for (uint32_t b = DoubleBufferSeqLockRetryStats::bucket_of(4) + 1u;
+         b < DoubleBufferSeqLockRetryStats::kBuckets; ++b) {
+        EXPECT(stats.buckets[b].load() == 0u);
+    }
+}
+
 // ---------------------------------------------------------------------------
 // Diagnostic stress tests
 // ---------------------------------------------------------------------------
@@ -429,6 +550,13 @@ int dbl_buffer_seqlock_tests() {
     RUN(test_stress_try_read_no_torn_read);
     RUN(test_stress_latest_wins_after_writer_done);
 
+    std::printf("\n--- contract: bounded read / retry statistics ---\n");
+    RUN(test_try_read_bounded_success);
+    RUN(test_try_read_bounded_exhausted_keeps_previous);
+    RUN(test_retry_stats_bucket_of);
+    RUN(test_retry_stats_recorded);
+    RUN(test_stress_try_read_bounded_no_torn_read);
+
     std::printf("\n--- implementation ---\n");
     RUN(test_seq_initial_value);
     RUN(test_seq_cacheline_alignment);
@@ -0,0 +1,258 @@
+/*
+ * doorbell_test.cpp
+ *
+ * Tests for Doorbell (spin-then-park consumer wakeup) and Doorbelled<Primitive>.
+ * Spec: primitives/primitives_README.md (Doorbell), contract in doorbell.hpp
+ *
+ * Wakeup cases park with a bounded timeout far above the expected latency, so
+ * a lost wakeup shows up as a failed EXPECT instead of a hang.
+ *
+ * Exit code: 0 = all tests passed (EXPECT aborts immediately on failure).
+ */
+
+#include "stam/primitives/doorbell.hpp"
+#include "stam/primitives/mailbox2slot_smp.hpp"
+#include "stam/primitives/shm_channel.hpp"
+#include "stam/primitives/spsc_ring.hpp"
+#include "test_harness.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace stam::primitives;
+
+static int g_total = 0;
+static int g_passed = 0;
+
+static constexpr const char *kSuiteName = "doorbell";
+static int g_failed = 0;
+
+// TEST/RUN/EXPECT provided by test_harness.hpp
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+using Ring = SPSCRing<uint64_t, 1024>;
+using Mailbox = Mailbox2SlotSmp<uint64_t>;
+
+// Parks immediately, bounded: a lost wakeup costs 2 s and fails the latency check.
+static constexpr DoorbellPolicy kParkNow{0u, 0u, 2000000u};
+
+using Clock = std::chrono::steady_clock;
+
+static long long elapsed_us(Clock::time_point since) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since).count();
+}
+
+// ---------------------------------------------------------------------------
+// Doorbell
+// ---------------------------------------------------------------------------
+
+TEST(test_ready_returns_without_parking)
+{
+    Doorbell bell;
+    for (int i = 0; i < 1000; ++i)
+        bell.ring(); // nobody parked: no futex traffic
+    EXPECT(bell.wait([]() noexcept { return true; }, kParkNow));
+    EXPECT(bell.parks() == 0u);
+}
+
+TEST(test_park_times_out)
+{
+    Doorbell bell;
+    const auto t0 = Clock::now();
+    EXPECT(!bell.wait([]() noexcept { return false; }, DoorbellPolicy{16u, 1u, 5000u}));
+    EXPECT(elapsed_us(t0) >= 4000);
+    EXPECT(bell.parks() == 1u);
+}
+
+TEST(test_ring_wakes_parked_consumer)
+{
+    Doorbell bell;
+    std::atomic<bool> flag{false};
+    std::atomic<bool> woke{false};
+    std::thread consumer([&] {
+        woke.store(bell.wait([&]() noexcept { return flag.load(std::memory_order_acquire); }, kParkNow),
+                   std::memory_order_release);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // let it park
+    const auto t0 = Clock::now();
+    flag.store(true, std::memory_order_release);
+    bell.ring();
+    consumer.join();
+    EXPECT(woke.load(std::memory_order_acquire));
+    EXPECT(elapsed_us(t0) < 1000000);
+    EXPECT(bell.parks() <= 1u);
+}
+
+TEST(test_one_wake_per_park_with_many_ringers)
+{
+    // Producers ring nonstop while the consumer parks once: only the ringer
+    // that claims the waiting bit may issue FUTEX_WAKE.
+    constexpr int kProducers = 4;
+    Doorbell bell;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> rings{0};
+    std::thread producers[kProducers];
+    for (std::thread &t : producers)
+    {
+        t = std::thread([&] {
+            while (!done.load(std::memory_order_acquire))
+            {
+                bell.ring();
+                rings.fetch_add(1u, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    while (rings.load(std::memory_order_relaxed) < 1000u)
+        std::this_thread::yield();
+    EXPECT(bell.wakes() == 0u); // nobody parked yet
+    EXPECT(!bell.wait([]() noexcept { return false; }, kParkNow));
+    const uint64_t wakes = bell.wakes();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10)); // keep ringing after the park
+    done.store(true, std::memory_order_release);
+    for (std::thread &t : producers)
+        t.join();
+
+    EXPECT(bell.parks() == 1u);
+    EXPECT(wakes == 1u && bell.wakes() == 1u);
+}
+
+// ---------------------------------------------------------------------------
+// Doorbelled<Primitive>
+// ---------------------------------------------------------------------------
+
+TEST(test_doorbelled_mailbox_wait_sees_each_publication)
+{
+    Doorbelled<Mailbox> ch;
+    auto w = ch.writer();
+    auto r = ch.reader();
+
+    EXPECT(!r.wait(DoorbellPolicy{8u, 0u, 1000u})); // nothing published
+    w.write(uint64_t{41});
+    EXPECT(r.wait(kParkNow));
+    uint64_t v = 0;
+    EXPECT(r.try_read(v) && v == 41u);
+    EXPECT(!r.wait(DoorbellPolicy{8u, 0u, 1000u})); // consumed by the previous wait
+}
+
+TEST(test_doorbelled_ring_full_push_does_not_ring)
+{
+    Doorbelled<SPSCRing<uint64_t, 4>> ch;
+    auto w = ch.writer();
+    auto r = ch.reader();
+    for (uint64_t i = 0; i < 3; ++i)
+        EXPECT(w.push(i));
+    EXPECT(!w.push(uint64_t{3}));
+    EXPECT(w.inner().full());
+
+    EXPECT(r.wait(kParkNow));
+    uint64_t v = 0;
+    uint64_t n = 0;
+    while (r.pop(v))
+        EXPECT(v == n++);
+    EXPECT(n == 3u);
+    EXPECT(!r.wait(DoorbellPolicy{8u, 0u, 1000u}));
+}
+
+TEST(test_doorbelled_ring_stream_no_lost_wakeup)
+{
+    // The producer alternates bursts and pauses, so the consumer keeps going
+    // from spinning to parked and back; every item must arrive in order.
+    constexpr uint64_t kItems = 20000;
+    Doorbelled<Ring> ch;
+    auto w = ch.writer();
+    auto r = ch.reader();
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool> in_order{true};
+
+    std::thread consumer([&] {
+        uint64_t next = 0;
+        const DoorbellPolicy policy{256u, 1u, 2000000u};
+        while (next < kItems)
+        {
+            if (!r.wait(policy))
+                break; // lost wakeup: 2 s without progress
+            uint64_t v = 0;
+            while (r.pop(v))
+            {
+                if (v != next)
+                    in_order.store(false, std::memory_order_relaxed);
+                ++next;
+            }
+        }
+        received.store(next, std::memory_order_release);
+    });
+
+    for (uint64_t i = 0; i < kItems; ++i)
+    {
+        while (!w.push(i))
+            std::this_thread::yield();
+        if (i % 500 == 499)
+            std::this_thread::sleep_for(std::chrono::microseconds(300));
+    }
+    consumer.join();
+    EXPECT(received.load(std::memory_order_acquire) == kItems);
+    EXPECT(in_order.load(std::memory_order_relaxed));
+}
+
+TEST(test_doorbelled_cross_process_wakeup)
+{
+    using Shared = ShmChannel<Doorbelled<Ring>>;
+    auto owner = Shared::create_anonymous();
+    EXPECT(static_cast<bool>(owner));
+    auto w = owner.writer();
+
+    const pid_t pid = ::fork();
+    EXPECT(pid >= 0);
+    if (pid == 0)
+    {
+        auto peer = Shared::attach(owner.fd());
+        if (!peer)
+            ::_exit(2);
+        auto r = peer.reader();
+        uint64_t v = 0;
+        if (!r.wait(kParkNow) || !r.pop(v) || v != 77u)
+            ::_exit(3);
+        ::_exit(0);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // let the child park
+    EXPECT(w.push(uint64_t{77}));
+    int status = 0;
+    EXPECT(::waitpid(pid, &status, 0) == pid);
+    EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point (called from main.cpp)
+// ---------------------------------------------------------------------------
+
+int doorbell_tests()
+{
+    std::printf("=== Doorbell tests ===\n\n");
+
+    std::printf("--- doorbell ---\n");
+    RUN(test_ready_returns_without_parking);
+    RUN(test_park_times_out);
+    RUN(test_ring_wakes_parked_consumer);
+    RUN(test_one_wake_per_park_with_many_ringers);
+
+    std::printf("\n--- doorbelled primitives ---\n");
+    RUN(test_doorbelled_mailbox_wait_sees_each_publication);
+    RUN(test_doorbelled_ring_full_push_does_not_ring);
+    RUN(test_doorbelled_ring_stream_no_lost_wakeup);
+    RUN(test_doorbelled_cross_process_wakeup);
+
+    std::printf("\n  passed: %d / %d\n\n", g_passed, g_total);
+    return 0;
+}
@@ -9,12 +9,17 @@
 int crc32_tests();
 int dbl_buffer_tests();
 int dbl_buffer_seqlock_tests();
+int doorbell_tests();
 int mailbox2slot_tests();
 int mailbox2slot_smp_tests();
 int spsc_ring_tests();
 int spsc_ring_drop_oldest_tests();
 int spmc_snapshot_tests();
 int spmc_snapshot_smp_tests();
+int spmc_snapshot_seqlock_tests();
+int sys_mem_tests();
+int sys_clock_tests();
+int shm_channel_tests();
 
 static int run_suite(const char* name, int (*suite_fn)()) {
     if (!stam::tests::should_run_suite(name)) {
@@ -61,12 +66,17 @@ int main(int argc, char** argv) {
     failures += run_suite("crc32", crc32_tests);
     failures += run_suite("dbl_buffer", dbl_buffer_tests);
     failures += run_suite("dbl_buffer_seqlock", dbl_buffer_seqlock_tests);
+    failures += run_suite("doorbell", doorbell_tests);
     failures += run_suite("mailbox2slot", mailbox2slot_tests);
     failures += run_suite("mailbox2slot_smp", mailbox2slot_smp_tests);
     failures += run_suite("spsc_ring", spsc_ring_tests);
     failures += run_suite("spsc_ring_drop_oldest", spsc_ring_drop_oldest_tests);
     failures += run_suite("spmc_snapshot", spmc_snapshot_tests);
     failures += run_suite("spmc_snapshot_smp", spmc_snapshot_smp_tests);
+    failures += run_suite("spmc_snapshot_seqlock", spmc_snapshot_seqlock_tests);
+    failures += run_suite("sys_mem", sys_mem_tests);
+    failures += run_suite("sys_clock", sys_clock_tests);
+    failures += run_suite("shm_channel", shm_channel_tests);
 
     if (failures == 0) {
         printf("=== ALL TESTS PASSED ===\n");
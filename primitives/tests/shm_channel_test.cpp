@@ -0,0 +1,259 @@
+/*
+ * shm_channel_test.cpp
+ *
+ * Tests for ShmChannel<Primitive> (cross-process placement of channel primitives).
+ * Spec: primitives/primitives_README.md (ShmChannel)
+ *
+ * Cross-process cases fork(): the child attaches, runs its role and reports
+ * through the exit code.
+ *
+ * Exit code: 0 = all tests passed (EXPECT aborts immediately on failure).
+ */
+
+#include "stam/primitives/shm_channel.hpp"
+#include "stam/primitives/spsc_ring.hpp"
+#include "stam/primitives/spmc_snapshot_smp.hpp"
+#include "test_harness.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace stam::primitives;
+
+static int g_total = 0;
+static int g_passed = 0;
+
+static constexpr const char *kSuiteName = "shm_channel";
+static int g_failed = 0;
+
+// TEST/RUN/EXPECT provided by test_harness.hpp
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+struct Sample
+{
+    uint64_t seq{0};
+    uint64_t check{0};
+};
+
+using Ring = SPSCRing<Sample, 256>;
+using RingOther = SPSCRing<Sample, 512>;
+using Snap = SPMCSnapshotSmp<Sample, 2>;
+
+// Per-process unique name so parallel ctest runs do not collide.
+static const char *shm_name(const char *tag) noexcept
+{
+    static char buf[64];
+    std::snprintf(buf, sizeof(buf), "/stam_test_%s_%d", tag, static_cast<int>(::getpid()));
+    return buf;
+}
+
+static int wait_child(pid_t pid) noexcept
+{
+    int status = 0;
+    if (::waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+        return -1;
+    return WEXITSTATUS(status);
+}
+
+// ---------------------------------------------------------------------------
+// Header / lifecycle
+// ---------------------------------------------------------------------------
+
+TEST(test_default_is_empty)
+{
+    ShmChannel<Ring> ch;
+    EXPECT(!ch);
+    EXPECT(ch.fd() < 0);
+}
+
+TEST(test_layout_hash_distinguishes_types)
+{
+    static_assert(ShmChannel<Ring>::layout_hash != ShmChannel<RingOther>::layout_hash);
+    static_assert(ShmChannel<Ring>::layout_hash != ShmChannel<Snap>::layout_hash);
+    static_assert(ShmChannel<Ring>::object_offset % SYS_CACHELINE_BYTES == 0u);
+}
+
+TEST(test_create_open_named)
+{
+    const char *name = shm_name("named");
+    auto owner = ShmChannel<Ring>::create(name);
+    EXPECT(static_cast<bool>(owner));
+    EXPECT(owner.status() == ShmStatus::ok);
+    EXPECT(owner.region().bytes >= ShmChannel<Ring>::required_bytes);
+
+    // O_EXCL: a second create with the same name fails.
+    auto dup = ShmChannel<Ring>::create(name);
+    EXPECT(!dup);
+    EXPECT(dup.status() == ShmStatus::sys_error);
+
+    auto peer = ShmChannel<Ring>::open(name);
+    EXPECT(static_cast<bool>(peer));
+    EXPECT(&peer.channel() != &owner.channel()); // distinct views of one object
+
+    auto w = owner.writer();
+    auto r = peer.reader();
+    EXPECT(w.push(Sample{7, 7}));
+    Sample s{};
+    EXPECT(r.pop(s));
+    EXPECT(s.seq == 7u);
+
+    EXPECT(ShmChannel<Ring>::unlink(name));
+    EXPECT(!ShmChannel<Ring>::open(name));
+}
+
+TEST(test_open_rejects_layout_mismatch)
+{
+    const char *name = shm_name("mismatch");
+    auto owner = ShmChannel<Ring>::create(name);
+    EXPECT(static_cast<bool>(owner));
+
+    auto wrong = ShmChannel<RingOther>::open(name);
+    EXPECT(!wrong);
+    EXPECT(wrong.status() == ShmStatus::layout_mismatch || wrong.status() == ShmStatus::too_small);
+
+    auto wrong_snap = ShmChannel<Snap>::attach(owner.fd());
+    EXPECT(!wrong_snap);
+    EXPECT(wrong_snap.status() == ShmStatus::layout_mismatch || wrong_snap.status() == ShmStatus::too_small);
+
+    (void)ShmChannel<Ring>::unlink(name);
+}
+
+TEST(test_open_rejects_foreign_region)
+{
+    // A zero-filled region without a published header.
+    const char *name = shm_name("foreign");
+    const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    EXPECT(fd >= 0);
+    EXPECT(::ftruncate(fd, 1 << 20) == 0);
+
+    auto ch = ShmChannel<Ring>::attach(fd);
+    EXPECT(!ch);
+    EXPECT(ch.status() == ShmStatus::not_ready);
+
+    ::close(fd);
+    (void)ShmChannel<Ring>::unlink(name);
+}
+
+TEST(test_open_missing_name)
+{
+    auto ch = ShmChannel<Ring>::open("/stam_test_does_not_exist");
+    EXPECT(!ch);
+    EXPECT(ch.status() == ShmStatus::sys_error);
+}
+
+// ---------------------------------------------------------------------------
+// Cross-process behavior
+// ---------------------------------------------------------------------------
+
+TEST(test_cross_process_spsc_ring)
+{
+    constexpr uint64_t kCount = 50'000;
+
+    auto owner = ShmChannel<Ring>::create_anonymous();
+    EXPECT(static_cast<bool>(owner));
+
+    const pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        auto peer = ShmChannel<Ring>::attach(owner.fd());
+        if (!peer)
+            ::_exit(2);
+        auto r = peer.reader();
+        uint64_t next = 0;
+        while (next < kCount)
+        {
+            Sample s{};
+            if (!r.pop(s))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            if (s.seq != next || s.check != ~next)
+                ::_exit(1);
+            ++next;
+        }
+        ::_exit(0);
+    }
+    EXPECT(pid > 0);
+
+    auto w = owner.writer();
+    for (uint64_t i = 0; i < kCount;)
+    {
+        if (w.push(Sample{i, ~i}))
+            ++i;
+        else
+            std::this_thread::yield();
+    }
+    EXPECT(wait_child(pid) == 0);
+}
+
+TEST(test_cross_process_snapshot)
+{
+    const char *name = shm_name("snap");
+    auto owner = ShmChannel<Snap>::create(name);
+    EXPECT(static_cast<bool>(owner));
+    auto w = owner.writer();
+    w.write(Sample{41, ~uint64_t{41}});
+
+    const pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        auto peer = ShmChannel<Snap>::open(name);
+        if (!peer)
+            ::_exit(2);
+        auto r = peer.reader();
+        Sample s{};
+        ::_exit(r.try_read(s) && s.seq == 41u && s.check == ~uint64_t{41} ? 0 : 1);
+    }
+    EXPECT(pid > 0);
+    EXPECT(wait_child(pid) == 0);
+    (void)ShmChannel<Snap>::unlink(name);
+}
+
+TEST(test_issue_guard_spans_processes)
+{
+    // writer() issued in the owner process; a second writer() from a peer aborts.
+    auto owner = ShmChannel<Ring>::create_anonymous();
+    EXPECT(static_cast<bool>(owner));
+    auto w = owner.writer();
+    (void)w;
+
+    const int fd = owner.fd();
+    const bool aborted = stam::tests::expect_child_abort([fd]
+                                                         {
+        auto peer = ShmChannel<Ring>::attach(fd);
+        if (!peer) ::_exit(2);
+        (void)peer.writer(); });
+    EXPECT(aborted);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point (called from main.cpp)
+// ---------------------------------------------------------------------------
+
+int shm_channel_tests()
+{
+    std::printf("=== ShmChannel tests ===\n\n");
+
+    std::printf("--- header / lifecycle ---\n");
+    RUN(test_default_is_empty);
+    RUN(test_layout_hash_distinguishes_types);
+    RUN(test_create_open_named);
+    RUN(test_open_rejects_layout_mismatch);
+    RUN(test_open_rejects_foreign_region);
+    RUN(test_open_missing_name);
+
+    std::printf("\n--- cross-process ---\n");
+    RUN(test_cross_process_spsc_ring);
+    RUN(test_cross_process_snapshot);
+    RUN(test_issue_guard_spans_processes);
+
+    std::printf("\n  passed: %d / %d\n\n", g_passed, g_total);
+    return 0;
+}
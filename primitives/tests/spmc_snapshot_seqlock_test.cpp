@@ -0,0 +1,379 @@
+/*
+ * spmc_snapshot_seqlock_test.cpp
+ *
+ * Tests for SPMCSnapshotSeqLock (SPMC snapshot, SMP-safe, load-only readers).
+ * Spec: primitives/docs/SPMCSnapshotSeqLock - RT Contract & Invariants.md (Rev 1.0)
+ *
+ * Exit code: 0 = all tests passed (EXPECT aborts immediately on failure).
+ */
+
+#include "stam/primitives/spmc_snapshot_seqlock.hpp"
+#include "test_harness.hpp"
+#include "stam/primitives/snapshot_concepts.hpp"
+#include "stam/sys/sys_align.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace stam::primitives;
+
+namespace stam::primitives
+{
+    template <typename T, uint32_t N, uint32_t K>
+    class SPMCSnapshotSeqLockTest
+    {
+    public:
+        static bool initialized(const SPMCSnapshotSeqLockCore<T, N, K> &core) noexcept
+        {
+            return core.ctrl.initialized.load(std::memory_order_relaxed);
+        }
+        static uint8_t published(const SPMCSnapshotSeqLockCore<T, N, K> &core) noexcept
+        {
+            return core.ctrl.published.load(std::memory_order_relaxed);
+        }
+        static uint32_t seq(const SPMCSnapshotSeqLockCore<T, N, K> &core, uint32_t i) noexcept
+        {
+            return core.seqs[i].seq.load(std::memory_order_relaxed);
+        }
+        static const void *slot_ptr(const SPMCSnapshotSeqLockCore<T, N, K> &core, uint32_t i) noexcept
+        {
+            return &core.slots[i];
+        }
+        static const void *seq_ptr(const SPMCSnapshotSeqLockCore<T, N, K> &core, uint32_t i) noexcept
+        {
+            return &core.seqs[i];
+        }
+        static const void *ctrl_ptr(const SPMCSnapshotSeqLockCore<T, N, K> &core) noexcept
+        {
+            return &core.ctrl;
+        }
+        // Force slot i into "write in progress" (simulates a writer lapping a reader).
+        static void open_slot(SPMCSnapshotSeqLockCore<T, N, K> &core, uint32_t i) noexcept
+        {
+            core.seqs[i].seq.fetch_add(1u, std::memory_order_relaxed);
+        }
+    };
+} // namespace stam::primitives
+
+static int g_total = 0;
+static int g_passed = 0;
+
+static constexpr const char *kSuiteName = "spmc_snapshot_seqlock";
+static int g_failed = 0;
+
+// TEST/RUN/EXPECT provided by test_harness.hpp
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+struct Pod32
+{
+    int32_t x{0};
+    int32_t y{0};
+};
+
+// Payload large enough that a copy spans several cachelines.
+struct LargePod
+{
+    uint64_t words[64]{};
+};
+
+using Small = SPMCSnapshotSeqLock<Pod32, 4>;
+using Small2 = SPMCSnapshotSeqLock<Pod32, 4, 2>;
+using Large = SPMCSnapshotSeqLock<LargePod, 32, 8>;
+using SmallTest = SPMCSnapshotSeqLockTest<Pod32, 4, 4>;
+using Small2Test = SPMCSnapshotSeqLockTest<Pod32, 4, 2>;
+
+static void fill(LargePod &p, uint64_t v) noexcept
+{
+    for (auto &w : p.words)
+        w = v;
+}
+
+static bool consistent(const LargePod &p) noexcept
+{
+    for (const auto &w : p.words)
+    {
+        if (w != p.words[0])
+            return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Contract tests: static / compile-time checks
+// ---------------------------------------------------------------------------
+
+TEST(test_concepts)
+{
+    static_assert(SnapshotWriter<SPMCSnapshotSeqLockWriter<Pod32, 2>, Pod32>,
+                  "SPMCSnapshotSeqLockWriter must satisfy SnapshotWriter");
+    static_assert(SnapshotReader<SPMCSnapshotSeqLockReader<Pod32, 2>, Pod32>,
+                  "SPMCSnapshotSeqLockReader must satisfy SnapshotReader");
+    static_assert(Small::max_readers == 4u);
+    static_assert(Small::slot_count == 4u);
+}
+
+TEST(test_initial_state)
+{
+    Small ch;
+    EXPECT(!SmallTest::initialized(ch.core()));
+    EXPECT(SmallTest::published(ch.core()) == 0u);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT(SmallTest::seq(ch.core(), i) == 0u);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Contract tests: behavior
+// ---------------------------------------------------------------------------
+
+TEST(test_try_read_before_publish_returns_false)
+{
+    Small ch;
+    auto r = ch.reader();
+    Pod32 out{42, 42};
+    EXPECT(!r.try_read(out));
+    EXPECT(out.x == 42 && out.y == 42);
+}
+
+TEST(test_publish_then_read)
+{
+    Small ch;
+    auto w = ch.writer();
+    auto r = ch.reader();
+    w.write({7, 14});
+    Pod32 out{};
+    EXPECT(r.try_read(out));
+    EXPECT(out.x == 7 && out.y == 14);
+}
+
+TEST(test_latest_wins)
+{
+    Small ch;
+    auto w = ch.writer();
+    auto r = ch.reader();
+    for (int i = 1; i <= 10; ++i)
+        w.write({i, -i});
+    Pod32 out{};
+    EXPECT(r.try_read(out));
+    EXPECT(out.x == 10 && out.y == -10);
+}
+
+TEST(test_all_readers_see_same_snapshot)
+{
+    Small ch;
+    auto w = ch.writer();
+    auto r0 = ch.reader();
+    auto r1 = ch.reader();
+    auto r2 = ch.reader();
+    auto r3 = ch.reader();
+    w.write({5, 6});
+    Pod32 a{}, b{}, c{}, d{};
+    EXPECT(r0.try_read(a) && r1.try_read(b) && r2.try_read(c) && r3.try_read(d));
+    EXPECT(a.x == 5 && b.x == 5 && c.x == 5 && d.x == 5);
+}
+
+TEST(test_round_robin_slots)
+{
+    Small ch;
+    auto w = ch.writer();
+    // published starts at 0, so the first write lands in slot 1.
+    for (uint32_t i = 1; i <= 9; ++i)
+    {
+        w.write({static_cast<int32_t>(i), 0});
+        EXPECT(SmallTest::published(ch.core()) == i % 4u);
+    }
+    // Every slot written; all windows closed (even).
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT((SmallTest::seq(ch.core(), i) & 1u) == 0u);
+        EXPECT(SmallTest::seq(ch.core(), i) >= 2u);
+    }
+}
+
+TEST(test_two_slot_configuration)
+{
+    Small2 ch;
+    auto w = ch.writer();
+    auto r = ch.reader();
+    w.write({1, 1});
+    EXPECT(Small2Test::published(ch.core()) == 1u);
+    w.write({2, 2});
+    EXPECT(Small2Test::published(ch.core()) == 0u);
+    Pod32 out{};
+    EXPECT(r.try_read(out));
+    EXPECT(out.x == 2);
+}
+
+TEST(test_read_of_open_slot_returns_false)
+{
+    Small ch;
+    auto w = ch.writer();
+    auto r = ch.reader();
+    w.write({3, 3});
+    Pod32 out{};
+    EXPECT(r.try_read(out));
+
+    // Writer lapped the reader and is rewriting the published slot.
+    const uint8_t pub = SmallTest::published(ch.core());
+    SmallTest::open_slot(ch.core(), pub);
+    Pod32 sticky{9, 9};
+    EXPECT(!r.try_read(sticky));
+    EXPECT(sticky.x == 9 && sticky.y == 9);
+}
+
+TEST(test_readers_are_load_only)
+{
+    // try_read() must not modify any byte of shared state.
+    Small ch;
+    auto w = ch.writer();
+    w.write({11, 22});
+
+    using CoreT = SPMCSnapshotSeqLockCore<Pod32, 4, 4>;
+    alignas(CoreT) unsigned char before[sizeof(CoreT)];
+    std::memcpy(before, static_cast<const void *>(&ch.core()), sizeof(CoreT));
+
+    auto r0 = ch.reader();
+    auto r1 = ch.reader();
+    Pod32 out{};
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT(r0.try_read(out));
+        EXPECT(r1.try_read(out));
+    }
+    EXPECT(std::memcmp(before, static_cast<const void *>(&ch.core()), sizeof(CoreT)) == 0);
+}
+
+TEST(test_writer_guard_fail_fast)
+{
+    Small ch;
+    const bool aborted = stam::tests::expect_double_issue_abort([&]
+                                                                { (void)ch.writer(); });
+    EXPECT(aborted);
+}
+
+TEST(test_reader_guard_fail_fast)
+{
+    Small ch;
+    const bool aborted = stam::tests::expect_issue_limit_abort(4, [&]
+                                                               { (void)ch.reader(); });
+    EXPECT(aborted);
+}
+
+// ---------------------------------------------------------------------------
+// Implementation tests: layout
+// ---------------------------------------------------------------------------
+
+TEST(test_layout_cacheline_separation)
+{
+    Small ch;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT(reinterpret_cast<uintptr_t>(SmallTest::slot_ptr(ch.core(), i)) % SYS_CACHELINE_BYTES == 0u);
+        EXPECT(reinterpret_cast<uintptr_t>(SmallTest::seq_ptr(ch.core(), i)) % SYS_CACHELINE_BYTES == 0u);
+    }
+    EXPECT(reinterpret_cast<uintptr_t>(SmallTest::ctrl_ptr(ch.core())) % SYS_CACHELINE_BYTES == 0u);
+    const auto s0 = reinterpret_cast<uintptr_t>(SmallTest::seq_ptr(ch.core(), 0));
+    const auto s1 = reinterpret_cast<uintptr_t>(SmallTest::seq_ptr(ch.core(), 1));
+    EXPECT(s1 - s0 >= SYS_CACHELINE_BYTES);
+}
+
+// ---------------------------------------------------------------------------
+// Contract tests: multi-threaded behavior
+// ---------------------------------------------------------------------------
+
+// Many readers on a multi-cacheline payload: every successful read is untorn
+// and per-reader values never go backwards.
+TEST(test_stress_many_readers_no_torn_read)
+{
+    constexpr uint64_t kFrames = 200'000;
+    constexpr uint32_t kReaders = 24;
+
+    Large ch;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<int> regressions{0};
+    std::atomic<uint64_t> hits{0};
+
+    std::vector<std::thread> readers;
+    for (uint32_t t = 0; t < kReaders; ++t)
+    {
+        readers.emplace_back([&]
+                             {
+            auto r = ch.reader();
+            LargePod out{};
+            uint64_t last = 0;
+            uint64_t local_hits = 0;
+            while (!done.load(std::memory_order_acquire) || last != kFrames) {
+                if (r.try_read(out)) {
+                    ++local_hits;
+                    if (!consistent(out)) {
+                        torn.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if (out.words[0] < last) {
+                        regressions.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    last = out.words[0];
+                }
+            }
+            hits.fetch_add(local_hits, std::memory_order_relaxed); });
+    }
+
+    std::thread writer_thread([&]
+                              {
+        auto w = ch.writer();
+        LargePod p{};
+        for (uint64_t i = 1; i <= kFrames; ++i) {
+            fill(p, i);
+            w.write(p);
+        }
+        done.store(true, std::memory_order_release); });
+
+    writer_thread.join();
+    for (auto &t : readers)
+        t.join();
+
+    EXPECT(torn.load() == 0);
+    EXPECT(regressions.load() == 0);
+    EXPECT(hits.load() >= kReaders);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point (called from main.cpp)
+// ---------------------------------------------------------------------------
+
+int spmc_snapshot_seqlock_tests()
+{
+    std::printf("=== SPMCSnapshotSeqLock tests ===\n\n");
+
+    std::printf("--- static / compile-time ---\n");
+    RUN(test_concepts);
+    RUN(test_initial_state);
+
+    std::printf("\n--- single-threaded behavior ---\n");
+    RUN(test_try_read_before_publish_returns_false);
+    RUN(test_publish_then_read);
+    RUN(test_latest_wins);
+    RUN(test_all_readers_see_same_snapshot);
+    RUN(test_round_robin_slots);
+    RUN(test_two_slot_configuration);
+    RUN(test_read_of_open_slot_returns_false);
+    RUN(test_readers_are_load_only);
+    RUN(test_writer_guard_fail_fast);
+    RUN(test_reader_guard_fail_fast);
+
+    std::printf("\n--- layout ---\n");
+    RUN(test_layout_cacheline_separation);
+
+    std::printf("\n--- multi-threaded stress ---\n");
+    RUN(test_stress_many_readers_no_torn_read);
+
+    std::printf("\n  passed: %d / %d\n\n", g_passed, g_total);
+    return 0;
+}
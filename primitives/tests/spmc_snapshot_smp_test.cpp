@@ -2,7 +2,7 @@
  * spmc_snapshot_smp_test.cpp
  *
  * Stress tests for SPMCSnapshotSmp (SPMC Snapshot Channel, SMP-safe).
- * Spec: primitives/docs/SPMCSnapshotSmp - RT Contract & Invariants.md (Rev 1.1)
+ * Spec: primitives/docs/SPMCSnapshotSmp - RT Contract & Invariants.md (Rev 1.2)
  */
 
 #include "stam/primitives/spmc_snapshot_smp.hpp"
@@ -28,8 +28,32 @@ public:
     using Core = SPMCSnapshotSmpCore<T, N>;
     using busy_mask_word_t = typename Core::busy_mask_word_t;
 
+    // OR of all busy_mask words: zero iff no slot is claimed.
     static busy_mask_word_t busy_mask(const Core& core) noexcept {
-        return core.ctrl.busy_mask.load(std::memory_order_relaxed);
+        busy_mask_word_t acc = 0;
+        for (uint32_t w = 0; w < Core::busy_mask_words; ++w) {
+            acc |= core.ctrl.busy_mask[w].load(std::memory_order_relaxed);
+        }
+        return acc;
+    }
+
+    // Simulates a reader claim on slot i (busy bit + refcnt), without copying.
+    static void claim(Core& core, uint32_t i) noexcept {
+        core.ctrl.busy_mask[Core::mask_word(i)].fetch_or(Core::mask_bit(i),
+                                                         std::memory_order_acq_rel);
+        core.refcnt[i].fetch_add(1u, std::memory_order_acq_rel);
+    }
+
+    static void release(Core& core, uint32_t i) noexcept {
+        core.release_claim(static_cast<uint8_t>(i));
+    }
+
+    static uint8_t published(const Core& core) noexcept {
+        return core.ctrl.published.load(std::memory_order_relaxed);
+    }
+
+    static constexpr uint32_t mask_words() noexcept {
+        return Core::busy_mask_words;
     }
 
     static uint8_t refcnt_value(const Core& core, uint32_t i) noexcept {
@@ -109,6 +133,86 @@ TEST(test_refcnt_and_busy_mask_cleanup) {
     }
 }
 
+TEST(test_mask_words_fast_path_for_small_n) {
+    // Single-word fast path is kept for every N that fits one signal_mask_t.
+    constexpr uint32_t kMaxSingle = static_cast<uint32_t>(stam::sys::signal_mask_width) - 2u;
+    using Small  = SPMCSnapshotSmpTest<Pod32, 2>;
+    using Single = SPMCSnapshotSmpTest<Pod32, kMaxSingle>;
+    using Wide   = SPMCSnapshotSmpTest<Pod32, kMaxSingle + 1u>;
+    using Max    = SPMCSnapshotSmpTest<Pod32, 254>;
+    EXPECT(Small::mask_words() == 1u);
+    EXPECT(Single::mask_words() == 1u);
+    EXPECT(Wide::mask_words() == 2u);
+    EXPECT(Max::mask_words() ==
+           (256u + stam::sys::signal_mask_width - 1u) / stam::sys::signal_mask_width);
+}
+
+TEST(test_wide_write_read_many_readers) {
+    constexpr uint32_t kN = 100;
+    SPMCSnapshotSmp<Pod32, kN> ch;
+    auto w = ch.writer();
+
+    using Reader = SPMCSnapshotSmpReader<Pod32, kN>;
+    alignas(Reader) unsigned char storage[kN][sizeof(Reader)];
+    Reader* readers[kN];
+    for (uint32_t i = 0; i < kN; ++i) {
+        readers[i] = ::new (storage[i]) Reader(ch.reader());
+    }
+
+    for (int v = 1; v <= 300; ++v) {
+        w.write({v, -v});
+        for (uint32_t i = 0; i < kN; ++i) {
+            Pod32 out{};
+            EXPECT(readers[i]->try_read(out));
+            EXPECT(out.x == v && out.y == -v);
+        }
+    }
+    using Test = SPMCSnapshotSmpTest<Pod32, kN>;
+    EXPECT(Test::busy_mask(ch.core()) == 0u);
+
+    for (uint32_t i = 0; i < kN; ++i) {
+        readers[i]->~Reader();
+    }
+}
+
+TEST(test_wide_writer_skips_claimed_slots_across_words) {
+    // Claim every slot except the published one and one slot in the last word:
+    // the writer must find that slot by scanning past all fully-busy words.
+    constexpr uint32_t kN = 200;
+    using Test = SPMCSnapshotSmpTest<Pod32, kN>;
+    SPMCSnapshotSmp<Pod32, kN> ch;
+    auto w = ch.writer();
+    auto r = ch.reader();
+
+    w.write({1, -1});
+    const uint32_t pub = Test::published(ch.core());
+    const uint32_t free_slot = Test::k_slots() - 1u;
+    EXPECT(pub != free_slot);
+
+    for (uint32_t i = 0; i < Test::k_slots(); ++i) {
+        if (i != pub && i != free_slot) {
+            Test::claim(ch.core(), i);
+        }
+    }
+
+    w.write({2, -2});
+    EXPECT(Test::published(ch.core()) == free_slot);
+
+    Pod32 out{};
+    EXPECT(r.try_read(out));
+    EXPECT(out.x == 2 && out.y == -2);
+
+    for (uint32_t i = 0; i < Test::k_slots(); ++i) {
+        if (i != pub && i != free_slot) {
+            Test::release(ch.core(), i);
+        }
+    }
+    EXPECT(Test::busy_mask(ch.core()) == 0u);
+    for (uint32_t i = 0; i < Test::k_slots(); ++i) {
+        EXPECT(Test::refcnt_value(ch.core(), i) == 0u);
+    }
+}
+
 TEST(test_writer_guard_fail_fast) {
     SPMCSnapshotSmp<Pod32, 2> ch;
     const bool aborted = stam::tests::expect_double_issue_abort([&] {
@@ -248,6 +352,61 @@ TEST(test_stress_sustained_cleanup) {
     }
 }
 
+// Multi-word busy_mask under concurrency: more readers than one mask word holds.
+TEST(test_stress_wide_many_readers_cleanup) {
+    constexpr auto kDuration = std::chrono::milliseconds(200);
+    constexpr uint32_t kN = static_cast<uint32_t>(stam::sys::signal_mask_width) + 8u;
+    using Test = SPMCSnapshotSmpTest<Pod32, kN>;
+    static_assert(Test::mask_words() >= 2u);
+    SPMCSnapshotSmp<Pod32, kN> ch;
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+    std::atomic<int> reads{0};
+
+    std::thread tw([&] {
+        auto w = ch.writer();
+        int i = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            ++i;
+            w.write({i, -i});
+        }
+    });
+
+    auto reader_job = [&] {
+        auto r = ch.reader();
+        Pod32 out{};
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (r.try_read(out)) {
+                reads.fetch_add(1, std::memory_order_relaxed);
+                if (out.x != -out.y) {
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+    std::thread readers[kN];
+    for (auto& t : readers) {
+        t = std::thread(reader_job);
+    }
+
+    std::this_thread::sleep_for(kDuration);
+    stop.store(true, std::memory_order_release);
+
+    tw.join();
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    EXPECT(reads.load() > 0);
+    EXPECT(torn.load() == 0);
+    EXPECT(Test::busy_mask(ch.core()) == 0u);
+    for (uint32_t i = 0; i < Test::k_slots(); ++i) {
+        EXPECT(Test::refcnt_value(ch.core(), i) == 0u);
+    }
+}
+
 // Single-shot SMP behavior diagnostic:
 // after initialization, try_read() may return false when publication changes
 // between claim and re-verify. We report miss/read ratio without hard bound.
@@ -311,6 +470,9 @@ int spmc_snapshot_smp_tests() {
     RUN(test_try_read_before_publish_returns_false);
     RUN(test_write_alias_and_publish_visible);
     RUN(test_refcnt_and_busy_mask_cleanup);
+    RUN(test_mask_words_fast_path_for_small_n);
+    RUN(test_wide_write_read_many_readers);
+    RUN(test_wide_writer_skips_claimed_slots_across_words);
     RUN(test_writer_guard_fail_fast);
     RUN(test_reader_guard_fail_fast);
 
@@ -318,6 +480,7 @@ int spmc_snapshot_smp_tests() {
     RUN(test_stress_n1_no_torn_read);
     RUN(test_stress_n2_no_torn_read);
     RUN(test_stress_sustained_cleanup);
+    RUN(test_stress_wide_many_readers_cleanup);
     RUN(test_stress_single_shot_miss_rate);
 
     std::printf("\n  passed: %d / %d\n\n", g_passed, g_total);
@@ -0,0 +1,208 @@
+/*
+ * sys_clock_test.cpp
+ *
+ * Tests for the counter-based timestamp source (TSC / CNTVCT_EL0 with
+ * CLOCK_MONOTONIC calibration and fallback).
+ * Spec: primitives/docs/Sys — Portability Contract.md (§2, sys_clock.hpp)
+ *
+ * The counter source depends on the host CPU, so tests check the clock
+ * against CLOCK_MONOTONIC with VM-friendly tolerances whatever the source.
+ *
+ * Exit code: 0 = all tests passed (EXPECT aborts immediately on failure).
+ */
+
+#include "stam/sys/sys_clock.hpp"
+#include "test_harness.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace stam::sys;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+static constexpr const char* kSuiteName = "sys_clock";
+static int g_failed = 0;
+
+// TEST/RUN/EXPECT provided by test_harness.hpp
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static uint64_t abs_diff(uint64_t a, uint64_t b) noexcept {
+    return a > b ? a - b : b - a;
+}
+
+static void sleep_ms(long ms) noexcept {
+    timespec req{ms / 1000, (ms % 1000) * 1000000L};
+    while (::nanosleep(&req, &req) != 0 && errno == EINTR) {
+    }
+}
+
+static const sys_clock& calibrated() {
+    static sys_clock clk = [] {
+        sys_clock c;
+        (void)c.calibrate();
+        return c;
+    }();
+    return clk;
+}
+
+// ---------------------------------------------------------------------------
+// Conversion
+// ---------------------------------------------------------------------------
+
+TEST(test_mul_shift_exact) {
+    EXPECT(detail::mul_shift(0, 12345, 7) == 0u);
+    EXPECT(detail::mul_shift(1000, 3, 0) == 3000u);
+    EXPECT(detail::mul_shift(1ull << 40, 1ull << 40, 63) == 1ull << 17);
+    // Product far beyond 64 bits.
+    EXPECT(detail::mul_shift(UINT64_MAX, 1ull << 62, 62) == UINT64_MAX);
+}
+
+TEST(test_scale_for_fast_and_slow_counters) {
+    uint64_t mult = 0;
+    uint32_t shift = 0;
+
+    // 3 GHz TSC → ns: 1/3.
+    detail::scale_for(1, 3, mult, shift);
+    EXPECT(shift == 63u);
+    EXPECT(detail::mul_shift(3000000000ull, mult, shift) == 1000000000u);
+
+    // 24 MHz generic timer → ns: 41.67, shift lowered to keep mult < 2^63.
+    detail::scale_for(1000, 24, mult, shift);
+    EXPECT(shift < 63u);
+    EXPECT(mult < (1ull << 63));
+    EXPECT(abs_diff(detail::mul_shift(24000000ull * 3600, mult, shift), 3600000000000ull) <= 1u);
+
+    // 3 GHz → 100 µs ticks: one tick per 300000 counts, exact at a day.
+    detail::scale_for(1, 300000, mult, shift);
+    EXPECT(detail::mul_shift(300000ull * 864000000ull, mult, shift) == 864000000u);
+}
+
+// ---------------------------------------------------------------------------
+// Clock
+// ---------------------------------------------------------------------------
+
+TEST(test_default_is_monotonic_fallback) {
+    sys_clock clk;
+    EXPECT(clk.source() == sys_clock_source::monotonic);
+    EXPECT(clk.counter_hz() == 0u);
+    const uint64_t a = sys_monotonic_ns();
+    const uint64_t b = clk.now_ns();
+    const uint64_t c = sys_monotonic_ns();
+    EXPECT(a <= b && b <= c);
+    EXPECT(abs_diff(clk.now_ticks(), c / sys_clock_default_tick_ns) <= 1u);
+}
+
+TEST(test_calibrate_picks_available_counter) {
+    const sys_clock& clk = calibrated();
+    const sys_clock_source avail = sys_clock_counter_source();
+    std::printf("(source %d, %llu Hz) ", static_cast<int>(clk.source()),
+                static_cast<unsigned long long>(clk.counter_hz()));
+    if (avail == sys_clock_source::monotonic) {
+        EXPECT(clk.source() == sys_clock_source::monotonic);
+        return;
+    }
+    // A VM may fail the plausibility check; then the fallback is in use.
+    EXPECT(clk.source() == avail || clk.source() == sys_clock_source::monotonic);
+    if (clk.source() != sys_clock_source::monotonic) {
+        EXPECT(clk.counter_hz() >= 1000000u);
+        EXPECT(sys_clock_counter() != 0u);
+    }
+}
+
+TEST(test_tracks_monotonic) {
+    const sys_clock& clk = calibrated();
+    for (int i = 0; i < 5; ++i) {
+        sleep_ms(20);
+        const uint64_t ref = sys_monotonic_ns();
+        const uint64_t ns = clk.now_ns();
+        // Same timebase: within 2 ms after calibration (loaded VM margin).
+        EXPECT(abs_diff(ns, ref) < 2000000u);
+        EXPECT(abs_diff(clk.now_ticks(), ns / clk.tick_ns()) <= 20u);
+    }
+}
+
+TEST(test_custom_tick) {
+    sys_clock clk;
+    (void)clk.calibrate(5000000u, 1000000u); // 1 ms ticks
+    EXPECT(clk.tick_ns() == 1000000u);
+    sleep_ms(10);
+    const uint64_t ref = sys_monotonic_ns() / 1000000u;
+    EXPECT(abs_diff(clk.now_ticks(), ref) <= 2u);
+
+    sys_clock zero;
+    (void)zero.calibrate(1000000u, 0u);
+    EXPECT(zero.tick_ns() == sys_clock_default_tick_ns);
+}
+
+TEST(test_monotonic_per_thread) {
+    const sys_clock& clk = calibrated();
+    uint64_t prev_ns = clk.now_ns();
+    uint64_t prev_tick = clk.now_ticks();
+    for (int i = 0; i < 1000000; ++i) {
+        const uint64_t ns = clk.now_ns();
+        const uint64_t tick = clk.now_ticks();
+        EXPECT(ns >= prev_ns);
+        EXPECT(tick >= prev_tick);
+        prev_ns = ns;
+        prev_tick = tick;
+    }
+}
+
+TEST(test_monotonic_across_threads) {
+    // Causality across cores: a stamp taken after observing another
+    // thread's stamp is never smaller.
+    const sys_clock& clk = calibrated();
+    constexpr int kThreads = 4;
+    constexpr int kRounds = 200000;
+    std::atomic<uint64_t> last{0};
+    std::atomic<int> violations{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < kRounds; ++i) {
+                const uint64_t seen = last.load(std::memory_order_acquire);
+                const uint64_t ns = clk.now_ns();
+                if (ns < seen)
+                    violations.fetch_add(1, std::memory_order_relaxed);
+                uint64_t cur = seen;
+                while (cur < ns && !last.compare_exchange_weak(cur, ns, std::memory_order_release,
+                                                               std::memory_order_acquire)) {
+                }
+            }
+        });
+    }
+    for (auto& th : threads)
+        th.join();
+    EXPECT(violations.load() == 0);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point (called from main.cpp)
+// ---------------------------------------------------------------------------
+
+int sys_clock_tests() {
+    std::printf("=== sys_clock tests ===\n\n");
+
+    std::printf("--- conversion ---\n");
+    RUN(test_mul_shift_exact);
+    RUN(test_scale_for_fast_and_slow_counters);
+
+    std::printf("\n--- clock ---\n");
+    RUN(test_default_is_monotonic_fallback);
+    RUN(test_calibrate_picks_available_counter);
+    RUN(test_tracks_monotonic);
+    RUN(test_custom_tick);
+    RUN(test_monotonic_per_thread);
+    RUN(test_monotonic_across_threads);
+
+    std::printf("\n  passed: %d / %d\n\n", g_passed, g_total);
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * sys_mem_test.cpp
+ *
+ * Tests for the sys_mem placement helper (huge pages / NUMA / prefault / mlock).
+ * Spec: primitives/docs/Sys — Portability Contract.md (§2, sys_mem.hpp)
+ *
+ * Every placement step is best-effort, so tests check the reported flags
+ * for consistency rather than assuming a configured hugetlb pool or NUMA box.
+ *
+ * Exit code: 0 = all tests passed (EXPECT aborts immediately on failure).
+ */
+
+#include "stam/sys/sys_mem.hpp"
+#include "stam/primitives/spsc_ring.hpp"
+#include "stam/primitives/spmc_snapshot_smp.hpp"
+#include "test_harness.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+using namespace stam::sys;
+using namespace stam::primitives;
+
+static int g_total  = 0;
+static int g_passed = 0;
+
+static constexpr const char* kSuiteName = "sys_mem";
+static int g_failed = 0;
+
+// TEST/RUN/EXPECT provided by test_harness.hpp
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+struct Sample {
+    uint64_t seq{0};
+    uint8_t  pad[56]{};
+};
+
+static bool all_zero(const sys_mem_region& r) noexcept {
+    const auto* b = static_cast<const uint8_t*>(r.addr);
+    for (size_t i = 0; i < r.bytes; ++i) {
+        if (b[i] != 0u) return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Region mapping
+// ---------------------------------------------------------------------------
+
+TEST(test_map_zero_bytes_returns_empty) {
+    sys_mem_region r = sys_mem_map(0, sys_mem_policy{});
+    EXPECT(r.addr == nullptr);
+    EXPECT(r.bytes == 0u);
+}
+
+TEST(test_map_base_pages) {
+    sys_mem_policy pol{};
+    pol.prefault = false;
+    pol.lock = false;
+
+    sys_mem_region r = sys_mem_map(100, pol);
+    EXPECT(r.addr != nullptr);
+    EXPECT(r.bytes >= 100u);
+    EXPECT(reinterpret_cast<uintptr_t>(r.addr) % SYS_CACHELINE_BYTES == 0u);
+    EXPECT(!r.has(sys_mem_hugetlb));
+    EXPECT(!r.has(sys_mem_prefaulted));
+    EXPECT(!r.has(sys_mem_locked));
+    EXPECT(all_zero(r));
+
+    sys_mem_unmap(r);
+    EXPECT(r.addr == nullptr);
+    EXPECT(r.bytes == 0u);
+}
+
+TEST(test_map_prefault_and_lock) {
+    sys_mem_policy pol{};
+    sys_mem_region r = sys_mem_map(64 * 1024, pol);
+    EXPECT(r.addr != nullptr);
+    EXPECT(r.has(sys_mem_prefaulted));
+    // mlock may legitimately fail under RLIMIT_MEMLOCK; only check it is reported.
+    std::printf("(locked=%d) ", r.has(sys_mem_locked) ? 1 : 0);
+    EXPECT(all_zero(r));
+    sys_mem_unmap(r);
+}
+
+TEST(test_map_huge_falls_back) {
+    // Without a hugetlb pool MAP_HUGETLB fails; THP fallback keeps a 2M-aligned region.
+    sys_mem_policy pol{};
+    pol.huge_pages = sys_huge_pages::hugetlb;
+    pol.lock = false;
+
+    sys_mem_region r = sys_mem_map(SYS_HUGE_PAGE_SIZE + 1u, pol);
+    EXPECT(r.addr != nullptr);
+    EXPECT(r.bytes % SYS_HUGE_PAGE_SIZE == 0u);
+    EXPECT(r.bytes >= 2u * SYS_HUGE_PAGE_SIZE);
+    EXPECT(reinterpret_cast<uintptr_t>(r.addr) % SYS_HUGE_PAGE_SIZE == 0u);
+    EXPECT(!(r.has(sys_mem_hugetlb) && r.has(sys_mem_thp)));
+    EXPECT(r.has(sys_mem_prefaulted));
+    sys_mem_unmap(r);
+}
+
+TEST(test_map_transparent_alignment) {
+    sys_mem_policy pol{};
+    pol.huge_pages = sys_huge_pages::transparent;
+    pol.prefault = false;
+    pol.lock = false;
+
+    sys_mem_region r = sys_mem_map(4096, pol);
+    EXPECT(r.addr != nullptr);
+    EXPECT(!r.has(sys_mem_hugetlb));
+    EXPECT(r.bytes == SYS_HUGE_PAGE_SIZE);
+    EXPECT(reinterpret_cast<uintptr_t>(r.addr) % SYS_HUGE_PAGE_SIZE == 0u);
+    sys_mem_unmap(r);
+}
+
+TEST(test_map_numa_current_node) {
+    const int32_t node = sys_mem_current_node();
+    sys_mem_policy pol{};
+    pol.numa_node = node;
+    pol.lock = false;
+
+    sys_mem_region r = sys_mem_map(8192, pol);
+    EXPECT(r.addr != nullptr);
+    if (node < 0) {
+        EXPECT(!r.has(sys_mem_numa_bound));
+    }
+    std::printf("(node=%d bound=%d) ", node, r.has(sys_mem_numa_bound) ? 1 : 0);
+    sys_mem_unmap(r);
+}
+
+TEST(test_map_invalid_numa_node_is_not_bound) {
+    sys_mem_policy pol{};
+    pol.numa_node = 100000;
+    pol.lock = false;
+
+    sys_mem_region r = sys_mem_map(4096, pol);
+    EXPECT(r.addr != nullptr);
+    EXPECT(!r.has(sys_mem_numa_bound));
+    sys_mem_unmap(r);
+}
+
+// ---------------------------------------------------------------------------
+// sys_placed<T>
+// ---------------------------------------------------------------------------
+
+TEST(test_placed_default_is_empty) {
+    sys_placed<SPSCRing<Sample, 8>> p;
+    EXPECT(!p);
+    EXPECT(p.get() == nullptr);
+}
+
+TEST(test_placed_spsc_ring_roundtrip) {
+    sys_mem_policy pol{};
+    pol.huge_pages = sys_huge_pages::transparent;
+
+    sys_placed<SPSCRing<Sample, 1024>> ring{pol};
+    EXPECT(static_cast<bool>(ring));
+    EXPECT(reinterpret_cast<uintptr_t>(ring.get()) % SYS_CACHELINE_BYTES == 0u);
+    EXPECT(ring.region().bytes >= sizeof(SPSCRing<Sample, 1024>));
+
+    auto w = ring->writer();
+    auto r = ring->reader();
+    for (uint64_t i = 0; i < 1023; ++i) {
+        EXPECT(w.push(Sample{i, {}}));
+    }
+    EXPECT(!w.push(Sample{}));
+    for (uint64_t i = 0; i < 1023; ++i) {
+        Sample s{};
+        EXPECT(r.pop(s));
+        EXPECT(s.seq == i);
+    }
+}
+
+TEST(test_placed_spmc_snapshot_smp) {
+    sys_placed<SPMCSnapshotSmp<Sample, 4>> snap{sys_mem_policy{}};
+    EXPECT(static_cast<bool>(snap));
+
+    auto w = snap->writer();
+    auto r = snap->reader();
+    Sample out{};
+    EXPECT(!r.try_read(out));
+    w.write(Sample{42, {}});
+    EXPECT(r.try_read(out));
+    EXPECT(out.seq == 42u);
+}
+
+TEST(test_placed_move_transfers_ownership) {
+    sys_placed<SPSCRing<Sample, 8>> a{sys_mem_policy{}};
+    EXPECT(static_cast<bool>(a));
+    auto* obj = a.get();
+
+    sys_placed<SPSCRing<Sample, 8>> b{std::move(a)};
+    EXPECT(!a);
+    EXPECT(b.get() == obj);
+    EXPECT(a.region().addr == nullptr);
+
+    sys_placed<SPSCRing<Sample, 8>> c;
+    c = std::move(b);
+    EXPECT(!b);
+    EXPECT(c.get() == obj);
+
+    c.reset();
+    EXPECT(!c);
+    EXPECT(c.region().addr == nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// Entry point (called from main.cpp)
+// ---------------------------------------------------------------------------
+
+int sys_mem_tests() {
+    std::printf("=== sys_mem tests ===\n\n");
+
+    std::printf("--- region mapping ---\n");
+    RUN(test_map_zero_bytes_returns_empty);
+    RUN(test_map_base_pages);
+    RUN(test_map_prefault_and_lock);
+    RUN(test_map_huge_falls_back);
+    RUN(test_map_transparent_alignment);
+    RUN(test_map_numa_current_node);
+    RUN(test_map_invalid_numa_node_is_not_bound);
+
+    std::printf("\n--- sys_placed<T> ---\n");
+    RUN(test_placed_default_is_empty);
+    RUN(test_placed_spsc_ring_roundtrip);
+    RUN(test_placed_spmc_snapshot_smp);
+    RUN(test_placed_move_transfers_ownership);
+
+    std::printf("\n  passed: %d / %d\n\n", g_passed, g_total);
+    return 0;
+}